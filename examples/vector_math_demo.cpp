@@ -15,6 +15,10 @@
  */
 
 #include "../libraries/vector-math/Vector.hpp"
+#include "../libraries/vector-math/BulkTransform.hpp"
+#include "../libraries/vector-math/BroadPhase.hpp"
+#include "../libraries/vector-math/BoundingVolumes.hpp"
+#include "../libraries/vector-math/MotionTracking.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -22,6 +26,7 @@
 #include <iomanip>
 #include <cmath>
 #include <sstream>
+#include <algorithm>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -662,6 +667,369 @@ void TestPerformanceBenchmarks() {
     }
 }
 
+void TestBulkTransform() {
+    TestResult::PrintHeader("PARALLEL BULK TRANSFORM");
+    
+    TestResult::PrintSubHeader("Point Cloud Rotation and Projection");
+    
+    const size_t pointCount = 200000;
+    std::vector<Vec3> points(pointCount);
+    std::vector<float> xs(pointCount), ys(pointCount), zs(pointCount);
+    for (size_t i = 0; i < pointCount; ++i) {
+        float t = static_cast<float>(i);
+        points[i] = Vec3(std::sin(t * 0.37f) * 50.0f, std::cos(t * 0.11f) * 20.0f, -5.0f - std::fmod(t, 97.0f));
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+        zs[i] = points[i].z;
+    }
+    
+    VectorMath::TaskScheduler scheduler(4);
+    auto rotation = VectorMath::MatrixOps::CreateRotationMatrix(Vec3(0.3f, 1.0f, 0.2f), 0.75f);
+    
+    // AoS rotation against the scalar reference
+    std::vector<Vec3> rotated(pointCount);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    VectorMath::BulkTransform::ApplyRotationMatrix(rotation, points.data(), rotated.data(), pointCount, scheduler);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto bulk_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    
+    bool aos_match = true;
+    for (size_t i = 0; i < pointCount; i += 997) {
+        Vec3 expected = VectorMath::MatrixOps::ApplyRotationMatrix(rotation, points[i]);
+        aos_match = aos_match && IsApproxEqual(rotated[i], expected);
+    }
+    
+    std::cout << "  Rotated " << pointCount << " points in " << bulk_time.count() << " us using "
+              << scheduler.GetThreadCount() << " threads" << std::endl;
+    TestResult::PrintResult("Bulk AoS rotation matches scalar", aos_match);
+    
+    // SoA rotation in place
+    VectorMath::BulkTransform::ApplyRotationMatrix(rotation, ConstVec3SoA(xs.data(), ys.data(), zs.data()),
+                                                  Vec3SoA(xs.data(), ys.data(), zs.data()), pointCount, scheduler);
+    bool soa_match = true;
+    for (size_t i = 0; i < pointCount; i += 997) {
+        soa_match = soa_match && IsApproxEqual(Vec3(xs[i], ys[i], zs[i]), rotated[i]);
+    }
+    TestResult::PrintResult("Bulk SoA in-place rotation", soa_match);
+    
+    // 4x4 transform with perspective divide
+    const float projection[4][4] = {
+        { 1.5f, 0.0f,  0.0f,  0.0f },
+        { 0.0f, 2.0f,  0.0f,  0.0f },
+        { 0.0f, 0.0f, -1.0f, -0.2f },
+        { 0.0f, 0.0f, -1.0f,  0.0f }
+    };
+    std::vector<Vec3> projected(pointCount);
+    VectorMath::BulkTransform::TransformPoints(projection, points.data(), projected.data(), pointCount, scheduler);
+    
+    bool projective_match = true;
+    for (size_t i = 0; i < pointCount; i += 997) {
+        const Vec3& p = points[i];
+        float w = -p.z;
+        Vec3 expected(1.5f * p.x / w, 2.0f * p.y / w, (-p.z - 0.2f) / w);
+        projective_match = projective_match && IsApproxEqual(projected[i], expected);
+    }
+    TestResult::PrintResult("Bulk 4x4 projective transform", projective_match);
+}
+
+void TestBroadPhase() {
+    TestResult::PrintHeader("BROAD-PHASE COLLISION DETECTION");
+    
+    TestResult::PrintSubHeader("Sweep-and-Prune Against Brute Force");
+    
+    const int boxCount = 2000;
+    std::vector<AABB> boxes(boxCount);
+    std::vector<Vec3> velocities(boxCount);
+    for (int i = 0; i < boxCount; ++i) {
+        float t = static_cast<float>(i);
+        Vec3 center(std::fmod(t * 37.1f, 200.0f), std::fmod(t * 11.3f, 150.0f), std::fmod(t * 5.7f, 60.0f));
+        Vec3 half(1.0f + std::fmod(t, 3.0f), 1.0f + std::fmod(t * 0.5f, 2.0f), 1.5f);
+        boxes[i] = AABB(center - half, center + half);
+        velocities[i] = Vec3(std::sin(t) * 0.4f, std::cos(t) * 0.4f, std::sin(t * 0.3f) * 0.2f);
+    }
+    
+    auto bruteForce = [&]() {
+        std::vector<VectorMath::OverlapPair> pairs;
+        for (int i = 0; i < boxCount; ++i) {
+            for (int j = i + 1; j < boxCount; ++j) {
+                if (boxes[i].Overlaps(boxes[j])) {
+                    pairs.emplace_back(i, j);
+                }
+            }
+        }
+        return pairs;
+    };
+    
+    VectorMath::SweepAndPrune singleAxis(VectorMath::SweepAndPrune::Mode::SingleAxis);
+    VectorMath::SweepAndPrune threeAxis(VectorMath::SweepAndPrune::Mode::ThreeAxis);
+    for (int i = 0; i < boxCount; ++i) {
+        singleAxis.AddBox(boxes[i]);
+        threeAxis.AddBox(boxes[i]);
+    }
+    
+    std::vector<VectorMath::OverlapPair> singlePairs, threePairs;
+    bool singleMatch = true;
+    bool threeMatch = true;
+    size_t lastPairCount = 0;
+    long long sapMicros = 0;
+    
+    // Several frames of coherent motion exercise the incremental re-sort
+    for (int frame = 0; frame < 10; ++frame) {
+        for (int i = 0; i < boxCount; ++i) {
+            boxes[i] = AABB(boxes[i].minBounds + velocities[i], boxes[i].maxBounds + velocities[i]);
+            singleAxis.UpdateBox(i, boxes[i]);
+            threeAxis.UpdateBox(i, boxes[i]);
+        }
+        
+        auto start_time = std::chrono::high_resolution_clock::now();
+        singleAxis.FindOverlaps(singlePairs);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        sapMicros += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+        threeAxis.FindOverlaps(threePairs);
+        
+        std::vector<VectorMath::OverlapPair> expected = bruteForce();
+        std::sort(expected.begin(), expected.end());
+        std::sort(singlePairs.begin(), singlePairs.end());
+        std::sort(threePairs.begin(), threePairs.end());
+        singleMatch = singleMatch && singlePairs == expected;
+        threeMatch = threeMatch && threePairs == expected;
+        lastPairCount = expected.size();
+    }
+    
+    std::cout << "  Boxes: " << boxCount << ", overlapping pairs in last frame: " << lastPairCount << std::endl;
+    std::cout << "  Single-axis SAP average: " << sapMicros / 10 << " us/frame" << std::endl;
+    
+    TestResult::PrintResult("Single-axis SAP matches brute force", singleMatch);
+    TestResult::PrintResult("Three-axis incremental SAP matches brute force", threeMatch);
+    
+    // Removing a box drops its pairs
+    threeAxis.RemoveBox(0);
+    threeAxis.FindOverlaps(threePairs);
+    bool removed = std::none_of(threePairs.begin(), threePairs.end(),
+                                [](const VectorMath::OverlapPair& p) { return p.first == 0; });
+    TestResult::PrintResult("Box removal", removed && threeAxis.GetBoxCount() == boxCount - 1);
+}
+
+void TestBoundingVolumes() {
+    TestResult::PrintHeader("CONVEX HULL AND BOUNDING VOLUMES");
+    
+    TestResult::PrintSubHeader("2D Convex Hull");
+    
+    const int pointCount = 20000;
+    std::vector<Vec2> points2D(pointCount);
+    for (int i = 0; i < pointCount; ++i) {
+        float t = static_cast<float>(i);
+        float radius = 50.0f * std::sqrt(std::fmod(t * 0.618034f, 1.0f));
+        float angle = t * 2.39996f;
+        points2D[i] = Vec2(10.0f + radius * std::cos(angle) * 1.5f, -5.0f + radius * std::sin(angle));
+    }
+    
+    VectorMath::BoundingVolumeBuilder builder;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<Vec2> hull = builder.ConvexHull(points2D.data(), points2D.size());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto hullMicros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    
+    // Every hull edge must turn left and keep all points on its left side
+    bool convex = hull.size() >= 3;
+    bool containsAll = true;
+    for (size_t e = 0; e < hull.size() && convex; ++e) {
+        const Vec2& a = hull[e];
+        const Vec2& b = hull[(e + 1) % hull.size()];
+        const Vec2& c = hull[(e + 2) % hull.size()];
+        Vec2 ab = b - a, bc = c - b;
+        convex = ab.x * bc.y - ab.y * bc.x > 0.0f;
+        Vec2 edge = b - a;
+        for (const Vec2& p : points2D) {
+            if (edge.x * (p.y - a.y) - edge.y * (p.x - a.x) < -1e-3f * edge.Length()) {
+                containsAll = false;
+                break;
+            }
+        }
+    }
+    
+    std::cout << "  Points: " << pointCount << ", hull vertices: " << hull.size()
+              << ", time: " << hullMicros << " us" << std::endl;
+    TestResult::PrintResult("Hull is convex and counter-clockwise", convex);
+    TestResult::PrintResult("Hull contains all points", containsAll);
+    
+    std::vector<Vec2> square = { Vec2(0, 0), Vec2(2, 0), Vec2(2, 2), Vec2(0, 2), Vec2(1, 1), Vec2(1, 0), Vec2(0.5f, 1.5f) };
+    TestResult::PrintResult("Square hull drops interior and collinear points",
+                            builder.ConvexHull(square.data(), square.size()).size() == 4);
+    
+    TestResult::PrintSubHeader("Minimum-Area Rectangle");
+    
+    VectorMath::OrientedRect rect = VectorMath::BoundingVolumeBuilder::MinimumAreaRectOfHull(hull.data(), hull.size());
+    Vec2 minorAxis(-rect.axis.y, rect.axis.x);
+    bool rectContains = true;
+    for (const Vec2& p : points2D) {
+        Vec2 d = p - rect.center;
+        if (std::abs(d.Dot(rect.axis)) > rect.halfExtents.x + 1e-2f || std::abs(d.Dot(minorAxis)) > rect.halfExtents.y + 1e-2f) {
+            rectContains = false;
+            break;
+        }
+    }
+    
+    // Brute force over all hull edge directions
+    float bruteArea = 1e30f;
+    for (size_t e = 0; e < hull.size(); ++e) {
+        Vec2 u = hull[(e + 1) % hull.size()] - hull[e];
+        u.Normalize();
+        Vec2 n(-u.y, u.x);
+        float minU = 1e30f, maxU = -1e30f, minN = 1e30f, maxN = -1e30f;
+        for (const Vec2& p : hull) {
+            minU = std::min(minU, p.Dot(u)); maxU = std::max(maxU, p.Dot(u));
+            minN = std::min(minN, p.Dot(n)); maxN = std::max(maxN, p.Dot(n));
+        }
+        bruteArea = std::min(bruteArea, (maxU - minU) * (maxN - minN));
+    }
+    
+    std::cout << "  Rectangle area: " << rect.Area() << " (brute force: " << bruteArea << ")" << std::endl;
+    TestResult::PrintResult("Rectangle contains all points", rectContains);
+    TestResult::PrintResult("Rotating calipers finds minimum area", std::abs(rect.Area() - bruteArea) <= 1e-3f * bruteArea);
+    
+    TestResult::PrintSubHeader("Bounding Spheres and Oriented Boxes");
+    
+    // Elongated, rotated cluster
+    std::vector<Vec3> points3D(pointCount);
+    Vec3 axisA = Vec3(1.0f, 1.0f, 0.0f).Normalized();
+    Vec3 axisB = Vec3(-1.0f, 1.0f, 0.5f).Normalized();
+    Vec3 axisC = axisA.Cross(axisB).Normalized();
+    for (int i = 0; i < pointCount; ++i) {
+        float t = static_cast<float>(i);
+        float a = std::sin(t * 0.7919f) * 40.0f;
+        float b = std::sin(t * 1.3137f) * 10.0f;
+        float c = std::cos(t * 0.5151f) * 3.0f;
+        points3D[i] = Vec3(100.0f, 50.0f, -20.0f) + axisA * a + axisB * b + axisC * c;
+    }
+    
+    VectorMath::BoundingSphere ritter = VectorMath::BoundingVolumeBuilder::RitterSphere(points3D.data(), points3D.size());
+    VectorMath::BoundingSphere minimum = builder.MinimumSphere(points3D.data(), points3D.size());
+    VectorMath::OrientedBox box = VectorMath::BoundingVolumeBuilder::FitOBB(points3D.data(), points3D.size());
+    
+    bool ritterContains = true, minimumContains = true, boxContains = true;
+    for (const Vec3& p : points3D) {
+        ritterContains = ritterContains && ritter.Contains(p, 1e-3f);
+        minimumContains = minimumContains && minimum.Contains(p, 1e-3f);
+        boxContains = boxContains && box.Contains(p, 1e-3f);
+    }
+    
+    std::cout << "  Ritter radius: " << ritter.radius << ", minimum radius: " << minimum.radius << std::endl;
+    std::cout << "  OBB volume: " << box.Volume() << std::endl;
+    TestResult::PrintResult("Ritter sphere contains all points", ritterContains);
+    TestResult::PrintResult("Minimum sphere contains all points", minimumContains);
+    TestResult::PrintResult("Minimum sphere not larger than Ritter", minimum.radius <= ritter.radius + 1e-3f);
+    TestResult::PrintResult("OBB contains all points", boxContains);
+    TestResult::PrintResult("OBB aligns with cluster", std::abs(box.axes[0].Dot(axisA)) > 0.99f && box.halfExtents.x <= 40.5f);
+}
+
+void TestMotionTracking() {
+    TestResult::PrintHeader("MOTION TRACKING AND PREDICTION");
+    
+    const size_t trackCount = 10000;
+    std::vector<Vec3> origins(trackCount), velocities(trackCount), accelerations(trackCount);
+    for (size_t i = 0; i < trackCount; ++i) {
+        float t = static_cast<float>(i);
+        origins[i] = Vec3(std::fmod(t * 13.7f, 500.0f), std::fmod(t * 7.1f, 300.0f), std::fmod(t, 20.0f));
+        velocities[i] = Vec3(std::sin(t) * 8.0f, std::cos(t) * 8.0f, std::sin(t * 0.7f));
+        accelerations[i] = Vec3(std::cos(t * 0.3f) * 2.0f, std::sin(t * 0.9f) * 2.0f, -1.0f);
+    }
+    
+    auto truePosition = [&](size_t i, double time, bool accelerate) {
+        float s = static_cast<float>(time);
+        Vec3 p = origins[i] + velocities[i] * s;
+        return accelerate ? p + accelerations[i] * (0.5f * s * s) : p;
+    };
+    
+    const double pollInterval = 0.1;  // 10 Hz source
+    const double baseTime = 1000.0;
+    std::vector<Vec3> samples(trackCount), predicted(trackCount);
+    
+    auto maxError = [&](bool accelerate, double time) {
+        float worst = 0.0f;
+        for (size_t i = 0; i < trackCount; ++i) {
+            worst = std::max(worst, predicted[i].Distance(truePosition(i, time - baseTime, accelerate)));
+        }
+        return worst;
+    };
+    
+    TestResult::PrintSubHeader("Constant Velocity and Acceleration Models");
+    
+    VectorMath::MotionTracker velocityTracker(trackCount, VectorMath::MotionTracker::Model::ConstantVelocity);
+    VectorMath::MotionTracker accelerationTracker(trackCount, VectorMath::MotionTracker::Model::ConstantAcceleration);
+    
+    long long pushMicros = 0;
+    for (int tick = 0; tick < 5; ++tick) {
+        double time = baseTime + tick * pollInterval;
+        for (size_t i = 0; i < trackCount; ++i) samples[i] = truePosition(i, time - baseTime, false);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        velocityTracker.PushSamples(time, samples.data(), trackCount);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        pushMicros += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+        
+        for (size_t i = 0; i < trackCount; ++i) samples[i] = truePosition(i, time - baseTime, true);
+        accelerationTracker.PushSamples(time, samples.data(), trackCount);
+    }
+    
+    // Extrapolate half a poll interval past the newest sample
+    double queryTime = baseTime + 4 * pollInterval + 0.05;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    velocityTracker.PredictAll(queryTime, predicted.data());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto predictMicros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    float velocityError = maxError(false, queryTime);
+    
+    accelerationTracker.PredictAll(queryTime, predicted.data());
+    float accelerationError = maxError(true, queryTime);
+    
+    std::cout << "  Tracks: " << trackCount << ", push: " << pushMicros / 5 << " us/tick, predict: "
+              << predictMicros << " us" << std::endl;
+    std::cout << "  Max error CV: " << velocityError << ", CA: " << accelerationError << std::endl;
+    TestResult::PrintResult("Constant velocity extrapolation", velocityError < 1e-2f);
+    TestResult::PrintResult("Constant acceleration extrapolation", accelerationError < 1e-2f);
+    
+    Vec3 single = accelerationTracker.Predict(1234, queryTime);
+    TestResult::PrintResult("Single-track prediction matches batch", single.Distance(predicted[1234]) < 1e-4f);
+    
+    // Querying between the last two samples interpolates the history
+    double pastTime = baseTime + 3.5 * pollInterval;
+    velocityTracker.PredictAll(pastTime, predicted.data());
+    TestResult::PrintResult("Interpolation behind newest sample", maxError(false, pastTime) < 1e-2f);
+    
+    TestResult::PrintSubHeader("Alpha-Beta Smoothing");
+    
+    VectorMath::MotionTracker smoothTracker(trackCount, VectorMath::MotionTracker::Model::AlphaBeta);
+    VectorMath::MotionTracker rawTracker(trackCount, VectorMath::MotionTracker::Model::ConstantVelocity);
+    for (int tick = 0; tick < 40; ++tick) {
+        double time = baseTime + tick * pollInterval;
+        for (size_t i = 0; i < trackCount; ++i) {
+            // Deterministic measurement noise of +-0.3 units
+            float noise = std::sin(static_cast<float>(i * 31 + tick * 17)) * 0.3f;
+            samples[i] = truePosition(i, time - baseTime, false) + Vec3(noise, -noise, 0.0f);
+        }
+        smoothTracker.PushSamples(time, samples.data(), trackCount);
+        rawTracker.PushSamples(time, samples.data(), trackCount);
+    }
+    
+    float smoothVelocityError = 0.0f, rawVelocityError = 0.0f;
+    for (size_t i = 0; i < trackCount; ++i) {
+        smoothVelocityError += smoothTracker.GetVelocity(i).Distance(velocities[i]);
+        rawVelocityError += rawTracker.GetVelocity(i).Distance(velocities[i]);
+    }
+    smoothVelocityError /= trackCount;
+    rawVelocityError /= trackCount;
+    
+    std::cout << "  Mean velocity error alpha-beta: " << smoothVelocityError
+              << ", raw differences: " << rawVelocityError << std::endl;
+    TestResult::PrintResult("Alpha-beta reduces velocity noise", smoothVelocityError < rawVelocityError * 0.5f);
+    
+    smoothTracker.ResetTrack(0);
+    smoothTracker.PushSample(0, baseTime + 100.0, Vec3(1.0f, 2.0f, 3.0f));
+    TestResult::PrintResult("Track reset and single-sample push",
+                            smoothTracker.GetSampleCount(0) == 1 &&
+                            smoothTracker.Predict(0, baseTime + 100.5).Distance(Vec3(1.0f, 2.0f, 3.0f)) < 1e-5f);
+}
+
 void TestRealWorldScenarios() {
     TestResult::PrintHeader("REAL-WORLD USAGE SCENARIOS");
     
@@ -784,6 +1152,10 @@ int main() {
     TestInterpolation();
     TestPerformanceBenchmarks();
     TestRealWorldScenarios();
+    TestBulkTransform();
+    TestBroadPhase();
+    TestBoundingVolumes();
+    TestMotionTracking();
     
     // Print final results
     TestResult::PrintFinalResults();
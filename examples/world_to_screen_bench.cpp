@@ -0,0 +1,418 @@
+/**
+ * @file world_to_screen_bench.cpp
+ * @brief Throughput benchmarks for the WorldToScreen projection and culling paths
+ * @author Lukas Ernst
+ *
+ * Measures point projection (WorldToScreen, QuickWorldToScreen, QuickWorldToScreenFused,
+ * WorldToScreenBatch, WorldToScreenParallel) and box tests (IsBoundingBoxVisible, Frustum::CullAABBs,
+ * GetScreenBounds, GetScreenBoundsBatch) as scalar, SIMD and threaded variants
+ * on synthetic scenes:
+ * - uniform: points spread over the whole camera volume, some behind the camera
+ * - clustered: the same volume with points packed around 64 centers
+ *
+ * Every case is repeated until a minimum time has passed (at least three runs);
+ * each run is one pass over all points, reported as ns per point. The table and
+ * the optional JSON export give the median (p50), p99 (nearest rank) and mean
+ * per point and the median throughput. For box benchmarks a point is one box.
+ *
+ * Usage:
+ *   world_to_screen_bench [--sizes 1000,100000,1000000] [--scenes uniform,clustered]
+ *                         [--threads N] [--min-time SECONDS] [--filter TEXT] [--json FILE]
+ *
+ * Sizes go up to 50000000; the largest runs need about 2 GB of memory.
+ * "simd" is the level the benchmark was compiled for; the batch projection
+ * kernels are picked at runtime, reported as "projection_kernel". Set
+ * VECTORMATH_SIMD_LEVEL to scalar, sse2, avx2 or avx512 to cap them.
+ */
+
+#include "../libraries/world-to-screen/WorldToScreen.hpp"
+#include "../libraries/world-to-screen/FrustumCulling.hpp"
+#include "../libraries/world-to-screen/ProjectionKernels.hpp"
+#include "../libraries/vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMinRepetitions = 3;
+constexpr size_t kMaxRepetitions = 1000;
+constexpr size_t kMaxPoints = 50000000;
+
+// Threaded variants split the input in chunks aligned to the 32-bit mask words
+constexpr size_t kThreadGrain = 32768;
+
+// Keeps results observable so the compiler cannot drop a measured pass
+volatile float g_sink = 0.0f;
+
+struct Options {
+    std::vector<size_t> sizes = { 1000, 100000, 1000000 };
+    std::vector<std::string> scenes = { "uniform", "clustered" };
+    unsigned threads = 0;
+    double minTime = 0.25;
+    std::string filter;
+    std::string jsonPath;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string variant;
+    std::string scene;
+    size_t count;
+    size_t repetitions;
+    double p50;                 // ns per point
+    double p99;
+    double mean;
+    double pointsPerSecond;     // at the median
+};
+
+/**
+ * @brief Synthetic points and boxes as SoA streams
+ */
+struct Scene {
+    std::string name;
+    size_t count;
+    std::vector<float> x, y, z;
+    std::vector<float> maxX, maxY, maxZ;    // boxes span (x, y, z) to (maxX, maxY, maxZ)
+};
+
+std::vector<size_t> ParseSizes(const std::string& text) {
+    std::vector<size_t> sizes;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const size_t size = static_cast<size_t>(std::strtoull(item.c_str(), nullptr, 10));
+        if (size > 0) {
+            sizes.push_back(std::min(size, kMaxPoints));
+        }
+    }
+    return sizes;
+}
+
+std::vector<std::string> ParseList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            options.sizes = ParseSizes(argv[++i]);
+        } else if (arg == "--scenes" && hasValue) {
+            options.scenes = ParseList(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTime = std::max(0.0, std::strtod(argv[++i], nullptr));
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--sizes 1000,100000,1000000] [--scenes uniform,clustered]"
+                      << " [--threads N] [--min-time SECONDS] [--filter TEXT] [--json FILE]" << std::endl;
+            return false;
+        }
+    }
+    for (const std::string& scene : options.scenes) {
+        if (scene != "uniform" && scene != "clustered") {
+            std::cerr << "Unknown scene: " << scene << std::endl;
+            return false;
+        }
+    }
+    return !options.sizes.empty() && !options.scenes.empty();
+}
+
+/**
+ * @brief Fills a scene; the same name and count always give the same points
+ */
+void GenerateScene(const std::string& name, size_t count, Scene& scene) {
+    scene.name = name;
+    scene.count = count;
+    for (std::vector<float>* stream : { &scene.x, &scene.y, &scene.z, &scene.maxX, &scene.maxY, &scene.maxZ }) {
+        stream->resize(count);
+    }
+
+    // Camera volume: 400 wide, 100 high, from 50 behind the camera to 400 in front
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> spanX(-200.0f, 200.0f), spanY(-50.0f, 50.0f), spanZ(-400.0f, 50.0f);
+    std::uniform_real_distribution<float> halfSize(0.5f, 3.0f);
+
+    std::vector<Vec3> centers(64);
+    for (Vec3& center : centers) {
+        center = Vec3(spanX(random), spanY(random), spanZ(random));
+    }
+    std::normal_distribution<float> spread(0.0f, 4.0f);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (name == "clustered") {
+            const Vec3& center = centers[i % centers.size()];
+            scene.x[i] = center.x + spread(random);
+            scene.y[i] = center.y + spread(random);
+            scene.z[i] = center.z + spread(random);
+        } else {
+            scene.x[i] = spanX(random);
+            scene.y[i] = spanY(random);
+            scene.z[i] = spanZ(random);
+        }
+        const float half = halfSize(random);
+        scene.maxX[i] = scene.x[i] + 2.0f * half;
+        scene.maxY[i] = scene.y[i] + 2.0f * half;
+        scene.maxZ[i] = scene.z[i] + 2.0f * half;
+    }
+}
+
+double Percentile(const std::vector<double>& sorted, double fraction) {
+    const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+/**
+ * @brief Runs body (one full pass) until minTime has passed, after one warm-up pass
+ */
+template <typename Body>
+BenchResult Measure(const char* name, const char* variant, const Scene& scene, double minTime, Body body) {
+    using Clock = std::chrono::steady_clock;
+
+    body();
+
+    std::vector<double> samples;
+    const Clock::time_point start = Clock::now();
+    while (samples.size() < kMinRepetitions ||
+           (samples.size() < kMaxRepetitions && std::chrono::duration<double>(Clock::now() - start).count() < minTime)) {
+        const Clock::time_point runStart = Clock::now();
+        body();
+        const Clock::time_point runEnd = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(runEnd - runStart).count() /
+                          static_cast<double>(scene.count));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.name = name;
+    result.variant = variant;
+    result.scene = scene.name;
+    result.count = scene.count;
+    result.repetitions = samples.size();
+    result.p50 = Percentile(samples, 0.50);
+    result.p99 = Percentile(samples, 0.99);
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    result.mean = sum / static_cast<double>(samples.size());
+    result.pointsPerSecond = result.p50 > 0.0 ? 1e9 / result.p50 : 0.0;
+    return result;
+}
+
+void PrintHeader() {
+    std::cout << std::left << std::setw(24) << "Benchmark" << std::setw(10) << "Variant" << std::setw(11) << "Scene"
+              << std::right << std::setw(10) << "Points" << std::setw(6) << "Runs" << std::setw(11) << "p50 ns/pt"
+              << std::setw(11) << "p99 ns/pt" << std::setw(12) << "Mpoints/s" << std::endl;
+    std::cout << std::string(95, '-') << std::endl;
+}
+
+void PrintResult(const BenchResult& result) {
+    std::cout << std::left << std::setw(24) << result.name << std::setw(10) << result.variant
+              << std::setw(11) << result.scene << std::right << std::setw(10) << result.count
+              << std::setw(6) << result.repetitions << std::fixed << std::setprecision(3)
+              << std::setw(11) << result.p50 << std::setw(11) << result.p99 << std::setprecision(1)
+              << std::setw(12) << result.pointsPerSecond / 1e6 << std::defaultfloat << std::endl;
+}
+
+bool WriteJson(const std::string& path, const Options& options, unsigned threads,
+               const std::vector<BenchResult>& results) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << "{\n";
+    file << "  \"simd\": \"" << VectorMath::SIMD::kName << "\",\n";
+    file << "  \"projection_kernel\": \""
+         << VectorMath::GetSimdLevelName(ProjectionKernels::GetProjectPointsLevel()) << "\",\n";
+    file << "  \"threads\": " << threads << ",\n";
+    file << "  \"min_time_s\": " << options.minTime << ",\n";
+    file << "  \"results\": [\n";
+    file << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        file << "    {\"name\": \"" << r.name << "\", \"variant\": \"" << r.variant << "\", \"scene\": \"" << r.scene
+             << "\", \"count\": " << r.count << ", \"repetitions\": " << r.repetitions
+             << ", \"ns_per_point_p50\": " << r.p50 << ", \"ns_per_point_p99\": " << r.p99
+             << ", \"ns_per_point_mean\": " << r.mean << ", \"points_per_second\": " << r.pointsPerSecond << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    VectorMath::TaskScheduler scheduler(options.threads);
+
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 1000.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 5.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    WorldToScreenTransform transform(viewport);
+    transform.SetViewMatrix(viewProj);
+    const Matrix4x4 screenMatrix = transform.GetScreenMatrix();
+    const Frustum frustum = Frustum::FromTransform(transform);
+
+    std::cout << "WorldToScreen benchmarks: " << VectorMath::SIMD::kName << " (projection kernel "
+              << VectorMath::GetSimdLevelName(ProjectionKernels::GetProjectPointsLevel()) << "), threads: "
+              << scheduler.GetThreadCount() << ", min " << options.minTime << " s per case" << std::endl;
+    std::cout << std::endl;
+    PrintHeader();
+
+    std::vector<BenchResult> results;
+    Scene scene;
+    std::vector<float> outX, outY, outZ, outW;
+    std::vector<uint32_t> mask;
+
+    for (size_t count : options.sizes) {
+        for (const std::string& sceneName : options.scenes) {
+            GenerateScene(sceneName, count, scene);
+            outX.resize(count);
+            outY.resize(count);
+            outZ.resize(count);
+            outW.resize(count);
+            mask.assign((count + 31) / 32, 0);
+
+            const ConstVec3SoA points(scene.x.data(), scene.y.data(), scene.z.data());
+            const ConstVec3SoA boxMax(scene.maxX.data(), scene.maxY.data(), scene.maxZ.data());
+            const W2SUtils::ScreenRectSoA rects(outX.data(), outY.data(), outZ.data(), outW.data());
+
+            auto run = [&](const char* name, const char* variant, auto body) {
+                const std::string label = std::string(name) + " " + variant;
+                if (!options.filter.empty() && label.find(options.filter) == std::string::npos) {
+                    return;
+                }
+                results.push_back(Measure(name, variant, scene, options.minTime, body));
+                PrintResult(results.back());
+            };
+
+            // Point projection
+            run("WorldToScreen", "scalar", [&]() {
+                Vec2 screen;
+                for (size_t i = 0; i < count; ++i) {
+                    transform.WorldToScreen(Vec3(scene.x[i], scene.y[i], scene.z[i]), screen);
+                    outX[i] = screen.x;
+                    outY[i] = screen.y;
+                }
+                g_sink = outX[count / 2];
+            });
+            run("QuickWorldToScreen", "scalar", [&]() {
+                Vec2 screen;
+                for (size_t i = 0; i < count; ++i) {
+                    W2SUtils::QuickWorldToScreen(Vec3(scene.x[i], scene.y[i], scene.z[i]), viewProj, viewport, screen);
+                    outX[i] = screen.x;
+                    outY[i] = screen.y;
+                }
+                g_sink = outX[count / 2];
+            });
+            // Same projection with the viewport folded into the matrix once per frame
+            run("QuickWorldToScreenFused", "scalar", [&]() {
+                Vec2 screen;
+                for (size_t i = 0; i < count; ++i) {
+                    W2SUtils::QuickWorldToScreenFused(Vec3(scene.x[i], scene.y[i], scene.z[i]), screenMatrix, screen);
+                    outX[i] = screen.x;
+                    outY[i] = screen.y;
+                }
+                g_sink = outX[count / 2];
+            });
+            run("WorldToScreenBatch", "simd", [&]() {
+                g_sink = static_cast<float>(transform.WorldToScreenBatch(points, outX.data(), outY.data(), mask.data(),
+                                                                         static_cast<int>(count)));
+            });
+            run("WorldToScreenBatch", "threaded", [&]() {
+                g_sink = static_cast<float>(transform.WorldToScreenParallel(points, outX.data(), outY.data(), mask.data(),
+                                                                            count, scheduler));
+            });
+
+            // Box visibility
+            run("IsBoundingBoxVisible", "scalar", [&]() {
+                size_t visible = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    visible += W2SUtils::IsBoundingBoxVisible(Vec3(scene.x[i], scene.y[i], scene.z[i]),
+                                                              Vec3(scene.maxX[i], scene.maxY[i], scene.maxZ[i]),
+                                                              viewProj, viewport) ? 1 : 0;
+                }
+                g_sink = static_cast<float>(visible);
+            });
+            run("Frustum::CullAABBs", "simd", [&]() {
+                g_sink = static_cast<float>(frustum.CullAABBs(points, boxMax, count, mask.data()));
+            });
+            run("Frustum::CullAABBs", "threaded", [&]() {
+                scheduler.ParallelFor(count, kThreadGrain, [&](size_t begin, size_t end) {
+                    frustum.CullAABBs(ConstVec3SoA(points.x + begin, points.y + begin, points.z + begin),
+                                      ConstVec3SoA(boxMax.x + begin, boxMax.y + begin, boxMax.z + begin),
+                                      end - begin, mask.data() + begin / 32);
+                });
+                g_sink = static_cast<float>(mask[0]);
+            });
+
+            // Box screen bounds
+            run("GetScreenBounds", "scalar", [&]() {
+                for (size_t i = 0; i < count; ++i) {
+                    W2SUtils::ScreenRect rect = W2SUtils::GetScreenBounds(Vec3(scene.x[i], scene.y[i], scene.z[i]),
+                                                                         Vec3(scene.maxX[i], scene.maxY[i], scene.maxZ[i]),
+                                                                         viewProj, viewport);
+                    outX[i] = rect.left;
+                    outY[i] = rect.right;
+                    outZ[i] = rect.top;
+                    outW[i] = rect.bottom;
+                }
+                g_sink = outX[count / 2];
+            });
+            run("GetScreenBoundsBatch", "simd", [&]() {
+                g_sink = static_cast<float>(W2SUtils::GetScreenBoundsBatch(points, boxMax, count, viewProj, viewport,
+                                                                           rects, mask.data()));
+            });
+            run("GetScreenBoundsBatch", "threaded", [&]() {
+                scheduler.ParallelFor(count, kThreadGrain, [&](size_t begin, size_t end) {
+                    W2SUtils::GetScreenBoundsBatch(ConstVec3SoA(points.x + begin, points.y + begin, points.z + begin),
+                                                   ConstVec3SoA(boxMax.x + begin, boxMax.y + begin, boxMax.z + begin),
+                                                   end - begin, viewProj, viewport,
+                                                   W2SUtils::ScreenRectSoA(rects.left + begin, rects.right + begin,
+                                                                           rects.top + begin, rects.bottom + begin),
+                                                   mask.data() + begin / 32);
+                });
+                g_sink = outX[count / 2];
+            });
+        }
+    }
+
+    if (!options.jsonPath.empty()) {
+        if (!WriteJson(options.jsonPath, options, scheduler.GetThreadCount(), results)) {
+            std::cerr << "Could not write " << options.jsonPath << std::endl;
+            return 1;
+        }
+        std::cout << std::endl << "Results written to " << options.jsonPath << std::endl;
+    }
+    return 0;
+}
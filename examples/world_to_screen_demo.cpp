@@ -15,6 +15,26 @@
  */
 
 #include "../libraries/world-to-screen/WorldToScreen.hpp"
+#include "../libraries/world-to-screen/CameraState.hpp"
+#include "../libraries/world-to-screen/CullingBVH.hpp"
+#include "../libraries/world-to-screen/FrustumCulling.hpp"
+#include "../libraries/world-to-screen/OcclusionCulling.hpp"
+#include "../libraries/world-to-screen/OverlayLOD.hpp"
+#include "../libraries/world-to-screen/OverlayRenderer.hpp"
+#include "../libraries/world-to-screen/ProjectionCache.hpp"
+#include "../libraries/world-to-screen/ProjectionKernels.hpp"
+#include "../libraries/world-to-screen/ScreenPicking.hpp"
+#include "../libraries/world-to-screen/SkeletonProjection.hpp"
+#include "../libraries/world-to-screen/TransformHierarchy.hpp"
+#include "../libraries/vector-math/CpuFeatures.hpp"
+#include "../libraries/vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -22,6 +42,7 @@
 #include <iomanip>
 #include <cmath>
 #include <sstream>
+#include <thread>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -805,6 +826,222 @@ void TestRealWorldScenarios() {
     TestResult::PrintResult("CAD orthographic projection", visibleBracketVertices > 0);
 }
 
+void TestLargeWorldCoordinates() {
+    TestResult::PrintHeader("LARGE WORLD COORDINATES");
+    
+    TestResult::PrintSubHeader("Camera-Relative Double Precision Projection");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(60.0f), 16.0f/9.0f, 0.1f, 1000.0f);
+    
+    // Camera 150 km from the world origin, target 10 units in front of it
+    Vec3d cameraPos(150000.37, 2.0, 120000.71);
+    Vec3d targetPos = cameraPos + Vec3d(1.25, 0.5, -10.0);
+    
+    // Reference: the same relative offset projected at the origin
+    Vec2 expected;
+    WorldToScreenTransform reference(viewport);
+    reference.SetViewMatrix(projMatrix);
+    reference.WorldToScreen(Vec3(1.25f, 0.5f, -10.0f), expected);
+    
+    CameraRelativeTransform cameraRelative(viewport);
+    cameraRelative.SetCamera(cameraPos, projMatrix);
+    Vec2 relativeResult;
+    bool relativeOk = cameraRelative.WorldToScreen(targetPos, relativeResult);
+    
+    // Absolute double matrix rebased internally
+    Matrix4x4d absoluteViewProj = Matrix4x4d(projMatrix) * Matrix4x4d::CreateTranslation(Vec3d() - cameraPos);
+    CameraRelativeTransform rebased(viewport);
+    rebased.SetViewMatrix(absoluteViewProj, cameraPos);
+    Vec2 rebasedResult;
+    bool rebasedOk = rebased.WorldToScreen(targetPos, rebasedResult);
+    
+    // Naive float path for comparison
+    Matrix4x4 floatViewProj = absoluteViewProj.ToFloat();
+    Vec2 floatResult;
+    W2SUtils::QuickWorldToScreen(targetPos.ToFloat(), floatViewProj, viewport, floatResult);
+    
+    std::cout << "  Expected screen position:    " << Vec2ToString(expected) << std::endl;
+    std::cout << "  Camera-relative (SetCamera): " << Vec2ToString(relativeResult) << std::endl;
+    std::cout << "  Camera-relative (rebased):   " << Vec2ToString(rebasedResult) << std::endl;
+    std::cout << "  Plain float path:            " << Vec2ToString(floatResult) << std::endl;
+    
+    TestResult::PrintResult("Camera-relative projection precision", relativeOk && IsApproxEqual(relativeResult, expected, 1e-2f));
+    TestResult::PrintResult("Rebased double view-projection", rebasedOk && IsApproxEqual(rebasedResult, expected, 1e-2f));
+    
+    // Batch path
+    Vec3d batchPoints[3] = { targetPos, cameraPos + Vec3d(0.0, 0.0, 5.0), cameraPos + Vec3d(-2.0, 1.0, -20.0) };
+    Vec2 batchResults[3];
+    int batchCount = cameraRelative.WorldToScreenBatch(batchPoints, batchResults, 3);
+    
+    TestResult::PrintResult("Camera-relative batch projection",
+                            batchCount == 2 && IsApproxEqual(batchResults[0], expected, 1e-2f) &&
+                            batchResults[1].x == -1.0f && batchResults[1].y == -1.0f);
+}
+
+void TestSIMDBatchProjection() {
+    TestResult::PrintHeader("SIMD BATCH PROJECTION");
+    
+    TestResult::PrintSubHeader("SoA Kernel Against Scalar Reference");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 2.0f, 10.0f), 5.0f, 15.0f, 0.0f);
+    
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix * viewMatrix);
+    
+    // Point field around the camera, roughly a fifth of it behind
+    const int numPoints = 100000;
+    std::vector<float> xs(numPoints), ys(numPoints), zs(numPoints);
+    std::vector<Vec3> aos(numPoints);
+    for (int i = 0; i < numPoints; ++i) {
+        float t = static_cast<float>(i);
+        xs[i] = std::fmod(t * 7.31f, 100.0f) - 50.0f;
+        ys[i] = std::fmod(t * 3.17f, 20.0f) - 10.0f;
+        zs[i] = std::fmod(t * 1.13f, 130.0f) - 100.0f;
+        aos[i] = Vec3(xs[i], ys[i], zs[i]);
+    }
+    
+    std::vector<float> screenX(numPoints), screenY(numPoints);
+    std::vector<uint32_t> mask((numPoints + 31) / 32);
+    std::vector<Vec2> aosResults(numPoints);
+    
+    // Best of several runs to keep the timing stable
+    long long bestNanos = -1;
+    int visibleCount = 0;
+    for (int run = 0; run < 5; ++run) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        visibleCount = transformer.WorldToScreenBatch(VectorMath::ConstVec3SoA(xs.data(), ys.data(), zs.data()),
+                                                      screenX.data(), screenY.data(), mask.data(), numPoints);
+        auto endTime = std::chrono::high_resolution_clock::now();
+        long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        bestNanos = (bestNanos < 0 || nanos < bestNanos) ? nanos : bestNanos;
+    }
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    int scalarCount = 0;
+    Vec2 scalarResult;
+    bool resultsMatch = true;
+    float maxError = 0.0f;
+    for (int i = 0; i < numPoints; ++i) {
+        bool visible = transformer.WorldToScreen(aos[i], scalarResult);
+        scalarCount += visible ? 1 : 0;
+        bool maskBit = (mask[i >> 5] >> (i & 31)) & 1u;
+        if (visible != maskBit) {
+            resultsMatch = false;
+        } else if (visible) {
+            // Off-screen points near the camera plane amplify rounding, compare on-screen pixels only
+            if (viewport.IsPointInside(scalarResult)) {
+                float error = std::max(std::abs(screenX[i] - scalarResult.x), std::abs(screenY[i] - scalarResult.y));
+                maxError = std::max(maxError, error);
+            }
+        } else if (screenX[i] != -1.0f || screenY[i] != -1.0f) {
+            resultsMatch = false;
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    long long scalarNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+    
+    int aosCount = transformer.WorldToScreenBatch(aos.data(), aosResults.data(), numPoints);
+    bool aosMatch = aosCount == visibleCount;
+    for (int i = 0; i < numPoints && aosMatch; ++i) {
+        aosMatch = aosResults[i].x == screenX[i] && aosResults[i].y == screenY[i];
+    }
+    
+    std::cout << "  SIMD level: " << VectorMath::SIMD::kName << std::endl;
+    std::cout << "  Points: " << numPoints << ", visible: " << visibleCount << std::endl;
+    std::cout << "  SoA batch: " << bestNanos / 1000 << " us (" << std::fixed << std::setprecision(2)
+              << (double)bestNanos / numPoints << " ns/point)" << std::endl;
+    std::cout << "  Scalar loop with checks: " << scalarNanos / 1000 << " us" << std::endl;
+    std::cout << "  Max on-screen deviation: " << std::setprecision(5) << maxError << " px" << std::endl;
+    
+    TestResult::PrintResult("Visibility mask and count match scalar", resultsMatch && visibleCount == scalarCount);
+    TestResult::PrintResult("Screen positions match scalar", maxError < 0.01f);
+    TestResult::PrintResult("AoS batch uses the same kernel", aosMatch);
+}
+
+void TestParallelProjection() {
+    TestResult::PrintHeader("PARALLEL PROJECTION");
+    
+    TestResult::PrintSubHeader("Tiled Projection and Prefix-Sum Compaction");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 2.0f, 10.0f), 5.0f, 15.0f, 0.0f);
+    
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix * viewMatrix);
+    
+    const size_t numPoints = 2000003;  // deliberately not a multiple of the tile size
+    std::vector<float> xs(numPoints), ys(numPoints), zs(numPoints);
+    std::vector<Vec3> aos(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        float t = static_cast<float>(i);
+        xs[i] = std::fmod(t * 7.31f, 200.0f) - 100.0f;
+        ys[i] = std::fmod(t * 3.17f, 40.0f) - 20.0f;
+        zs[i] = std::fmod(t * 1.13f, 260.0f) - 200.0f;
+        aos[i] = Vec3(xs[i], ys[i], zs[i]);
+    }
+    VectorMath::ConstVec3SoA soa(xs.data(), ys.data(), zs.data());
+    
+    // Single-threaded reference through the SoA kernel
+    std::vector<float> refX(numPoints), refY(numPoints);
+    std::vector<uint32_t> refMask((numPoints + 31) / 32);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    int refCount = transformer.WorldToScreenBatch(soa, refX.data(), refY.data(), refMask.data(), static_cast<int>(numPoints));
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto serialMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    VectorMath::TaskScheduler scheduler(4);
+    std::vector<float> parX(numPoints), parY(numPoints);
+    std::vector<uint32_t> parMask((numPoints + 31) / 32);
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t parCount = transformer.WorldToScreenParallel(soa, parX.data(), parY.data(), parMask.data(), numPoints, scheduler);
+    endTime = std::chrono::high_resolution_clock::now();
+    auto parallelMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    bool parallelMatch = parCount == static_cast<size_t>(refCount) && parMask == refMask && parX == refX && parY == refY;
+    
+    // Compacted output must list exactly the on-screen points, in input order
+    std::vector<float> compactX(numPoints), compactY(numPoints);
+    std::vector<uint32_t> compactIndex(numPoints);
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t compactCount = transformer.WorldToScreenCompact(soa, numPoints, compactX.data(), compactY.data(),
+                                                           compactIndex.data(), scheduler);
+    endTime = std::chrono::high_resolution_clock::now();
+    auto compactMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    size_t expectedCount = 0;
+    bool compactMatch = true;
+    for (size_t i = 0; i < numPoints && compactMatch; ++i) {
+        bool inFront = (refMask[i >> 5] >> (i & 31)) & 1u;
+        if (inFront && viewport.IsPointInside(Vec2(refX[i], refY[i]))) {
+            compactMatch = expectedCount < compactCount && compactIndex[expectedCount] == i &&
+                           compactX[expectedCount] == refX[i] && compactY[expectedCount] == refY[i];
+            ++expectedCount;
+        }
+    }
+    compactMatch = compactMatch && expectedCount == compactCount;
+    
+    std::vector<Vec2> compactAoS(numPoints);
+    std::vector<uint32_t> aosIndex(numPoints);
+    size_t aosCount = transformer.WorldToScreenCompact(aos.data(), numPoints, compactAoS.data(), aosIndex.data(), scheduler);
+    bool aosMatch = aosCount == compactCount;
+    for (size_t i = 0; i < aosCount && aosMatch; ++i) {
+        aosMatch = aosIndex[i] == compactIndex[i] && compactAoS[i].x == compactX[i] && compactAoS[i].y == compactY[i];
+    }
+    
+    std::cout << "  Points: " << numPoints << ", threads: " << scheduler.GetThreadCount()
+              << ", in front: " << refCount << ", on screen: " << compactCount << std::endl;
+    std::cout << "  Serial SoA: " << serialMicros << " us, parallel: " << parallelMicros
+              << " us, parallel + compaction: " << compactMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("Parallel projection matches serial kernel", parallelMatch);
+    TestResult::PrintResult("Compacted output in input order", compactMatch);
+    TestResult::PrintResult("AoS compaction matches SoA", aosMatch);
+}
+
 void TestPerformanceBenchmarks() {
     TestResult::PrintHeader("PERFORMANCE BENCHMARKS");
     
@@ -891,6 +1128,2042 @@ void TestPerformanceBenchmarks() {
     }
 }
 
+void TestFrustumCulling() {
+    TestResult::PrintHeader("FRUSTUM CULLING");
+    
+    TestResult::PrintSubHeader("Plane Extraction and Box/Sphere Classification");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(viewProj);
+    Frustum frustum = Frustum::FromTransform(transformer);
+    
+    // Camera at the origin looking down -Z
+    bool pointTest = frustum.IsPointInside(Vec3(0.0f, 0.0f, -10.0f)) &&
+                     !frustum.IsPointInside(Vec3(0.0f, 0.0f, 10.0f)) &&
+                     !frustum.IsPointInside(Vec3(0.0f, 0.0f, -1000.0f));
+    
+    CullResult inside = frustum.TestAABB(Vec3(-0.5f, -0.5f, -10.5f), Vec3(0.5f, 0.5f, -9.5f));
+    CullResult behind = frustum.TestAABB(Vec3(-1.0f, -1.0f, 5.0f), Vec3(1.0f, 1.0f, 10.0f));
+    CullResult beyondFar = frustum.TestAABB(Vec3(-1.0f, -1.0f, -1010.0f), Vec3(1.0f, 1.0f, -1000.0f));
+    
+    // Every corner of these boxes projects off-screen or behind the camera, yet both are visible
+    Vec3 surroundMin(-1.0f, -1.0f, -1.0f), surroundMax(1.0f, 1.0f, 1.0f);
+    Vec3 wideMin(-100.0f, -1.0f, -20.0f), wideMax(100.0f, 1.0f, -19.0f);
+    CullResult surround = frustum.TestAABB(surroundMin, surroundMax);
+    CullResult wide = frustum.TestAABB(wideMin, wideMax);
+    
+    bool boxTest = inside == CullResult::Inside && behind == CullResult::Outside &&
+                   beyondFar == CullResult::Outside && surround == CullResult::Intersect &&
+                   wide == CullResult::Intersect;
+    bool utilityTest = W2SUtils::IsBoundingBoxVisible(surroundMin, surroundMax, viewProj, viewport) &&
+                       W2SUtils::IsBoundingBoxVisible(wideMin, wideMax, viewProj, viewport) &&
+                       !W2SUtils::IsBoundingBoxVisible(Vec3(-1.0f, -1.0f, 5.0f), Vec3(1.0f, 1.0f, 10.0f), viewProj, viewport);
+    
+    // The wide box only straddles the left and right planes
+    uint32_t planeMask = Frustum::kAllPlanes;
+    frustum.TestAABB(wideMin, wideMax, planeMask);
+    uint32_t insideMask = Frustum::kAllPlanes;
+    frustum.TestAABB(Vec3(-0.5f, -0.5f, -10.5f), Vec3(0.5f, 0.5f, -9.5f), insideMask);
+    bool maskTest = planeMask == ((1u << Frustum::Left) | (1u << Frustum::Right)) && insideMask == 0;
+    
+    bool sphereTest = frustum.TestSphere(Vec3(0.0f, 0.0f, -10.0f), 1.0f) == CullResult::Inside &&
+                      frustum.TestSphere(Vec3(0.0f, 0.0f, 0.0f), 1.0f) == CullResult::Intersect &&
+                      frustum.TestSphere(Vec3(0.0f, 0.0f, 5.0f), 1.0f) == CullResult::Outside;
+    
+    std::cout << "  Surrounding box: " << static_cast<int>(surround) << ", wide box: " << static_cast<int>(wide)
+              << " (0 = outside, 1 = intersect, 2 = inside)" << std::endl;
+    
+    TestResult::PrintResult("Point inside frustum", pointTest);
+    TestResult::PrintResult("AABB inside/intersect/outside", boxTest);
+    TestResult::PrintResult("Bounding box visibility via planes", utilityTest);
+    TestResult::PrintResult("Straddled plane mask", maskTest);
+    TestResult::PrintResult("Sphere classification", sphereTest);
+    
+    TestResult::PrintSubHeader("SIMD Batch Culling");
+    
+    const size_t numBoxes = 100003;
+    std::vector<float> minX(numBoxes), minY(numBoxes), minZ(numBoxes);
+    std::vector<float> maxX(numBoxes), maxY(numBoxes), maxZ(numBoxes), radii(numBoxes);
+    std::vector<AABB> boxes(numBoxes);
+    for (size_t i = 0; i < numBoxes; ++i) {
+        float t = static_cast<float>(i);
+        minX[i] = std::fmod(t * 7.31f, 400.0f) - 200.0f;
+        minY[i] = std::fmod(t * 3.17f, 200.0f) - 100.0f;
+        minZ[i] = std::fmod(t * 1.13f, 600.0f) - 550.0f;
+        float size = 0.5f + std::fmod(t * 0.37f, 8.0f);
+        maxX[i] = minX[i] + size;
+        maxY[i] = minY[i] + size * 0.5f;
+        maxZ[i] = minZ[i] + size;
+        radii[i] = size;
+        boxes[i] = AABB(Vec3(minX[i], minY[i], minZ[i]), Vec3(maxX[i], maxY[i], maxZ[i]));
+    }
+    VectorMath::ConstVec3SoA soaMin(minX.data(), minY.data(), minZ.data());
+    VectorMath::ConstVec3SoA soaMax(maxX.data(), maxY.data(), maxZ.data());
+    
+    std::vector<uint32_t> mask((numBoxes + 31) / 32);
+    std::vector<CullResult> results(numBoxes);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t batchCount = frustum.CullAABBs(soaMin, soaMax, numBoxes, mask.data(), results.data());
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto batchMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    size_t scalarCount = 0;
+    startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numBoxes; ++i) {
+        scalarCount += frustum.IsAABBVisible(boxes[i].minBounds, boxes[i].maxBounds) ? 1 : 0;
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto scalarMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // Fused multiply-add may flip boxes that touch a plane to within rounding, nothing else
+    size_t mismatches = 0;
+    bool maskConsistent = true;
+    for (size_t i = 0; i < numBoxes; ++i) {
+        mismatches += results[i] != frustum.TestAABB(boxes[i]) ? 1 : 0;
+        bool bit = (mask[i >> 5] >> (i & 31)) & 1u;
+        maskConsistent = maskConsistent && bit == (results[i] != CullResult::Outside);
+    }
+    bool batchTest = mismatches * 10000 <= numBoxes && maskConsistent &&
+                     (batchCount > scalarCount ? batchCount - scalarCount : scalarCount - batchCount) <= mismatches;
+    
+    std::vector<uint32_t> aosMask((numBoxes + 31) / 32);
+    std::vector<CullResult> aosResults(numBoxes);
+    size_t aosCount = frustum.CullAABBs(boxes.data(), numBoxes, aosMask.data(), aosResults.data());
+    bool aosTest = aosCount == batchCount && aosMask == mask && aosResults == results;
+    
+    std::vector<uint32_t> sphereMask((numBoxes + 31) / 32);
+    std::vector<CullResult> sphereResults(numBoxes);
+    frustum.CullSpheres(soaMin, radii.data(), numBoxes, sphereMask.data(), sphereResults.data());
+    size_t sphereMismatches = 0;
+    for (size_t i = 0; i < numBoxes; ++i) {
+        sphereMismatches += sphereResults[i] != frustum.TestSphere(boxes[i].minBounds, radii[i]) ? 1 : 0;
+    }
+    
+    std::cout << "  Boxes: " << numBoxes << " (" << VectorMath::SIMD::kName << "), visible: " << batchCount
+              << ", mismatches: " << mismatches << std::endl;
+    std::cout << "  Batch: " << batchMicros << " us, scalar: " << scalarMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("SIMD AABB batch matches scalar", batchTest);
+    TestResult::PrintResult("AoS batch matches SoA", aosTest);
+    TestResult::PrintResult("SIMD sphere batch matches scalar", sphereMismatches * 10000 <= numBoxes);
+}
+
+void TestBVHCulling() {
+    TestResult::PrintHeader("BVH FRUSTUM CULLING");
+    
+    TestResult::PrintSubHeader("SAH Hierarchy over a Large Static Scene");
+    
+    // Scattered props on a 2 km x 2 km ground plane
+    const size_t numObjects = 500000;
+    std::vector<AABB> boxes(numObjects);
+    for (size_t i = 0; i < numObjects; ++i) {
+        float t = static_cast<float>(i);
+        Vec3 base(std::fmod(t * 7.31f, 2000.0f) - 1000.0f,
+                  std::fmod(t * 0.71f, 20.0f),
+                  std::fmod(t * 3.77f + std::floor(t / 2000.0f) * 0.37f, 2000.0f) - 1000.0f);
+        float size = 0.5f + std::fmod(t * 0.13f, 4.0f);
+        boxes[i] = AABB(base, base + Vec3(size, size * 2.0f, size));
+    }
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    CullingBVH bvh;
+    bvh.Build(boxes);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto buildMillis = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 10.0f, 0.0f), 30.0f, 0.0f, 0.0f);
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix * viewMatrix);
+    Frustum frustum = Frustum::FromTransform(transformer);
+    
+    // Brute-force reference in object order
+    std::vector<uint32_t> reference;
+    for (size_t i = 0; i < numObjects; ++i) {
+        if (frustum.IsAABBVisible(boxes[i].minBounds, boxes[i].maxBounds)) {
+            reference.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    
+    std::vector<uint32_t> visible;
+    visible.reserve(numObjects);
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t visibleCount = bvh.Cull(transformer, visible);
+    endTime = std::chrono::high_resolution_clock::now();
+    auto bvhMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // The buffer keeps room for every object; only the first visibleCount entries are valid
+    std::vector<uint32_t> sorted(visible.begin(), visible.begin() + visibleCount);
+    std::sort(sorted.begin(), sorted.end());
+    bool bvhTest = visible.size() == numObjects && sorted == reference;
+    
+    VectorMath::TaskScheduler scheduler(4);
+    std::vector<uint32_t> parallelVisible;
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t parallelCount = bvh.CullParallel(frustum, parallelVisible, scheduler);
+    endTime = std::chrono::high_resolution_clock::now();
+    auto parallelMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    bool parallelTest = parallelCount == visibleCount &&
+                        std::equal(visible.begin(), visible.begin() + visibleCount, parallelVisible.begin());
+    
+    std::vector<uint32_t> batchMask((numObjects + 31) / 32);
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t batchCount = frustum.CullAABBs(boxes.data(), numObjects, batchMask.data());
+    endTime = std::chrono::high_resolution_clock::now();
+    auto batchMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // Move everything sideways and refit instead of rebuilding
+    const Vec3 offset(25.0f, 0.0f, -40.0f);
+    for (AABB& box : boxes) {
+        box = AABB(box.minBounds + offset, box.maxBounds + offset);
+    }
+    bvh.Refit(boxes.data());
+    const uint32_t* bufferBefore = visible.data();
+    size_t refitCount = bvh.Cull(frustum, visible);
+    std::sort(visible.begin(), visible.begin() + refitCount);
+    size_t refitReference = 0;
+    bool refitTest = visible.data() == bufferBefore && visible.size() == numObjects;
+    for (size_t i = 0; i < numObjects && refitTest; ++i) {
+        if (frustum.IsAABBVisible(boxes[i].minBounds, boxes[i].maxBounds)) {
+            refitTest = refitReference < refitCount && visible[refitReference] == i;
+            ++refitReference;
+        }
+    }
+    refitTest = refitTest && refitReference == refitCount;
+    
+    std::cout << "  Objects: " << numObjects << ", nodes: " << bvh.GetNodeCount() << ", depth: " << bvh.GetDepth()
+              << ", build: " << buildMillis << " ms" << std::endl;
+    std::cout << "  Visible: " << visibleCount << " (batch test: " << batchCount << ")" << std::endl;
+    std::cout << "  BVH: " << bvhMicros << " us, parallel BVH: " << parallelMicros
+              << " us, SIMD batch over all boxes: " << batchMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("BVH culling matches brute force", bvhTest);
+    TestResult::PrintResult("Parallel traversal matches serial", parallelTest);
+    TestResult::PrintResult("Refit after moving objects, buffer reused", refitTest);
+}
+
+void TestOcclusionCulling() {
+    TestResult::PrintHeader("OCCLUSION CULLING");
+    
+    TestResult::PrintSubHeader("Software Depth Buffer and Hierarchical Depth Test");
+    
+    // Camera at the origin looking down -Z at a wall 30 units away
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 2.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    
+    VectorMath::TaskScheduler scheduler(4);
+    OcclusionBuffer occlusion(256, 128);
+    occlusion.BeginFrame(viewProj);
+    occlusion.AddOccluder(AABB(Vec3(-20.0f, -5.0f, -31.0f), Vec3(20.0f, 15.0f, -30.0f)));
+    
+    // A ground quad straddling the near plane exercises clipping
+    Vec3 groundVertices[4] = { Vec3(-50.0f, -6.0f, 10.0f), Vec3(50.0f, -6.0f, 10.0f),
+                               Vec3(50.0f, -6.0f, -200.0f), Vec3(-50.0f, -6.0f, -200.0f) };
+    uint32_t groundIndices[6] = { 0, 1, 2, 0, 2, 3 };
+    occlusion.AddOccluder(groundVertices, 4, groundIndices, 6);
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    occlusion.Rasterize(scheduler);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto rasterMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    bool hiddenBehindWall = !occlusion.IsAABBVisible(Vec3(-1.0f, -1.0f, -61.0f), Vec3(1.0f, 1.0f, -59.0f));
+    bool hiddenBelowGround = !occlusion.IsAABBVisible(Vec3(-1.0f, -10.0f, -50.0f), Vec3(1.0f, -8.0f, -48.0f));
+    bool inFrontOfWall = occlusion.IsAABBVisible(Vec3(-1.0f, -1.0f, -11.0f), Vec3(1.0f, 1.0f, -9.0f));
+    bool aboveWall = occlusion.IsAABBVisible(Vec3(-1.0f, 39.0f, -61.0f), Vec3(1.0f, 41.0f, -59.0f));
+    bool besideWall = occlusion.IsAABBVisible(Vec3(59.0f, -1.0f, -61.0f), Vec3(61.0f, 1.0f, -59.0f));
+    bool peeksOverWall = occlusion.IsAABBVisible(Vec3(-1.0f, 10.0f, -61.0f), Vec3(1.0f, 40.0f, -59.0f));
+    bool aroundCamera = occlusion.IsAABBVisible(Vec3(-1.0f, -1.0f, -1.0f), Vec3(1.0f, 1.0f, 1.0f));
+    
+    bool occlusionTest = hiddenBehindWall && hiddenBelowGround;
+    bool visibleTest = inFrontOfWall && aboveWall && besideWall && peeksOverWall && aroundCamera;
+    
+    // Tiles rasterized in parallel must give exactly the single-threaded buffer
+    VectorMath::TaskScheduler serialScheduler(1);
+    OcclusionBuffer serialOcclusion(256, 128);
+    serialOcclusion.BeginFrame(viewProj);
+    serialOcclusion.AddOccluder(AABB(Vec3(-20.0f, -5.0f, -31.0f), Vec3(20.0f, 15.0f, -30.0f)));
+    serialOcclusion.AddOccluder(groundVertices, 4, groundIndices, 6);
+    serialOcclusion.Rasterize(serialScheduler);
+    bool tileTest = true;
+    for (int y = 0; y < occlusion.GetHeight() && tileTest; ++y) {
+        for (int x = 0; x < occlusion.GetWidth() && tileTest; ++x) {
+            tileTest = occlusion.GetDepth(x, y) == serialOcclusion.GetDepth(x, y);
+        }
+    }
+    
+    // The top of the pyramid is the farthest depth anywhere, here uncovered sky
+    bool pyramidTest = occlusion.GetMaxDepth(occlusion.GetLevelCount() - 1, 0, 0) == FLT_MAX &&
+                       occlusion.GetDepth(128, 64) < 1.0f;
+    
+    TestResult::PrintSubHeader("Batch Occlusion Test");
+    
+    const size_t numBoxes = 100000;
+    std::vector<AABB> boxes(numBoxes);
+    for (size_t i = 0; i < numBoxes; ++i) {
+        float t = static_cast<float>(i);
+        Vec3 base(std::fmod(t * 7.31f, 200.0f) - 100.0f, std::fmod(t * 3.17f, 40.0f) - 15.0f,
+                  -std::fmod(t * 1.13f, 150.0f) - 5.0f);
+        boxes[i] = AABB(base, base + Vec3(1.0f, 1.0f, 1.0f));
+    }
+    
+    std::vector<uint32_t> mask((numBoxes + 31) / 32);
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t visibleCount = occlusion.CullAABBs(boxes.data(), numBoxes, mask.data(), scheduler);
+    endTime = std::chrono::high_resolution_clock::now();
+    auto testMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    bool batchTest = true;
+    size_t expectedVisible = 0;
+    for (size_t i = 0; i < numBoxes && batchTest; ++i) {
+        bool visible = occlusion.IsAABBVisible(boxes[i]);
+        batchTest = visible == (((mask[i >> 5] >> (i & 31)) & 1u) != 0);
+        expectedVisible += visible ? 1 : 0;
+    }
+    batchTest = batchTest && expectedVisible == visibleCount;
+    
+    std::vector<uint32_t> indices(numBoxes);
+    for (size_t i = 0; i < numBoxes; ++i) {
+        indices[i] = static_cast<uint32_t>(i);
+    }
+    size_t kept = occlusion.FilterVisible(boxes.data(), indices.data(), numBoxes);
+    bool filterTest = kept == visibleCount;
+    for (size_t i = 0; i < kept && filterTest; ++i) {
+        filterTest = ((mask[indices[i] >> 5] >> (indices[i] & 31)) & 1u) != 0 && (i == 0 || indices[i] > indices[i - 1]);
+    }
+    
+    std::cout << "  Buffer: " << occlusion.GetWidth() << "x" << occlusion.GetHeight() << ", occluder triangles: "
+              << occlusion.GetOccluderTriangleCount() << ", pyramid levels: " << occlusion.GetLevelCount() << std::endl;
+    std::cout << "  Rasterize: " << rasterMicros << " us, " << numBoxes << " box tests: " << testMicros
+              << " us, not occluded: " << visibleCount << std::endl;
+    
+    TestResult::PrintResult("Boxes behind occluders rejected", occlusionTest);
+    TestResult::PrintResult("Unoccluded and near-plane boxes kept", visibleTest);
+    TestResult::PrintResult("Parallel tiles match serial raster", tileTest);
+    TestResult::PrintResult("Min/max depth pyramid", pyramidTest);
+    TestResult::PrintResult("Batch test matches single tests", batchTest);
+    TestResult::PrintResult("Index list filtering", filterTest);
+}
+
+void TestScreenBoundsBatch() {
+    TestResult::PrintHeader("BATCH SCREEN BOUNDS");
+    
+    TestResult::PrintSubHeader("Near-Plane Clipped Rectangles");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    
+    // Fully in front: the rectangle bounds the projected corners
+    W2SUtils::ScreenRect front = W2SUtils::GetScreenBounds(Vec3(-1.0f, -1.0f, -11.0f), Vec3(1.0f, 1.0f, -9.0f), viewProj, viewport);
+    bool frontTest = front.valid && front.Center().x > 955.0f && front.Center().x < 965.0f &&
+                     front.Width() > 0.0f && front.Height() > 0.0f;
+    
+    // A long box reaching behind the camera covers the whole view once its near part is kept
+    W2SUtils::ScreenRect straddling = W2SUtils::GetScreenBounds(Vec3(-1.0f, -1.0f, -20.0f), Vec3(1.0f, 1.0f, 5.0f), viewProj, viewport);
+    bool straddleTest = straddling.valid && straddling.left < 0.0f && straddling.right > 1920.0f &&
+                        straddling.top < 0.0f && straddling.bottom > 1080.0f;
+    
+    W2SUtils::ScreenRect behind = W2SUtils::GetScreenBounds(Vec3(-1.0f, -1.0f, 5.0f), Vec3(1.0f, 1.0f, 8.0f), viewProj, viewport);
+    
+    std::cout << "  Straddling box rect: (" << straddling.left << ", " << straddling.top << ") - ("
+              << straddling.right << ", " << straddling.bottom << ")" << std::endl;
+    
+    TestResult::PrintResult("Box in front of the camera", frontTest);
+    TestResult::PrintResult("Box straddling the camera plane", straddleTest);
+    TestResult::PrintResult("Box behind the camera is invalid", !behind.valid);
+    
+    TestResult::PrintSubHeader("SIMD Batch");
+    
+    const size_t numBoxes = 100003;
+    std::vector<float> minX(numBoxes), minY(numBoxes), minZ(numBoxes);
+    std::vector<float> maxX(numBoxes), maxY(numBoxes), maxZ(numBoxes);
+    std::vector<AABB> boxes(numBoxes);
+    for (size_t i = 0; i < numBoxes; ++i) {
+        float t = static_cast<float>(i);
+        minX[i] = std::fmod(t * 7.31f, 200.0f) - 100.0f;
+        minY[i] = std::fmod(t * 3.17f, 60.0f) - 30.0f;
+        minZ[i] = std::fmod(t * 1.13f, 250.0f) - 200.0f;
+        float size = 0.5f + std::fmod(t * 0.37f, 6.0f);
+        maxX[i] = minX[i] + size;
+        maxY[i] = minY[i] + size;
+        maxZ[i] = minZ[i] + size * 3.0f;
+        boxes[i] = AABB(Vec3(minX[i], minY[i], minZ[i]), Vec3(maxX[i], maxY[i], maxZ[i]));
+    }
+    
+    std::vector<float> left(numBoxes), right(numBoxes), top(numBoxes), bottom(numBoxes);
+    std::vector<uint32_t> validMask((numBoxes + 31) / 32);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t validCount = W2SUtils::GetScreenBoundsBatch(
+        VectorMath::ConstVec3SoA(minX.data(), minY.data(), minZ.data()),
+        VectorMath::ConstVec3SoA(maxX.data(), maxY.data(), maxZ.data()), numBoxes, viewProj, viewport,
+        W2SUtils::ScreenRectSoA(left.data(), right.data(), top.data(), bottom.data()), validMask.data());
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto batchMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    std::vector<W2SUtils::ScreenRect> scalarRects(numBoxes);
+    startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numBoxes; ++i) {
+        scalarRects[i] = W2SUtils::GetScreenBounds(boxes[i].minBounds, boxes[i].maxBounds, viewProj, viewport);
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto scalarMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // Same math up to rounding; near the camera plane coordinates are huge, so compare relatively
+    auto close = [](float a, float b) { return std::abs(a - b) <= 1e-3f * std::max(1.0f, std::abs(b)); };
+    size_t scalarValid = 0;
+    bool batchTest = true;
+    for (size_t i = 0; i < numBoxes && batchTest; ++i) {
+        bool valid = ((validMask[i >> 5] >> (i & 31)) & 1u) != 0;
+        batchTest = valid == scalarRects[i].valid;
+        if (valid && batchTest) {
+            batchTest = close(left[i], scalarRects[i].left) && close(right[i], scalarRects[i].right) &&
+                        close(top[i], scalarRects[i].top) && close(bottom[i], scalarRects[i].bottom);
+        }
+        scalarValid += scalarRects[i].valid ? 1 : 0;
+    }
+    batchTest = batchTest && scalarValid == validCount;
+    
+    std::vector<W2SUtils::ScreenRect> aosRects(numBoxes);
+    size_t aosValid = W2SUtils::GetScreenBoundsBatch(boxes.data(), numBoxes, viewProj, viewport, aosRects.data());
+    bool aosTest = aosValid == validCount;
+    for (size_t i = 0; i < numBoxes && aosTest; ++i) {
+        aosTest = aosRects[i].valid == (((validMask[i >> 5] >> (i & 31)) & 1u) != 0) &&
+                  (!aosRects[i].valid || (aosRects[i].left == left[i] && aosRects[i].right == right[i] &&
+                                          aosRects[i].top == top[i] && aosRects[i].bottom == bottom[i]));
+    }
+    
+    std::cout << "  Boxes: " << numBoxes << ", valid: " << validCount << std::endl;
+    std::cout << "  Batch: " << batchMicros << " us, scalar: " << scalarMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("SIMD batch matches scalar rectangles", batchTest);
+    TestResult::PrintResult("AoS batch matches SoA", aosTest);
+}
+
+void TestLineProjection() {
+    TestResult::PrintHeader("LINE AND POLYLINE PROJECTION");
+    
+    TestResult::PrintSubHeader("Clip-Space Segment Clipping");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix * viewMatrix);
+    
+    // A road line running from far ahead to behind the camera
+    Vec3 starts[3] = { Vec3(2.0f, -1.0f, -50.0f), Vec3(-1.0f, 0.0f, 5.0f), Vec3(-30.0f, 0.0f, -10.0f) };
+    Vec3 ends[3]   = { Vec3(2.0f, -1.0f, 10.0f),  Vec3(1.0f, 0.0f, 8.0f),  Vec3(30.0f, 0.0f, -10.0f) };
+    ScreenSegment segments[3];
+    
+    size_t count = transformer.ProjectSegments(starts, ends, 3, segments);
+    bool crossingTest = count == 2 && segments[0].sourceIndex == 0 && segments[1].sourceIndex == 2 &&
+                        segments[0].end.y > 1080.0f && segments[0].start.x > 960.0f;
+    
+    std::cout << "  Crossing line: (" << segments[0].start.x << ", " << segments[0].start.y << ") - ("
+              << segments[0].end.x << ", " << segments[0].end.y << ")" << std::endl;
+    
+    size_t clippedCount = transformer.ProjectSegments(starts, ends, 3, segments, true);
+    auto onScreen = [](const Vec2& p) {
+        return p.x >= -0.5f && p.x <= 1920.5f && p.y >= -0.5f && p.y <= 1080.5f;
+    };
+    bool screenClipTest = clippedCount == 2;
+    for (size_t i = 0; i < clippedCount; ++i) {
+        screenClipTest = screenClipTest && onScreen(segments[i].start) && onScreen(segments[i].end);
+    }
+    // The wide horizontal line is cut at both viewport edges
+    screenClipTest = screenClipTest && std::abs(std::min(segments[1].start.x, segments[1].end.x)) < 0.5f &&
+                     std::abs(std::max(segments[1].start.x, segments[1].end.x) - 1920.0f) < 0.5f;
+    
+    TestResult::PrintResult("Line crossing the camera plane is kept", crossingTest);
+    TestResult::PrintResult("Line behind the camera is dropped", count == 2);
+    TestResult::PrintResult("Viewport clipping keeps endpoints on screen", screenClipTest);
+    
+    TestResult::PrintSubHeader("Polyline Batch");
+    
+    // A spiral path winding around and behind the camera
+    const size_t numVertices = 50001;
+    std::vector<float> vx(numVertices), vy(numVertices), vz(numVertices);
+    std::vector<Vec3> vertices(numVertices);
+    for (size_t i = 0; i < numVertices; ++i) {
+        float t = static_cast<float>(i) * 0.01f;
+        vx[i] = std::cos(t) * (5.0f + t * 0.1f);
+        vy[i] = std::sin(t * 0.7f) * 3.0f;
+        vz[i] = std::sin(t) * (5.0f + t * 0.1f) - 20.0f;
+        vertices[i] = Vec3(vx[i], vy[i], vz[i]);
+    }
+    
+    std::vector<ScreenSegment> batch(numVertices);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t batchCount = transformer.ProjectPolyline(VectorMath::ConstVec3SoA(vx.data(), vy.data(), vz.data()),
+                                                    numVertices, batch.data(), true);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto batchMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // One segment per call takes the scalar path
+    std::vector<ScreenSegment> reference;
+    startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i + 1 < numVertices; ++i) {
+        ScreenSegment segment;
+        if (transformer.ProjectSegments(&vertices[i], &vertices[i + 1], 1, &segment, true) == 1) {
+            segment.sourceIndex = static_cast<uint32_t>(i);
+            reference.push_back(segment);
+        }
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto scalarMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // Clip parameters can differ in the last bit between SIMD division and scalar
+    auto close = [](const Vec2& a, const Vec2& b) {
+        return std::abs(a.x - b.x) <= 0.05f && std::abs(a.y - b.y) <= 0.05f;
+    };
+    bool batchTest = batchCount == reference.size();
+    for (size_t i = 0; i < batchCount && batchTest; ++i) {
+        batchTest = batch[i].sourceIndex == reference[i].sourceIndex &&
+                    close(batch[i].start, reference[i].start) && close(batch[i].end, reference[i].end);
+    }
+    
+    std::vector<ScreenSegment> aos(numVertices);
+    size_t aosCount = transformer.ProjectPolyline(vertices.data(), numVertices, aos.data(), true);
+    bool aosTest = aosCount == batchCount;
+    for (size_t i = 0; i < aosCount && aosTest; ++i) {
+        aosTest = aos[i].sourceIndex == batch[i].sourceIndex &&
+                  aos[i].start.x == batch[i].start.x && aos[i].start.y == batch[i].start.y &&
+                  aos[i].end.x == batch[i].end.x && aos[i].end.y == batch[i].end.y;
+    }
+    
+    // Indexed lines over the same path
+    std::vector<uint32_t> indices(2 * (numVertices - 1));
+    for (size_t i = 0; i + 1 < numVertices; ++i) {
+        indices[2 * i] = static_cast<uint32_t>(i);
+        indices[2 * i + 1] = static_cast<uint32_t>(i + 1);
+    }
+    std::vector<ScreenSegment> lines(numVertices);
+    size_t lineCount = transformer.ProjectLines(vertices.data(), indices.data(), numVertices - 1, lines.data(), true);
+    bool linesTest = lineCount == batchCount;
+    for (size_t i = 0; i < lineCount && linesTest; ++i) {
+        linesTest = lines[i].sourceIndex == batch[i].sourceIndex &&
+                    lines[i].start.x == batch[i].start.x && lines[i].end.y == batch[i].end.y;
+    }
+    
+    std::cout << "  Segments: " << numVertices - 1 << ", visible: " << batchCount << std::endl;
+    std::cout << "  Batch: " << batchMicros << " us, scalar: " << scalarMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("SIMD polyline matches scalar clipping", batchTest);
+    TestResult::PrintResult("AoS polyline matches SoA", aosTest);
+    TestResult::PrintResult("Indexed lines match polyline", linesTest);
+}
+
+void TestCameraState() {
+    TestResult::PrintHeader("SEQLOCK CAMERA STATE");
+    
+    TestResult::PrintSubHeader("Publish and Snapshot");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 2.0f, 5.0f), 0.3f, -0.1f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    
+    CameraState camera;
+    bool emptyTest = !camera.Read().IsValid() && camera.GetVersion() == 0;
+    
+    camera.Publish(viewProj, viewport);
+    CameraSnapshot snapshot = camera.Read();
+    
+    // Without a writer in flight one attempt is enough
+    CameraSnapshot attempt;
+    bool tryReadTest = camera.TryRead(attempt) && attempt.version == snapshot.version &&
+                       attempt.viewport.width == viewport.width &&
+                       std::memcmp(attempt.viewProjMatrix.m, snapshot.viewProjMatrix.m, sizeof(attempt.viewProjMatrix.m)) == 0;
+    
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(viewProj);
+    Vec3 point(1.0f, 0.5f, -10.0f);
+    Vec2 expected, actual;
+    bool projectTest = snapshot.IsValid() && snapshot.version == 1 &&
+                       transformer.WorldToScreen(point, expected) && snapshot.WorldToScreen(point, actual) &&
+                       std::abs(expected.x - actual.x) < 1e-3f && std::abs(expected.y - actual.y) < 1e-3f &&
+                       snapshot.frustum.IsPointInside(point);
+    
+    // A reader only copies when something new was published
+    WorldToScreenTransform readerTransform(Viewport(640, 480));
+    uint64_t readerVersion = 0;
+    bool firstUpdate = camera.Update(readerTransform, readerVersion);
+    bool secondUpdate = camera.Update(readerTransform, readerVersion);
+    camera.PublishViewport(Viewport(1280, 720));
+    bool viewportUpdate = camera.Update(readerTransform, readerVersion);
+    bool updateTest = firstUpdate && !secondUpdate && viewportUpdate && readerVersion == 2 &&
+                      readerTransform.GetViewport().width == 1280 && readerTransform.IsMatrixValid() &&
+                      readerTransform.GetViewMatrix().m[0][0] == viewProj.m[0][0];
+    
+    TestResult::PrintResult("Nothing published yet", emptyTest);
+    TestResult::PrintResult("Snapshot projects like the transform", projectTest);
+    TestResult::PrintResult("TryRead matches Read when idle", tryReadTest);
+    TestResult::PrintResult("Readers update only on new versions", updateTest);
+    
+    TestResult::PrintSubHeader("Concurrent Readers");
+    
+    // Every publish writes one value into all matrix entries and a matching
+    // viewport, so a torn snapshot shows up as mixed values
+    CameraState shared;
+    std::atomic<bool> running(true);
+    std::atomic<size_t> tornReads(0);
+    std::atomic<size_t> totalReads(0);
+    std::atomic<size_t> versionErrors(0);
+    std::atomic<size_t> skippedReads(0);
+    
+    const int numReaders = 3;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < numReaders; ++r) {
+        // The first reader never waits and keeps its last snapshot when a publish is in flight
+        const bool nonBlocking = r == 0;
+        readers.emplace_back([&, nonBlocking]() {
+            uint64_t lastVersion = 0;
+            size_t reads = 0;
+            CameraSnapshot current;
+            while (running.load(std::memory_order_relaxed)) {
+                if (nonBlocking) {
+                    if (!shared.TryRead(current)) {
+                        skippedReads.fetch_add(1);
+                    }
+                } else {
+                    current = shared.Read();
+                }
+                ++reads;
+                if (current.version < lastVersion) {
+                    versionErrors.fetch_add(1);
+                }
+                lastVersion = current.version;
+                if (!current.IsValid()) {
+                    continue;
+                }
+                
+                const float value = current.viewProjMatrix.m[0][0];
+                bool consistent = current.viewport.width == 100 + static_cast<int>(value) % 1000 &&
+                                  current.halfWidth == current.viewport.width * 0.5f &&
+                                  static_cast<uint64_t>(value) + 1 == current.version;
+                for (int i = 0; i < 4; ++i) {
+                    for (int j = 0; j < 4; ++j) {
+                        consistent = consistent && current.viewProjMatrix.m[i][j] == value;
+                    }
+                }
+                if (!consistent) {
+                    tornReads.fetch_add(1);
+                }
+            }
+            totalReads.fetch_add(reads);
+        });
+    }
+    
+    const int numPublishes = 200000;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int k = 0; k < numPublishes; ++k) {
+        Matrix4x4 matrix;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                matrix.m[i][j] = static_cast<float>(k);
+            }
+        }
+        shared.Publish(matrix, Viewport(100 + k % 1000, 100));
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    running.store(false);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    auto publishMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    std::cout << "  Publishes: " << numPublishes << " in " << publishMicros << " us, reads: "
+              << totalReads.load() << ", torn: " << tornReads.load()
+              << ", TryRead during a publish: " << skippedReads.load() << std::endl;
+    
+    TestResult::PrintResult("No torn snapshots", tornReads.load() == 0 && totalReads.load() > 0);
+    TestResult::PrintResult("Versions never go backwards", versionErrors.load() == 0);
+    TestResult::PrintResult("Final version counts all publishes", shared.GetVersion() == static_cast<uint64_t>(numPublishes));
+}
+
+void TestScreenMatrix() {
+    TestResult::PrintHeader("FUSED SCREEN MATRIX");
+    
+    TestResult::PrintSubHeader("Viewport Folded into the Matrix");
+    
+    Viewport viewport(1920, 1080, 100.0f, 50.0f);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(3.0f, 2.0f, 5.0f), 0.2f, -0.4f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    Matrix4x4 screenMatrix = W2SUtils::CreateScreenMatrix(viewProj, viewport);
+    
+    const size_t numPoints = 200000;
+    std::vector<Vec3> points(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        float t = static_cast<float>(i);
+        points[i] = Vec3(std::fmod(t * 7.31f, 200.0f) - 100.0f, std::fmod(t * 3.17f, 60.0f) - 30.0f,
+                         std::fmod(t * 1.13f, 250.0f) - 200.0f);
+    }
+    
+    // Same points visible, positions equal up to rounding
+    bool matchTest = true;
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < numPoints && matchTest; ++i) {
+        Vec2 separate, fused;
+        bool a = W2SUtils::QuickWorldToScreen(points[i], viewProj, viewport, separate);
+        bool b = W2SUtils::QuickWorldToScreenFused(points[i], screenMatrix, fused);
+        matchTest = a == b && (!a || (std::abs(separate.x - fused.x) <= 1e-3f * std::max(1.0f, std::abs(separate.x)) &&
+                                      std::abs(separate.y - fused.y) <= 1e-3f * std::max(1.0f, std::abs(separate.y))));
+        visibleCount += a ? 1 : 0;
+    }
+    
+    // The transform keeps its cached matrix in sync with both setters
+    WorldToScreenTransform transformer(Viewport(640, 480));
+    transformer.SetViewMatrix(viewProj);
+    transformer.SetViewport(viewport);
+    Vec2 cached, expected;
+    bool cacheTest = true;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            cacheTest = cacheTest && transformer.GetScreenMatrix().m[i][j] == screenMatrix.m[i][j];
+        }
+    }
+    cacheTest = cacheTest && transformer.WorldToScreen(Vec3(3.0f, 2.0f, -5.0f), cached) &&
+                W2SUtils::QuickWorldToScreen(Vec3(3.0f, 2.0f, -5.0f), viewProj, viewport, expected) &&
+                std::abs(cached.x - expected.x) < 0.01f && std::abs(cached.y - expected.y) < 0.01f;
+    
+    TestResult::PrintSubHeader("Per-Point Cost");
+    
+    float checksum = 0.0f;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numPoints; ++i) {
+        Vec2 screen;
+        if (W2SUtils::QuickWorldToScreen(points[i], viewProj, viewport, screen)) {
+            checksum += screen.x;
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto separateMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numPoints; ++i) {
+        Vec2 screen;
+        if (W2SUtils::QuickWorldToScreenFused(points[i], screenMatrix, screen)) {
+            checksum -= screen.x;
+        }
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto fusedMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    std::cout << "  Points: " << numPoints << ", visible: " << visibleCount << std::endl;
+    std::cout << "  Separate viewport: " << separateMicros << " us, fused: " << fusedMicros
+              << " us (checksum " << checksum << ")" << std::endl;
+    
+    TestResult::PrintResult("Fused matrix matches separate viewport mapping", matchTest);
+    TestResult::PrintResult("Transform caches the fused matrix", cacheTest);
+}
+
+void TestProjectionCache() {
+    TestResult::PrintHeader("INCREMENTAL PROJECTION CACHE");
+    
+    TestResult::PrintSubHeader("Dirty Entities Only");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 2.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix * viewMatrix);
+    
+    const size_t numEntities = 200000;
+    ProjectionCache cache;
+    cache.Resize(numEntities);
+    VectorMath::Vec3SoA positions = cache.GetPositions();
+    for (size_t i = 0; i < numEntities; ++i) {
+        float t = static_cast<float>(i);
+        positions.x[i] = std::fmod(t * 7.31f, 200.0f) - 100.0f;
+        positions.y[i] = std::fmod(t * 3.17f, 60.0f) - 30.0f;
+        positions.z[i] = std::fmod(t * 1.13f, 250.0f) - 200.0f;
+    }
+    
+    // Compares the cache with projecting everything from scratch
+    std::vector<float> refX(numEntities), refY(numEntities);
+    std::vector<uint32_t> refMask((numEntities + 31) / 32);
+    auto matchesFullProjection = [&]() {
+        int visible = transformer.WorldToScreenBatch(VectorMath::ConstVec3SoA(positions.x, positions.y, positions.z),
+                                                     refX.data(), refY.data(), refMask.data(), static_cast<int>(numEntities));
+        bool match = cache.GetVisibleCount() == static_cast<size_t>(visible);
+        for (size_t w = 0; w < refMask.size() && match; ++w) {
+            match = refMask[w] == cache.GetVisibleMask()[w];
+        }
+        for (size_t i = 0; i < numEntities && match; ++i) {
+            match = std::abs(refX[i] - cache.GetScreenX()[i]) <= 1e-3f * std::max(1.0f, std::abs(refX[i])) &&
+                    std::abs(refY[i] - cache.GetScreenY()[i]) <= 1e-3f * std::max(1.0f, std::abs(refY[i]));
+        }
+        return match;
+    };
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t firstUpdate = cache.Update(transformer);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto fullMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    bool initialTest = firstUpdate == numEntities && matchesFullProjection();
+    
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t staticUpdate = cache.Update(transformer);
+    endTime = std::chrono::high_resolution_clock::now();
+    auto staticMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // Scattered movers plus a contiguous block reported through a bitset
+    size_t moved = 0;
+    for (size_t i = 17; i < numEntities; i += 97) {
+        Vec3 p = cache.GetPosition(i);
+        cache.SetPosition(i, Vec3(p.x + 1.5f, p.y, p.z + 20.0f));
+        ++moved;
+    }
+    std::vector<uint32_t> movedBits((numEntities + 31) / 32, 0);
+    for (size_t i = 64000; i < 70400; ++i) {
+        positions.y[i] += 3.0f;
+        positions.z[i] = -positions.z[i];
+        if (((movedBits[i >> 5] >> (i & 31)) & 1u) == 0) {
+            movedBits[i >> 5] |= 1u << (i & 31);
+            moved += ((i - 17) % 97 == 0) ? 0 : 1;
+        }
+    }
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t dirtyUpdate = cache.UpdateMoved(transformer, movedBits.data());
+    endTime = std::chrono::high_resolution_clock::now();
+    auto dirtyMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    bool dirtyTest = dirtyUpdate == moved && matchesFullProjection();
+    
+    // Moving the camera invalidates everything
+    transformer.SetViewMatrix(projMatrix * W2SUtils::CreateViewMatrixFromEuler(Vec3(5.0f, 2.0f, 0.0f), 0.3f, 0.0f, 0.0f));
+    size_t cameraUpdate = cache.Update(transformer);
+    bool cameraTest = cameraUpdate == numEntities && matchesFullProjection();
+    
+    size_t added = cache.Add(Vec3(0.0f, 0.0f, -10.0f));
+    size_t addUpdate = cache.Update(transformer);
+    bool addTest = addUpdate == 1 && cache.IsVisible(added) && cache.GetCount() == numEntities + 1;
+    
+    // Shrinking drops the visible bits of removed entities; growing back adds dirty, invisible ones
+    auto countMaskBits = [&]() {
+        size_t bits = 0;
+        for (size_t w = 0; w < (cache.GetCount() + 31) / 32; ++w) {
+            bits += VectorMath::SIMD::PopCount(cache.GetVisibleMask()[w]);
+        }
+        return bits;
+    };
+    positions = cache.GetPositions();    // Add may have reallocated the streams
+    cache.Resize(numEntities - 45);
+    bool shrinkCount = cache.GetVisibleCount() == countMaskBits();
+    cache.Resize(numEntities);
+    bool growCount = cache.GetVisibleCount() == countMaskBits() && !cache.IsVisible(numEntities - 1);
+    size_t regrowUpdate = cache.Update(transformer);
+    bool resizeTest = shrinkCount && growCount && regrowUpdate == 45 && matchesFullProjection();
+    
+    // Appending one entity at a time must not rescan the cache
+    ProjectionCache appended;
+    const size_t numAppended = 200000;
+    startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numAppended; ++i) {
+        appended.Add(Vec3(positions.x[i % numEntities], positions.y[i % numEntities], positions.z[i % numEntities]));
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto appendMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    bool appendTest = appended.GetCount() == numAppended && appended.Update(transformer) == numAppended &&
+                      appended.GetVisibleCount() > 0 && appendMicros < 1000000;
+    
+    std::cout << "  Entities: " << numEntities << ", visible: " << cache.GetVisibleCount() << std::endl;
+    std::cout << "  Full: " << fullMicros << " us, static frame: " << staticMicros << " us, "
+              << dirtyUpdate << " moved: " << dirtyMicros << " us, " << numAppended << " appends: "
+              << appendMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("First update projects everything", initialTest);
+    TestResult::PrintResult("Static frame reprojects nothing", staticUpdate == 0);
+    TestResult::PrintResult("Moved entities match a full projection", dirtyTest);
+    TestResult::PrintResult("Camera change reprojects everything", cameraTest);
+    TestResult::PrintResult("Added entity is projected on its own", addTest);
+    TestResult::PrintResult("Resize keeps the visible count exact", resizeTest);
+    TestResult::PrintResult("Appending entities stays linear", appendTest);
+}
+
+void TestScreenPicking() {
+    TestResult::PrintHeader("SCREEN-SPACE PICKING");
+    
+    TestResult::PrintSubHeader("Point Grid");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 2.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix * viewMatrix);
+    
+    const size_t numPoints = 100000;
+    std::vector<float> px(numPoints), py(numPoints), pz(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        float t = static_cast<float>(i);
+        px[i] = std::fmod(t * 7.31f, 200.0f) - 100.0f;
+        py[i] = std::fmod(t * 3.17f, 60.0f) - 30.0f;
+        pz[i] = std::fmod(t * 1.13f, 250.0f) - 200.0f;
+    }
+    
+    ScreenPickGrid grid(32.0f);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    grid.Build(transformer, VectorMath::ConstVec3SoA(px.data(), py.data(), pz.data()), numPoints);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto buildMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // Brute-force reference over the same projection
+    std::vector<PickHit> all;
+    std::vector<float> allX(numPoints, -1.0f), allY(numPoints, -1.0f);
+    for (size_t i = 0; i < numPoints; ++i) {
+        Vec2 screen;
+        Vec3 world(px[i], py[i], pz[i]);
+        if (transformer.WorldToScreen(world, screen) && viewport.IsPointInside(screen)) {
+            all.push_back(PickHit(static_cast<uint32_t>(i), transformer.GetDistanceToPoint(world), 0.0f));
+            allX[i] = screen.x;
+            allY[i] = screen.y;
+        }
+    }
+    
+    auto byDepth = [](const PickHit& a, const PickHit& b) {
+        return a.depth < b.depth || (a.depth == b.depth && a.index < b.index);
+    };
+    auto sameIndices = [](const std::vector<PickHit>& a, const std::vector<PickHit>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].index != b[i].index) {
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    bool pointTest = grid.GetItemCount() == all.size();
+    bool rectTest = pointTest;
+    bool nearestTest = pointTest;
+    std::vector<PickHit> hits, expected;
+    const float radius = 12.0f;
+    double queryMicros = 0.0;
+    const int numQueries = 200;
+    for (int q = 0; q < numQueries && pointTest && rectTest && nearestTest; ++q) {
+        Vec2 cursor(std::fmod(q * 197.3f, 1920.0f), std::fmod(q * 83.9f, 1080.0f));
+        
+        auto queryStart = std::chrono::high_resolution_clock::now();
+        grid.PickPoint(cursor, radius, hits);
+        auto queryEnd = std::chrono::high_resolution_clock::now();
+        queryMicros += std::chrono::duration<double, std::micro>(queryEnd - queryStart).count();
+        expected.clear();
+        for (const PickHit& hit : all) {
+            float dx = allX[hit.index] - cursor.x, dy = allY[hit.index] - cursor.y;
+            if (std::sqrt(dx * dx + dy * dy) <= radius) {
+                expected.push_back(hit);
+            }
+        }
+        std::sort(expected.begin(), expected.end(), byDepth);
+        pointTest = sameIndices(hits, expected);
+        
+        W2SUtils::ScreenRect selection(cursor.x, cursor.x + 150.0f, cursor.y, cursor.y + 90.0f);
+        grid.PickRect(selection, hits);
+        expected.clear();
+        for (const PickHit& hit : all) {
+            if (allX[hit.index] >= selection.left && allX[hit.index] <= selection.right &&
+                allY[hit.index] >= selection.top && allY[hit.index] <= selection.bottom) {
+                expected.push_back(hit);
+            }
+        }
+        std::sort(expected.begin(), expected.end(), byDepth);
+        rectTest = sameIndices(hits, expected);
+        
+        const size_t k = 5;
+        grid.PickNearest(cursor, k, 400.0f, hits);
+        expected.clear();
+        for (PickHit hit : all) {
+            float dx = allX[hit.index] - cursor.x, dy = allY[hit.index] - cursor.y;
+            hit.distance = std::sqrt(dx * dx + dy * dy);
+            if (hit.distance <= 400.0f) {
+                expected.push_back(hit);
+            }
+        }
+        std::sort(expected.begin(), expected.end(), [&](const PickHit& a, const PickHit& b) {
+            return a.distance < b.distance || (a.distance == b.distance && byDepth(a, b));
+        });
+        expected.resize(std::min(expected.size(), k));
+        nearestTest = sameIndices(hits, expected);
+    }
+    
+    PickHit topmost;
+    bool topmostTest = grid.PickTopmost(Vec2(960.0f, 600.0f), 20.0f, topmost);
+    grid.PickPoint(Vec2(960.0f, 600.0f), 20.0f, hits);
+    topmostTest = topmostTest && !hits.empty() && hits[0].index == topmost.index;
+    
+    std::cout << "  Points on screen: " << grid.GetItemCount() << ", grid " << grid.GetCellsX() << "x"
+              << grid.GetCellsY() << std::endl;
+    std::cout << "  Build: " << buildMicros << " us, point pick: " << std::fixed << std::setprecision(2)
+              << queryMicros / numQueries << " us" << std::endl;
+    
+    TestResult::PrintResult("Point picks match brute force, depth sorted", pointTest);
+    TestResult::PrintResult("Rectangle picks match brute force", rectTest);
+    TestResult::PrintResult("Nearest picks match brute force", nearestTest);
+    TestResult::PrintResult("Topmost pick is the nearest to the camera", topmostTest);
+    
+    TestResult::PrintSubHeader("Rectangle Grid");
+    
+    // Overlapping rectangles: the cursor hits several, nearest first, each once
+    std::vector<W2SUtils::ScreenRect> rects;
+    std::vector<float> rectDepth;
+    rects.push_back(W2SUtils::ScreenRect(100.0f, 700.0f, 100.0f, 500.0f));
+    rectDepth.push_back(30.0f);
+    rects.push_back(W2SUtils::ScreenRect(300.0f, 400.0f, 200.0f, 300.0f));
+    rectDepth.push_back(10.0f);
+    rects.push_back(W2SUtils::ScreenRect(-500.0f, 2500.0f, 250.0f, 260.0f));
+    rectDepth.push_back(20.0f);
+    rects.push_back(W2SUtils::ScreenRect());
+    rectDepth.push_back(1.0f);
+    rects.push_back(W2SUtils::ScreenRect(3000.0f, 3100.0f, 100.0f, 200.0f));
+    rectDepth.push_back(1.0f);
+    
+    ScreenPickGrid rectGrid(64.0f);
+    rectGrid.Build(viewport, rects.data(), rectDepth.data(), rects.size());
+    rectGrid.PickPoint(Vec2(350.0f, 255.0f), 0.0f, hits);
+    bool stackTest = rectGrid.GetItemCount() == 3 && hits.size() == 3 &&
+                     hits[0].index == 1 && hits[1].index == 2 && hits[2].index == 0;
+    rectGrid.PickRect(W2SUtils::ScreenRect(0.0f, 1920.0f, 0.0f, 1080.0f), hits);
+    bool rectSelectTest = hits.size() == 3;
+    rectGrid.PickNearest(Vec2(1000.0f, 600.0f), 2, 1000.0f, hits);
+    bool rectNearestTest = hits.size() == 2 && hits[0].index == 0 && hits[1].index == 2;
+    
+    TestResult::PrintResult("Stacked rectangles sorted by depth", stackTest);
+    TestResult::PrintResult("Wide rectangles reported once", rectSelectTest);
+    TestResult::PrintResult("Nearest rectangles by screen distance", rectNearestTest);
+}
+
+void TestBatchUnprojection() {
+    TestResult::PrintHeader("BATCH SCREEN-TO-WORLD RAYS");
+    
+    TestResult::PrintSubHeader("Inverse View-Projection");
+    
+    Viewport viewport(1920, 1080, 40.0f, 20.0f);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(3.0f, 2.0f, 5.0f), 0.3f, -0.2f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    
+    Matrix4x4 invViewProj;
+    bool invertible = W2SUtils::InvertMatrix(viewProj, invViewProj);
+    Matrix4x4 identity = viewProj * invViewProj;
+    bool inverseTest = invertible;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            inverseTest = inverseTest && std::abs(identity.m[i][j] - (i == j ? 1.0f : 0.0f)) < 1e-4f;
+        }
+    }
+    Matrix4x4 singular;
+    singular.m[3][3] = 0.0f;
+    for (int j = 0; j < 4; ++j) {
+        singular.m[2][j] = singular.m[1][j];
+    }
+    Matrix4x4 unused;
+    bool singularTest = !W2SUtils::InvertMatrix(singular, unused);
+    
+    TestResult::PrintResult("Projective matrix inverse", inverseTest);
+    TestResult::PrintResult("Singular matrix rejected", singularTest);
+    
+    TestResult::PrintSubHeader("Probe Grid");
+    
+    // A ray through a pixel projects back onto that pixel along its whole length
+    auto raysHitPixels = [&](const float* px, const float* py, size_t count,
+                             const VectorMath::Vec3SoA& origins, const VectorMath::Vec3SoA& directions) {
+        for (size_t i = 0; i < count; ++i) {
+            Vec3 origin(origins.x[i], origins.y[i], origins.z[i]);
+            Vec3 direction(directions.x[i], directions.y[i], directions.z[i]);
+            if (std::abs(direction.Length() - 1.0f) > 1e-4f) {
+                return false;
+            }
+            const float distances[2] = { 1.0f, 50.0f };
+            for (float t : distances) {
+                Vec2 screen;
+                if (!W2SUtils::QuickWorldToScreen(origin + direction * t, viewProj, viewport, screen) ||
+                    std::abs(screen.x - px[i]) > 0.05f || std::abs(screen.y - py[i]) > 0.05f) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    
+    const int columns = 257, rows = 129;
+    const size_t numRays = static_cast<size_t>(columns) * rows;
+    const Vec2 firstPixel(45.5f, 25.5f), step(7.25f, 8.0f);
+    std::vector<float> ox(numRays), oy(numRays), oz(numRays), dx(numRays), dy(numRays), dz(numRays);
+    VectorMath::Vec3SoA origins(ox.data(), oy.data(), oz.data()), directions(dx.data(), dy.data(), dz.data());
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    W2SUtils::ScreenToWorldRayGrid(firstPixel, step, columns, rows, invViewProj, viewport, origins, directions);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto gridMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    std::vector<float> px(numRays), py(numRays);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            px[row * columns + col] = firstPixel.x + col * step.x;
+            py[row * columns + col] = firstPixel.y + row * step.y;
+        }
+    }
+    bool gridTest = raysHitPixels(px.data(), py.data(), numRays, origins, directions);
+    
+    std::vector<float> lx(numRays), ly(numRays), lz(numRays), ldx(numRays), ldy(numRays), ldz(numRays);
+    VectorMath::Vec3SoA listOrigins(lx.data(), ly.data(), lz.data()), listDirections(ldx.data(), ldy.data(), ldz.data());
+    W2SUtils::ScreenToWorldRays(px.data(), py.data(), numRays, invViewProj, viewport, listOrigins, listDirections);
+    bool listTest = raysHitPixels(px.data(), py.data(), numRays, listOrigins, listDirections);
+    
+    W2SUtils::Ray single = W2SUtils::ScreenToWorldRay(Vec2(px[1000], py[1000]), invViewProj, viewport);
+    bool singleTest = std::abs(single.origin.x - lx[1000]) < 1e-3f && std::abs(single.direction.z - ldz[1000]) < 1e-4f;
+    
+    startTime = std::chrono::high_resolution_clock::now();
+    float checksum = 0.0f;
+    for (size_t i = 0; i < numRays; ++i) {
+        checksum += W2SUtils::ScreenToWorldRay(Vec2(px[i], py[i]), viewMatrix, projMatrix, viewport).direction.x;
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto perPixelMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    std::cout << "  Rays: " << numRays << ", grid: " << gridMicros << " us, per-pixel inverse: "
+              << perPixelMicros << " us (checksum " << checksum << ")" << std::endl;
+    
+    TestResult::PrintResult("Grid rays project back onto their pixels", gridTest);
+    TestResult::PrintResult("Pixel list rays project back onto their pixels", listTest);
+    TestResult::PrintResult("Single-ray overload matches the batch", singleTest);
+}
+
+void TestOverlayRasterizer() {
+    TestResult::PrintHeader("HEADLESS OVERLAY RASTERIZER");
+    
+    TestResult::PrintSubHeader("Coverage Rules");
+    
+    auto channel = [](uint32_t pixel, int c) { return static_cast<int>((pixel >> (8 * c)) & 0xFFu); };
+    
+    OverlayRasterizer raster(96, 80);
+    DrawList drawList;
+    drawList.AddRectFilled(W2SUtils::ScreenRect(10.0f, 20.0f, 10.0f, 20.0f), PackColor(255, 0, 0));
+    raster.Clear();
+    raster.Render(drawList);
+    size_t covered = 0;
+    bool exactTest = true;
+    for (int y = 0; y < raster.GetHeight(); ++y) {
+        for (int x = 0; x < raster.GetWidth(); ++x) {
+            bool inside = x >= 10 && x < 20 && y >= 10 && y < 20;
+            uint32_t pixel = raster.GetPixel(x, y);
+            covered += pixel != 0 ? 1 : 0;
+            exactTest = exactTest && pixel == (inside ? PackColor(255, 0, 0) : 0u);
+        }
+    }
+    
+    // Two translucent triangles sharing a diagonal through pixel centers
+    drawList.Clear();
+    drawList.AddTriangleFilled(Vec2(40.0f, 10.0f), Vec2(70.0f, 10.0f), Vec2(70.0f, 40.0f), PackColor(0, 255, 0, 128));
+    drawList.AddTriangleFilled(Vec2(40.0f, 10.0f), Vec2(70.0f, 40.0f), Vec2(40.0f, 40.0f), PackColor(0, 255, 0, 128));
+    raster.Clear(PackColor(0, 0, 0));
+    raster.Render(drawList);
+    uint32_t reference = raster.GetPixel(45, 30);
+    bool sharedEdgeTest = channel(reference, 1) == 128;
+    for (int y = 10; y < 40; ++y) {
+        for (int x = 40; x < 70; ++x) {
+            sharedEdgeTest = sharedEdgeTest && raster.GetPixel(x, y) == reference;
+        }
+    }
+    
+    std::cout << "  Filled rect pixels: " << covered << ", shared-edge quad green: "
+              << channel(reference, 1) << std::endl;
+    
+    TestResult::PrintResult("Filled rectangle covers exactly its pixels", exactTest && covered == 100);
+    TestResult::PrintResult("Shared triangle edge is blended once", sharedEdgeTest);
+    
+    TestResult::PrintSubHeader("Antialiasing");
+    
+    drawList.Clear();
+    drawList.AddLine(Vec2(5.0f, 60.0f), Vec2(90.0f, 70.0f), PackColor(255, 255, 255), 1.5f);
+    raster.Clear(PackColor(0, 0, 0));
+    raster.Render(drawList, false);
+    bool hardTest = true;
+    for (int i = 0; i < raster.GetWidth() * raster.GetHeight(); ++i) {
+        int value = channel(raster.GetPixels()[i], 0);
+        hardTest = hardTest && (value == 0 || value == 255);
+    }
+    raster.Clear(PackColor(0, 0, 0));
+    raster.Render(drawList, true);
+    size_t partial = 0;
+    for (int i = 0; i < raster.GetWidth() * raster.GetHeight(); ++i) {
+        int value = channel(raster.GetPixels()[i], 0);
+        partial += (value > 0 && value < 255) ? 1 : 0;
+    }
+    
+    std::cout << "  Partially covered pixels with AA: " << partial << std::endl;
+    
+    TestResult::PrintResult("Aliased line is fully on or off", hardTest);
+    TestResult::PrintResult("Antialiased line has partial coverage", partial > 0);
+    
+    TestResult::PrintSubHeader("Projected Scene");
+    
+    Viewport viewport(1280, 720);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 4.0f, 10.0f), 0.0f, -0.15f, 0.0f);
+    Matrix4x4 viewProj = projMatrix * viewMatrix;
+    WorldToScreenTransform transform(viewport);
+    transform.SetViewMatrix(viewProj);
+    
+    const size_t numBoxes = 2000;
+    std::vector<AABB> boxes(numBoxes);
+    for (size_t i = 0; i < numBoxes; ++i) {
+        float t = static_cast<float>(i);
+        Vec3 minBounds(std::fmod(t * 7.31f, 120.0f) - 60.0f, std::fmod(t * 3.17f, 10.0f) - 2.0f,
+                       -std::fmod(t * 1.13f, 150.0f) - 2.0f);
+        boxes[i] = AABB(minBounds, minBounds + Vec3(1.0f, 1.5f, 1.0f));
+    }
+    std::vector<W2SUtils::ScreenRect> rects(numBoxes);
+    W2SUtils::GetScreenBoundsBatch(boxes.data(), numBoxes, viewProj, viewport, rects.data());
+    
+    std::vector<Vec3> path;
+    for (int i = 0; i < 200; ++i) {
+        float t = static_cast<float>(i) * 0.1f;
+        path.push_back(Vec3(std::sin(t) * 20.0f, 0.0f, -5.0f - t * 6.0f));
+    }
+    std::vector<ScreenSegment> segments(path.size());
+    size_t numSegments = transform.ProjectPolyline(path.data(), path.size(), segments.data(), true);
+    
+    DrawList scene;
+    for (size_t i = 0; i < numBoxes; ++i) {
+        scene.AddRect(rects[i], PackColor(0, 200, 255, 160), 1.5f);
+        if (rects[i].valid) {
+            scene.AddMarker(rects[i].Center(), 6.0f, PackColor(255, 220, 0), static_cast<MarkerShape>(i % 4));
+        }
+    }
+    scene.AddSegments(segments.data(), numSegments, PackColor(255, 64, 64, 200), 2.0f);
+    
+    OverlayRasterizer frame(viewport.width, viewport.height);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    frame.Clear(PackColor(16, 16, 16));
+    frame.Render(scene, true);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto renderMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    uint64_t parallelHash = frame.Hash();
+    
+    VectorMath::TaskScheduler serial(1);
+    frame.Clear(PackColor(16, 16, 16));
+    frame.Render(scene, true, serial);
+    bool deterministicTest = frame.Hash() == parallelHash;
+    
+    const std::string dumpPath = "overlay_test_frame.rgba";
+    bool saved = frame.SaveRaw(dumpPath);
+    std::ifstream dump(dumpPath, std::ios::binary | std::ios::ate);
+    bool dumpTest = saved && dump && static_cast<size_t>(dump.tellg()) == static_cast<size_t>(viewport.width) * viewport.height * 4;
+    dump.close();
+    std::remove(dumpPath.c_str());
+    
+    std::cout << "  Triangles: " << scene.GetTriangleCount() << ", commands: " << scene.GetCommands().size()
+              << ", render: " << renderMicros << " us (AA, " << VectorMath::TaskScheduler::Shared().GetThreadCount()
+              << " threads)" << std::endl;
+    std::cout << "  Frame hash: 0x" << std::hex << parallelHash << std::dec << std::endl;
+    
+    TestResult::PrintResult("Image independent of thread count", deterministicTest);
+    TestResult::PrintResult("Raw RGBA dump has width * height * 4 bytes", dumpTest);
+}
+
+void TestOverlayLOD() {
+    TestResult::PrintHeader("OVERLAY LOD AND LABEL DECLUTTER");
+    
+    TestResult::PrintSubHeader("Projected Sphere Size");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 5000.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    WorldToScreenTransform transform(viewport);
+    transform.SetViewMatrix(projMatrix * viewMatrix);
+    
+    // Near box, mid-range dot, too small, behind the camera, off screen, beyond the distance limit
+    float cx[6] = { 0.0f, 5.0f, 0.0f, 0.0f, 1000.0f, 0.0f };
+    float cy[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    float cz[6] = { -100.0f, -500.0f, -2000.0f, 50.0f, -10.0f, -3000.0f };
+    float radii[6] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 10.0f };
+    
+    OverlayLOD lod;
+    lod.SetMaxDistance(2500.0f);
+    size_t shown = lod.Select(transform, VectorMath::ConstVec3SoA(cx, cy, cz), radii, 6);
+    const float pixelsPerUnit = 540.0f / std::tan(DEG2RAD(35.0f));
+    bool radiusTest = std::abs(lod.GetScreenRadius()[0] - pixelsPerUnit / 100.0f) < 0.01f &&
+                      std::abs(lod.GetScreenRadius()[1] - pixelsPerUnit / 500.0f) < 0.01f;
+    bool levelTest = shown == 2 && lod.GetLevel(0) == 2 && lod.GetLevel(1) == 1 && lod.GetLevel(2) == 0 &&
+                     lod.GetLevel(3) == 0 && lod.GetLevel(4) == 0 && lod.GetLevel(5) == 0 &&
+                     lod.GetBucket(0).size() == 4 && lod.GetBucket(2).size() == 1 && lod.GetBucket(2)[0] == 0;
+    
+    std::cout << "  Radius at 100 / 500 units: " << lod.GetScreenRadius()[0] << " / "
+              << lod.GetScreenRadius()[1] << " px" << std::endl;
+    
+    TestResult::PrintResult("Projected radius from sphere and w", radiusTest);
+    TestResult::PrintResult("Box, dot and hidden levels", levelTest);
+    
+    TestResult::PrintSubHeader("50k Entities");
+    
+    viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 20.0f, 50.0f), 10.0f, 0.0f, 0.0f);
+    transform.SetViewMatrix(projMatrix * viewMatrix);
+    
+    const size_t numEntities = 50000;
+    std::vector<float> ex(numEntities), ey(numEntities), ez(numEntities), er(numEntities), priority(numEntities);
+    for (size_t i = 0; i < numEntities; ++i) {
+        float t = static_cast<float>(i);
+        ex[i] = std::fmod(t * 7.31f, 800.0f) - 400.0f;
+        ey[i] = std::fmod(t * 3.17f, 20.0f);
+        ez[i] = -std::fmod(t * 1.13f, 1500.0f);
+        er[i] = 0.5f + std::fmod(t * 0.37f, 2.0f);
+        priority[i] = std::fmod(t * 0.618f, 1.0f);
+    }
+    VectorMath::ConstVec3SoA centers(ex.data(), ey.data(), ez.data());
+    
+    const float thresholds[3] = { 0.75f, 3.0f, 12.0f };
+    lod.SetLevels(thresholds, 3);
+    lod.SetMaxDistance(FLT_MAX);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    shown = lod.Select(transform, centers, er.data(), numEntities);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto selectMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    bool bulkTest = lod.GetLevelCount() == 4;
+    size_t bucketTotal = 0;
+    for (int level = 0; level < lod.GetLevelCount(); ++level) {
+        const std::vector<uint32_t>& bucket = lod.GetBucket(level);
+        bucketTotal += bucket.size();
+        for (size_t k = 0; k < bucket.size() && bulkTest; ++k) {
+            bulkTest = lod.GetLevel(bucket[k]) == level && (k == 0 || bucket[k - 1] < bucket[k]);
+        }
+    }
+    for (size_t i = 0; i < numEntities && bulkTest; ++i) {
+        float distance = transform.GetDistanceToPoint(Vec3(ex[i], ey[i], ez[i]));
+        if (distance > 0.0f) {
+            float expected = er[i] * pixelsPerUnit / distance;
+            bulkTest = std::abs(lod.GetScreenRadius()[i] - expected) <= 1e-3f * expected;
+        } else {
+            bulkTest = lod.GetLevel(i) == 0;
+        }
+    }
+    bulkTest = bulkTest && bucketTotal == numEntities && shown == numEntities - lod.GetBucket(0).size();
+    
+    std::cout << "  Levels: " << lod.GetBucket(0).size() << " hidden, " << lod.GetBucket(1).size() << " dots, "
+              << lod.GetBucket(2).size() << " boxes, " << lod.GetBucket(3).size() << " full in "
+              << selectMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("Buckets hold every entity in input order", bulkTest);
+    
+    TestResult::PrintSubHeader("Label Declutter");
+    
+    LabelDeclutter declutter(64.0f);
+    W2SUtils::ScreenRect labels[4] = {
+        W2SUtils::ScreenRect(100.0f, 200.0f, 100.0f, 120.0f),
+        W2SUtils::ScreenRect(150.0f, 250.0f, 110.0f, 130.0f),     // overlaps the first one
+        W2SUtils::ScreenRect(200.0f, 300.0f, 100.0f, 120.0f),     // touches the first one
+        W2SUtils::ScreenRect(3000.0f, 3100.0f, 100.0f, 120.0f)    // off screen
+    };
+    float labelPriority[4] = { 2.0f, 1.0f, 1.0f, 5.0f };
+    size_t accepted = declutter.Resolve(viewport, labels, labelPriority, 4);
+    bool greedyTest = accepted == 2 && declutter.GetAccepted()[0] == 0 && declutter.GetAccepted()[1] == 2 &&
+                      declutter.IsAccepted(0) && !declutter.IsAccepted(1) && declutter.IsAccepted(2) &&
+                      !declutter.IsAccepted(3);
+    
+    // Grid result matches the quadratic greedy pass on the same candidates
+    std::vector<uint32_t> candidates(lod.GetBucket(2));
+    candidates.insert(candidates.end(), lod.GetBucket(3).begin(), lod.GetBucket(3).end());
+    const Vec2 labelSize(60.0f, 14.0f), labelOffset(4.0f, -7.0f);
+    
+    startTime = std::chrono::high_resolution_clock::now();
+    accepted = declutter.Resolve(viewport, lod.GetScreenX(), lod.GetScreenY(), candidates.data(), candidates.size(),
+                                 labelSize, labelOffset, priority.data());
+    endTime = std::chrono::high_resolution_clock::now();
+    auto gridMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    std::vector<uint32_t> order(candidates);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return priority[a] > priority[b]; });
+    std::vector<uint32_t> bruteForce;
+    startTime = std::chrono::high_resolution_clock::now();
+    for (uint32_t i : order) {
+        float left = lod.GetScreenX()[i] + labelOffset.x, top = lod.GetScreenY()[i] + labelOffset.y;
+        if (!(left + labelSize.x > 0.0f && left < 1920.0f && top + labelSize.y > 0.0f && top < 1080.0f)) {
+            continue;
+        }
+        bool blocked = false;
+        for (uint32_t j : bruteForce) {
+            float otherLeft = lod.GetScreenX()[j] + labelOffset.x, otherTop = lod.GetScreenY()[j] + labelOffset.y;
+            if (left < otherLeft + labelSize.x && otherLeft < left + labelSize.x &&
+                top < otherTop + labelSize.y && otherTop < top + labelSize.y) {
+                blocked = true;
+                break;
+            }
+        }
+        if (!blocked) {
+            bruteForce.push_back(i);
+        }
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto bruteMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    bool matchTest = declutter.GetAccepted() == bruteForce;
+    
+    std::cout << "  Candidates: " << candidates.size() << ", accepted: " << accepted << ", grid: " << gridMicros
+              << " us, all pairs: " << bruteMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("Greedy by priority, touching labels allowed", greedyTest);
+    TestResult::PrintResult("Grid declutter matches all-pairs check", matchTest && accepted > 0);
+}
+
+void TestDepthPrecision() {
+    TestResult::PrintHeader("REVERSE-Z AND INFINITE PROJECTIONS");
+    
+    TestResult::PrintSubHeader("Depth Conventions");
+    
+    const float nearPlane = 0.1f, farPlane = 100000.0f;
+    const float fov = DEG2RAD(70.0f), aspect = 16.0f/9.0f;
+    Matrix4x4 standard = Matrix4x4::CreatePerspective(fov, aspect, nearPlane, farPlane);
+    Matrix4x4 reverseZ = Matrix4x4::CreatePerspectiveReverseZ(fov, aspect, nearPlane, farPlane);
+    Matrix4x4 infinite = Matrix4x4::CreatePerspectiveInfinite(fov, aspect, nearPlane);
+    Matrix4x4 infiniteReverseZ = Matrix4x4::CreatePerspectiveInfiniteReverseZ(fov, aspect, nearPlane);
+    
+    auto ndcDepth = [](const Matrix4x4& proj, float distance) {
+        return (proj.m[2][2] * -distance + proj.m[2][3]) / (proj.m[3][2] * -distance + proj.m[3][3]);
+    };
+    bool rangeTest = std::abs(ndcDepth(standard, nearPlane) + 1.0f) < 1e-4f &&
+                     std::abs(ndcDepth(reverseZ, nearPlane) - 1.0f) < 1e-6f &&
+                     std::abs(ndcDepth(reverseZ, farPlane)) < 1e-6f &&
+                     std::abs(ndcDepth(infinite, nearPlane) + 1.0f) < 1e-4f &&
+                     ndcDepth(infinite, 1000.0f) < 1.0f && ndcDepth(infinite, 1000.0f) > 0.999f &&
+                     std::abs(ndcDepth(infiniteReverseZ, nearPlane) - 1.0f) < 1e-6f &&
+                     ndcDepth(infiniteReverseZ, 1e8f) > 0.0f;
+    
+    const Matrix4x4* matrices[4] = { &standard, &reverseZ, &infinite, &infiniteReverseZ };
+    const char* names[4] = { "Standard", "Reverse-Z", "Infinite", "Infinite reverse-Z" };
+    bool linearizeTest = true;
+    for (const Matrix4x4* proj : matrices) {
+        float distance = W2SUtils::LinearizeDepth(ndcDepth(*proj, 3.7f), *proj);
+        linearizeTest = linearizeTest && std::abs(distance - 3.7f) < 1e-3f;
+    }
+    
+    TestResult::PrintResult("Near/far mapping of all four matrices", rangeTest);
+    TestResult::PrintResult("Depth linearization round trip", linearizeTest);
+    
+    TestResult::PrintSubHeader("Depth Error Harness");
+    
+    W2SUtils::DepthErrorStats stats[4];
+    for (int i = 0; i < 4; ++i) {
+        stats[i] = W2SUtils::MeasureDepthError(*matrices[i], nearPlane, farPlane, 4000, 1e-4f);
+        std::cout << "  " << std::left << std::setw(20) << names[i] << std::right << std::scientific
+                  << std::setprecision(2) << "max error " << stats[i].maxRelativeError << ", mean "
+                  << stats[i].meanRelativeError << std::defaultfloat << ", ordering errors "
+                  << stats[i].orderingErrors << "/" << stats[i].sampleCount << std::endl;
+    }
+    
+    // 0.1 to 100000 units: standard depth collapses at range, reverse-Z stays near float epsilon
+    bool precisionTest = stats[1].maxRelativeError < 1e-5 && stats[3].maxRelativeError < 1e-5 &&
+                         stats[1].orderingErrors == 0 && stats[3].orderingErrors == 0 &&
+                         stats[0].orderingErrors > 0 && stats[0].maxRelativeError > 100.0 * stats[1].maxRelativeError;
+    
+    TestResult::PrintResult("Reverse-Z keeps depth order across the range", precisionTest);
+    
+    TestResult::PrintSubHeader("Batch Projection with Depth");
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(5.0f, 3.0f, 20.0f), 5.0f, 10.0f, 0.0f);
+    WorldToScreenTransform standardTransform(viewport), reverseTransform(viewport);
+    standardTransform.SetViewMatrix(standard * viewMatrix);
+    reverseTransform.SetViewMatrix(reverseZ * viewMatrix);
+    
+    const size_t numPoints = 10007;
+    std::vector<float> px(numPoints), py(numPoints), pz(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        float t = static_cast<float>(i);
+        px[i] = std::fmod(t * 7.31f, 400.0f) - 200.0f;
+        py[i] = std::fmod(t * 3.17f, 60.0f) - 30.0f;
+        pz[i] = -std::pow(10.0f, std::fmod(t * 0.0137f, 4.5f));
+    }
+    VectorMath::ConstVec3SoA points(px.data(), py.data(), pz.data());
+    std::vector<float> sx0(numPoints), sy0(numPoints), depth0(numPoints);
+    std::vector<float> sx1(numPoints), sy1(numPoints), depth1(numPoints), distance(numPoints);
+    std::vector<uint32_t> mask0((numPoints + 31) / 32), mask1((numPoints + 31) / 32);
+    int visible0 = standardTransform.WorldToScreenBatch(points, sx0.data(), sy0.data(), depth0.data(), mask0.data(),
+                                                         static_cast<int>(numPoints));
+    int visible1 = reverseTransform.WorldToScreenBatch(points, sx1.data(), sy1.data(), depth1.data(), mask1.data(),
+                                                        static_cast<int>(numPoints));
+    W2SUtils::LinearizeDepthBatch(depth1.data(), distance.data(), numPoints, reverseZ);
+    
+    bool batchTest = visible0 == visible1 && mask0 == mask1;
+    for (size_t i = 0; i < numPoints && batchTest; ++i) {
+        if (((mask1[i >> 5] >> (i & 31)) & 1u) == 0) {
+            batchTest = depth1[i] == 0.0f;
+            continue;
+        }
+        float expected = reverseTransform.GetDistanceToPoint(Vec3(px[i], py[i], pz[i]));
+        if (expected < nearPlane) {
+            continue;   // in front of the camera but closer than the near plane
+        }
+        batchTest = std::abs(sx0[i] - sx1[i]) <= 1e-3f * std::max(1.0f, std::abs(sx0[i])) &&
+                    std::abs(sy0[i] - sy1[i]) <= 1e-3f * std::max(1.0f, std::abs(sy0[i])) &&
+                    std::abs(distance[i] - expected) <= 1e-4f * expected;
+    }
+    
+    TestResult::PrintResult("Same kernel for both conventions, depth linearizes", batchTest);
+    
+    TestResult::PrintSubHeader("Culling with Reverse-Z");
+    
+    Matrix4x4 cameraView = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    Matrix4x4 occlusionProj = Matrix4x4::CreatePerspectiveReverseZ(DEG2RAD(70.0f), 2.0f, 0.1f, 500.0f);
+    OcclusionBuffer occlusion(256, 128);
+    occlusion.BeginFrame(occlusionProj * cameraView, true);
+    occlusion.AddOccluder(AABB(Vec3(-20.0f, -5.0f, -31.0f), Vec3(20.0f, 15.0f, -30.0f)));
+    occlusion.Rasterize();
+    bool occlusionTest = !occlusion.IsAABBVisible(Vec3(-1.0f, -1.0f, -61.0f), Vec3(1.0f, 1.0f, -59.0f)) &&
+                         occlusion.IsAABBVisible(Vec3(-1.0f, -1.0f, -11.0f), Vec3(1.0f, 1.0f, -9.0f)) &&
+                         occlusion.IsAABBVisible(Vec3(-1.0f, -1.0f, -1.0f), Vec3(1.0f, 1.0f, 1.0f)) &&
+                         occlusion.IsAABBVisible(Vec3(-1.0f, 39.0f, -61.0f), Vec3(1.0f, 41.0f, -59.0f));
+    
+    Frustum frustum = Frustum::FromMatrix(occlusionProj * cameraView, Frustum::ClipDepth::ReversedZeroToOne);
+    bool frustumTest = frustum.IsPointInside(Vec3(0.0f, 0.0f, -1.0f)) &&
+                       !frustum.IsPointInside(Vec3(0.0f, 0.0f, -0.05f)) &&
+                       !frustum.IsPointInside(Vec3(0.0f, 0.0f, -600.0f)) &&
+                       frustum.GetPlane(Frustum::Near).Distance(Vec3(0.0f, 0.0f, -1.0f)) < 1.0f;
+    
+    TestResult::PrintResult("Occlusion buffer with reverse-Z depth", occlusionTest);
+    TestResult::PrintResult("Frustum planes of a reverse-Z matrix", frustumTest);
+}
+
+void TestTransformHierarchy() {
+    TestResult::PrintHeader("TRANSFORM HIERARCHY");
+    
+    TestResult::PrintSubHeader("Cached World Matrices");
+    
+    // Random forest with parents before children, plus a 256-bone chain at the end
+    const size_t numNodes = 100000, chainLength = 256;
+    std::vector<uint32_t> parents(numNodes);
+    std::vector<Matrix4x4> locals(numNodes);
+    for (size_t i = 0; i < numNodes; ++i) {
+        uint32_t hash = static_cast<uint32_t>(i) * 2654435761u;
+        if (i >= numNodes - chainLength) {
+            parents[i] = static_cast<uint32_t>(i - 1);
+        } else {
+            parents[i] = (i % 5000 == 0) ? TransformHierarchy::kNoParent : (hash >> 7) % static_cast<uint32_t>(i);
+        }
+        float t = static_cast<float>(i);
+        locals[i] = Matrix4x4::CreateTranslation(Vec3(std::fmod(t * 0.37f, 4.0f) - 2.0f, 0.25f, std::fmod(t * 0.11f, 2.0f) - 1.0f)) *
+                    Matrix4x4::CreateRotationY(std::fmod(t * 13.0f, 360.0f)) *
+                    Matrix4x4::CreateScale(Vec3(1.0f, 1.0f + std::fmod(t * 0.01f, 0.02f), 1.0f));
+    }
+    
+    TransformHierarchy hierarchy;
+    hierarchy.Reserve(numNodes);
+    for (size_t i = 0; i < numNodes; ++i) {
+        hierarchy.AddNode(parents[i], locals[i]);
+    }
+    
+    // Reference: scalar operator* along the chain, parents first by depth
+    std::vector<Matrix4x4> reference(numNodes);
+    auto computeReference = [&]() {
+        std::vector<uint32_t> order(numNodes);
+        for (size_t i = 0; i < numNodes; ++i) order[i] = static_cast<uint32_t>(i);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return hierarchy.GetDepth(a) < hierarchy.GetDepth(b);
+        });
+        for (uint32_t i : order) {
+            uint32_t parent = hierarchy.GetParent(i);
+            reference[i] = parent == TransformHierarchy::kNoParent ? locals[i] : reference[parent] * locals[i];
+        }
+    };
+    auto matchesReference = [&]() {
+        for (size_t i = 0; i < numNodes; ++i) {
+            Matrix4x4 world = hierarchy.GetWorld(static_cast<uint32_t>(i));
+            for (int r = 0; r < 4; ++r) {
+                for (int c = 0; c < 4; ++c) {
+                    if (std::abs(world.m[r][c] - reference[i].m[r][c]) > 1e-3f * std::max(1.0f, std::abs(reference[i].m[r][c]))) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+    
+    size_t fullCount = hierarchy.Update();
+    
+    // Flagging the roots recomputes the whole forest
+    for (size_t i = 0; i < numNodes; ++i) {
+        if (parents[i] == TransformHierarchy::kNoParent) hierarchy.MarkDirty(static_cast<uint32_t>(i));
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t rootCount = hierarchy.Update();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto fullMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    // What the hierarchy replaces: operator* along every chain, every frame
+    startTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numNodes; ++i) {
+        reference[i] = parents[i] == TransformHierarchy::kNoParent ? locals[i] : reference[parents[i]] * locals[i];
+    }
+    endTime = std::chrono::high_resolution_clock::now();
+    auto scalarMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    bool initialTest = fullCount == numNodes && rootCount == numNodes && matchesReference() &&
+                       hierarchy.GetDepth(static_cast<uint32_t>(numNodes - 1)) >= static_cast<int>(chainLength);
+    bool staticTest = hierarchy.Update() == 0;
+    
+    TestResult::PrintSubHeader("Dirty Propagation");
+    
+    // Animate a few nodes: every descendant and nothing else is recomputed
+    std::vector<uint8_t> expected(numNodes, 0);
+    for (size_t i = 777; i < numNodes; i += 997) {
+        locals[i] = locals[i] * Matrix4x4::CreateRotationY(15.0f);
+        hierarchy.SetLocal(static_cast<uint32_t>(i), locals[i]);
+        expected[i] = 1;
+    }
+    size_t expectedCount = 0;
+    for (size_t i = 0; i < numNodes; ++i) {
+        if (parents[i] != TransformHierarchy::kNoParent && expected[parents[i]]) expected[i] = 1;
+        expectedCount += expected[i];
+    }
+    
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t dirtyCount = hierarchy.Update();
+    endTime = std::chrono::high_resolution_clock::now();
+    auto dirtyMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    bool changedBitsMatch = true;
+    for (size_t i = 0; i < numNodes && changedBitsMatch; ++i) {
+        changedBitsMatch = ((hierarchy.GetChangedBits()[i >> 5] >> (i & 31)) & 1u) == expected[i];
+    }
+    computeReference();
+    bool dirtyTest = dirtyCount == expectedCount && changedBitsMatch && matchesReference();
+    
+    // Incremental results are bit-identical to rebuilding from scratch, on any thread count
+    VectorMath::TaskScheduler scheduler(4);
+    TransformHierarchy rebuilt;
+    for (size_t i = 0; i < numNodes; ++i) {
+        rebuilt.AddNode(parents[i], locals[i]);
+    }
+    rebuilt.Update(scheduler);
+    bool identicalTest = true;
+    for (size_t i = 0; i < numNodes && identicalTest; ++i) {
+        Matrix4x4 a = hierarchy.GetWorld(static_cast<uint32_t>(i)), b = rebuilt.GetWorld(static_cast<uint32_t>(i));
+        identicalTest = std::memcmp(a.m, b.m, sizeof(a.m)) == 0;
+    }
+    
+    std::cout << "  Nodes: " << numNodes << ", levels: " << hierarchy.GetLevelCount() << std::endl;
+    std::cout << "  Scalar chain: " << scalarMicros << " us, full update: " << fullMicros << " us, "
+              << dirtyCount << " dirty: " << dirtyMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("World matrices match chained multiplication", initialTest);
+    TestResult::PrintResult("Static frame recomputes nothing", staticTest);
+    TestResult::PrintResult("Only dirty subtrees are recomputed", dirtyTest);
+    TestResult::PrintResult("Incremental update equals a rebuild", identicalTest);
+    
+    TestResult::PrintSubHeader("Reparenting");
+    
+    // Move the bone chain under an early node and an early node under the end of the chain
+    const uint32_t chainRoot = static_cast<uint32_t>(numNodes - chainLength);
+    const uint32_t chainEnd = static_cast<uint32_t>(numNodes - 1);
+    bool cycleRejected = !hierarchy.SetParent(chainRoot, chainEnd) && !hierarchy.SetParent(chainEnd, chainEnd) &&
+                         hierarchy.AddNode(static_cast<uint32_t>(numNodes + 5)) == TransformHierarchy::kNoParent;
+    bool reparented = hierarchy.SetParent(chainRoot, 3) && hierarchy.SetParent(12, chainEnd);
+    hierarchy.Update();
+    computeReference();
+    bool reparentTest = cycleRejected && reparented && matchesReference() &&
+                        hierarchy.GetDepth(12) == hierarchy.GetDepth(chainEnd) + 1;
+    
+    // World origins feed straight into the projection paths
+    std::vector<float> wx(numNodes), wy(numNodes), wz(numNodes);
+    hierarchy.GetWorldPositions(VectorMath::Vec3SoA(wx.data(), wy.data(), wz.data()));
+    Vec3 origin = hierarchy.GetWorldPosition(chainEnd);
+    bool positionTest = wx[chainEnd] == origin.x && wy[chainEnd] == origin.y && wz[chainEnd] == origin.z &&
+                        std::abs(origin.x - reference[chainEnd].m[0][3]) < 1e-3f * std::max(1.0f, std::abs(origin.x));
+    
+    TestResult::PrintResult("Reparenting rejects cycles and keeps matrices exact", reparentTest);
+    TestResult::PrintResult("World positions by node id", positionTest);
+}
+
+void TestSkeletonProjection() {
+    TestResult::PrintHeader("SKELETON PROJECTION");
+    
+    TestResult::PrintSubHeader("Batch Bone Composition");
+    
+    // 64-bone skeleton: an 8-bone spine with limbs branching off it
+    const size_t numBones = 64, numCharacters = 200;
+    std::vector<int32_t> parents(numBones);
+    for (size_t b = 0; b < numBones; ++b) {
+        parents[b] = b == 0 ? SkeletonProjector::kNoParent : static_cast<int32_t>(b % 8 == 0 ? b / 8 : b - 1);
+    }
+    
+    // Matrix4x4 keeps rows contiguous, so the first 12 floats are the 3x4 bone matrix
+    std::vector<Matrix4x4> localMatrices(numCharacters * numBones), rootMatrices(numCharacters);
+    std::vector<float> locals(numCharacters * numBones * 12), roots(numCharacters * 12);
+    for (size_t c = 0; c < numCharacters; ++c) {
+        float fc = static_cast<float>(c);
+        Vec3 position(std::fmod(fc * 3.7f, 60.0f) - 30.0f, -1.0f, -5.0f - std::fmod(fc * 1.3f, 55.0f));
+        if (c == 0) {
+            position = Vec3(0.0f, -0.5f, 0.2f);     // straddles the camera plane
+        }
+        rootMatrices[c] = Matrix4x4::CreateTranslation(position) * Matrix4x4::CreateRotationY(fc * 17.0f);
+        std::memcpy(&roots[c * 12], rootMatrices[c].m, 12 * sizeof(float));
+        for (size_t b = 0; b < numBones; ++b) {
+            float fb = static_cast<float>(b);
+            Matrix4x4& local = localMatrices[c * numBones + b];
+            local = Matrix4x4::CreateTranslation(Vec3(0.02f * static_cast<float>(b % 3), 0.1f, 0.03f)) *
+                    Matrix4x4::CreateRotationY(fb * 7.0f + fc);
+            std::memcpy(&locals[(c * numBones + b) * 12], local.m, 12 * sizeof(float));
+        }
+    }
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    Matrix4x4 viewMatrix = W2SUtils::CreateViewMatrixFromEuler(Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix * viewMatrix);
+    
+    // Reference: what the batch replaces, operator* down the chain and one WorldToScreen per joint
+    std::vector<Matrix4x4> boneWorld(numBones);
+    std::vector<Vec3> refJoints(numCharacters * numBones);
+    std::vector<Vec2> refScreen(numCharacters * numBones);
+    std::vector<uint8_t> refVisible(numCharacters * numBones);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (size_t c = 0; c < numCharacters; ++c) {
+        for (size_t b = 0; b < numBones; ++b) {
+            const Matrix4x4& parentWorld = parents[b] == SkeletonProjector::kNoParent ? rootMatrices[c] : boneWorld[parents[b]];
+            boneWorld[b] = parentWorld * localMatrices[c * numBones + b];
+            refJoints[c * numBones + b] = Vec3(boneWorld[b].m[0][3], boneWorld[b].m[1][3], boneWorld[b].m[2][3]);
+            refVisible[c * numBones + b] = transformer.WorldToScreen(refJoints[c * numBones + b], refScreen[c * numBones + b]);
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto scalarMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    SkeletonProjector skeletons;
+    bool skeletonTest = skeletons.SetSkeleton(parents.data(), numBones) && skeletons.GetBoneCount() == numBones;
+    skeletons.Update(transformer, locals.data(), roots.data(), numCharacters);     // warm-up
+    startTime = std::chrono::high_resolution_clock::now();
+    size_t visibleJoints = skeletons.Update(transformer, locals.data(), roots.data(), numCharacters);
+    endTime = std::chrono::high_resolution_clock::now();
+    auto batchMicros = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    
+    bool jointTest = true;
+    size_t refVisibleCount = 0;
+    for (size_t c = 0; c < numCharacters; ++c) {
+        for (size_t b = 0; b < numBones; ++b) {
+            const size_t j = c * numBones + b;
+            Vec2 screen;
+            bool visible = skeletons.GetJointScreenPosition(c, b, screen);
+            Vec3 joint(skeletons.GetJointPositions().x[j], skeletons.GetJointPositions().y[j], skeletons.GetJointPositions().z[j]);
+            refVisibleCount += refVisible[j];
+            jointTest = jointTest && (joint - refJoints[j]).Length() < 1e-4f && visible == (refVisible[j] != 0) &&
+                        (!visible || (screen - refScreen[j]).Length() < 0.05f);
+        }
+    }
+    jointTest = jointTest && visibleJoints == refVisibleCount && refVisibleCount < numCharacters * numBones;
+    
+    Matrix4x4 world = skeletons.GetBoneWorld(7, 63);
+    bool worldTest = (Vec3(world.m[0][3], world.m[1][3], world.m[2][3]) - refJoints[7 * numBones + 63]).Length() < 1e-4f &&
+                     world.m[3][3] == 1.0f;
+    
+    std::cout << "  " << numCharacters << " characters x " << numBones << " bones, " << visibleJoints
+              << " joints in front" << std::endl;
+    std::cout << "  Scalar chain + WorldToScreen: " << scalarMicros << " us, batch: " << batchMicros << " us" << std::endl;
+    
+    TestResult::PrintResult("Skeleton layout accepted", skeletonTest);
+    TestResult::PrintResult("Joints match chained operator* and WorldToScreen", jointTest);
+    TestResult::PrintResult("Bone-to-world matrices", worldTest);
+    
+    TestResult::PrintSubHeader("Bone Segments");
+    
+    // Every bone is compared against clipping it on its own
+    auto segmentsMatch = [&](bool clipToViewport) {
+        const std::vector<ScreenSegment>& segments = skeletons.GetSegments();
+        size_t next = 0;
+        for (size_t c = 0; c < numCharacters; ++c) {
+            for (size_t b = 1; b < numBones; ++b) {
+                const uint32_t joint = static_cast<uint32_t>(c * numBones + b);
+                Vec3 start = refJoints[c * numBones + parents[b]], end = refJoints[joint];
+                ScreenSegment expected;
+                if (transformer.ProjectSegments(&start, &end, 1, &expected, clipToViewport) == 0) {
+                    if (next < segments.size() && segments[next].sourceIndex == joint) return false;
+                    continue;
+                }
+                if (next >= segments.size() || segments[next].sourceIndex != joint) return false;
+                if ((segments[next].start - expected.start).Length() > 0.05f ||
+                    (segments[next].end - expected.end).Length() > 0.05f) return false;
+                ++next;
+            }
+        }
+        return next == segments.size();
+    };
+    
+    bool segmentTest = segmentsMatch(false);
+    size_t unclippedCount = skeletons.GetSegments().size();
+    
+    skeletons.Update(transformer, locals.data(), roots.data(), numCharacters, true);
+    bool clippedTest = segmentsMatch(true);
+    for (const ScreenSegment& segment : skeletons.GetSegments()) {
+        for (const Vec2& p : { segment.start, segment.end }) {
+            clippedTest = clippedTest && p.x >= -0.01f && p.x <= 1920.01f && p.y >= -0.01f && p.y <= 1080.01f;
+        }
+    }
+    
+    const int32_t badParents[3] = { SkeletonProjector::kNoParent, 2, 0 };
+    bool rejectTest = !skeletons.SetSkeleton(badParents, 3) && skeletons.GetBoneCount() == 0;
+    
+    std::cout << "  Segments: " << unclippedCount << " clipped to the camera plane, "
+              << skeletons.GetSegments().size() << " to the viewport" << std::endl;
+    
+    TestResult::PrintResult("Segments match per-bone clipping, in joint order", segmentTest);
+    TestResult::PrintResult("Viewport clipping keeps segments on screen", clippedTest);
+    TestResult::PrintResult("Out-of-order parents rejected", rejectTest);
+}
+
+void TestCpuDispatch() {
+    TestResult::PrintHeader("CPU FEATURE DETECTION AND DISPATCH");
+    
+    TestResult::PrintSubHeader("CPU Features");
+    
+    using VectorMath::SimdLevel;
+    const VectorMath::CpuFeatures& features = VectorMath::GetCpuFeatures();
+    const SimdLevel detected = VectorMath::GetDetectedSimdLevel();
+    const SimdLevel active = VectorMath::GetSimdLevel();
+    
+    std::cout << "  Extensions:";
+    const std::pair<const char*, bool> named[] = {
+        { "SSE2", features.sse2 }, { "SSE4.2", features.sse42 }, { "POPCNT", features.popcnt },
+        { "AVX", features.avx }, { "AVX2", features.avx2 }, { "FMA", features.fma },
+        { "BMI1", features.bmi1 }, { "BMI2", features.bmi2 }, { "AVX-512F", features.avx512f },
+        { "AVX-512DQ", features.avx512dq }, { "AVX-512BW", features.avx512bw }, { "AVX-512VL", features.avx512vl },
+        { "AES", features.aes }, { "PCLMUL", features.pclmul }, { "SHA", features.sha }
+    };
+    for (const auto& feature : named) {
+        if (feature.second) std::cout << " " << feature.first;
+    }
+    std::cout << std::endl;
+    std::cout << "  Detected level: " << VectorMath::GetSimdLevelName(detected)
+              << ", active: " << VectorMath::GetSimdLevelName(active)
+              << ", demo compiled for: " << VectorMath::SIMD::kName << std::endl;
+    
+    // Wider extensions need the narrower ones and the OS state behind them
+    bool consistentTest = (!features.avx2 || features.avx) && (!features.fma || features.avx) &&
+                          (!features.avx512f || features.avx2) && (!features.avx512dq || features.avx512f) &&
+                          (!features.sse42 || features.sse41) && (!features.sse41 || features.ssse3);
+    
+    // This binary runs, so the CPU has at least the level it was compiled for
+    bool compiledTest = true;
+#if defined(VECTORMATH_SIMD_AVX512)
+    compiledTest = detected == SimdLevel::AVX512;
+#elif defined(VECTORMATH_SIMD_AVX2)
+    compiledTest = static_cast<int>(detected) >= static_cast<int>(SimdLevel::AVX2);
+#elif defined(VECTORMATH_SIMD_SSE2)
+    compiledTest = static_cast<int>(detected) >= static_cast<int>(SimdLevel::SSE2);
+#endif
+    compiledTest = compiledTest && static_cast<int>(active) <= static_cast<int>(detected);
+    
+    VectorMath::CpuFeatures again = VectorMath::DetectCpuFeatures();
+    bool cachedTest = &VectorMath::GetCpuFeatures() == &features && again.avx2 == features.avx2 &&
+                      again.avx512f == features.avx512f && again.bmi2 == features.bmi2 && again.sha == features.sha;
+    
+    SimdLevel parsed = SimdLevel::Scalar;
+    bool parseTest = VectorMath::ParseSimdLevel("AVX2", parsed) && parsed == SimdLevel::AVX2 &&
+                     VectorMath::ParseSimdLevel("avx512", parsed) && parsed == SimdLevel::AVX512 &&
+                     VectorMath::ParseSimdLevel("Scalar", parsed) && parsed == SimdLevel::Scalar &&
+                     !VectorMath::ParseSimdLevel("sse4", parsed) && !VectorMath::ParseSimdLevel("", parsed) &&
+                     parsed == SimdLevel::Scalar;
+    
+    // Gaps fall through to the next lower level
+    const int variants[VectorMath::kSimdLevelCount] = { 1, 0, 3, 0 };
+    SimdLevel selected = SimdLevel::Scalar;
+    bool selectTest = VectorMath::SelectForLevel(variants, SimdLevel::AVX512, &selected) == 3 && selected == SimdLevel::AVX2 &&
+                      VectorMath::SelectForLevel(variants, SimdLevel::SSE2, &selected) == 1 && selected == SimdLevel::Scalar;
+    
+    TestResult::PrintResult("Feature flags are consistent", consistentTest);
+    TestResult::PrintResult("Detected level covers the compiled level", compiledTest);
+    TestResult::PrintResult("Detection cached and repeatable", cachedTest);
+    TestResult::PrintResult("VECTORMATH_SIMD_LEVEL names parsed", parseTest);
+    TestResult::PrintResult("Level selection falls back to lower builds", selectTest);
+    
+    TestResult::PrintSubHeader("Projection Kernel Dispatch");
+    
+    // Points well away from the camera plane, so every level agrees on visibility
+    const size_t numPoints = 100003;
+    std::vector<float> xs(numPoints), ys(numPoints), zs(numPoints);
+    uint32_t seed = 12345;
+    auto next = [&seed](float lo, float hi) {
+        seed = seed * 1664525u + 1013904223u;
+        return lo + (hi - lo) * static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < numPoints; ++i) {
+        xs[i] = next(-60.0f, 60.0f);
+        ys[i] = next(-35.0f, 35.0f);
+        zs[i] = next(-150.0f, 20.0f);
+        if (std::fabs(zs[i]) < 0.05f) zs[i] = -1.0f;
+    }
+    
+    Viewport viewport(1920, 1080);
+    Matrix4x4 projMatrix = Matrix4x4::CreatePerspective(DEG2RAD(70.0f), 16.0f/9.0f, 0.1f, 500.0f);
+    WorldToScreenTransform transformer(viewport);
+    transformer.SetViewMatrix(projMatrix);
+    const float* screenMatrix = &transformer.GetScreenMatrix().m[0][0];
+    const ProjectionKernels::ScreenBounds bounds = { 0.0f, 1920.0f, 0.0f, 1080.0f };
+    const size_t maskWords = (numPoints + 31) / 32;
+    
+    std::vector<float> refX(numPoints), refY(numPoints), refDepth(numPoints);
+    std::vector<uint32_t> refMask(maskWords), refClipMask(maskWords);
+    ProjectionKernels::ProjectPointsFunction scalarKernel = ProjectionKernels::GetKernelsScalar().projectPoints;
+    int refVisible = scalarKernel(screenMatrix, bounds, xs.data(), ys.data(), zs.data(), refX.data(), refY.data(),
+                                  refMask.data(), numPoints, false, refDepth.data());
+    scalarKernel(screenMatrix, bounds, xs.data(), ys.data(), zs.data(), refX.data(), refY.data(),
+                 refClipMask.data(), numPoints, true, refDepth.data());
+    
+    std::vector<float> sx(numPoints), sy(numPoints), depth(numPoints);
+    std::vector<uint32_t> mask(maskWords);
+    bool kernelTest = refVisible > 0 && refVisible < static_cast<int>(numPoints);
+    for (int level = 0; level <= static_cast<int>(detected); ++level) {
+        SimdLevel kernelLevel = SimdLevel::Scalar;
+        ProjectionKernels::ProjectPointsFunction kernel =
+            ProjectionKernels::GetProjectPoints(static_cast<SimdLevel>(level), &kernelLevel);
+        if (!kernel || static_cast<int>(kernelLevel) > level) {
+            kernelTest = false;
+            continue;
+        }
+        
+        auto startTime = std::chrono::high_resolution_clock::now();
+        int visible = kernel(screenMatrix, bounds, xs.data(), ys.data(), zs.data(), sx.data(), sy.data(),
+                             mask.data(), numPoints, false, depth.data());
+        auto endTime = std::chrono::high_resolution_clock::now();
+        
+        bool match = visible == refVisible && mask == refMask;
+        for (size_t i = 0; i < numPoints && match; ++i) {
+            match = std::fabs(sx[i] - refX[i]) <= 0.05f + 1e-5f * std::fabs(refX[i]) &&
+                    std::fabs(sy[i] - refY[i]) <= 0.05f + 1e-5f * std::fabs(refY[i]) &&
+                    std::fabs(depth[i] - refDepth[i]) < 1e-4f;
+        }
+        
+        // Rounding may move points lying right on the viewport edge, so those are not compared
+        kernel(screenMatrix, bounds, xs.data(), ys.data(), zs.data(), sx.data(), sy.data(),
+               mask.data(), numPoints, true, nullptr);
+        for (size_t i = 0; i < numPoints && match; ++i) {
+            const bool nearEdge = std::fabs(refX[i]) < 0.01f || std::fabs(refX[i] - 1920.0f) < 0.01f ||
+                                  std::fabs(refY[i]) < 0.01f || std::fabs(refY[i] - 1080.0f) < 0.01f;
+            const bool bit = ((mask[i >> 5] >> (i & 31)) & 1u) != 0;
+            const bool refBit = ((refClipMask[i >> 5] >> (i & 31)) & 1u) != 0;
+            match = nearEdge || bit == refBit;
+        }
+        
+        std::cout << "  " << std::setw(8) << VectorMath::GetSimdLevelName(static_cast<SimdLevel>(level)) << " -> "
+                  << std::setw(8) << VectorMath::GetSimdLevelName(kernelLevel) << " kernel: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count()
+                  << " us for " << numPoints << " points" << (match ? "" : "  MISMATCH") << std::endl;
+        kernelTest = kernelTest && match;
+    }
+    
+    // The batch entry points run exactly the kernel picked for the active level
+    std::vector<uint32_t> batchMask(maskWords);
+    ProjectionKernels::GetProjectPoints()(screenMatrix, bounds, xs.data(), ys.data(), zs.data(), refX.data(), refY.data(),
+                                          refMask.data(), numPoints, false, nullptr);
+    int batchVisible = transformer.WorldToScreenBatch(ConstVec3SoA(xs.data(), ys.data(), zs.data()), sx.data(), sy.data(),
+                                                      batchMask.data(), static_cast<int>(numPoints));
+    bool dispatchTest = batchVisible == refVisible && batchMask == refMask &&
+                        std::memcmp(sx.data(), refX.data(), numPoints * sizeof(float)) == 0 &&
+                        std::memcmp(sy.data(), refY.data(), numPoints * sizeof(float)) == 0 &&
+                        ProjectionKernels::GetProjectPoints() == ProjectionKernels::GetProjectPoints(active) &&
+                        static_cast<int>(ProjectionKernels::GetProjectPointsLevel()) <= static_cast<int>(active);
+    
+    std::cout << "  Batch projection runs the " << VectorMath::GetSimdLevelName(ProjectionKernels::GetProjectPointsLevel())
+              << " kernel" << std::endl;
+    
+    TestResult::PrintResult("Every supported level matches the scalar kernel", kernelTest);
+    TestResult::PrintResult("Batch projection uses the dispatched kernel", dispatchTest);
+    
+    TestResult::PrintSubHeader("Box Kernel Dispatch");
+    
+    // Boxes around the camera, some straddling or behind the camera plane
+    const size_t numBoxes = 20011;
+    std::vector<float> minX(numBoxes), minY(numBoxes), minZ(numBoxes), maxX(numBoxes), maxY(numBoxes), maxZ(numBoxes);
+    for (size_t i = 0; i < numBoxes; ++i) {
+        minX[i] = next(-80.0f, 80.0f);
+        minY[i] = next(-40.0f, 40.0f);
+        minZ[i] = next(-200.0f, 30.0f);
+        maxX[i] = minX[i] + next(0.1f, 8.0f);
+        maxY[i] = minY[i] + next(0.1f, 8.0f);
+        maxZ[i] = minZ[i] + next(0.1f, 8.0f);
+    }
+    const ProjectionKernels::BoxStreams boxes = { minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data() };
+    const size_t boxWords = (numBoxes + 31) / 32;
+    
+    const Frustum frustum = Frustum::FromMatrix(projMatrix);
+    float planes[Frustum::PlaneCount][4];
+    for (int p = 0; p < Frustum::PlaneCount; ++p) {
+        const FrustumPlane& plane = frustum.GetPlane(p);
+        planes[p][0] = plane.normal.x;
+        planes[p][1] = plane.normal.y;
+        planes[p][2] = plane.normal.z;
+        planes[p][3] = plane.d;
+    }
+    const float viewportValues[4] = { 1920.0f, 1080.0f, 0.0f, 0.0f };
+    
+    const ProjectionKernels::KernelSet scalarKernels = ProjectionKernels::GetKernelsScalar();
+    std::vector<uint32_t> refCullMask(boxWords), refValidMask(boxWords);
+    std::vector<uint8_t> refResults(numBoxes);
+    std::vector<float> refLeft(numBoxes), refRight(numBoxes), refTop(numBoxes), refBottom(numBoxes);
+    size_t refCulled = scalarKernels.cullBoxes(&planes[0][0], boxes, numBoxes, refCullMask.data(), refResults.data());
+    size_t refValid = scalarKernels.screenBounds(&projMatrix.m[0][0], viewportValues, boxes, numBoxes,
+                                                 { refLeft.data(), refRight.data(), refTop.data(), refBottom.data() },
+                                                 refValidMask.data());
+    
+    // Rounding may flip a box lying exactly on a plane, so a handful of differences is tolerated
+    std::vector<uint32_t> cullMask(boxWords), validMask(boxWords);
+    std::vector<uint8_t> results(numBoxes);
+    std::vector<float> left(numBoxes), right(numBoxes), top(numBoxes), bottom(numBoxes);
+    auto close = [](float a, float b) { return std::fabs(a - b) <= 0.05f + 1e-4f * std::fabs(b); };
+    bool boxKernelTest = refCulled > 0 && refCulled < numBoxes && refValid > 0 && refValid < numBoxes;
+    for (int level = 0; level <= static_cast<int>(detected); ++level) {
+        const ProjectionKernels::KernelSet kernels = ProjectionKernels::GetKernels(static_cast<SimdLevel>(level));
+        size_t culled = kernels.cullBoxes(&planes[0][0], boxes, numBoxes, cullMask.data(), results.data());
+        size_t valid = kernels.screenBounds(&projMatrix.m[0][0], viewportValues, boxes, numBoxes,
+                                            { left.data(), right.data(), top.data(), bottom.data() }, validMask.data());
+        size_t differences = 0;
+        for (size_t i = 0; i < numBoxes; ++i) {
+            const bool refBit = ((refValidMask[i >> 5] >> (i & 31)) & 1u) != 0;
+            const bool bit = ((validMask[i >> 5] >> (i & 31)) & 1u) != 0;
+            const bool rectMatch = bit == refBit && close(left[i], refLeft[i]) && close(right[i], refRight[i]) &&
+                                   close(top[i], refTop[i]) && close(bottom[i], refBottom[i]);
+            differences += (results[i] != refResults[i] || !rectMatch) ? 1 : 0;
+        }
+        const bool match = differences <= numBoxes / 1000 &&
+                           (culled > refCulled ? culled - refCulled : refCulled - culled) <= numBoxes / 1000 &&
+                           (valid > refValid ? valid - refValid : refValid - valid) <= numBoxes / 1000;
+        std::cout << "  " << std::setw(8) << VectorMath::GetSimdLevelName(static_cast<SimdLevel>(level))
+                  << " box kernels: " << differences << " of " << numBoxes << " boxes differ"
+                  << (match ? "" : "  MISMATCH") << std::endl;
+        boxKernelTest = boxKernelTest && match;
+    }
+    
+    // Frustum::CullAABBs and GetScreenBoundsBatch run exactly the dispatched kernels
+    const ProjectionKernels::KernelSet& activeKernels = ProjectionKernels::GetKernels();
+    activeKernels.cullBoxes(&planes[0][0], boxes, numBoxes, refCullMask.data(), refResults.data());
+    activeKernels.screenBounds(&projMatrix.m[0][0], viewportValues, boxes, numBoxes,
+                               { refLeft.data(), refRight.data(), refTop.data(), refBottom.data() }, refValidMask.data());
+    std::vector<CullResult> cullResults(numBoxes);
+    frustum.CullAABBs(ConstVec3SoA(minX.data(), minY.data(), minZ.data()), ConstVec3SoA(maxX.data(), maxY.data(), maxZ.data()),
+                      numBoxes, cullMask.data(), cullResults.data());
+    W2SUtils::GetScreenBoundsBatch(ConstVec3SoA(minX.data(), minY.data(), minZ.data()),
+                                   ConstVec3SoA(maxX.data(), maxY.data(), maxZ.data()), numBoxes, projMatrix, viewport,
+                                   W2SUtils::ScreenRectSoA(left.data(), right.data(), top.data(), bottom.data()),
+                                   validMask.data());
+    bool boxDispatchTest = cullMask == refCullMask && validMask == refValidMask &&
+                           std::memcmp(cullResults.data(), refResults.data(), numBoxes) == 0 &&
+                           std::memcmp(left.data(), refLeft.data(), numBoxes * sizeof(float)) == 0 &&
+                           std::memcmp(bottom.data(), refBottom.data(), numBoxes * sizeof(float)) == 0;
+    
+    TestResult::PrintResult("Box kernels at every level match the scalar build", boxKernelTest);
+    TestResult::PrintResult("Box culling and bounds use the dispatched kernels", boxDispatchTest);
+}
+
 int main() {
     std::cout << "Initializing WorldToScreen Demo..." << std::endl;
     
@@ -910,6 +3183,25 @@ int main() {
     TestUtilityFunctions();
     TestBoundingBoxOperations();
     TestRealWorldScenarios();
+    TestLargeWorldCoordinates();
+    TestSIMDBatchProjection();
+    TestParallelProjection();
+    TestFrustumCulling();
+    TestBVHCulling();
+    TestOcclusionCulling();
+    TestScreenBoundsBatch();
+    TestLineProjection();
+    TestCameraState();
+    TestScreenMatrix();
+    TestProjectionCache();
+    TestScreenPicking();
+    TestBatchUnprojection();
+    TestOverlayRasterizer();
+    TestOverlayLOD();
+    TestDepthPrecision();
+    TestTransformHierarchy();
+    TestSkeletonProjection();
+    TestCpuDispatch();
     TestPerformanceBenchmarks();
     
     // Print final results
@@ -926,6 +3218,25 @@ int main() {
     std::cout << "[+] Screen-to-World Ray Conversion" << std::endl;
     std::cout << "[+] Matrix Inverse and Utility Functions" << std::endl;
     std::cout << "[+] Camera Position and FOV Extraction" << std::endl;
+    std::cout << "[+] Camera-Relative Double Precision Projection" << std::endl;
+    std::cout << "[+] SIMD SoA Batch Projection with Visibility Masks" << std::endl;
+    std::cout << "[+] Multi-Threaded Projection with Compacted Output" << std::endl;
+    std::cout << "[+] Frustum-Plane Culling of Boxes and Spheres" << std::endl;
+    std::cout << "[+] SAH BVH Culling with Plane Masks" << std::endl;
+    std::cout << "[+] Software Occlusion Culling with a Depth Pyramid" << std::endl;
+    std::cout << "[+] Batched Near-Plane Clipped Screen Bounds" << std::endl;
+    std::cout << "[+] Line and Polyline Projection with Clipping" << std::endl;
+    std::cout << "[+] Seqlock Camera State for Concurrent Readers" << std::endl;
+    std::cout << "[+] Fused View-Projection-Viewport Matrix" << std::endl;
+    std::cout << "[+] Incremental Projection Cache with Dirty Bits" << std::endl;
+    std::cout << "[+] Screen-Space Grid Picking" << std::endl;
+    std::cout << "[+] Batch Screen-to-World Ray Unprojection" << std::endl;
+    std::cout << "[+] Headless Overlay Rasterizer" << std::endl;
+    std::cout << "[+] Batch LOD Selection and Label Declutter" << std::endl;
+    std::cout << "[+] Reverse-Z and Infinite Projections with Depth Error Harness" << std::endl;
+    std::cout << "[+] Transform Hierarchy with Dirty Propagation" << std::endl;
+    std::cout << "[+] Batch Skeleton Projection" << std::endl;
+    std::cout << "[+] Runtime CPU Feature Detection and Kernel Dispatch" << std::endl;
     std::cout << "[+] Real-World Graphics Application Scenarios" << std::endl;
     std::cout << "[+] High-Performance Rendering Pipeline Support" << std::endl;
     
@@ -9,6 +9,7 @@
  */
 
 #include "PatternScanning.hpp"
+#include "../vector-math/CpuFeatures.hpp"
 #include <cstring>
 #include <thread>
 #include <algorithm>
@@ -221,22 +222,8 @@ ScanResults BoyerMooreScanner::ScanAll(const uint8_t* data, size_t size, uintptr
 
 // SIMDScanner implementation
 bool SIMDScanner::IsAvailable() {
-    // Check for SSE2 support (basic requirement)
-    #ifdef _WIN32
-        #ifdef _MSC_VER
-            int cpuInfo[4];
-            __cpuid(cpuInfo, 1);
-            return (cpuInfo[3] & (1 << 26)) != 0; // SSE2 bit
-        #elif defined(__GNUC__)
-            unsigned int eax, ebx, ecx, edx;
-            __get_cpuid(1, &eax, &ebx, &ecx, &edx);
-            return (edx & (1 << 26)) != 0; // SSE2 bit
-        #else
-            return false;
-        #endif
-    #else
-        return false; // Not implemented for non-Windows
-    #endif
+    // SSE2 is the baseline the scanner needs; detection is shared with the vector-math kernels
+    return VectorMath::GetCpuFeatures().sse2;
 }
 
 ScanResult SIMDScanner::FastScan(const std::vector<uint8_t>& bytes, const uint8_t* data, size_t size, uintptr_t baseAddress) {
@@ -129,6 +129,9 @@ class SIMDScanner {
 public:
     /**
      * @brief Check if SIMD instructions are available
+     *
+     * Uses the cached VectorMath::GetCpuFeatures(), which also reports SSE4.2,
+     * AVX2, AVX-512 and BMI2 for wider scanning kernels.
      */
     static bool IsAvailable();
     
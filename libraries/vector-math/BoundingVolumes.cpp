@@ -0,0 +1,674 @@
+/**
+ * @file BoundingVolumes.cpp
+ * @brief Implementation of convex hull and bounding-volume fitting
+ * @author Lukas Ernst
+ */
+
+#include "BoundingVolumes.hpp"
+#include "VectorSIMD.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+namespace VectorMath {
+
+namespace {
+
+// Points are deinterleaved into stack blocks of this size for the SIMD passes
+constexpr size_t kBlockSize = 256;
+
+// Extreme directions in counter-clockwise angular order starting at -y
+constexpr int kDirectionCount = 8;
+const float kDirections[kDirectionCount][2] = {
+    {  0.0f, -1.0f }, {  1.0f, -1.0f }, {  1.0f,  0.0f }, {  1.0f,  1.0f },
+    {  0.0f,  1.0f }, { -1.0f,  1.0f }, { -1.0f,  0.0f }, { -1.0f, -1.0f }
+};
+
+inline float Cross(const Vec2& o, const Vec2& a, const Vec2& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+inline float Support(const Vec2& p, int direction) {
+    return kDirections[direction][0] * p.x + kDirections[direction][1] * p.y;
+}
+
+void LoadBlock(const Vec2* points, size_t count, float* xs, float* ys) {
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+    }
+}
+
+void LoadBlock(const Vec3* points, size_t count, float* xs, float* ys, float* zs) {
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+        zs[i] = points[i].z;
+    }
+}
+
+/**
+ * @brief Finds one point per direction in kDirections that maximizes the support
+ */
+void FindExtremePoints(const Vec2* points, size_t count, Vec2 extremes[kDirectionCount]) {
+    using namespace SIMD;
+    float best[kDirectionCount];
+    for (int d = 0; d < kDirectionCount; ++d) {
+        best[d] = -FLT_MAX;
+        extremes[d] = points[0];
+    }
+
+    float xs[kBlockSize], ys[kBlockSize];
+    for (size_t base = 0; base < count; base += kBlockSize) {
+        const size_t n = std::min(kBlockSize, count - base);
+        LoadBlock(points + base, n, xs, ys);
+
+        FloatV blockMax[kDirectionCount];
+        for (int d = 0; d < kDirectionCount; ++d) {
+            blockMax[d] = Set1(-FLT_MAX);
+        }
+
+        size_t i = 0;
+        for (; i + kWidth <= n; i += kWidth) {
+            const FloatV x = Load(xs + i);
+            const FloatV y = Load(ys + i);
+            for (int d = 0; d < kDirectionCount; ++d) {
+                const FloatV value = Add(Mul(Set1(kDirections[d][0]), x), Mul(Set1(kDirections[d][1]), y));
+                blockMax[d] = Max(blockMax[d], value);
+            }
+        }
+
+        for (int d = 0; d < kDirectionCount; ++d) {
+            float value = ReduceMax(blockMax[d]);
+            for (size_t j = i; j < n; ++j) {
+                value = std::max(value, Support(points[base + j], d));
+            }
+
+            // Improvements get rare quickly, so locating the winner stays cheap
+            if (value > best[d]) {
+                best[d] = value;
+                for (size_t j = 0; j < n; ++j) {
+                    if (Support(points[base + j], d) == value) {
+                        extremes[d] = points[base + j];
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Index of the point farthest from origin
+ */
+size_t FindFarthest(const Vec3* points, size_t count, const Vec3& origin) {
+    using namespace SIMD;
+    float best = -1.0f;
+    size_t bestIndex = 0;
+
+    const FloatV ox = Set1(origin.x), oy = Set1(origin.y), oz = Set1(origin.z);
+    float xs[kBlockSize], ys[kBlockSize], zs[kBlockSize];
+
+    for (size_t base = 0; base < count; base += kBlockSize) {
+        const size_t n = std::min(kBlockSize, count - base);
+        LoadBlock(points + base, n, xs, ys, zs);
+
+        FloatV blockMax = Set1(-1.0f);
+        size_t i = 0;
+        for (; i + kWidth <= n; i += kWidth) {
+            const FloatV dx = Sub(Load(xs + i), ox);
+            const FloatV dy = Sub(Load(ys + i), oy);
+            const FloatV dz = Sub(Load(zs + i), oz);
+            blockMax = Max(blockMax, MulAdd(dx, dx, MulAdd(dy, dy, Mul(dz, dz))));
+        }
+
+        float value = ReduceMax(blockMax);
+        for (size_t j = i; j < n; ++j) {
+            value = std::max(value, points[base + j].DistanceSquared(origin));
+        }
+
+        if (value > best) {
+            best = value;
+            for (size_t j = 0; j < n; ++j) {
+                if (points[base + j].DistanceSquared(origin) >= value) {
+                    bestIndex = base + j;
+                    break;
+                }
+            }
+        }
+    }
+    return bestIndex;
+}
+
+// ---------------------------------------------------------------------------
+// Exact minimum sphere helpers (double precision)
+// ---------------------------------------------------------------------------
+
+struct DVec {
+    double x, y, z;
+};
+
+inline DVec ToD(const Vec3& v) { return { v.x, v.y, v.z }; }
+inline DVec Sub(const DVec& a, const DVec& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline DVec Add(const DVec& a, const DVec& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline DVec Scale(const DVec& a, double s) { return { a.x * s, a.y * s, a.z * s }; }
+inline double Dot(const DVec& a, const DVec& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline DVec CrossD(const DVec& a, const DVec& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+struct DSphere {
+    DVec center;
+    double radiusSquared;
+
+    bool Contains(const DVec& p) const {
+        DVec d = Sub(p, center);
+        return Dot(d, d) <= radiusSquared * (1.0 + 1e-9) + 1e-12;
+    }
+};
+
+DSphere SphereFrom1(const DVec& a) {
+    return { a, 0.0 };
+}
+
+DSphere SphereFrom2(const DVec& a, const DVec& b) {
+    DVec center = Scale(Add(a, b), 0.5);
+    DVec d = Sub(a, center);
+    return { center, Dot(d, d) };
+}
+
+DSphere SphereFrom3(const DVec& a, const DVec& b, const DVec& c) {
+    const DVec ab = Sub(b, a);
+    const DVec ac = Sub(c, a);
+    const DVec normal = CrossD(ab, ac);
+    const double denom = 2.0 * Dot(normal, normal);
+
+    if (denom < 1e-18 * Dot(ab, ab) * Dot(ac, ac) || denom == 0.0) {
+        // Collinear: the two farthest points span the sphere
+        DSphere s = SphereFrom2(a, b);
+        DSphere t = SphereFrom2(a, c);
+        DSphere u = SphereFrom2(b, c);
+        if (t.radiusSquared > s.radiusSquared) s = t;
+        if (u.radiusSquared > s.radiusSquared) s = u;
+        return s;
+    }
+
+    const DVec offset = Scale(Add(Scale(CrossD(ac, normal), Dot(ab, ab)),
+                                  Scale(CrossD(normal, ab), Dot(ac, ac))), 1.0 / denom);
+    return { Add(a, offset), Dot(offset, offset) };
+}
+
+DSphere SphereFrom4(const DVec& a, const DVec& b, const DVec& c, const DVec& d) {
+    const DVec ab = Sub(b, a);
+    const DVec ac = Sub(c, a);
+    const DVec ad = Sub(d, a);
+    const double det = Dot(ab, CrossD(ac, ad));
+    const double scale = std::sqrt(Dot(ab, ab) * Dot(ac, ac) * Dot(ad, ad));
+
+    if (std::abs(det) <= 1e-12 * scale) {
+        // Coplanar: smallest lower-order sphere that still contains all four
+        const DVec pts[4] = { a, b, c, d };
+        DSphere best = { a, DBL_MAX };
+        for (int i = 0; i < 4; ++i) {
+            for (int j = i + 1; j < 4; ++j) {
+                for (int k = j; k < 4; ++k) {
+                    DSphere s = (k == j) ? SphereFrom2(pts[i], pts[j]) : SphereFrom3(pts[i], pts[j], pts[k]);
+                    if (s.radiusSquared < best.radiusSquared &&
+                        s.Contains(a) && s.Contains(b) && s.Contains(c) && s.Contains(d)) {
+                        best = s;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    const DVec offset = Scale(Add(Add(Scale(CrossD(ac, ad), Dot(ab, ab)),
+                                      Scale(CrossD(ad, ab), Dot(ac, ac))),
+                                  Scale(CrossD(ab, ac), Dot(ad, ad))), 1.0 / (2.0 * det));
+    return { Add(a, offset), Dot(offset, offset) };
+}
+
+/**
+ * @brief Eigen decomposition of a symmetric 3x3 matrix (cyclic Jacobi)
+ * @param a Matrix, destroyed; eigenvalues end up on the diagonal
+ * @param v Output eigenvectors as columns
+ */
+void JacobiEigen(double a[3][3], double v[3][3]) {
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            v[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 32; ++sweep) {
+        const double offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        if (offDiagonal < 1e-30) {
+            break;
+        }
+
+        for (int p = 0; p < 2; ++p) {
+            for (int q = p + 1; q < 3; ++q) {
+                if (std::abs(a[p][q]) < 1e-30) {
+                    continue;
+                }
+
+                const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+
+                for (int k = 0; k < 3; ++k) {
+                    const double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Bounding volume types
+// ---------------------------------------------------------------------------
+
+void OrientedRect::GetCorners(Vec2 corners[4]) const {
+    const Vec2 u = axis * halfExtents.x;
+    const Vec2 v = Vec2(-axis.y, axis.x) * halfExtents.y;
+    corners[0] = center - u - v;
+    corners[1] = center + u - v;
+    corners[2] = center + u + v;
+    corners[3] = center - u + v;
+}
+
+bool OrientedBox::Contains(const Vec3& point, float epsilon) const {
+    const Vec3 d = point - center;
+    return std::abs(d.Dot(axes[0])) <= halfExtents.x + epsilon &&
+           std::abs(d.Dot(axes[1])) <= halfExtents.y + epsilon &&
+           std::abs(d.Dot(axes[2])) <= halfExtents.z + epsilon;
+}
+
+void OrientedBox::GetCorners(Vec3 corners[8]) const {
+    for (int i = 0; i < 8; ++i) {
+        corners[i] = center
+            + axes[0] * ((i & 1) ? halfExtents.x : -halfExtents.x)
+            + axes[1] * ((i & 2) ? halfExtents.y : -halfExtents.y)
+            + axes[2] * ((i & 4) ? halfExtents.z : -halfExtents.z);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Convex hull
+// ---------------------------------------------------------------------------
+
+const std::vector<Vec2>& BoundingVolumeBuilder::ConvexHull(const Vec2* points, size_t count) {
+    m_hull.clear();
+    m_candidates.clear();
+    if (count == 0) {
+        return m_hull;
+    }
+
+    // Akl-Toussaint: the octagon of extreme points is inside the hull, so any
+    // point strictly inside it can be dropped before sorting
+    Vec2 extremes[kDirectionCount];
+    FindExtremePoints(points, count, extremes);
+
+    Vec2 polygon[kDirectionCount];
+    int polygonSize = 0;
+    for (int d = 0; d < kDirectionCount; ++d) {
+        if (polygonSize == 0 || extremes[d].x != polygon[polygonSize - 1].x || extremes[d].y != polygon[polygonSize - 1].y) {
+            polygon[polygonSize++] = extremes[d];
+        }
+    }
+    while (polygonSize > 1 && polygon[polygonSize - 1].x == polygon[0].x && polygon[polygonSize - 1].y == polygon[0].y) {
+        --polygonSize;
+    }
+
+    if (polygonSize < 3) {
+        m_candidates.assign(points, points + count);
+    } else {
+        using namespace SIMD;
+        // Side of edge e is ex * (y - ay) - ey * (x - ax); evaluated unfused so the
+        // octagon vertices themselves land exactly on zero and are always kept
+        float edgeX[kDirectionCount], edgeY[kDirectionCount], originX[kDirectionCount], originY[kDirectionCount];
+        for (int e = 0; e < polygonSize; ++e) {
+            const Vec2& a = polygon[e];
+            const Vec2& b = polygon[(e + 1) % polygonSize];
+            edgeX[e] = b.x - a.x;
+            edgeY[e] = b.y - a.y;
+            originX[e] = a.x;
+            originY[e] = a.y;
+        }
+
+        const FloatV zero = Set1(0.0f);
+        float xs[kBlockSize], ys[kBlockSize];
+        for (size_t base = 0; base < count; base += kBlockSize) {
+            const size_t n = std::min(kBlockSize, count - base);
+            LoadBlock(points + base, n, xs, ys);
+
+            size_t i = 0;
+            for (; i + kWidth <= n; i += kWidth) {
+                const FloatV x = Load(xs + i);
+                const FloatV y = Load(ys + i);
+                MaskV inside = CmpGt(Set1(1.0f), zero);
+                for (int e = 0; e < polygonSize; ++e) {
+                    const FloatV side = Sub(Mul(Set1(edgeX[e]), Sub(y, Set1(originY[e]))),
+                                            Mul(Set1(edgeY[e]), Sub(x, Set1(originX[e]))));
+                    inside = MaskAnd(inside, CmpGt(side, zero));
+                }
+
+                uint32_t keep = ~MaskBits(inside) & ((kWidth == 32) ? 0xFFFFFFFFu : ((1u << kWidth) - 1u));
+                while (keep) {
+                    const int lane = LowestBit(keep);
+                    keep &= keep - 1;
+                    m_candidates.push_back(points[base + i + lane]);
+                }
+            }
+
+            for (; i < n; ++i) {
+                bool inside = true;
+                for (int e = 0; e < polygonSize && inside; ++e) {
+                    inside = edgeX[e] * (ys[i] - originY[e]) - edgeY[e] * (xs[i] - originX[e]) > 0.0f;
+                }
+                if (!inside) {
+                    m_candidates.push_back(points[base + i]);
+                }
+            }
+        }
+    }
+
+    // Andrew's monotone chain
+    std::sort(m_candidates.begin(), m_candidates.end(), [](const Vec2& a, const Vec2& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+
+    const size_t n = m_candidates.size();
+    if (n < 3) {
+        m_hull.assign(m_candidates.begin(), m_candidates.end());
+        if (n == 2 && m_hull[0].x == m_hull[1].x && m_hull[0].y == m_hull[1].y) {
+            m_hull.pop_back();
+        }
+        return m_hull;
+    }
+
+    m_hull.resize(2 * n);
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        while (k >= 2 && Cross(m_hull[k - 2], m_hull[k - 1], m_candidates[i]) <= 0.0f) {
+            --k;
+        }
+        m_hull[k++] = m_candidates[i];
+    }
+    for (size_t i = n - 1, lower = k + 1; i-- > 0;) {
+        while (k >= lower && Cross(m_hull[k - 2], m_hull[k - 1], m_candidates[i]) <= 0.0f) {
+            --k;
+        }
+        m_hull[k++] = m_candidates[i];
+    }
+    m_hull.resize(k > 1 ? k - 1 : k);
+    return m_hull;
+}
+
+OrientedRect BoundingVolumeBuilder::MinimumAreaRect(const Vec2* points, size_t count) {
+    const std::vector<Vec2>& hull = ConvexHull(points, count);
+    return MinimumAreaRectOfHull(hull.data(), hull.size());
+}
+
+OrientedRect BoundingVolumeBuilder::MinimumAreaRectOfHull(const Vec2* hull, size_t count) {
+    OrientedRect best;
+    if (count == 0) {
+        return best;
+    }
+    if (count == 1) {
+        best.center = hull[0];
+        return best;
+    }
+
+    auto dot = [](const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; };
+    auto next = [count](size_t i) { return (i + 1 == count) ? 0 : i + 1; };
+
+    float bestArea = FLT_MAX;
+    size_t right = 0, top = 0, left = 0;
+
+    // Rotating calipers: the three support pointers only ever move forward
+    for (size_t i = 0; i < count; ++i) {
+        const Vec2 edge = hull[next(i)] - hull[i];
+        const float length = edge.Length();
+        if (length < 1e-12f) {
+            continue;
+        }
+        const Vec2 u = edge / length;
+        const Vec2 n(-u.y, u.x);  // inward normal of a counter-clockwise hull
+
+        if (i == 0) {
+            right = next(i);
+        }
+        for (size_t guard = 0; guard < count && dot(hull[next(right)], u) > dot(hull[right], u); ++guard) {
+            right = next(right);
+        }
+        if (i == 0) {
+            top = right;
+        }
+        for (size_t guard = 0; guard < count && dot(hull[next(top)], n) > dot(hull[top], n); ++guard) {
+            top = next(top);
+        }
+        if (i == 0) {
+            left = top;
+        }
+        for (size_t guard = 0; guard < count && dot(hull[next(left)], u) < dot(hull[left], u); ++guard) {
+            left = next(left);
+        }
+
+        const float minU = dot(hull[left], u);
+        const float maxU = dot(hull[right], u);
+        const float minN = dot(hull[i], n);
+        const float maxN = dot(hull[top], n);
+        const float area = (maxU - minU) * (maxN - minN);
+
+        if (area < bestArea) {
+            bestArea = area;
+            best.axis = u;
+            best.halfExtents = Vec2((maxU - minU) * 0.5f, (maxN - minN) * 0.5f);
+            best.center = u * ((minU + maxU) * 0.5f) + n * ((minN + maxN) * 0.5f);
+        }
+    }
+    return best;
+}
+
+// ---------------------------------------------------------------------------
+// Spheres and boxes
+// ---------------------------------------------------------------------------
+
+BoundingSphere BoundingVolumeBuilder::RitterSphere(const Vec3* points, size_t count) {
+    if (count == 0) {
+        return BoundingSphere();
+    }
+
+    // Approximate diameter: farthest from an arbitrary point, then farthest from that
+    const size_t a = FindFarthest(points, count, points[0]);
+    const size_t b = FindFarthest(points, count, points[a]);
+
+    Vec3 center = (points[a] + points[b]) * 0.5f;
+    float radius = points[a].Distance(points[b]) * 0.5f;
+
+    using namespace SIMD;
+    float xs[kBlockSize], ys[kBlockSize], zs[kBlockSize];
+    for (size_t base = 0; base < count; base += kBlockSize) {
+        const size_t n = std::min(kBlockSize, count - base);
+        LoadBlock(points + base, n, xs, ys, zs);
+
+        // Skip blocks entirely inside the current sphere
+        const FloatV cx = Set1(center.x), cy = Set1(center.y), cz = Set1(center.z);
+        FloatV farthest = Set1(0.0f);
+        size_t i = 0;
+        for (; i + kWidth <= n; i += kWidth) {
+            const FloatV dx = Sub(Load(xs + i), cx);
+            const FloatV dy = Sub(Load(ys + i), cy);
+            const FloatV dz = Sub(Load(zs + i), cz);
+            farthest = Max(farthest, MulAdd(dx, dx, MulAdd(dy, dy, Mul(dz, dz))));
+        }
+        float blockMax = ReduceMax(farthest);
+        for (; i < n; ++i) {
+            blockMax = std::max(blockMax, points[base + i].DistanceSquared(center));
+        }
+        if (blockMax <= radius * radius) {
+            continue;
+        }
+
+        for (size_t j = 0; j < n; ++j) {
+            const Vec3& p = points[base + j];
+            const float distanceSquared = p.DistanceSquared(center);
+            if (distanceSquared > radius * radius) {
+                const float distance = std::sqrt(distanceSquared);
+                const float newRadius = (radius + distance) * 0.5f;
+                center = center + (p - center) * ((newRadius - radius) / distance);
+                radius = newRadius;
+            }
+        }
+    }
+
+    return BoundingSphere(center, radius);
+}
+
+BoundingSphere BoundingVolumeBuilder::MinimumSphere(const Vec3* points, size_t count) {
+    if (count == 0) {
+        return BoundingSphere();
+    }
+
+    // Random order gives the iterative Welzl loops their expected linear time
+    m_shuffled.assign(points, points + count);
+    std::mt19937 rng(0x5EEDu);
+    std::shuffle(m_shuffled.begin(), m_shuffled.end(), rng);
+
+    const Vec3* p = m_shuffled.data();
+    DSphere sphere = SphereFrom1(ToD(p[0]));
+    for (size_t i = 1; i < count; ++i) {
+        const DVec pi = ToD(p[i]);
+        if (sphere.Contains(pi)) continue;
+        sphere = SphereFrom1(pi);
+        for (size_t j = 0; j < i; ++j) {
+            const DVec pj = ToD(p[j]);
+            if (sphere.Contains(pj)) continue;
+            sphere = SphereFrom2(pi, pj);
+            for (size_t k = 0; k < j; ++k) {
+                const DVec pk = ToD(p[k]);
+                if (sphere.Contains(pk)) continue;
+                sphere = SphereFrom3(pi, pj, pk);
+                for (size_t l = 0; l < k; ++l) {
+                    const DVec pl = ToD(p[l]);
+                    if (sphere.Contains(pl)) continue;
+                    sphere = SphereFrom4(pi, pj, pk, pl);
+                }
+            }
+        }
+    }
+
+    return BoundingSphere(Vec3(static_cast<float>(sphere.center.x),
+                               static_cast<float>(sphere.center.y),
+                               static_cast<float>(sphere.center.z)),
+                          static_cast<float>(std::sqrt(sphere.radiusSquared)));
+}
+
+OrientedBox BoundingVolumeBuilder::FitOBB(const Vec3* points, size_t count) {
+    OrientedBox box;
+    if (count == 0) {
+        return box;
+    }
+
+    // Mean and covariance in double to avoid cancellation on large clusters
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < count; ++i) {
+        mean[0] += points[i].x;
+        mean[1] += points[i].y;
+        mean[2] += points[i].z;
+    }
+    for (double& m : mean) {
+        m /= static_cast<double>(count);
+    }
+
+    double covariance[3][3] = {};
+    for (size_t i = 0; i < count; ++i) {
+        const double d[3] = { points[i].x - mean[0], points[i].y - mean[1], points[i].z - mean[2] };
+        for (int r = 0; r < 3; ++r) {
+            for (int c = r; c < 3; ++c) {
+                covariance[r][c] += d[r] * d[c];
+            }
+        }
+    }
+    covariance[1][0] = covariance[0][1];
+    covariance[2][0] = covariance[0][2];
+    covariance[2][1] = covariance[1][2];
+
+    double eigenvectors[3][3];
+    JacobiEigen(covariance, eigenvectors);
+
+    // Largest variance first, third axis rebuilt to keep the frame right-handed
+    int order[3] = { 0, 1, 2 };
+    std::sort(order, order + 3, [&](int a, int b) { return covariance[a][a] > covariance[b][b]; });
+    for (int k = 0; k < 2; ++k) {
+        box.axes[k] = Vec3(static_cast<float>(eigenvectors[0][order[k]]),
+                           static_cast<float>(eigenvectors[1][order[k]]),
+                           static_cast<float>(eigenvectors[2][order[k]])).Normalized();
+    }
+    box.axes[2] = box.axes[0].Cross(box.axes[1]).Normalized();
+    box.axes[1] = box.axes[2].Cross(box.axes[0]);
+
+    // Extents along each axis, measured relative to the mean
+    using namespace SIMD;
+    const Vec3 origin(static_cast<float>(mean[0]), static_cast<float>(mean[1]), static_cast<float>(mean[2]));
+    float minExtent[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float maxExtent[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    float xs[kBlockSize], ys[kBlockSize], zs[kBlockSize];
+    for (size_t base = 0; base < count; base += kBlockSize) {
+        const size_t n = std::min(kBlockSize, count - base);
+        LoadBlock(points + base, n, xs, ys, zs);
+
+        for (int k = 0; k < 3; ++k) {
+            const FloatV ax = Set1(box.axes[k].x), ay = Set1(box.axes[k].y), az = Set1(box.axes[k].z);
+            const FloatV ox = Set1(origin.x), oy = Set1(origin.y), oz = Set1(origin.z);
+            FloatV lo = Set1(FLT_MAX), hi = Set1(-FLT_MAX);
+
+            size_t i = 0;
+            for (; i + kWidth <= n; i += kWidth) {
+                const FloatV projection = MulAdd(Sub(Load(xs + i), ox), ax,
+                                          MulAdd(Sub(Load(ys + i), oy), ay,
+                                                 Mul(Sub(Load(zs + i), oz), az)));
+                lo = Min(lo, projection);
+                hi = Max(hi, projection);
+            }
+
+            minExtent[k] = std::min(minExtent[k], ReduceMin(lo));
+            maxExtent[k] = std::max(maxExtent[k], ReduceMax(hi));
+            for (; i < n; ++i) {
+                const float projection = (points[base + i] - origin).Dot(box.axes[k]);
+                minExtent[k] = std::min(minExtent[k], projection);
+                maxExtent[k] = std::max(maxExtent[k], projection);
+            }
+        }
+    }
+
+    box.center = origin;
+    for (int k = 0; k < 3; ++k) {
+        box.center = box.center + box.axes[k] * ((minExtent[k] + maxExtent[k]) * 0.5f);
+    }
+    box.halfExtents = Vec3((maxExtent[0] - minExtent[0]) * 0.5f,
+                           (maxExtent[1] - minExtent[1]) * 0.5f,
+                           (maxExtent[2] - minExtent[2]) * 0.5f);
+    return box;
+}
+
+} // namespace VectorMath
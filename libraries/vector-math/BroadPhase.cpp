@@ -0,0 +1,309 @@
+/**
+ * @file BroadPhase.cpp
+ * @brief Implementation of sweep-and-prune broad-phase collision detection
+ * @author Lukas Ernst
+ */
+
+#include "BroadPhase.hpp"
+#include "VectorSIMD.hpp"
+#include <algorithm>
+#include <cfloat>
+
+namespace VectorMath {
+
+SweepAndPrune::SweepAndPrune(Mode mode, int sortAxis)
+    : m_mode(mode), m_sortAxis(std::max(0, std::min(2, sortAxis))),
+      m_liveCount(0), m_membershipChanged(false) {}
+
+uint32_t SweepAndPrune::AddBox(const AABB& box) {
+    uint32_t handle;
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_boxes[handle] = box;
+        m_alive[handle] = 1;
+    } else {
+        handle = static_cast<uint32_t>(m_boxes.size());
+        m_boxes.push_back(box);
+        m_alive.push_back(1);
+    }
+
+    ++m_liveCount;
+    m_membershipChanged = true;
+    return handle;
+}
+
+void SweepAndPrune::RemoveBox(uint32_t handle) {
+    if (handle >= m_boxes.size() || !m_alive[handle]) {
+        return;
+    }
+
+    m_alive[handle] = 0;
+    m_freeHandles.push_back(handle);
+    --m_liveCount;
+    m_membershipChanged = true;
+}
+
+void SweepAndPrune::UpdateBox(uint32_t handle, const AABB& box) {
+    if (handle < m_boxes.size() && m_alive[handle]) {
+        m_boxes[handle] = box;
+    }
+}
+
+void SweepAndPrune::Clear() {
+    m_boxes.clear();
+    m_alive.clear();
+    m_freeHandles.clear();
+    m_order.clear();
+    for (int axis = 0; axis < 3; ++axis) {
+        m_endpoints[axis].clear();
+    }
+    m_pairCounts.clear();
+    m_liveCount = 0;
+    m_membershipChanged = false;
+}
+
+size_t SweepAndPrune::FindOverlaps(std::vector<OverlapPair>& pairs) {
+    pairs.clear();
+
+    if (m_mode == Mode::SingleAxis) {
+        UpdateSingleAxisOrder();
+        BuildSortedStreams();
+        SweepSingleAxis(pairs);
+        return pairs.size();
+    }
+
+    if (m_membershipChanged) {
+        RebuildEndpoints();
+        m_membershipChanged = false;
+    } else {
+        for (int axis = 0; axis < 3; ++axis) {
+            SortEndpointsIncremental(axis);
+        }
+    }
+
+    for (const auto& entry : m_pairCounts) {
+        if (entry.second == 3) {
+            pairs.emplace_back(static_cast<uint32_t>(entry.first >> 32), static_cast<uint32_t>(entry.first));
+        }
+    }
+    return pairs.size();
+}
+
+float SweepAndPrune::Bound(const AABB& box, int axis, bool isMax) {
+    const Vec3& v = isMax ? box.maxBounds : box.minBounds;
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+uint64_t SweepAndPrune::PairKey(uint32_t a, uint32_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// ---------------------------------------------------------------------------
+// Single-axis sweep
+// ---------------------------------------------------------------------------
+
+void SweepAndPrune::UpdateSingleAxisOrder() {
+    if (m_membershipChanged) {
+        m_order.clear();
+        for (uint32_t handle = 0; handle < m_boxes.size(); ++handle) {
+            if (m_alive[handle]) {
+                m_order.push_back(handle);
+            }
+        }
+        std::sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) {
+            return Bound(m_boxes[a], m_sortAxis, false) < Bound(m_boxes[b], m_sortAxis, false);
+        });
+        m_membershipChanged = false;
+        return;
+    }
+
+    // Coherent motion leaves the order almost sorted, so insertion sort is ~O(n)
+    std::vector<float>& keys = m_sortedMin[m_sortAxis];
+    const size_t count = m_order.size();
+    keys.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = Bound(m_boxes[m_order[i]], m_sortAxis, false);
+    }
+
+    for (size_t i = 1; i < count; ++i) {
+        const float key = keys[i];
+        const uint32_t handle = m_order[i];
+        size_t j = i;
+        while (j > 0 && keys[j - 1] > key) {
+            keys[j] = keys[j - 1];
+            m_order[j] = m_order[j - 1];
+            --j;
+        }
+        keys[j] = key;
+        m_order[j] = handle;
+    }
+}
+
+void SweepAndPrune::BuildSortedStreams() {
+    // Copy bounds into sorted order so the sweep reads contiguous lanes;
+    // one vector of padding keeps the tail loads in bounds
+    const size_t count = m_order.size();
+    const size_t padded = count + SIMD::kWidth;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        m_sortedMin[axis].resize(padded);
+        m_sortedMax[axis].resize(padded);
+        float* minStream = m_sortedMin[axis].data();
+        float* maxStream = m_sortedMax[axis].data();
+
+        for (size_t i = 0; i < count; ++i) {
+            const AABB& box = m_boxes[m_order[i]];
+            minStream[i] = Bound(box, axis, false);
+            maxStream[i] = Bound(box, axis, true);
+        }
+        for (size_t i = count; i < padded; ++i) {
+            minStream[i] = FLT_MAX;
+            maxStream[i] = -FLT_MAX;
+        }
+    }
+}
+
+void SweepAndPrune::SweepSingleAxis(std::vector<OverlapPair>& pairs) const {
+    using namespace SIMD;
+
+    const int a = m_sortAxis;
+    const int b = (a + 1) % 3;
+    const int c = (a + 2) % 3;
+    const float* minA = m_sortedMin[a].data();
+    const float* maxA = m_sortedMax[a].data();
+    const float* minB = m_sortedMin[b].data();
+    const float* maxB = m_sortedMax[b].data();
+    const float* minC = m_sortedMin[c].data();
+    const float* maxC = m_sortedMax[c].data();
+    const size_t count = m_order.size();
+
+    for (size_t i = 0; i < count; ++i) {
+        const FloatV boxMaxA = Set1(maxA[i]);
+        const FloatV boxMinB = Set1(minB[i]);
+        const FloatV boxMaxB = Set1(maxB[i]);
+        const FloatV boxMinC = Set1(minC[i]);
+        const FloatV boxMaxC = Set1(maxC[i]);
+
+        // Candidates are sorted by minA, so the run ends at the first min beyond our max
+        for (size_t j = i + 1; j < count; j += kWidth) {
+            const MaskV onAxis = CmpLe(Load(minA + j), boxMaxA);
+            uint32_t axisBits = MaskBits(onAxis);
+            if (axisBits == 0) {
+                break;
+            }
+
+            MaskV overlap = MaskAnd(onAxis, CmpLe(Load(minB + j), boxMaxB));
+            overlap = MaskAnd(overlap, CmpGe(Load(maxB + j), boxMinB));
+            overlap = MaskAnd(overlap, CmpLe(Load(minC + j), boxMaxC));
+            overlap = MaskAnd(overlap, CmpGe(Load(maxC + j), boxMinC));
+
+            uint32_t bits = MaskBits(overlap);
+            const size_t remaining = count - j;
+            if (remaining < static_cast<size_t>(kWidth)) {
+                bits &= (1u << remaining) - 1u;
+            }
+
+            while (bits) {
+                const int lane = LowestBit(bits);
+                bits &= bits - 1;
+                pairs.emplace_back(m_order[i], m_order[j + lane]);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Three-axis incremental sweep
+// ---------------------------------------------------------------------------
+
+namespace {
+    inline bool EndpointLess(float valueA, bool isMaxA, float valueB, bool isMaxB) {
+        // Min before max on ties so touching intervals count as overlapping
+        return valueA < valueB || (valueA == valueB && !isMaxA && isMaxB);
+    }
+}
+
+void SweepAndPrune::IncrementPair(uint32_t a, uint32_t b) {
+    ++m_pairCounts[PairKey(a, b)];
+}
+
+void SweepAndPrune::DecrementPair(uint32_t a, uint32_t b) {
+    auto it = m_pairCounts.find(PairKey(a, b));
+    if (it != m_pairCounts.end() && --it->second == 0) {
+        m_pairCounts.erase(it);
+    }
+}
+
+void SweepAndPrune::RebuildEndpoints() {
+    m_pairCounts.clear();
+
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> activeIndex(m_boxes.size(), 0);
+
+    for (int axis = 0; axis < 3; ++axis) {
+        std::vector<Endpoint>& endpoints = m_endpoints[axis];
+        endpoints.clear();
+        endpoints.reserve(m_liveCount * 2);
+
+        for (uint32_t handle = 0; handle < m_boxes.size(); ++handle) {
+            if (m_alive[handle]) {
+                endpoints.push_back({ Bound(m_boxes[handle], axis, false), handle });
+                endpoints.push_back({ Bound(m_boxes[handle], axis, true), handle | 0x80000000u });
+            }
+        }
+
+        std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& x, const Endpoint& y) {
+            return EndpointLess(x.value, x.IsMax(), y.value, y.IsMax());
+        });
+
+        // Every box whose min lies inside an open interval overlaps it on this axis
+        active.clear();
+        for (const Endpoint& endpoint : endpoints) {
+            const uint32_t box = endpoint.Box();
+            if (!endpoint.IsMax()) {
+                for (uint32_t other : active) {
+                    IncrementPair(other, box);
+                }
+                activeIndex[box] = static_cast<uint32_t>(active.size());
+                active.push_back(box);
+            } else {
+                const uint32_t index = activeIndex[box];
+                active[index] = active.back();
+                activeIndex[active[index]] = index;
+                active.pop_back();
+            }
+        }
+    }
+}
+
+void SweepAndPrune::SortEndpointsIncremental(int axis) {
+    std::vector<Endpoint>& endpoints = m_endpoints[axis];
+    for (Endpoint& endpoint : endpoints) {
+        endpoint.value = Bound(m_boxes[endpoint.Box()], axis, endpoint.IsMax());
+    }
+
+    // Each swap of a min and a max endpoint of different boxes starts or ends an overlap
+    for (size_t i = 1; i < endpoints.size(); ++i) {
+        const Endpoint moving = endpoints[i];
+        const bool movingIsMax = moving.IsMax();
+        size_t j = i;
+
+        while (j > 0 && EndpointLess(moving.value, movingIsMax, endpoints[j - 1].value, endpoints[j - 1].IsMax())) {
+            const Endpoint& passed = endpoints[j - 1];
+            if (passed.Box() != moving.Box()) {
+                if (!movingIsMax && passed.IsMax()) {
+                    IncrementPair(moving.Box(), passed.Box());
+                } else if (movingIsMax && !passed.IsMax()) {
+                    DecrementPair(moving.Box(), passed.Box());
+                }
+            }
+            endpoints[j] = passed;
+            --j;
+        }
+        endpoints[j] = moving;
+    }
+}
+
+} // namespace VectorMath
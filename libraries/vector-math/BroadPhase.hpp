@@ -0,0 +1,138 @@
+/**
+ * @file BroadPhase.hpp
+ * @brief Sweep-and-prune broad-phase overlap detection for AABBs
+ * @author Lukas Ernst
+ *
+ * Finds all overlapping pairs among many moving axis-aligned boxes without the
+ * O(N^2) pairwise loop. Boxes are kept sorted between frames and re-sorted with
+ * insertion sort, which is close to linear when motion is coherent.
+ *
+ * Two modes are available:
+ * - SingleAxis: boxes sorted by their minimum on one axis, then swept with a
+ *   SIMD test of the remaining axes against runs of candidates.
+ * - ThreeAxis: classic incremental SAP with sorted endpoint lists on all three
+ *   axes; endpoint swaps update per-pair overlap counts, so steady-state cost
+ *   depends on how many endpoints actually cross rather than on cluster density.
+ */
+
+#pragma once
+
+#include "Vector.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace VectorMath {
+
+/**
+ * @brief Pair of overlapping box handles, always first < second
+ */
+struct OverlapPair {
+    uint32_t first;
+    uint32_t second;
+
+    OverlapPair() : first(0), second(0) {}
+    OverlapPair(uint32_t a, uint32_t b) : first(a < b ? a : b), second(a < b ? b : a) {}
+
+    bool operator==(const OverlapPair& other) const { return first == other.first && second == other.second; }
+    bool operator<(const OverlapPair& other) const {
+        return first < other.first || (first == other.first && second < other.second);
+    }
+};
+
+/**
+ * @brief Incremental sweep-and-prune over axis-aligned boxes
+ */
+class SweepAndPrune {
+public:
+    enum class Mode {
+        SingleAxis,
+        ThreeAxis
+    };
+
+    /**
+     * @param mode Sorting strategy
+     * @param sortAxis Axis used in SingleAxis mode (0 = x, 1 = y, 2 = z)
+     */
+    explicit SweepAndPrune(Mode mode = Mode::SingleAxis, int sortAxis = 0);
+
+    /**
+     * @brief Adds a box and returns its handle (handles of removed boxes are reused)
+     */
+    uint32_t AddBox(const AABB& box);
+
+    /**
+     * @brief Removes a box, its handle becomes invalid
+     */
+    void RemoveBox(uint32_t handle);
+
+    /**
+     * @brief Moves a box, the sort is repaired on the next FindOverlaps
+     */
+    void UpdateBox(uint32_t handle, const AABB& box);
+
+    /**
+     * @brief Gets the current bounds of a box
+     */
+    const AABB& GetBox(uint32_t handle) const { return m_boxes[handle]; }
+
+    /**
+     * @brief Number of live boxes
+     */
+    size_t GetBoxCount() const { return m_liveCount; }
+
+    /**
+     * @brief Computes all overlapping pairs
+     * @param pairs Output buffer, cleared and refilled (capacity is reused between frames)
+     * @return Number of pairs written
+     */
+    size_t FindOverlaps(std::vector<OverlapPair>& pairs);
+
+    /**
+     * @brief Removes all boxes
+     */
+    void Clear();
+
+    Mode GetMode() const { return m_mode; }
+
+private:
+    struct Endpoint {
+        float value;
+        uint32_t data;  // box handle in the low 31 bits, top bit set for max endpoints
+
+        bool IsMax() const { return (data & 0x80000000u) != 0; }
+        uint32_t Box() const { return data & 0x7FFFFFFFu; }
+    };
+
+    void UpdateSingleAxisOrder();
+    void BuildSortedStreams();
+    void SweepSingleAxis(std::vector<OverlapPair>& pairs) const;
+
+    void RebuildEndpoints();
+    void SortEndpointsIncremental(int axis);
+    void IncrementPair(uint32_t a, uint32_t b);
+    void DecrementPair(uint32_t a, uint32_t b);
+
+    static float Bound(const AABB& box, int axis, bool isMax);
+    static uint64_t PairKey(uint32_t a, uint32_t b);
+
+    Mode m_mode;
+    int m_sortAxis;
+
+    std::vector<AABB> m_boxes;
+    std::vector<uint8_t> m_alive;
+    std::vector<uint32_t> m_freeHandles;
+    size_t m_liveCount;
+    bool m_membershipChanged;
+
+    // SingleAxis: handles sorted by min on m_sortAxis plus sorted SoA copies for the sweep
+    std::vector<uint32_t> m_order;
+    std::vector<float> m_sortedMin[3];
+    std::vector<float> m_sortedMax[3];
+
+    // ThreeAxis: endpoint lists and per-pair count of overlapping axes
+    std::vector<Endpoint> m_endpoints[3];
+    std::unordered_map<uint64_t, uint8_t> m_pairCounts;
+};
+
+} // namespace VectorMath
@@ -0,0 +1,183 @@
+/**
+ * @file BulkTransform.cpp
+ * @brief Implementation of parallel SIMD point transforms
+ * @author Lukas Ernst
+ */
+
+#include "BulkTransform.hpp"
+#include "VectorSIMD.hpp"
+#include <algorithm>
+
+namespace VectorMath {
+
+namespace BulkTransform {
+
+namespace {
+
+static_assert(sizeof(Vec3) == 3 * sizeof(float), "Vec3 must be tightly packed");
+
+// AoS tiles are deinterleaved into stack buffers of this many points
+constexpr size_t kBlockSize = 256;
+
+/**
+ * @brief 3x3 rotation kernel over SoA streams
+ */
+void RotateKernel(const float r[9], ConstVec3SoA in, Vec3SoA out, size_t count) {
+    using namespace SIMD;
+    const FloatV r00 = Set1(r[0]), r01 = Set1(r[1]), r02 = Set1(r[2]);
+    const FloatV r10 = Set1(r[3]), r11 = Set1(r[4]), r12 = Set1(r[5]);
+    const FloatV r20 = Set1(r[6]), r21 = Set1(r[7]), r22 = Set1(r[8]);
+
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        const FloatV x = Load(in.x + i);
+        const FloatV y = Load(in.y + i);
+        const FloatV z = Load(in.z + i);
+        Store(out.x + i, MulAdd(r02, z, MulAdd(r01, y, Mul(r00, x))));
+        Store(out.y + i, MulAdd(r12, z, MulAdd(r11, y, Mul(r10, x))));
+        Store(out.z + i, MulAdd(r22, z, MulAdd(r21, y, Mul(r20, x))));
+    }
+
+    for (; i < count; ++i) {
+        const float x = in.x[i], y = in.y[i], z = in.z[i];
+        out.x[i] = r[0] * x + r[1] * y + r[2] * z;
+        out.y[i] = r[3] * x + r[4] * y + r[5] * z;
+        out.z[i] = r[6] * x + r[7] * y + r[8] * z;
+    }
+}
+
+/**
+ * @brief 4x4 projective kernel over SoA streams (Matrix4x4::TransformPoint semantics)
+ */
+void ProjectKernel(const float (&m)[4][4], ConstVec3SoA in, Vec3SoA out, size_t count) {
+    using namespace SIMD;
+    FloatV row[4][4];
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            row[r][c] = Set1(m[r][c]);
+        }
+    }
+    const FloatV zero = Set1(0.0f);
+    const FloatV one = Set1(1.0f);
+
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        const FloatV x = Load(in.x + i);
+        const FloatV y = Load(in.y + i);
+        const FloatV z = Load(in.z + i);
+        const FloatV tx = MulAdd(row[0][0], x, MulAdd(row[0][1], y, MulAdd(row[0][2], z, row[0][3])));
+        const FloatV ty = MulAdd(row[1][0], x, MulAdd(row[1][1], y, MulAdd(row[1][2], z, row[1][3])));
+        const FloatV tz = MulAdd(row[2][0], x, MulAdd(row[2][1], y, MulAdd(row[2][2], z, row[2][3])));
+        const FloatV w = MulAdd(row[3][0], x, MulAdd(row[3][1], y, MulAdd(row[3][2], z, row[3][3])));
+
+        // w == 0 leaves the point undivided, matching the scalar path
+        const MaskV nonZero = CmpNeq(w, zero);
+        const FloatV invW = Select(nonZero, Div(one, Select(nonZero, w, one)), one);
+        Store(out.x + i, Mul(tx, invW));
+        Store(out.y + i, Mul(ty, invW));
+        Store(out.z + i, Mul(tz, invW));
+    }
+
+    for (; i < count; ++i) {
+        const float x = in.x[i], y = in.y[i], z = in.z[i];
+        float tx = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+        float ty = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+        float tz = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+        const float w = m[3][0] * x + m[3][1] * y + m[3][2] * z + m[3][3];
+        if (w != 0.0f) {
+            tx /= w;
+            ty /= w;
+            tz /= w;
+        }
+        out.x[i] = tx;
+        out.y[i] = ty;
+        out.z[i] = tz;
+    }
+}
+
+/**
+ * @brief Runs an SoA kernel over an AoS range through small deinterleave buffers
+ */
+template<typename Kernel>
+void RunAoS(const Vec3* input, Vec3* output, size_t count, const Kernel& kernel) {
+    float bx[kBlockSize], by[kBlockSize], bz[kBlockSize];
+
+    for (size_t base = 0; base < count; base += kBlockSize) {
+        const size_t n = std::min(kBlockSize, count - base);
+        for (size_t i = 0; i < n; ++i) {
+            bx[i] = input[base + i].x;
+            by[i] = input[base + i].y;
+            bz[i] = input[base + i].z;
+        }
+
+        kernel(ConstVec3SoA(bx, by, bz), Vec3SoA(bx, by, bz), n);
+
+        for (size_t i = 0; i < n; ++i) {
+            output[base + i].x = bx[i];
+            output[base + i].y = by[i];
+            output[base + i].z = bz[i];
+        }
+    }
+}
+
+void FlattenMatrix(const std::array<std::array<float, 3>, 3>& matrix, float r[9]) {
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            r[i * 3 + j] = matrix[i][j];
+        }
+    }
+}
+
+} // namespace
+
+void ApplyRotationMatrix(const std::array<std::array<float, 3>, 3>& matrix,
+                         const Vec3* input, Vec3* output, size_t count,
+                         TaskScheduler& scheduler) {
+    float r[9];
+    FlattenMatrix(matrix, r);
+
+    scheduler.ParallelFor(count, kTileSize, [&](size_t begin, size_t end) {
+        RunAoS(input + begin, output + begin, end - begin, [&](ConstVec3SoA in, Vec3SoA out, size_t n) {
+            RotateKernel(r, in, out, n);
+        });
+    });
+}
+
+void ApplyRotationMatrix(const std::array<std::array<float, 3>, 3>& matrix,
+                         ConstVec3SoA input, Vec3SoA output, size_t count,
+                         TaskScheduler& scheduler) {
+    float r[9];
+    FlattenMatrix(matrix, r);
+
+    scheduler.ParallelFor(count, kTileSize, [&](size_t begin, size_t end) {
+        RotateKernel(r,
+                     ConstVec3SoA(input.x + begin, input.y + begin, input.z + begin),
+                     Vec3SoA(output.x + begin, output.y + begin, output.z + begin),
+                     end - begin);
+    });
+}
+
+void TransformPoints(const float (&matrix)[4][4],
+                     const Vec3* input, Vec3* output, size_t count,
+                     TaskScheduler& scheduler) {
+    scheduler.ParallelFor(count, kTileSize, [&](size_t begin, size_t end) {
+        RunAoS(input + begin, output + begin, end - begin, [&](ConstVec3SoA in, Vec3SoA out, size_t n) {
+            ProjectKernel(matrix, in, out, n);
+        });
+    });
+}
+
+void TransformPoints(const float (&matrix)[4][4],
+                     ConstVec3SoA input, Vec3SoA output, size_t count,
+                     TaskScheduler& scheduler) {
+    scheduler.ParallelFor(count, kTileSize, [&](size_t begin, size_t end) {
+        ProjectKernel(matrix,
+                      ConstVec3SoA(input.x + begin, input.y + begin, input.z + begin),
+                      Vec3SoA(output.x + begin, output.y + begin, output.z + begin),
+                      end - begin);
+    });
+}
+
+} // namespace BulkTransform
+
+} // namespace VectorMath
@@ -0,0 +1,174 @@
+/**
+ * @file CpuFeatures.cpp
+ * @brief Implementation of CPU feature detection
+ * @author Lukas Ernst
+ */
+
+#include "CpuFeatures.hpp"
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define VECTORMATH_CPU_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace VectorMath {
+
+namespace {
+
+// XCR0 state components the OS must save: XMM and YMM for AVX, plus opmask and ZMM for AVX-512
+constexpr uint64_t kXcr0Avx = 0x06;
+constexpr uint64_t kXcr0Avx512 = 0xE6;
+
+constexpr const char* kEnvironmentOverride = "VECTORMATH_SIMD_LEVEL";
+
+#if defined(VECTORMATH_CPU_X86)
+
+struct CpuidRegisters {
+    uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+};
+
+CpuidRegisters Cpuid(uint32_t leaf, uint32_t subleaf) {
+    CpuidRegisters r;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    r.eax = static_cast<uint32_t>(info[0]);
+    r.ebx = static_cast<uint32_t>(info[1]);
+    r.ecx = static_cast<uint32_t>(info[2]);
+    r.edx = static_cast<uint32_t>(info[3]);
+#else
+    __cpuid_count(leaf, subleaf, r.eax, r.ebx, r.ecx, r.edx);
+#endif
+    return r;
+}
+
+// Only valid when cpuid reports OSXSAVE
+uint64_t ReadXcr0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+bool Bit(uint32_t value, int bit) {
+    return ((value >> bit) & 1u) != 0;
+}
+
+#endif
+
+SimdLevel ReadLevelOverride(SimdLevel detected) {
+    const char* value = std::getenv(kEnvironmentOverride);
+    SimdLevel requested;
+    if (!value || !ParseSimdLevel(value, requested)) {
+        return detected;
+    }
+    return static_cast<int>(requested) < static_cast<int>(detected) ? requested : detected;
+}
+
+} // namespace
+
+CpuFeatures DetectCpuFeatures() {
+    CpuFeatures features;
+#if defined(VECTORMATH_CPU_X86)
+    const uint32_t maxLeaf = Cpuid(0, 0).eax;
+    if (maxLeaf < 1) {
+        return features;
+    }
+
+    const CpuidRegisters leaf1 = Cpuid(1, 0);
+    features.sse2 = Bit(leaf1.edx, 26);
+    features.sse3 = Bit(leaf1.ecx, 0);
+    features.pclmul = Bit(leaf1.ecx, 1);
+    features.ssse3 = Bit(leaf1.ecx, 9);
+    features.sse41 = Bit(leaf1.ecx, 19);
+    features.sse42 = Bit(leaf1.ecx, 20);
+    features.popcnt = Bit(leaf1.ecx, 23);
+    features.aes = Bit(leaf1.ecx, 25);
+
+    // AVX state has to be enabled by the OS, not just present in the CPU
+    const bool osxsave = Bit(leaf1.ecx, 27);
+    const uint64_t xcr0 = osxsave ? ReadXcr0() : 0;
+    const bool osAvx = (xcr0 & kXcr0Avx) == kXcr0Avx;
+    const bool osAvx512 = (xcr0 & kXcr0Avx512) == kXcr0Avx512;
+    features.avx = osAvx && Bit(leaf1.ecx, 28);
+    features.fma = osAvx && Bit(leaf1.ecx, 12);
+
+    if (maxLeaf >= 7) {
+        const CpuidRegisters leaf7 = Cpuid(7, 0);
+        features.bmi1 = Bit(leaf7.ebx, 3);
+        features.avx2 = osAvx && Bit(leaf7.ebx, 5);
+        features.bmi2 = Bit(leaf7.ebx, 8);
+        features.avx512f = osAvx512 && Bit(leaf7.ebx, 16);
+        features.avx512dq = osAvx512 && Bit(leaf7.ebx, 17);
+        features.sha = Bit(leaf7.ebx, 29);
+        features.avx512bw = osAvx512 && Bit(leaf7.ebx, 30);
+        features.avx512vl = osAvx512 && Bit(leaf7.ebx, 31);
+    }
+#endif
+    return features;
+}
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+SimdLevel GetDetectedSimdLevel() {
+    const CpuFeatures& f = GetCpuFeatures();
+    if (f.avx512f && f.avx512dq && f.avx2 && f.fma) {
+        return SimdLevel::AVX512;
+    }
+    if (f.avx2 && f.fma) {
+        return SimdLevel::AVX2;
+    }
+    if (f.sse2) {
+        return SimdLevel::SSE2;
+    }
+    return SimdLevel::Scalar;
+}
+
+SimdLevel GetSimdLevel() {
+    static const SimdLevel level = ReadLevelOverride(GetDetectedSimdLevel());
+    return level;
+}
+
+const char* GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SSE2: return "SSE2";
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::AVX512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
+
+bool ParseSimdLevel(const char* name, SimdLevel& level) {
+    static const char* const kNames[kSimdLevelCount] = { "scalar", "sse2", "avx2", "avx512" };
+    char lower[16] = {};
+    const size_t length = std::strlen(name);
+    if (length >= sizeof(lower)) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(name[i])));
+    }
+    for (size_t i = 0; i < kSimdLevelCount; ++i) {
+        if (std::strcmp(lower, kNames[i]) == 0) {
+            level = static_cast<SimdLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace VectorMath
@@ -0,0 +1,113 @@
+/**
+ * @file CpuFeatures.hpp
+ * @brief Runtime CPU feature detection and SIMD level selection
+ * @author Lukas Ernst
+ *
+ * Reads the instruction set extensions of the running CPU with cpuid and
+ * checks with xgetbv that the operating system saves the wider registers, so
+ * AVX and AVX-512 are only reported when they can actually be used. The result
+ * is detected once and cached for the lifetime of the process.
+ *
+ * Kernels that are compiled for several instruction sets register one function
+ * per SimdLevel and pick theirs with SelectForLevel(GetSimdLevel()), once, on
+ * first use. Setting the environment variable VECTORMATH_SIMD_LEVEL to scalar,
+ * sse2, avx2 or avx512 caps the selected level, which lets tests run every code
+ * path on one machine. A level above what the CPU supports is never selected.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace VectorMath {
+
+/**
+ * @brief Instruction set levels that SIMD kernels are built for, in ascending order
+ */
+enum class SimdLevel : int {
+    Scalar = 0,
+    SSE2,
+    AVX2,       // AVX2 with FMA
+    AVX512      // AVX-512 F and DQ
+};
+
+constexpr size_t kSimdLevelCount = 4;
+
+/**
+ * @brief Extensions reported by the CPU and enabled by the operating system
+ */
+struct CpuFeatures {
+    bool sse2 = false;
+    bool sse3 = false;
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool sse42 = false;
+    bool popcnt = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool bmi1 = false;
+    bool bmi2 = false;
+    bool avx512f = false;
+    bool avx512dq = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+    bool aes = false;
+    bool pclmul = false;
+    bool sha = false;
+};
+
+/**
+ * @brief Queries the CPU; every call runs cpuid again
+ */
+CpuFeatures DetectCpuFeatures();
+
+/**
+ * @brief Features of the running CPU, detected on first call
+ */
+const CpuFeatures& GetCpuFeatures();
+
+/**
+ * @brief Highest level the CPU and operating system support
+ */
+SimdLevel GetDetectedSimdLevel();
+
+/**
+ * @brief Level kernels should use: the detected level, capped by VECTORMATH_SIMD_LEVEL
+ *
+ * Read once; changing the environment variable afterwards has no effect.
+ */
+SimdLevel GetSimdLevel();
+
+/**
+ * @brief "Scalar", "SSE2", "AVX2" or "AVX-512", matching SIMD::kName
+ */
+const char* GetSimdLevelName(SimdLevel level);
+
+/**
+ * @brief Parses scalar, sse2, avx2 or avx512 (any case)
+ * @return false if name is not a level
+ */
+bool ParseSimdLevel(const char* name, SimdLevel& level);
+
+/**
+ * @brief Picks the variant for the highest level at or below level that is available
+ * @param variants One entry per SimdLevel, null where a kernel was not built for that level
+ * @param selected Receives the level of the returned variant; may be null
+ * @return Null (value-initialized) only if no variant at or below level exists
+ */
+template <typename Function>
+Function SelectForLevel(const Function (&variants)[kSimdLevelCount], SimdLevel level,
+                        SimdLevel* selected = nullptr) {
+    for (int i = static_cast<int>(level); i >= 0; --i) {
+        if (variants[i]) {
+            if (selected) {
+                *selected = static_cast<SimdLevel>(i);
+            }
+            return variants[i];
+        }
+    }
+    return Function();
+}
+
+} // namespace VectorMath
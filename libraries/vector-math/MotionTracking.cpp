@@ -0,0 +1,354 @@
+/**
+ * @file MotionTracking.cpp
+ * @brief Implementation of the batched motion tracker
+ * @author Lukas Ernst
+ */
+
+#include "MotionTracking.hpp"
+#include "VectorSIMD.hpp"
+#include <algorithm>
+
+namespace VectorMath {
+
+namespace {
+    // Samples closer together than this are treated as duplicates
+    constexpr float kMinDeltaTime = 1e-5f;
+
+    size_t RoundUpPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+MotionTracker::MotionTracker(size_t trackCount, Model model, size_t historyLength)
+    : m_model(model), m_alpha(0.6f), m_beta(0.25f), m_maxExtrapolation(0.25f),
+      m_trackCount(0), m_paddedCount(0),
+      m_historyLength(RoundUpPowerOfTwo(std::max<size_t>(4, historyLength))),
+      m_epoch(0.0), m_hasEpoch(false) {
+    Resize(trackCount);
+}
+
+void MotionTracker::Resize(size_t trackCount) {
+    const size_t width = static_cast<size_t>(SIMD::kWidth);
+    const size_t kept = std::min(trackCount, m_trackCount);
+
+    m_trackCount = trackCount;
+    m_paddedCount = (trackCount + width - 1) / width * width;
+
+    m_lastTime.resize(m_paddedCount);
+    m_lastDt.resize(m_paddedCount);
+    for (int axis = 0; axis < 3; ++axis) {
+        m_position[axis].resize(m_paddedCount);
+        m_velocity[axis].resize(m_paddedCount);
+        m_acceleration[axis].resize(m_paddedCount);
+        m_history[axis].resize(m_paddedCount * m_historyLength);
+    }
+    m_sampleCount.resize(m_paddedCount);
+    m_historyTime.resize(m_paddedCount * m_historyLength);
+    m_historyHead.resize(m_paddedCount);
+
+    // Slots past the old size may hold state from an earlier, larger size
+    for (size_t track = kept; track < m_paddedCount; ++track) {
+        ResetTrack(track);
+    }
+}
+
+void MotionTracker::ResetTrack(size_t track) {
+    m_lastTime[track] = 0.0f;
+    m_lastDt[track] = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        m_position[axis][track] = 0.0f;
+        m_velocity[axis][track] = 0.0f;
+        m_acceleration[axis][track] = 0.0f;
+    }
+    m_sampleCount[track] = 0;
+    m_historyHead[track] = 0;
+}
+
+float MotionTracker::ToLocalTime(double timestamp) {
+    if (!m_hasEpoch) {
+        m_epoch = timestamp;
+        m_hasEpoch = true;
+    }
+    return static_cast<float>(timestamp - m_epoch);
+}
+
+float MotionTracker::ToLocalTimeConst(double timestamp) const {
+    return m_hasEpoch ? static_cast<float>(timestamp - m_epoch) : 0.0f;
+}
+
+// ---------------------------------------------------------------------------
+// Sample ingestion
+// ---------------------------------------------------------------------------
+
+uint32_t MotionTracker::UpdateBlock(size_t base, float time, const float* px, const float* py, const float* pz,
+                                    const float* laneEnabled) {
+    using namespace SIMD;
+
+    float counts[kWidth];
+    for (int lane = 0; lane < kWidth; ++lane) {
+        counts[lane] = static_cast<float>(m_sampleCount[base + lane]);
+    }
+
+    const FloatV zero = Set1(0.0f);
+    const FloatV half = Set1(0.5f);
+    const FloatV t = Set1(time);
+    const FloatV count = Load(counts);
+    const FloatV last = Load(&m_lastTime[base]);
+    const FloatV prevDt = Load(&m_lastDt[base]);
+    const FloatV dt = Sub(t, last);
+
+    const MaskV enabled = CmpGt(Load(laneEnabled), half);
+    const MaskV isFirst = CmpLt(count, half);
+    const MaskV single = CmpLt(count, Set1(1.5f));
+    const MaskV first = MaskAnd(isFirst, enabled);
+    const MaskV advance = MaskAnd(MaskAndNot(isFirst, CmpGt(dt, Set1(kMinDeltaTime))), enabled);
+    const MaskV hasHistory = MaskAndNot(single, advance);  // advancing with at least two samples so far
+    const MaskV accept = MaskOr(first, advance);
+
+    const FloatV safeDt = Select(advance, dt, Set1(1.0f));
+    const FloatV invDt = Div(Set1(1.0f), safeDt);
+    const MaskV useAcceleration = MaskAnd(hasHistory, CmpGt(prevDt, Set1(kMinDeltaTime)));
+    const FloatV invMidSpan = Div(Set1(1.0f), Mul(half, Add(safeDt, Select(useAcceleration, prevDt, zero))));
+
+    const float* samples[3] = { px, py, pz };
+    for (int axis = 0; axis < 3; ++axis) {
+        float* positionPtr = &m_position[axis][base];
+        float* velocityPtr = &m_velocity[axis][base];
+        float* accelerationPtr = &m_acceleration[axis][base];
+
+        const FloatV p = Load(samples[axis]);
+        const FloatV position = Load(positionPtr);
+        const FloatV velocity = Load(velocityPtr);
+        const FloatV acceleration = Load(accelerationPtr);
+
+        // Finite-difference velocity over the last interval (valid at its midpoint)
+        const FloatV rawVelocity = Mul(Sub(p, position), invDt);
+
+        FloatV newPosition = p;
+        FloatV newVelocity = rawVelocity;
+        FloatV newAcceleration = zero;
+
+        if (m_model == Model::ConstantAcceleration) {
+            // Previous midpoint velocity recovered from the stored end velocity
+            const FloatV previousMid = Sub(velocity, Mul(acceleration, Mul(half, prevDt)));
+            newAcceleration = Select(useAcceleration, Mul(Sub(rawVelocity, previousMid), invMidSpan), zero);
+            newVelocity = MulAdd(newAcceleration, Mul(half, safeDt), rawVelocity);
+        } else if (m_model == Model::AlphaBeta) {
+            const FloatV predicted = MulAdd(velocity, safeDt, position);
+            const FloatV residual = Sub(p, predicted);
+            newPosition = Select(hasHistory, MulAdd(Set1(m_alpha), residual, predicted), p);
+            newVelocity = Select(hasHistory, MulAdd(Mul(Set1(m_beta), invDt), residual, velocity), rawVelocity);
+        }
+
+        newVelocity = Select(first, zero, newVelocity);
+        newAcceleration = Select(first, zero, newAcceleration);
+
+        Store(positionPtr, Select(accept, newPosition, position));
+        Store(velocityPtr, Select(accept, newVelocity, velocity));
+        Store(accelerationPtr, Select(accept, newAcceleration, acceleration));
+    }
+
+    Store(&m_lastTime[base], Select(accept, t, last));
+    Store(&m_lastDt[base], Select(advance, dt, Select(first, zero, prevDt)));
+    return MaskBits(accept);
+}
+
+void MotionTracker::PushHistory(size_t track, float time, float x, float y, float z) {
+    const size_t slot = track * m_historyLength + m_historyHead[track];
+    m_historyTime[slot] = time;
+    m_history[0][slot] = x;
+    m_history[1][slot] = y;
+    m_history[2][slot] = z;
+
+    m_historyHead[track] = static_cast<uint32_t>((m_historyHead[track] + 1) & (m_historyLength - 1));
+    if (m_sampleCount[track] < m_historyLength) {
+        ++m_sampleCount[track];
+    }
+}
+
+void MotionTracker::PushSample(size_t track, double timestamp, const Vec3& position) {
+    using namespace SIMD;
+    const float time = ToLocalTime(timestamp);
+    const size_t base = track - track % kWidth;
+    const int lane = static_cast<int>(track - base);
+
+    float px[kWidth] = {}, py[kWidth] = {}, pz[kWidth] = {}, enabled[kWidth] = {};
+    px[lane] = position.x;
+    py[lane] = position.y;
+    pz[lane] = position.z;
+    enabled[lane] = 1.0f;
+
+    if (UpdateBlock(base, time, px, py, pz, enabled) != 0) {
+        PushHistory(track, time, position.x, position.y, position.z);
+    }
+}
+
+void MotionTracker::PushSamples(double timestamp, const Vec3* positions, size_t count) {
+    using namespace SIMD;
+    const float time = ToLocalTime(timestamp);
+    count = std::min(count, m_trackCount);
+
+    float px[kWidth], py[kWidth], pz[kWidth], enabled[kWidth];
+    for (size_t base = 0; base < count; base += kWidth) {
+        const size_t lanes = std::min<size_t>(kWidth, count - base);
+        for (size_t lane = 0; lane < static_cast<size_t>(kWidth); ++lane) {
+            const bool active = lane < lanes;
+            px[lane] = active ? positions[base + lane].x : 0.0f;
+            py[lane] = active ? positions[base + lane].y : 0.0f;
+            pz[lane] = active ? positions[base + lane].z : 0.0f;
+            enabled[lane] = active ? 1.0f : 0.0f;
+        }
+
+        uint32_t accepted = UpdateBlock(base, time, px, py, pz, enabled);
+        while (accepted) {
+            const int lane = LowestBit(accepted);
+            accepted &= accepted - 1;
+            PushHistory(base + lane, time, px[lane], py[lane], pz[lane]);
+        }
+    }
+}
+
+void MotionTracker::PushSamples(double timestamp, ConstVec3SoA positions, size_t count) {
+    using namespace SIMD;
+    const float time = ToLocalTime(timestamp);
+    count = std::min(count, m_trackCount);
+
+    float px[kWidth], py[kWidth], pz[kWidth], enabled[kWidth];
+    for (size_t base = 0; base < count; base += kWidth) {
+        const size_t lanes = std::min<size_t>(kWidth, count - base);
+        for (size_t lane = 0; lane < static_cast<size_t>(kWidth); ++lane) {
+            const bool active = lane < lanes;
+            px[lane] = active ? positions.x[base + lane] : 0.0f;
+            py[lane] = active ? positions.y[base + lane] : 0.0f;
+            pz[lane] = active ? positions.z[base + lane] : 0.0f;
+            enabled[lane] = active ? 1.0f : 0.0f;
+        }
+
+        uint32_t accepted = UpdateBlock(base, time, px, py, pz, enabled);
+        while (accepted) {
+            const int lane = LowestBit(accepted);
+            accepted &= accepted - 1;
+            PushHistory(base + lane, time, px[lane], py[lane], pz[lane]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Prediction
+// ---------------------------------------------------------------------------
+
+Vec3 MotionTracker::Interpolate(size_t track, float time) const {
+    const size_t mask = m_historyLength - 1;
+    const size_t row = track * m_historyLength;
+    const size_t available = m_sampleCount[track];
+
+    size_t newer = (m_historyHead[track] + mask) & mask;
+    for (size_t i = 1; i < available; ++i) {
+        const size_t older = (newer + mask) & mask;
+        const float olderTime = m_historyTime[row + older];
+        if (olderTime <= time) {
+            const float span = m_historyTime[row + newer] - olderTime;
+            const float s = span > 0.0f ? (time - olderTime) / span : 0.0f;
+            return Vec3(m_history[0][row + older] + (m_history[0][row + newer] - m_history[0][row + older]) * s,
+                        m_history[1][row + older] + (m_history[1][row + newer] - m_history[1][row + older]) * s,
+                        m_history[2][row + older] + (m_history[2][row + newer] - m_history[2][row + older]) * s);
+        }
+        newer = older;
+    }
+
+    // Older than the whole history: hold the oldest sample
+    return Vec3(m_history[0][row + newer], m_history[1][row + newer], m_history[2][row + newer]);
+}
+
+Vec3 MotionTracker::Predict(size_t track, double timestamp) const {
+    if (m_sampleCount[track] == 0) {
+        return Vec3();
+    }
+
+    const float time = ToLocalTimeConst(timestamp);
+    float dt = time - m_lastTime[track];
+    if (dt < 0.0f) {
+        return Interpolate(track, time);
+    }
+
+    dt = std::min(dt, m_maxExtrapolation);
+    const float halfDt2 = 0.5f * dt * dt;
+    return Vec3(m_position[0][track] + m_velocity[0][track] * dt + m_acceleration[0][track] * halfDt2,
+                m_position[1][track] + m_velocity[1][track] * dt + m_acceleration[1][track] * halfDt2,
+                m_position[2][track] + m_velocity[2][track] * dt + m_acceleration[2][track] * halfDt2);
+}
+
+void MotionTracker::PredictBlock(size_t base, float time, float* x, float* y, float* z) const {
+    using namespace SIMD;
+    const FloatV zero = Set1(0.0f);
+
+    const FloatV rawDt = Sub(Set1(time), Load(&m_lastTime[base]));
+    const FloatV dt = Min(Max(rawDt, zero), Set1(m_maxExtrapolation));
+    const FloatV halfDt2 = Mul(Set1(0.5f), Mul(dt, dt));
+
+    float* outputs[3] = { x, y, z };
+    for (int axis = 0; axis < 3; ++axis) {
+        const FloatV position = Load(&m_position[axis][base]);
+        const FloatV velocity = Load(&m_velocity[axis][base]);
+        const FloatV acceleration = Load(&m_acceleration[axis][base]);
+        Store(outputs[axis], MulAdd(acceleration, halfDt2, MulAdd(velocity, dt, position)));
+    }
+
+    // Queries behind the newest sample are rare (render delay), resolve them from history
+    uint32_t behind = MaskBits(CmpLt(rawDt, zero));
+    while (behind) {
+        const int lane = LowestBit(behind);
+        behind &= behind - 1;
+        if (base + lane < m_trackCount && m_sampleCount[base + lane] > 0) {
+            const Vec3 p = Interpolate(base + lane, time);
+            x[lane] = p.x;
+            y[lane] = p.y;
+            z[lane] = p.z;
+        }
+    }
+}
+
+void MotionTracker::PredictAll(double timestamp, Vec3* out) const {
+    using namespace SIMD;
+    const float time = ToLocalTimeConst(timestamp);
+
+    float x[kWidth], y[kWidth], z[kWidth];
+    for (size_t base = 0; base < m_trackCount; base += kWidth) {
+        PredictBlock(base, time, x, y, z);
+        const size_t lanes = std::min<size_t>(kWidth, m_trackCount - base);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            out[base + lane] = Vec3(x[lane], y[lane], z[lane]);
+        }
+    }
+}
+
+void MotionTracker::PredictAll(double timestamp, Vec3SoA out) const {
+    using namespace SIMD;
+    const float time = ToLocalTimeConst(timestamp);
+
+    float x[kWidth], y[kWidth], z[kWidth];
+    for (size_t base = 0; base < m_trackCount; base += kWidth) {
+        const size_t lanes = std::min<size_t>(kWidth, m_trackCount - base);
+        if (lanes == static_cast<size_t>(kWidth)) {
+            PredictBlock(base, time, out.x + base, out.y + base, out.z + base);
+            continue;
+        }
+
+        PredictBlock(base, time, x, y, z);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            out.x[base + lane] = x[lane];
+            out.y[base + lane] = y[lane];
+            out.z[base + lane] = z[lane];
+        }
+    }
+}
+
+Vec3 MotionTracker::GetVelocity(size_t track) const {
+    return Vec3(m_velocity[0][track], m_velocity[1][track], m_velocity[2][track]);
+}
+
+} // namespace VectorMath
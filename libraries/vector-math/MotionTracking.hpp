@@ -0,0 +1,137 @@
+/**
+ * @file MotionTracking.hpp
+ * @brief Batched motion extrapolation and smoothing for many entity tracks
+ * @author Lukas Ernst
+ *
+ * Keeps a short sample history per track in SoA ring buffers and a filter
+ * state (position, velocity, acceleration) in SoA arrays, so a whole tick of
+ * samples is folded in with SIMD across tracks. Positions can then be queried
+ * at any timestamp: after the newest sample the filter extrapolates, before it
+ * the history is interpolated. This lets overlays stay smooth between polls of
+ * the underlying data source.
+ *
+ * Timestamps are seconds as double and stored as float offsets from the first
+ * sample pushed, which keeps sub-millisecond resolution for several hours.
+ */
+
+#pragma once
+
+#include "Vector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VectorMath {
+
+/**
+ * @brief SoA track store with SIMD filters and prediction
+ */
+class MotionTracker {
+public:
+    enum class Model {
+        ConstantVelocity,       // velocity from the last two samples
+        ConstantAcceleration,   // velocity and acceleration from the last three samples
+        AlphaBeta               // smoothed position and velocity, robust to noisy samples
+    };
+
+    /**
+     * @param trackCount Number of tracks, addressed as 0..trackCount-1
+     * @param model Filter used for new samples
+     * @param historyLength Samples kept per track for interpolation (rounded up to a power of two)
+     */
+    explicit MotionTracker(size_t trackCount = 0, Model model = Model::ConstantVelocity, size_t historyLength = 8);
+
+    /**
+     * @brief Changes the number of tracks, new tracks start empty
+     */
+    void Resize(size_t trackCount);
+
+    /**
+     * @brief Drops the history and filter state of one track (e.g. entity respawned)
+     */
+    void ResetTrack(size_t track);
+
+    void SetModel(Model model) { m_model = model; }
+    Model GetModel() const { return m_model; }
+
+    /**
+     * @brief Sets the alpha-beta gains (position and velocity correction, both in [0, 1])
+     */
+    void SetAlphaBeta(float alpha, float beta) { m_alpha = alpha; m_beta = beta; }
+
+    /**
+     * @brief Caps how far past the newest sample positions are extrapolated
+     */
+    void SetMaxExtrapolation(float seconds) { m_maxExtrapolation = seconds; }
+
+    /**
+     * @brief Adds one sample to one track
+     *
+     * Samples not newer than the track's newest sample are ignored.
+     */
+    void PushSample(size_t track, double timestamp, const Vec3& position);
+
+    /**
+     * @brief Adds one sample per track for tracks 0..count-1, all taken at the same time
+     */
+    void PushSamples(double timestamp, const Vec3* positions, size_t count);
+    void PushSamples(double timestamp, ConstVec3SoA positions, size_t count);
+
+    /**
+     * @brief Position of one track at a timestamp (extrapolated or interpolated)
+     */
+    Vec3 Predict(size_t track, double timestamp) const;
+
+    /**
+     * @brief Positions of all tracks at one timestamp
+     * @param out GetTrackCount() outputs
+     */
+    void PredictAll(double timestamp, Vec3* out) const;
+    void PredictAll(double timestamp, Vec3SoA out) const;
+
+    /**
+     * @brief Current filtered velocity of a track
+     */
+    Vec3 GetVelocity(size_t track) const;
+
+    /**
+     * @brief Number of accepted samples of a track (saturates at the history length)
+     */
+    size_t GetSampleCount(size_t track) const { return m_sampleCount[track]; }
+
+    size_t GetTrackCount() const { return m_trackCount; }
+
+private:
+    uint32_t UpdateBlock(size_t base, float time, const float* px, const float* py, const float* pz, const float* laneEnabled);
+    void PredictBlock(size_t base, float time, float* x, float* y, float* z) const;
+    void PushHistory(size_t track, float time, float x, float y, float z);
+    Vec3 Interpolate(size_t track, float time) const;
+    float ToLocalTime(double timestamp);
+    float ToLocalTimeConst(double timestamp) const;
+
+    Model m_model;
+    float m_alpha;
+    float m_beta;
+    float m_maxExtrapolation;
+
+    size_t m_trackCount;
+    size_t m_paddedCount;   // rounded up to the SIMD width so blocks never need a scalar tail
+    size_t m_historyLength;
+    double m_epoch;
+    bool m_hasEpoch;
+
+    // Filter state, one entry per track
+    std::vector<float> m_lastTime;
+    std::vector<float> m_lastDt;
+    std::vector<float> m_position[3];
+    std::vector<float> m_velocity[3];
+    std::vector<float> m_acceleration[3];
+    std::vector<uint32_t> m_sampleCount;
+
+    // History rings, track-major: entry (track, slot) at track * m_historyLength + slot
+    std::vector<float> m_historyTime;
+    std::vector<float> m_history[3];
+    std::vector<uint32_t> m_historyHead;
+};
+
+} // namespace VectorMath
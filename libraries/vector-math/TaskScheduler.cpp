@@ -0,0 +1,121 @@
+/**
+ * @file TaskScheduler.cpp
+ * @brief Implementation of the shared worker pool
+ * @author Lukas Ernst
+ */
+
+#include "TaskScheduler.hpp"
+#include <algorithm>
+
+namespace VectorMath {
+
+namespace {
+    // Set while a thread executes chunks so nested ParallelFor calls run inline
+    thread_local bool t_insideJob = false;
+}
+
+TaskScheduler::TaskScheduler(unsigned threadCount)
+    : m_body(nullptr), m_count(0), m_grainSize(1), m_chunkCount(0), m_nextChunk(0),
+      m_generation(0), m_busyWorkers(0), m_stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The calling thread always participates, so spawn one less worker
+    m_workers.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        m_workers.emplace_back(&TaskScheduler::WorkerLoop, this);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::Shared() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+void TaskScheduler::ParallelFor(size_t count, size_t grainSize, const RangeFunction& body) {
+    if (count == 0) {
+        return;
+    }
+
+    grainSize = std::max<size_t>(1, grainSize);
+    const size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+    // Single chunk, no workers, nested call or pool already busy: run inline
+    std::unique_lock<std::mutex> submitLock(m_submitMutex, std::defer_lock);
+    if (chunkCount == 1 || m_workers.empty() || t_insideJob || !submitLock.try_lock()) {
+        for (size_t begin = 0; begin < count; begin += grainSize) {
+            body(begin, std::min(count, begin + grainSize));
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_grainSize = grainSize;
+        m_chunkCount = chunkCount;
+        m_nextChunk.store(0, std::memory_order_relaxed);
+        m_busyWorkers = static_cast<unsigned>(m_workers.size());
+        ++m_generation;
+    }
+    m_wakeCondition.notify_all();
+
+    RunChunks();
+
+    // Workers may still be finishing their last chunk and reference m_body
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] { return m_busyWorkers == 0; });
+    m_body = nullptr;
+}
+
+void TaskScheduler::RunChunks() {
+    t_insideJob = true;
+    for (;;) {
+        const size_t chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= m_chunkCount) {
+            break;
+        }
+        const size_t begin = chunk * m_grainSize;
+        (*m_body)(begin, std::min(m_count, begin + m_grainSize));
+    }
+    t_insideJob = false;
+}
+
+void TaskScheduler::WorkerLoop() {
+    uint64_t seenGeneration = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+            if (m_stopping) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        RunChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busyWorkers;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+} // namespace VectorMath
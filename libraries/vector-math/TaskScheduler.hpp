@@ -0,0 +1,86 @@
+/**
+ * @file TaskScheduler.hpp
+ * @brief Shared worker pool for data-parallel batch operations
+ * @author Lukas Ernst
+ *
+ * A small persistent thread pool used by the bulk transform, projection and
+ * culling paths. Work is expressed as a ParallelFor over an index range that is
+ * split into fixed-size chunks; workers and the calling thread pull chunks from
+ * a shared atomic counter until the range is exhausted.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VectorMath {
+
+/**
+ * @brief Persistent worker pool with chunked ParallelFor
+ *
+ * One job runs at a time. A ParallelFor issued from inside a running job, or
+ * while another thread owns the pool, executes inline on the calling thread
+ * instead of blocking, so nesting and concurrent callers never deadlock.
+ */
+class TaskScheduler {
+public:
+    using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+    /**
+     * @brief Creates the pool
+     * @param threadCount Total threads including the caller, 0 = hardware concurrency
+     */
+    explicit TaskScheduler(unsigned threadCount = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Runs body over [0, count) split into chunks of grainSize indices
+     * @param count Number of indices
+     * @param grainSize Indices per chunk (one chunk is the unit of work stealing)
+     * @param body Called with [begin, end) for each chunk, must not throw
+     */
+    void ParallelFor(size_t count, size_t grainSize, const RangeFunction& body);
+
+    /**
+     * @brief Number of threads participating in a ParallelFor, including the caller
+     */
+    unsigned GetThreadCount() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    /**
+     * @brief Process-wide scheduler sized to the hardware concurrency
+     */
+    static TaskScheduler& Shared();
+
+private:
+    void WorkerLoop();
+    void RunChunks();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+
+    const RangeFunction* m_body;
+    size_t m_count;
+    size_t m_grainSize;
+    size_t m_chunkCount;
+    std::atomic<size_t> m_nextChunk;
+
+    uint64_t m_generation;
+    unsigned m_busyWorkers;
+    bool m_stopping;
+};
+
+} // namespace VectorMath
@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <algorithm>
 #include <array>
+#include <cfloat>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -195,6 +196,206 @@ inline Vec3 operator/(Vec3 a, float scalar) { return a /= scalar; }
 inline Vec3 operator+(Vec3 a, const Vec3& b) { return a += b; }
 inline Vec3 operator-(Vec3 a, const Vec3& b) { return a -= b; }
 
+/**
+ * @brief Double-precision 2D vector for large world coordinates
+ */
+struct Vec2d {
+    double x, y;
+
+    // Constructors
+    Vec2d() noexcept : x(0.0), y(0.0) {}
+    Vec2d(double x_val, double y_val) : x(x_val), y(y_val) {}
+    explicit Vec2d(const Vec2& v) : x(v.x), y(v.y) {}
+
+    inline double Length() const noexcept {
+        return std::sqrt(x * x + y * y);
+    }
+
+    inline double LengthSquared() const noexcept {
+        return x * x + y * y;
+    }
+
+    inline double Dot(const Vec2d& other) const noexcept {
+        return x * other.x + y * other.y;
+    }
+
+    inline Vec2 ToFloat() const noexcept {
+        return Vec2(static_cast<float>(x), static_cast<float>(y));
+    }
+
+    // Operator overloads
+    Vec2d& operator*=(double scalar) { x *= scalar; y *= scalar; return *this; }
+    Vec2d& operator/=(double scalar) { x /= scalar; y /= scalar; return *this; }
+    Vec2d& operator+=(const Vec2d& other) { x += other.x; y += other.y; return *this; }
+    Vec2d& operator-=(const Vec2d& other) { x -= other.x; y -= other.y; return *this; }
+};
+
+// Vec2d binary operators
+inline Vec2d operator*(Vec2d a, double scalar) { return a *= scalar; }
+inline Vec2d operator/(Vec2d a, double scalar) { return a /= scalar; }
+inline Vec2d operator+(Vec2d a, const Vec2d& b) { return a += b; }
+inline Vec2d operator-(Vec2d a, const Vec2d& b) { return a -= b; }
+
+/**
+ * @brief Double-precision 3D vector for large world coordinates
+ * 
+ * A float has a 24-bit mantissa, so positions 100 km from the origin are only
+ * resolvable to ~8 mm and jitter once projected. Keep absolute positions in Vec3d
+ * and convert the (small) offset from a nearby origin with RelativeTo().
+ */
+struct Vec3d {
+    double x, y, z;
+
+    // Constructors
+    Vec3d() noexcept : x(0.0), y(0.0), z(0.0) {}
+    Vec3d(double x_val, double y_val, double z_val) : x(x_val), y(y_val), z(z_val) {}
+    explicit Vec3d(const Vec3& v) : x(v.x), y(v.y), z(v.z) {}
+
+    inline double Length() const noexcept {
+        return std::sqrt(x * x + y * y + z * z);
+    }
+
+    inline double LengthSquared() const noexcept {
+        return x * x + y * y + z * z;
+    }
+
+    inline Vec3d Normalized() const noexcept {
+        const double length = Length();
+        if (length > 1e-12) {
+            return Vec3d(x / length, y / length, z / length);
+        }
+        return Vec3d(0.0, 0.0, 0.0);
+    }
+
+    inline double Dot(const Vec3d& other) const noexcept {
+        return x * other.x + y * other.y + z * other.z;
+    }
+
+    inline Vec3d Cross(const Vec3d& other) const noexcept {
+        return Vec3d(
+            y * other.z - z * other.y,
+            z * other.x - x * other.z,
+            x * other.y - y * other.x
+        );
+    }
+
+    inline double Distance(const Vec3d& other) const {
+        double dx = x - other.x;
+        double dy = y - other.y;
+        double dz = z - other.z;
+        return std::sqrt(dx*dx + dy*dy + dz*dz);
+    }
+
+    inline Vec3 ToFloat() const noexcept {
+        return Vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+    }
+
+    // Offset from origin, subtracted in double before narrowing to float
+    inline Vec3 RelativeTo(const Vec3d& origin) const noexcept {
+        return Vec3(static_cast<float>(x - origin.x),
+                    static_cast<float>(y - origin.y),
+                    static_cast<float>(z - origin.z));
+    }
+
+    // Operator overloads
+    Vec3d& operator*=(double scalar) { x *= scalar; y *= scalar; z *= scalar; return *this; }
+    Vec3d& operator/=(double scalar) { x /= scalar; y /= scalar; z /= scalar; return *this; }
+    Vec3d& operator+=(const Vec3d& other) { x += other.x; y += other.y; z += other.z; return *this; }
+    Vec3d& operator-=(const Vec3d& other) { x -= other.x; y -= other.y; z -= other.z; return *this; }
+};
+
+// Vec3d binary operators
+inline Vec3d operator*(Vec3d a, double scalar) { return a *= scalar; }
+inline Vec3d operator/(Vec3d a, double scalar) { return a /= scalar; }
+inline Vec3d operator+(Vec3d a, const Vec3d& b) { return a += b; }
+inline Vec3d operator-(Vec3d a, const Vec3d& b) { return a -= b; }
+
+/**
+ * @brief Axis-aligned bounding box given by its min/max corners
+ */
+struct AABB {
+    Vec3 minBounds;
+    Vec3 maxBounds;
+
+    AABB() noexcept {}
+    AABB(const Vec3& min_val, const Vec3& max_val) : minBounds(min_val), maxBounds(max_val) {}
+
+    // Inverted box that any Expand() call replaces
+    static AABB Empty() noexcept {
+        return AABB(Vec3(FLT_MAX, FLT_MAX, FLT_MAX), Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+    }
+
+    inline bool IsValid() const noexcept {
+        return minBounds.x <= maxBounds.x && minBounds.y <= maxBounds.y && minBounds.z <= maxBounds.z;
+    }
+
+    // Touching boxes count as overlapping
+    inline bool Overlaps(const AABB& other) const noexcept {
+        return minBounds.x <= other.maxBounds.x && maxBounds.x >= other.minBounds.x &&
+               minBounds.y <= other.maxBounds.y && maxBounds.y >= other.minBounds.y &&
+               minBounds.z <= other.maxBounds.z && maxBounds.z >= other.minBounds.z;
+    }
+
+    inline bool Contains(const Vec3& point) const noexcept {
+        return point.x >= minBounds.x && point.x <= maxBounds.x &&
+               point.y >= minBounds.y && point.y <= maxBounds.y &&
+               point.z >= minBounds.z && point.z <= maxBounds.z;
+    }
+
+    inline Vec3 Center() const noexcept {
+        return (minBounds + maxBounds) * 0.5f;
+    }
+
+    // Half size along each axis
+    inline Vec3 Extents() const noexcept {
+        return (maxBounds - minBounds) * 0.5f;
+    }
+
+    inline float SurfaceArea() const noexcept {
+        Vec3 size = maxBounds - minBounds;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    inline void Expand(const Vec3& point) noexcept {
+        if (point.x < minBounds.x) minBounds.x = point.x;
+        if (point.y < minBounds.y) minBounds.y = point.y;
+        if (point.z < minBounds.z) minBounds.z = point.z;
+        if (point.x > maxBounds.x) maxBounds.x = point.x;
+        if (point.y > maxBounds.y) maxBounds.y = point.y;
+        if (point.z > maxBounds.z) maxBounds.z = point.z;
+    }
+
+    inline void Expand(const AABB& box) noexcept {
+        Expand(box.minBounds);
+        Expand(box.maxBounds);
+    }
+};
+
+/**
+ * @brief Structure-of-arrays views over externally owned point storage
+ * 
+ * Batch kernels read and write one float stream per component so that SIMD
+ * lanes map to consecutive points. The views do not own memory.
+ */
+struct Vec3SoA {
+    float* x;
+    float* y;
+    float* z;
+
+    Vec3SoA() noexcept : x(nullptr), y(nullptr), z(nullptr) {}
+    Vec3SoA(float* x_ptr, float* y_ptr, float* z_ptr) noexcept : x(x_ptr), y(y_ptr), z(z_ptr) {}
+};
+
+struct ConstVec3SoA {
+    const float* x;
+    const float* y;
+    const float* z;
+
+    ConstVec3SoA() noexcept : x(nullptr), y(nullptr), z(nullptr) {}
+    ConstVec3SoA(const float* x_ptr, const float* y_ptr, const float* z_ptr) noexcept : x(x_ptr), y(y_ptr), z(z_ptr) {}
+    ConstVec3SoA(const Vec3SoA& other) noexcept : x(other.x), y(other.y), z(other.z) {}
+};
+
 /**
  * @brief Utility functions for angle calculations (implemented in Vector.cpp)
  */
@@ -275,6 +476,11 @@ namespace MatrixOps {
 // Bring the main classes and functions into global scope for convenience
 using VectorMath::Vec2;
 using VectorMath::Vec3;
+using VectorMath::Vec2d;
+using VectorMath::Vec3d;
+using VectorMath::AABB;
+using VectorMath::Vec3SoA;
+using VectorMath::ConstVec3SoA;
 using VectorMath::CalculateAngle;
 using VectorMath::CalculateFOV;
 using VectorMath::ClampAngles;
@@ -0,0 +1,327 @@
+/**
+ * @file VectorSIMD.hpp
+ * @brief Thin SIMD lane abstraction shared by the batch kernels
+ * @author Lukas Ernst
+ *
+ * Maps a small set of float operations onto AVX-512, AVX2/FMA, SSE2 or plain
+ * scalar code, depending on the instruction set the translation unit is compiled
+ * for. Kernels written against SIMD::FloatV process SIMD::kWidth lanes per step
+ * and handle the remainder with a scalar loop or a padded tail. Defining
+ * VECTORMATH_NO_SIMD forces the scalar path regardless of the target.
+ *
+ * A translation unit may also define VECTORMATH_SIMD_AVX512, _AVX2 or _SSE2
+ * itself, together with matching target pragmas, to build a kernel for a level
+ * above its compile flags that is only called after runtime detection (see
+ * CpuFeatures.hpp). Everything here lives in an inline namespace named after
+ * the level, so such kernels never share inline symbols with the rest.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(VECTORMATH_NO_SIMD)
+// Scalar reference build
+#elif defined(VECTORMATH_SIMD_AVX512) || defined(VECTORMATH_SIMD_AVX2) || defined(VECTORMATH_SIMD_SSE2)
+// Level chosen by the including translation unit
+#elif defined(__AVX512F__) && defined(__AVX512DQ__)
+#define VECTORMATH_SIMD_AVX512 1
+#elif defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define VECTORMATH_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTORMATH_SIMD_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(VECTORMATH_SIMD_AVX512) || defined(VECTORMATH_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(VECTORMATH_SIMD_SSE2)
+#include <emmintrin.h>
+#else
+#include <cmath>
+#endif
+
+#if defined(VECTORMATH_SIMD_AVX512)
+#define VECTORMATH_SIMD_ABI avx512
+#elif defined(VECTORMATH_SIMD_AVX2)
+#define VECTORMATH_SIMD_ABI avx2
+#elif defined(VECTORMATH_SIMD_SSE2)
+#define VECTORMATH_SIMD_ABI sse2
+#else
+#define VECTORMATH_SIMD_ABI scalar
+#endif
+
+namespace VectorMath {
+namespace SIMD {
+
+// Symbols carry the level, so translation units built for different levels can share a binary
+inline namespace VECTORMATH_SIMD_ABI {
+
+#if defined(VECTORMATH_SIMD_AVX512)
+
+constexpr int kWidth = 16;
+constexpr const char* kName = "AVX-512";
+using FloatV = __m512;
+using MaskV = __mmask16;
+
+// GCC 12 implements the unmasked min, max, sqrt and rcp14 as masked builtins with an
+// _mm512_undefined_ps() pass-through, which -Wall reports as uninitialized; the
+// zero-masking forms with every lane enabled compile to the same instruction
+constexpr MaskV kAllLanes = 0xFFFF;
+
+inline FloatV Load(const float* p) { return _mm512_loadu_ps(p); }
+inline void Store(float* p, FloatV v) { _mm512_storeu_ps(p, v); }
+inline FloatV Set1(float v) { return _mm512_set1_ps(v); }
+inline FloatV Add(FloatV a, FloatV b) { return _mm512_add_ps(a, b); }
+inline FloatV Sub(FloatV a, FloatV b) { return _mm512_sub_ps(a, b); }
+inline FloatV Mul(FloatV a, FloatV b) { return _mm512_mul_ps(a, b); }
+inline FloatV Div(FloatV a, FloatV b) { return _mm512_div_ps(a, b); }
+inline FloatV Min(FloatV a, FloatV b) { return _mm512_maskz_min_ps(kAllLanes, a, b); }
+inline FloatV Max(FloatV a, FloatV b) { return _mm512_maskz_max_ps(kAllLanes, a, b); }
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return _mm512_fmadd_ps(a, b, c); }
+inline FloatV Sqrt(FloatV a) { return _mm512_maskz_sqrt_ps(kAllLanes, a); }
+inline FloatV Abs(FloatV a) { return _mm512_abs_ps(a); }
+
+// rcp14 plus one Newton-Raphson step: r' = r * (2 - a * r)
+inline FloatV Rcp(FloatV a) {
+    FloatV r = _mm512_maskz_rcp14_ps(kAllLanes, a);
+    return _mm512_mul_ps(r, _mm512_fnmadd_ps(a, r, _mm512_set1_ps(2.0f)));
+}
+
+inline MaskV CmpLt(FloatV a, FloatV b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+inline MaskV CmpLe(FloatV a, FloatV b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+inline MaskV CmpGt(FloatV a, FloatV b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+inline MaskV CmpGe(FloatV a, FloatV b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+inline MaskV CmpNeq(FloatV a, FloatV b) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_OQ); }
+inline MaskV MaskAnd(MaskV a, MaskV b) { return static_cast<MaskV>(a & b); }
+inline MaskV MaskOr(MaskV a, MaskV b) { return static_cast<MaskV>(a | b); }
+inline MaskV MaskAndNot(MaskV a, MaskV b) { return static_cast<MaskV>(~a & b); }
+inline FloatV Select(MaskV m, FloatV a, FloatV b) { return _mm512_mask_blend_ps(m, b, a); }
+inline uint32_t MaskBits(MaskV m) { return static_cast<uint32_t>(m); }
+
+#elif defined(VECTORMATH_SIMD_AVX2)
+
+constexpr int kWidth = 8;
+constexpr const char* kName = "AVX2";
+using FloatV = __m256;
+using MaskV = __m256;
+
+inline FloatV Load(const float* p) { return _mm256_loadu_ps(p); }
+inline void Store(float* p, FloatV v) { _mm256_storeu_ps(p, v); }
+inline FloatV Set1(float v) { return _mm256_set1_ps(v); }
+inline FloatV Add(FloatV a, FloatV b) { return _mm256_add_ps(a, b); }
+inline FloatV Sub(FloatV a, FloatV b) { return _mm256_sub_ps(a, b); }
+inline FloatV Mul(FloatV a, FloatV b) { return _mm256_mul_ps(a, b); }
+inline FloatV Div(FloatV a, FloatV b) { return _mm256_div_ps(a, b); }
+inline FloatV Min(FloatV a, FloatV b) { return _mm256_min_ps(a, b); }
+inline FloatV Max(FloatV a, FloatV b) { return _mm256_max_ps(a, b); }
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return _mm256_fmadd_ps(a, b, c); }
+inline FloatV Sqrt(FloatV a) { return _mm256_sqrt_ps(a); }
+inline FloatV Abs(FloatV a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+inline FloatV Rcp(FloatV a) {
+    FloatV r = _mm256_rcp_ps(a);
+    return _mm256_mul_ps(r, _mm256_fnmadd_ps(a, r, _mm256_set1_ps(2.0f)));
+}
+
+inline MaskV CmpLt(FloatV a, FloatV b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline MaskV CmpLe(FloatV a, FloatV b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline MaskV CmpGt(FloatV a, FloatV b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline MaskV CmpGe(FloatV a, FloatV b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline MaskV CmpNeq(FloatV a, FloatV b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_OQ); }
+inline MaskV MaskAnd(MaskV a, MaskV b) { return _mm256_and_ps(a, b); }
+inline MaskV MaskOr(MaskV a, MaskV b) { return _mm256_or_ps(a, b); }
+inline MaskV MaskAndNot(MaskV a, MaskV b) { return _mm256_andnot_ps(a, b); }
+inline FloatV Select(MaskV m, FloatV a, FloatV b) { return _mm256_blendv_ps(b, a, m); }
+inline uint32_t MaskBits(MaskV m) { return static_cast<uint32_t>(_mm256_movemask_ps(m)); }
+
+#elif defined(VECTORMATH_SIMD_SSE2)
+
+constexpr int kWidth = 4;
+constexpr const char* kName = "SSE2";
+using FloatV = __m128;
+using MaskV = __m128;
+
+inline FloatV Load(const float* p) { return _mm_loadu_ps(p); }
+inline void Store(float* p, FloatV v) { _mm_storeu_ps(p, v); }
+inline FloatV Set1(float v) { return _mm_set1_ps(v); }
+inline FloatV Add(FloatV a, FloatV b) { return _mm_add_ps(a, b); }
+inline FloatV Sub(FloatV a, FloatV b) { return _mm_sub_ps(a, b); }
+inline FloatV Mul(FloatV a, FloatV b) { return _mm_mul_ps(a, b); }
+inline FloatV Div(FloatV a, FloatV b) { return _mm_div_ps(a, b); }
+inline FloatV Min(FloatV a, FloatV b) { return _mm_min_ps(a, b); }
+inline FloatV Max(FloatV a, FloatV b) { return _mm_max_ps(a, b); }
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline FloatV Sqrt(FloatV a) { return _mm_sqrt_ps(a); }
+inline FloatV Abs(FloatV a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+inline FloatV Rcp(FloatV a) {
+    FloatV r = _mm_rcp_ps(a);
+    return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(a, r)));
+}
+
+inline MaskV CmpLt(FloatV a, FloatV b) { return _mm_cmplt_ps(a, b); }
+inline MaskV CmpLe(FloatV a, FloatV b) { return _mm_cmple_ps(a, b); }
+inline MaskV CmpGt(FloatV a, FloatV b) { return _mm_cmpgt_ps(a, b); }
+inline MaskV CmpGe(FloatV a, FloatV b) { return _mm_cmpge_ps(a, b); }
+inline MaskV CmpNeq(FloatV a, FloatV b) { return _mm_cmpneq_ps(a, b); }
+inline MaskV MaskAnd(MaskV a, MaskV b) { return _mm_and_ps(a, b); }
+inline MaskV MaskOr(MaskV a, MaskV b) { return _mm_or_ps(a, b); }
+inline MaskV MaskAndNot(MaskV a, MaskV b) { return _mm_andnot_ps(a, b); }
+inline FloatV Select(MaskV m, FloatV a, FloatV b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+inline uint32_t MaskBits(MaskV m) { return static_cast<uint32_t>(_mm_movemask_ps(m)); }
+
+#else
+
+constexpr int kWidth = 1;
+constexpr const char* kName = "Scalar";
+using FloatV = float;
+using MaskV = bool;
+
+inline FloatV Load(const float* p) { return *p; }
+inline void Store(float* p, FloatV v) { *p = v; }
+inline FloatV Set1(float v) { return v; }
+inline FloatV Add(FloatV a, FloatV b) { return a + b; }
+inline FloatV Sub(FloatV a, FloatV b) { return a - b; }
+inline FloatV Mul(FloatV a, FloatV b) { return a * b; }
+inline FloatV Div(FloatV a, FloatV b) { return a / b; }
+inline FloatV Min(FloatV a, FloatV b) { return a < b ? a : b; }
+inline FloatV Max(FloatV a, FloatV b) { return a > b ? a : b; }
+inline FloatV MulAdd(FloatV a, FloatV b, FloatV c) { return a * b + c; }
+inline FloatV Sqrt(FloatV a) { return std::sqrt(a); }
+inline FloatV Abs(FloatV a) { return std::fabs(a); }
+inline FloatV Rcp(FloatV a) { return 1.0f / a; }
+
+inline MaskV CmpLt(FloatV a, FloatV b) { return a < b; }
+inline MaskV CmpLe(FloatV a, FloatV b) { return a <= b; }
+inline MaskV CmpGt(FloatV a, FloatV b) { return a > b; }
+inline MaskV CmpGe(FloatV a, FloatV b) { return a >= b; }
+inline MaskV CmpNeq(FloatV a, FloatV b) { return a != b; }
+inline MaskV MaskAnd(MaskV a, MaskV b) { return a && b; }
+inline MaskV MaskOr(MaskV a, MaskV b) { return a || b; }
+inline MaskV MaskAndNot(MaskV a, MaskV b) { return !a && b; }
+inline FloatV Select(MaskV m, FloatV a, FloatV b) { return m ? a : b; }
+inline uint32_t MaskBits(MaskV m) { return m ? 1u : 0u; }
+
+#endif
+
+/**
+ * @brief Fixed four-lane vector for row-at-a-time 4x4 matrix math
+ *
+ * Independent of kWidth: one matrix row per register, for kernels that work on
+ * one matrix at a time instead of one element across many. SSE on every x86
+ * level, a plain array in scalar builds.
+ */
+#if defined(VECTORMATH_SIMD_AVX512) || defined(VECTORMATH_SIMD_AVX2) || defined(VECTORMATH_SIMD_SSE2)
+
+using Float4 = __m128;
+
+inline Float4 Load4(const float* p) { return _mm_loadu_ps(p); }
+inline void Store4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+inline Float4 Set4(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline Float4 Add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 Mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+#if defined(VECTORMATH_SIMD_AVX512) || defined(VECTORMATH_SIMD_AVX2)
+inline Float4 MulAdd4(Float4 a, Float4 b, Float4 c) { return _mm_fmadd_ps(a, b, c); }
+#else
+inline Float4 MulAdd4(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#endif
+template <int Lane>
+inline Float4 Splat4(Float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(Lane, Lane, Lane, Lane)); }
+
+#else
+
+struct Float4 {
+    float v[4];
+};
+
+inline Float4 Load4(const float* p) { return Float4{{ p[0], p[1], p[2], p[3] }}; }
+inline void Store4(float* p, Float4 a) { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+inline Float4 Set4(float x, float y, float z, float w) { return Float4{{ x, y, z, w }}; }
+inline Float4 Add4(Float4 a, Float4 b) {
+    return Float4{{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }};
+}
+inline Float4 Mul4(Float4 a, Float4 b) {
+    return Float4{{ a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }};
+}
+inline Float4 MulAdd4(Float4 a, Float4 b, Float4 c) { return Add4(Mul4(a, b), c); }
+template <int Lane>
+inline Float4 Splat4(Float4 a) { return Float4{{ a.v[Lane], a.v[Lane], a.v[Lane], a.v[Lane] }}; }
+
+#endif
+
+/**
+ * @brief out = a * b for 3x4 affine matrices
+ *
+ * Matrices are the upper three rows of a row-major 4x4, twelve floats, with
+ * an implicit (0, 0, 0, 1) bottom row that only adds the translation of a to
+ * column 3. Each output row is a combination of the rows of b weighted by one
+ * row of a. out may alias either input.
+ */
+inline void MultiplyAffine(const float* a, const float* b, float* out) {
+    const Float4 b0 = Load4(b), b1 = Load4(b + 4), b2 = Load4(b + 8);
+    const Float4 unitW = Set4(0.0f, 0.0f, 0.0f, 1.0f);
+    for (int r = 0; r < 3; ++r) {
+        const Float4 row = Load4(a + r * 4);
+        Store4(out + r * 4, MulAdd4(Splat4<0>(row), b0, MulAdd4(Splat4<1>(row), b1,
+                            MulAdd4(Splat4<2>(row), b2, Mul4(Splat4<3>(row), unitW)))));
+    }
+}
+
+/**
+ * @brief Horizontal reductions across all lanes
+ */
+inline float ReduceMin(FloatV v) {
+    float lanes[kWidth];
+    Store(lanes, v);
+    float result = lanes[0];
+    for (int i = 1; i < kWidth; ++i) {
+        result = lanes[i] < result ? lanes[i] : result;
+    }
+    return result;
+}
+
+inline float ReduceMax(FloatV v) {
+    float lanes[kWidth];
+    Store(lanes, v);
+    float result = lanes[0];
+    for (int i = 1; i < kWidth; ++i) {
+        result = lanes[i] > result ? lanes[i] : result;
+    }
+    return result;
+}
+
+/**
+ * @brief Index of the lowest set bit, used to walk MaskBits() results
+ * @note bits must be non-zero
+ */
+inline int LowestBit(uint32_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+/**
+ * @brief Number of set bits, used to count lanes in MaskBits() results
+ */
+inline int PopCount(uint32_t bits) {
+#if defined(_MSC_VER)
+    bits = bits - ((bits >> 1) & 0x55555555u);
+    bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+    return static_cast<int>((((bits + (bits >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#else
+    return __builtin_popcount(bits);
+#endif
+}
+
+} // namespace VECTORMATH_SIMD_ABI
+} // namespace SIMD
+} // namespace VectorMath
@@ -0,0 +1,193 @@
+/**
+ * @file CameraState.cpp
+ * @brief Implementation of the seqlock camera state
+ * @author Lukas Ernst
+ */
+
+#include "CameraState.hpp"
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// Failed read or write attempts before the thread yields; the other side holds
+// the sequence only for a short copy, unless it was preempted in the middle
+constexpr int kSpinsBeforeYield = 64;
+
+void Backoff(int& spins) {
+    if (++spins >= kSpinsBeforeYield) {
+        spins = 0;
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+bool CameraSnapshot::WorldToScreen(const Vec3& worldPos, Vec2& screenPos) const {
+    if (!IsValid()) {
+        return false;
+    }
+
+    const float w = viewProjMatrix.GetTransformW(worldPos);
+    if (w < 0.001f) {
+        return false;
+    }
+
+    const Vec3 clip = viewProjMatrix.TransformVector(worldPos);
+    const float invW = 1.0f / w;
+    screenPos.x = center.x + clip.x * invW * halfWidth;
+    screenPos.y = center.y - clip.y * invW * halfHeight;
+    return true;
+}
+
+void CameraSnapshot::ApplyTo(WorldToScreenTransform& transform) const {
+    transform.SetViewport(viewport);
+    if (IsValid()) {
+        transform.SetViewMatrix(viewProjMatrix);
+    }
+}
+
+CameraState::CameraState()
+    : m_sequence(0) {
+    static_assert(sizeof(Payload) == kWordCount * sizeof(uint32_t), "payload is copied word by word");
+    StorePayload();
+}
+
+void CameraState::Publish(const Matrix4x4& viewProjMatrix, const Viewport& viewport) {
+    const uint64_t sequence = BeginWrite();
+    m_pendingMatrix = viewProjMatrix;
+    m_pendingViewport = viewport;
+    StorePayload();
+    EndWrite(sequence);
+}
+
+void CameraState::PublishMatrix(const Matrix4x4& viewProjMatrix) {
+    const uint64_t sequence = BeginWrite();
+    m_pendingMatrix = viewProjMatrix;
+    StorePayload();
+    EndWrite(sequence);
+}
+
+void CameraState::PublishViewport(const Viewport& viewport) {
+    const uint64_t sequence = BeginWrite();
+    m_pendingViewport = viewport;
+    StorePayload();
+    EndWrite(sequence);
+}
+
+CameraSnapshot CameraState::Read() const {
+    CameraSnapshot snapshot;
+    uint64_t sequence;
+    int spins = 0;
+    while (!ReadAttempt(snapshot, sequence)) {
+        Backoff(spins);
+    }
+    return snapshot;
+}
+
+bool CameraState::TryRead(CameraSnapshot& snapshot) const {
+    uint64_t sequence;
+    return ReadAttempt(snapshot, sequence);
+}
+
+bool CameraState::ReadIfNewer(uint64_t knownVersion, CameraSnapshot& snapshot) const {
+    if (GetVersion() == knownVersion) {
+        return false;
+    }
+    snapshot = Read();
+    return snapshot.version != knownVersion;
+}
+
+bool CameraState::Update(WorldToScreenTransform& transform, uint64_t& version) const {
+    CameraSnapshot snapshot;
+    if (!ReadIfNewer(version, snapshot)) {
+        return false;
+    }
+    snapshot.ApplyTo(transform);
+    version = snapshot.version;
+    return true;
+}
+
+uint64_t CameraState::BeginWrite() {
+    int spins = 0;
+    uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+    for (;;) {
+        if ((sequence & 1u) == 0 &&
+            m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+            break;
+        }
+        Backoff(spins);
+        sequence = m_sequence.load(std::memory_order_relaxed);
+    }
+
+    // Keeps the payload stores below from moving above the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence + 1;
+}
+
+void CameraState::EndWrite(uint64_t sequence) {
+    m_sequence.store(sequence + 1, std::memory_order_release);
+}
+
+void CameraState::StorePayload() {
+    Payload payload;
+    std::memcpy(payload.matrix, m_pendingMatrix.m, sizeof(payload.matrix));
+    payload.width = m_pendingViewport.width;
+    payload.height = m_pendingViewport.height;
+    payload.xOffset = m_pendingViewport.x_offset;
+    payload.yOffset = m_pendingViewport.y_offset;
+
+    const Frustum frustum = Frustum::FromMatrix(m_pendingMatrix);
+    for (int i = 0; i < Frustum::PlaneCount; ++i) {
+        const FrustumPlane& plane = frustum.GetPlane(i);
+        payload.planes[i][0] = plane.normal.x;
+        payload.planes[i][1] = plane.normal.y;
+        payload.planes[i][2] = plane.normal.z;
+        payload.planes[i][3] = plane.d;
+    }
+
+    const Vec2 center = m_pendingViewport.GetCenter();
+    payload.centerX = center.x;
+    payload.centerY = center.y;
+    payload.halfWidth = m_pendingViewport.width * 0.5f;
+    payload.halfHeight = m_pendingViewport.height * 0.5f;
+
+    uint32_t words[kWordCount];
+    std::memcpy(words, &payload, sizeof(Payload));
+    for (size_t i = 0; i < kWordCount; ++i) {
+        m_words[i].store(words[i], std::memory_order_relaxed);
+    }
+}
+
+bool CameraState::ReadAttempt(CameraSnapshot& snapshot, uint64_t& sequence) const {
+    sequence = m_sequence.load(std::memory_order_acquire);
+    if (sequence & 1u) {
+        return false;
+    }
+
+    uint32_t words[kWordCount];
+    for (size_t i = 0; i < kWordCount; ++i) {
+        words[i] = m_words[i].load(std::memory_order_relaxed);
+    }
+
+    // Keeps the payload loads above from moving below the sequence check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_sequence.load(std::memory_order_relaxed) != sequence) {
+        return false;
+    }
+
+    Payload payload;
+    std::memcpy(&payload, words, sizeof(Payload));
+    std::memcpy(snapshot.viewProjMatrix.m, payload.matrix, sizeof(payload.matrix));
+    snapshot.viewport = Viewport(payload.width, payload.height, payload.xOffset, payload.yOffset);
+    for (int i = 0; i < Frustum::PlaneCount; ++i) {
+        snapshot.frustum.SetPlane(i, FrustumPlane(Vec3(payload.planes[i][0], payload.planes[i][1], payload.planes[i][2]),
+                                                  payload.planes[i][3]));
+    }
+    snapshot.center = Vec2(payload.centerX, payload.centerY);
+    snapshot.halfWidth = payload.halfWidth;
+    snapshot.halfHeight = payload.halfHeight;
+    snapshot.version = sequence >> 1;
+    return true;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file CameraState.hpp
+ * @brief Seqlock publication of the camera to concurrent projection threads
+ * @author Lukas Ernst
+ *
+ * One thread (typically the one reading the camera from the target process)
+ * publishes the view-projection matrix and viewport; any number of render or
+ * analysis threads take consistent snapshots of it. The state is guarded by a
+ * sequence lock: the writer makes the sequence odd, stores the payload and
+ * makes it even again, readers copy the payload and retry if the sequence
+ * changed meanwhile. Readers never hold up the writer or each other and never
+ * return a torn matrix, but they are not lock-free: Read() retries, and after a
+ * few dozen attempts yields, for as long as a write is in flight. That is a few
+ * dozen stores, unless the writer is preempted in the middle of one. Threads
+ * that must not wait use TryRead() and keep their last good snapshot.
+ *
+ * The payload is stored as relaxed atomic words, so concurrent copies are well
+ * defined under the C++ memory model rather than relying on a benign race.
+ * Concurrent writers are serialized by claiming the odd sequence with a CAS.
+ */
+
+#pragma once
+
+#include "FrustumCulling.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Consistent copy of the published camera with its derived constants
+ */
+struct CameraSnapshot {
+    Matrix4x4 viewProjMatrix;
+    Viewport viewport;
+    Frustum frustum;
+    Vec2 center;            // viewport center in pixels
+    float halfWidth;        // NDC to pixel scale
+    float halfHeight;
+    uint64_t version;       // number of publishes so far, 0 if nothing was published
+
+    CameraSnapshot() : halfWidth(0.0f), halfHeight(0.0f), version(0) {}
+
+    bool IsValid() const { return version != 0; }
+
+    /**
+     * @brief Projects a point with the snapshot's constants
+     * @return false if the point is behind the camera or nothing was published
+     */
+    bool WorldToScreen(const Vec3& worldPos, Vec2& screenPos) const;
+
+    /**
+     * @brief Loads matrix and viewport into a transform for the batch paths
+     */
+    void ApplyTo(WorldToScreenTransform& transform) const;
+};
+
+/**
+ * @brief Seqlock-protected camera shared between one producer and many readers
+ */
+class CameraState {
+public:
+    CameraState();
+
+    CameraState(const CameraState&) = delete;
+    CameraState& operator=(const CameraState&) = delete;
+
+    /**
+     * @brief Publishes a new matrix and viewport, derived constants are recomputed
+     */
+    void Publish(const Matrix4x4& viewProjMatrix, const Viewport& viewport);
+
+    /**
+     * @brief Publishes the matrix and viewport currently set on a transform
+     */
+    void Publish(const WorldToScreenTransform& transform) {
+        Publish(transform.GetViewMatrix(), transform.GetViewport());
+    }
+
+    /**
+     * @brief Publishes a new matrix, keeping the last published viewport
+     */
+    void PublishMatrix(const Matrix4x4& viewProjMatrix);
+
+    /**
+     * @brief Publishes a new viewport, keeping the last published matrix
+     */
+    void PublishViewport(const Viewport& viewport);
+
+    /**
+     * @brief Copies the latest published state
+     *
+     * Retries while a write is in progress, spinning first and then yielding,
+     * so it waits as long as a preempted writer holds the sequence.
+     */
+    CameraSnapshot Read() const;
+
+    /**
+     * @brief Copies the latest published state in one attempt, without waiting
+     * @return false, leaving snapshot untouched, if a write was in progress
+     */
+    bool TryRead(CameraSnapshot& snapshot) const;
+
+    /**
+     * @brief Copies the state only if it changed since knownVersion
+     * @return true if snapshot was updated
+     */
+    bool ReadIfNewer(uint64_t knownVersion, CameraSnapshot& snapshot) const;
+
+    /**
+     * @brief Updates a transform if a newer camera was published
+     * @param version In: version the transform holds; out: version it holds now
+     * @return true if the transform changed
+     */
+    bool Update(WorldToScreenTransform& transform, uint64_t& version) const;
+
+    /**
+     * @brief Number of publishes so far, cheap enough to poll
+     */
+    uint64_t GetVersion() const { return m_sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+    /**
+     * @brief Everything published under one sequence number, as plain 4-byte fields
+     */
+    struct Payload {
+        float matrix[4][4];
+        int32_t width;
+        int32_t height;
+        float xOffset;
+        float yOffset;
+        float planes[Frustum::PlaneCount][4];
+        float centerX;
+        float centerY;
+        float halfWidth;
+        float halfHeight;
+    };
+
+    static constexpr size_t kWordCount = (sizeof(Payload) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    uint64_t BeginWrite();
+    void EndWrite(uint64_t sequence);
+    void StorePayload();
+    bool ReadAttempt(CameraSnapshot& snapshot, uint64_t& sequence) const;
+
+    // Even: stable, odd: write in progress; version is sequence / 2
+    alignas(64) std::atomic<uint64_t> m_sequence;
+    alignas(64) std::atomic<uint32_t> m_words[kWordCount];
+
+    // Writer-side copy, only touched while the sequence is held odd
+    Matrix4x4 m_pendingMatrix;
+    Viewport m_pendingViewport;
+};
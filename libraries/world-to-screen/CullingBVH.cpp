@@ -0,0 +1,331 @@
+/**
+ * @file CullingBVH.cpp
+ * @brief Implementation of the SAH culling BVH
+ * @author Lukas Ernst
+ */
+
+#include "CullingBVH.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+namespace {
+
+// Centroid bins per axis evaluated by the SAH
+constexpr int kSahBins = 16;
+
+// Leaves may grow up to this size when the SAH says splitting does not pay off
+constexpr uint32_t kMaxSahLeafSize = 16;
+
+// Build depth limit, bounds the traversal stack
+constexpr int kMaxDepth = 64;
+
+// Traversal stack: each pop pushes at most two children, one level deeper
+constexpr int kStackSize = 2 * kMaxDepth + 2;
+
+// Parallel traversal splits the tree into at most this many subtrees
+constexpr size_t kMaxFrontier = 256;
+
+// Smaller trees are not worth distributing
+constexpr size_t kParallelMinObjects = 4096;
+
+inline float Axis(const Vec3& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+struct TraversalEntry {
+    uint32_t node;
+    uint32_t planeMask;
+};
+
+} // namespace
+
+CullingBVH::CullingBVH(uint32_t maxLeafSize)
+    : m_maxLeafSize(std::max(1u, maxLeafSize))
+    , m_depth(0) {
+}
+
+void CullingBVH::Build(const AABB* boxes, size_t count) {
+    m_nodes.clear();
+    m_objectIndices.resize(count);
+    m_objectBounds.resize(count);
+    m_depth = 0;
+
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<Vec3> centroids(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_objectIndices[i] = static_cast<uint32_t>(i);
+        centroids[i] = boxes[i].Center();
+    }
+
+    m_nodes.reserve(2 * count);
+    BuildNode(boxes, centroids.data(), 0, static_cast<uint32_t>(count), 1);
+
+    for (size_t slot = 0; slot < count; ++slot) {
+        m_objectBounds[slot] = boxes[m_objectIndices[slot]];
+    }
+}
+
+uint32_t CullingBVH::BuildNode(const AABB* boxes, const Vec3* centroids, uint32_t first, uint32_t count, int depth) {
+    const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_depth = std::max(m_depth, depth);
+
+    AABB bounds = AABB::Empty();
+    AABB centroidBounds = AABB::Empty();
+    for (uint32_t i = first; i < first + count; ++i) {
+        bounds.Expand(boxes[m_objectIndices[i]]);
+        centroidBounds.Expand(centroids[m_objectIndices[i]]);
+    }
+
+    Node node;
+    node.minBounds = bounds.minBounds;
+    node.maxBounds = bounds.maxBounds;
+    node.firstObject = first;
+    node.objectCount = count;
+    node.rightChild = 0;
+
+    if (count <= m_maxLeafSize || depth >= kMaxDepth) {
+        m_nodes[index] = node;
+        return index;
+    }
+
+    // Binned SAH over all three axes
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    int bestSplit = 0;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        const float axisMin = Axis(centroidBounds.minBounds, axis);
+        const float extent = Axis(centroidBounds.maxBounds, axis) - axisMin;
+        if (extent <= 0.0f) {
+            continue;
+        }
+
+        AABB binBounds[kSahBins];
+        uint32_t binCount[kSahBins] = {};
+        for (int b = 0; b < kSahBins; ++b) {
+            binBounds[b] = AABB::Empty();
+        }
+
+        const float scale = kSahBins / extent;
+        for (uint32_t i = first; i < first + count; ++i) {
+            const uint32_t object = m_objectIndices[i];
+            const int bin = std::min(kSahBins - 1, static_cast<int>((Axis(centroids[object], axis) - axisMin) * scale));
+            ++binCount[bin];
+            binBounds[bin].Expand(boxes[object]);
+        }
+
+        // Sweep from the right to get the area and count of every right half
+        float rightArea[kSahBins];
+        uint32_t rightCount[kSahBins];
+        AABB accumulated = AABB::Empty();
+        uint32_t accumulatedCount = 0;
+        for (int b = kSahBins - 1; b > 0; --b) {
+            accumulated.Expand(binBounds[b]);
+            accumulatedCount += binCount[b];
+            rightArea[b] = accumulatedCount ? accumulated.SurfaceArea() : 0.0f;
+            rightCount[b] = accumulatedCount;
+        }
+
+        accumulated = AABB::Empty();
+        accumulatedCount = 0;
+        for (int split = 0; split < kSahBins - 1; ++split) {
+            accumulated.Expand(binBounds[split]);
+            accumulatedCount += binCount[split];
+            if (accumulatedCount == 0 || rightCount[split + 1] == 0) {
+                continue;
+            }
+            const float cost = accumulated.SurfaceArea() * accumulatedCount + rightArea[split + 1] * rightCount[split + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t leftCount = 0;
+    if (bestAxis >= 0) {
+        // Traversal step costs as much as one box test
+        const float area = bounds.SurfaceArea();
+        const float splitCost = 1.0f + (area > 0.0f ? bestCost / area : 0.0f);
+        if (splitCost >= static_cast<float>(count) && count <= kMaxSahLeafSize) {
+            m_nodes[index] = node;
+            return index;
+        }
+
+        const float axisMin = Axis(centroidBounds.minBounds, bestAxis);
+        const float scale = kSahBins / (Axis(centroidBounds.maxBounds, bestAxis) - axisMin);
+        uint32_t* begin = m_objectIndices.data() + first;
+        uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t object) {
+            return std::min(kSahBins - 1, static_cast<int>((Axis(centroids[object], bestAxis) - axisMin) * scale)) <= bestSplit;
+        });
+        leftCount = static_cast<uint32_t>(middle - begin);
+    }
+
+    // Coincident centroids: any split is as good as another
+    if (leftCount == 0 || leftCount == count) {
+        leftCount = count / 2;
+    }
+
+    BuildNode(boxes, centroids, first, leftCount, depth + 1);
+    node.rightChild = BuildNode(boxes, centroids, first + leftCount, count - leftCount, depth + 1);
+    m_nodes[index] = node;
+    return index;
+}
+
+void CullingBVH::Refit(const AABB* boxes) {
+    for (size_t slot = 0; slot < m_objectIndices.size(); ++slot) {
+        m_objectBounds[slot] = boxes[m_objectIndices[slot]];
+    }
+
+    // Children always follow their parent, so a reverse sweep sees them first
+    for (size_t i = m_nodes.size(); i-- > 0;) {
+        Node& node = m_nodes[i];
+        AABB bounds = AABB::Empty();
+        if (node.IsLeaf()) {
+            for (uint32_t slot = node.firstObject; slot < node.firstObject + node.objectCount; ++slot) {
+                bounds.Expand(m_objectBounds[slot]);
+            }
+        } else {
+            const Node& left = m_nodes[i + 1];
+            const Node& right = m_nodes[node.rightChild];
+            bounds = AABB(left.minBounds, left.maxBounds);
+            bounds.Expand(AABB(right.minBounds, right.maxBounds));
+        }
+        node.minBounds = bounds.minBounds;
+        node.maxBounds = bounds.maxBounds;
+    }
+}
+
+size_t CullingBVH::Traverse(const Frustum& frustum, uint32_t nodeIndex, uint32_t planeMask, uint32_t* out) const {
+    TraversalEntry stack[kStackSize];
+    int top = 0;
+    stack[top++] = { nodeIndex, planeMask };
+
+    size_t written = 0;
+    while (top > 0) {
+        const TraversalEntry entry = stack[--top];
+        const Node& node = m_nodes[entry.node];
+
+        uint32_t mask = entry.planeMask;
+        if (mask && frustum.TestAABB(node.minBounds, node.maxBounds, mask) == CullResult::Outside) {
+            continue;
+        }
+
+        if (mask == 0) {
+            // Completely inside: the whole subtree is one contiguous run of objects
+            std::memcpy(out + written, m_objectIndices.data() + node.firstObject, node.objectCount * sizeof(uint32_t));
+            written += node.objectCount;
+        } else if (node.IsLeaf()) {
+            for (uint32_t slot = node.firstObject; slot < node.firstObject + node.objectCount; ++slot) {
+                uint32_t objectMask = mask;
+                const AABB& box = m_objectBounds[slot];
+                if (frustum.TestAABB(box.minBounds, box.maxBounds, objectMask) != CullResult::Outside) {
+                    out[written++] = m_objectIndices[slot];
+                }
+            }
+        } else {
+            // Left child popped first, so output follows tree order
+            stack[top++] = { node.rightChild, mask };
+            stack[top++] = { entry.node + 1, mask };
+        }
+    }
+    return written;
+}
+
+size_t CullingBVH::Cull(const Frustum& frustum, uint32_t* visibleIndices) const {
+    if (m_nodes.empty()) {
+        return 0;
+    }
+    return Traverse(frustum, 0, Frustum::kAllPlanes, visibleIndices);
+}
+
+size_t CullingBVH::Cull(const Frustum& frustum, std::vector<uint32_t>& visibleIndices) const {
+    // Grow only; resizing down and back up would zero-fill the whole buffer every frame
+    if (visibleIndices.size() < GetObjectCount()) {
+        visibleIndices.resize(GetObjectCount());
+    }
+    return Cull(frustum, visibleIndices.data());
+}
+
+size_t CullingBVH::CullParallel(const Frustum& frustum, uint32_t* visibleIndices,
+                                VectorMath::TaskScheduler& scheduler) const {
+    const size_t threads = scheduler.GetThreadCount();
+    if (threads <= 1 || GetObjectCount() < kParallelMinObjects) {
+        return Cull(frustum, visibleIndices);
+    }
+
+    uint32_t rootMask = Frustum::kAllPlanes;
+    if (frustum.TestAABB(m_nodes[0].minBounds, m_nodes[0].maxBounds, rootMask) == CullResult::Outside) {
+        return 0;
+    }
+
+    // Expand the top of the tree breadth-first, keeping subtrees in tree order
+    TraversalEntry frontier[kMaxFrontier];
+    TraversalEntry expanded[kMaxFrontier];
+    size_t frontierCount = 1;
+    frontier[0] = { 0, rootMask };
+
+    const size_t target = std::min(kMaxFrontier / 2, threads * 8);
+    while (frontierCount < target) {
+        size_t expandedCount = 0;
+        bool changed = false;
+        for (size_t i = 0; i < frontierCount; ++i) {
+            const Node& node = m_nodes[frontier[i].node];
+            if (frontier[i].planeMask == 0 || node.IsLeaf()) {
+                expanded[expandedCount++] = frontier[i];
+                continue;
+            }
+
+            changed = true;
+            const uint32_t children[2] = { frontier[i].node + 1, node.rightChild };
+            for (uint32_t child : children) {
+                uint32_t mask = frontier[i].planeMask;
+                const Node& childNode = m_nodes[child];
+                if (frustum.TestAABB(childNode.minBounds, childNode.maxBounds, mask) != CullResult::Outside) {
+                    expanded[expandedCount++] = { child, mask };
+                }
+            }
+        }
+
+        std::copy(expanded, expanded + expandedCount, frontier);
+        frontierCount = expandedCount;
+        if (!changed) {
+            break;
+        }
+    }
+
+    // Every subtree writes at the start of its own object range, which is never
+    // smaller than what it can emit
+    size_t counts[kMaxFrontier];
+    scheduler.ParallelFor(frontierCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const TraversalEntry& entry = frontier[i];
+            counts[i] = Traverse(frustum, entry.node, entry.planeMask,
+                                 visibleIndices + m_nodes[entry.node].firstObject);
+        }
+    });
+
+    size_t written = 0;
+    for (size_t i = 0; i < frontierCount; ++i) {
+        const uint32_t first = m_nodes[frontier[i].node].firstObject;
+        if (first != written && counts[i] > 0) {
+            std::memmove(visibleIndices + written, visibleIndices + first, counts[i] * sizeof(uint32_t));
+        }
+        written += counts[i];
+    }
+    return written;
+}
+
+size_t CullingBVH::CullParallel(const Frustum& frustum, std::vector<uint32_t>& visibleIndices,
+                                VectorMath::TaskScheduler& scheduler) const {
+    if (visibleIndices.size() < GetObjectCount()) {
+        visibleIndices.resize(GetObjectCount());
+    }
+    return CullParallel(frustum, visibleIndices.data(), scheduler);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file CullingBVH.hpp
+ * @brief Bounding volume hierarchy for frustum culling of large static scenes
+ * @author Lukas Ernst
+ *
+ * Objects are given as AABBs and organized into a binary BVH built with the
+ * binned surface area heuristic. Culling walks the tree with the frustum and
+ * carries a plane mask down each path, so a child only tests the planes its
+ * parent straddled. Subtrees that end up completely inside are accepted
+ * without further tests: their objects are stored contiguously and are copied
+ * to the output in one block.
+ *
+ * Visible object indices are written in tree order, which is identical for the
+ * serial and the parallel traversal.
+ */
+
+#pragma once
+
+#include "FrustumCulling.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief SAH bounding volume hierarchy over object AABBs
+ */
+class CullingBVH {
+public:
+    /**
+     * @brief Tree node, children of an interior node are at index + 1 and rightChild
+     */
+    struct Node {
+        Vec3 minBounds;
+        uint32_t firstObject;   // subtree objects are [firstObject, firstObject + objectCount)
+        Vec3 maxBounds;
+        uint32_t objectCount;
+        uint32_t rightChild;    // 0 for leaves
+
+        bool IsLeaf() const { return rightChild == 0; }
+    };
+
+    /**
+     * @param maxLeafSize Leaves are split until they hold at most this many objects
+     *        unless the SAH prefers a larger leaf
+     */
+    explicit CullingBVH(uint32_t maxLeafSize = 4);
+
+    /**
+     * @brief Builds the tree over boxes[0..count-1], object i keeps index i
+     */
+    void Build(const AABB* boxes, size_t count);
+    void Build(const std::vector<AABB>& boxes) { Build(boxes.data(), boxes.size()); }
+
+    /**
+     * @brief Updates node bounds after objects moved, keeping the topology
+     *
+     * Cheap compared to Build, but tree quality degrades if objects move far.
+     * @param boxes Same object count and order as passed to Build
+     */
+    void Refit(const AABB* boxes);
+
+    /**
+     * @brief Writes the indices of all objects not outside the frustum
+     * @param visibleIndices Output with room for GetObjectCount() indices
+     * @return Number of indices written
+     */
+    size_t Cull(const Frustum& frustum, uint32_t* visibleIndices) const;
+
+    /**
+     * @brief Cull into a reused buffer
+     *
+     * The buffer is grown to GetObjectCount() if it is smaller and never
+     * shrunk, so steady-state frames touch only the visible entries.
+     * @return Number of visible objects; only entries [0, count) are valid
+     */
+    size_t Cull(const Frustum& frustum, std::vector<uint32_t>& visibleIndices) const;
+
+    /**
+     * @brief Cull against the view-projection matrix of a transform
+     */
+    size_t Cull(const WorldToScreenTransform& transform, std::vector<uint32_t>& visibleIndices) const {
+        return Cull(Frustum::FromTransform(transform), visibleIndices);
+    }
+
+    /**
+     * @brief Parallel traversal, same output as Cull
+     *
+     * The top of the tree is expanded on the calling thread until there are
+     * enough independent subtrees, which are then traversed by the scheduler.
+     * Each subtree writes into its own object range of the output, and the
+     * ranges are compacted afterwards.
+     */
+    size_t CullParallel(const Frustum& frustum, uint32_t* visibleIndices,
+                        VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared()) const;
+
+    /**
+     * @brief Parallel cull into a reused buffer, sized like the serial overload
+     * @return Number of visible objects; only entries [0, count) are valid
+     */
+    size_t CullParallel(const Frustum& frustum, std::vector<uint32_t>& visibleIndices,
+                        VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared()) const;
+
+    size_t CullParallel(const WorldToScreenTransform& transform, std::vector<uint32_t>& visibleIndices,
+                        VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared()) const {
+        return CullParallel(Frustum::FromTransform(transform), visibleIndices, scheduler);
+    }
+
+    size_t GetObjectCount() const { return m_objectIndices.size(); }
+    size_t GetNodeCount() const { return m_nodes.size(); }
+    const std::vector<Node>& GetNodes() const { return m_nodes; }
+
+    /**
+     * @brief Depth of the deepest leaf, the root is depth 1
+     */
+    int GetDepth() const { return m_depth; }
+
+private:
+    uint32_t BuildNode(const AABB* boxes, const Vec3* centroids, uint32_t first, uint32_t count, int depth);
+    size_t Traverse(const Frustum& frustum, uint32_t node, uint32_t planeMask, uint32_t* out) const;
+
+    uint32_t m_maxLeafSize;
+    int m_depth;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_objectIndices;  // object index per tree slot
+    std::vector<AABB> m_objectBounds;       // object bounds in tree slot order
+};
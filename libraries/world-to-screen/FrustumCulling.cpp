@@ -0,0 +1,261 @@
+/**
+ * @file FrustumCulling.cpp
+ * @brief Implementation of frustum plane extraction and culling
+ * @author Lukas Ernst
+ */
+
+#include "FrustumCulling.hpp"
+#include "ProjectionKernels.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Boxes are deinterleaved into stack blocks of this size for the AoS batch path
+constexpr size_t kCullBlock = 256;
+
+// Planes with a shorter normal than this are degenerate (e.g. infinite far plane)
+constexpr float kDegeneratePlane = 1e-12f;
+
+FrustumPlane MakePlane(float a, float b, float c, float d) {
+    const float length = std::sqrt(a * a + b * b + c * c);
+    if (length < kDegeneratePlane) {
+        // Always-inside plane
+        return FrustumPlane(Vec3(0.0f, 0.0f, 0.0f), 1.0f);
+    }
+    const float invLength = 1.0f / length;
+    return FrustumPlane(Vec3(a * invLength, b * invLength, c * invLength), d * invLength);
+}
+
+inline CullResult ClassifyCode(bool outside, bool intersect) {
+    return outside ? CullResult::Outside : (intersect ? CullResult::Intersect : CullResult::Inside);
+}
+
+/**
+ * @brief Broadcast plane constants shared by the SIMD batch loops
+ */
+struct PlaneLanes {
+    VectorMath::SIMD::FloatV nx[Frustum::PlaneCount];
+    VectorMath::SIMD::FloatV ny[Frustum::PlaneCount];
+    VectorMath::SIMD::FloatV nz[Frustum::PlaneCount];
+    VectorMath::SIMD::FloatV ax[Frustum::PlaneCount];  // absolute normal, for box extents
+    VectorMath::SIMD::FloatV ay[Frustum::PlaneCount];
+    VectorMath::SIMD::FloatV az[Frustum::PlaneCount];
+    VectorMath::SIMD::FloatV d[Frustum::PlaneCount];
+
+    explicit PlaneLanes(const Frustum& frustum) {
+        using namespace VectorMath::SIMD;
+        for (int p = 0; p < Frustum::PlaneCount; ++p) {
+            const FrustumPlane& plane = frustum.GetPlane(p);
+            nx[p] = Set1(plane.normal.x);
+            ny[p] = Set1(plane.normal.y);
+            nz[p] = Set1(plane.normal.z);
+            ax[p] = Set1(std::abs(plane.normal.x));
+            ay[p] = Set1(std::abs(plane.normal.y));
+            az[p] = Set1(std::abs(plane.normal.z));
+            d[p] = Set1(plane.d);
+        }
+    }
+};
+
+/**
+ * @brief Writes the mask bits and per-object results of one SIMD block
+ * @return Number of visible objects in the block
+ */
+size_t StoreBlockResults(uint32_t outsideBits, uint32_t intersectBits, size_t index,
+                         uint32_t* visibleMask, CullResult* results) {
+    using namespace VectorMath::SIMD;
+    const uint32_t laneMask = (kWidth == 32) ? 0xFFFFFFFFu : ((1u << kWidth) - 1u);
+    const uint32_t visibleBits = ~outsideBits & laneMask;
+
+    if (visibleMask) {
+        visibleMask[index >> 5] |= visibleBits << (index & 31);
+    }
+    if (results) {
+        for (int lane = 0; lane < kWidth; ++lane) {
+            results[index + lane] = ClassifyCode(((outsideBits >> lane) & 1u) != 0, ((intersectBits >> lane) & 1u) != 0);
+        }
+    }
+    return static_cast<size_t>(PopCount(visibleBits));
+}
+
+} // namespace
+
+Frustum::Frustum() {
+    for (int p = 0; p < PlaneCount; ++p) {
+        m_planes[p] = FrustumPlane(Vec3(0.0f, 0.0f, 0.0f), 1.0f);
+    }
+}
+
+Frustum Frustum::FromMatrix(const Matrix4x4& viewProjMatrix, ClipDepth depth) {
+    // Column vectors: clip = M * p, so each plane is a sum/difference of matrix rows
+    const float (&m)[4][4] = viewProjMatrix.m;
+    Frustum frustum;
+
+    frustum.m_planes[Left]   = MakePlane(m[3][0] + m[0][0], m[3][1] + m[0][1], m[3][2] + m[0][2], m[3][3] + m[0][3]);
+    frustum.m_planes[Right]  = MakePlane(m[3][0] - m[0][0], m[3][1] - m[0][1], m[3][2] - m[0][2], m[3][3] - m[0][3]);
+    frustum.m_planes[Bottom] = MakePlane(m[3][0] + m[1][0], m[3][1] + m[1][1], m[3][2] + m[1][2], m[3][3] + m[1][3]);
+    frustum.m_planes[Top]    = MakePlane(m[3][0] - m[1][0], m[3][1] - m[1][1], m[3][2] - m[1][2], m[3][3] - m[1][3]);
+    frustum.m_planes[Far]    = MakePlane(m[3][0] - m[2][0], m[3][1] - m[2][1], m[3][2] - m[2][2], m[3][3] - m[2][3]);
+
+    if (depth == ClipDepth::ReversedZeroToOne) {
+        // Same 0 <= z <= w volume as ZeroToOne with the roles of the two planes swapped
+        frustum.m_planes[Near] = frustum.m_planes[Far];
+        frustum.m_planes[Far] = MakePlane(m[2][0], m[2][1], m[2][2], m[2][3]);
+    } else if (depth == ClipDepth::ZeroToOne) {
+        frustum.m_planes[Near] = MakePlane(m[2][0], m[2][1], m[2][2], m[2][3]);
+    } else {
+        frustum.m_planes[Near] = MakePlane(m[3][0] + m[2][0], m[3][1] + m[2][1], m[3][2] + m[2][2], m[3][3] + m[2][3]);
+    }
+
+    return frustum;
+}
+
+bool Frustum::IsPointInside(const Vec3& point) const {
+    for (int p = 0; p < PlaneCount; ++p) {
+        if (m_planes[p].Distance(point) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CullResult Frustum::TestAABB(const Vec3& minBounds, const Vec3& maxBounds) const {
+    uint32_t planeMask = kAllPlanes;
+    return TestAABB(minBounds, maxBounds, planeMask);
+}
+
+CullResult Frustum::TestAABB(const Vec3& minBounds, const Vec3& maxBounds, uint32_t& planeMask) const {
+    const Vec3 center = (minBounds + maxBounds) * 0.5f;
+    const Vec3 extents = (maxBounds - minBounds) * 0.5f;
+
+    uint32_t straddling = 0;
+    for (int p = 0; p < PlaneCount; ++p) {
+        if (!(planeMask & (1u << p))) {
+            continue;
+        }
+
+        // Distance of the box center and projected radius of the box onto the normal;
+        // center - radius is the n-vertex, center + radius the p-vertex
+        const FrustumPlane& plane = m_planes[p];
+        const float distance = plane.Distance(center);
+        const float radius = std::abs(plane.normal.x) * extents.x +
+                             std::abs(plane.normal.y) * extents.y +
+                             std::abs(plane.normal.z) * extents.z;
+
+        if (distance < -radius) {
+            planeMask = 0;
+            return CullResult::Outside;
+        }
+        if (distance < radius) {
+            straddling |= 1u << p;
+        }
+    }
+
+    planeMask = straddling;
+    return straddling ? CullResult::Intersect : CullResult::Inside;
+}
+
+CullResult Frustum::TestSphere(const Vec3& center, float radius) const {
+    CullResult result = CullResult::Inside;
+    for (int p = 0; p < PlaneCount; ++p) {
+        const float distance = m_planes[p].Distance(center);
+        if (distance < -radius) {
+            return CullResult::Outside;
+        }
+        if (distance < radius) {
+            result = CullResult::Intersect;
+        }
+    }
+    return result;
+}
+
+size_t Frustum::CullAABBs(ConstVec3SoA boxMin, ConstVec3SoA boxMax, size_t count,
+                          uint32_t* visibleMask, CullResult* results) const {
+    static_assert(sizeof(CullResult) == sizeof(uint8_t) && static_cast<int>(CullResult::Outside) == 0 &&
+                  static_cast<int>(CullResult::Intersect) == 1 && static_cast<int>(CullResult::Inside) == 2,
+                  "the culling kernel writes CullResult values as bytes");
+
+    float planes[PlaneCount][4];
+    for (int p = 0; p < PlaneCount; ++p) {
+        planes[p][0] = m_planes[p].normal.x;
+        planes[p][1] = m_planes[p].normal.y;
+        planes[p][2] = m_planes[p].normal.z;
+        planes[p][3] = m_planes[p].d;
+    }
+
+    // Runs the ProjectionKernels build for the CPU's SIMD level
+    const ProjectionKernels::BoxStreams boxes = { boxMin.x, boxMin.y, boxMin.z, boxMax.x, boxMax.y, boxMax.z };
+    return ProjectionKernels::GetKernels().cullBoxes(&planes[0][0], boxes, count, visibleMask,
+                                                     reinterpret_cast<uint8_t*>(results));
+}
+
+size_t Frustum::CullAABBs(const AABB* boxes, size_t count, uint32_t* visibleMask, CullResult* results) const {
+    float minX[kCullBlock], minY[kCullBlock], minZ[kCullBlock];
+    float maxX[kCullBlock], maxY[kCullBlock], maxZ[kCullBlock];
+
+    size_t visibleCount = 0;
+    for (size_t base = 0; base < count; base += kCullBlock) {
+        const size_t n = std::min(kCullBlock, count - base);
+        for (size_t i = 0; i < n; ++i) {
+            minX[i] = boxes[base + i].minBounds.x;
+            minY[i] = boxes[base + i].minBounds.y;
+            minZ[i] = boxes[base + i].minBounds.z;
+            maxX[i] = boxes[base + i].maxBounds.x;
+            maxY[i] = boxes[base + i].maxBounds.y;
+            maxZ[i] = boxes[base + i].maxBounds.z;
+        }
+
+        // kCullBlock is a multiple of 32, so each block owns whole mask words
+        visibleCount += CullAABBs(ConstVec3SoA(minX, minY, minZ), ConstVec3SoA(maxX, maxY, maxZ), n,
+                                  visibleMask ? visibleMask + base / 32 : nullptr,
+                                  results ? results + base : nullptr);
+    }
+    return visibleCount;
+}
+
+size_t Frustum::CullSpheres(ConstVec3SoA centers, const float* radii, size_t count,
+                            uint32_t* visibleMask, CullResult* results) const {
+    using namespace VectorMath::SIMD;
+
+    if (visibleMask) {
+        std::memset(visibleMask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+    }
+
+    const PlaneLanes planes(*this);
+
+    size_t visibleCount = 0;
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        const FloatV cx = Load(centers.x + i), cy = Load(centers.y + i), cz = Load(centers.z + i);
+        const FloatV radius = Load(radii + i);
+        const FloatV negRadius = Sub(Set1(0.0f), radius);
+
+        MaskV outside = CmpLt(Set1(1.0f), Set1(0.0f));
+        MaskV intersect = outside;
+        for (int p = 0; p < PlaneCount; ++p) {
+            const FloatV distance = MulAdd(planes.nx[p], cx, MulAdd(planes.ny[p], cy, MulAdd(planes.nz[p], cz, planes.d[p])));
+            outside = MaskOr(outside, CmpLt(distance, negRadius));
+            intersect = MaskOr(intersect, CmpLt(distance, radius));
+        }
+
+        visibleCount += StoreBlockResults(MaskBits(outside), MaskBits(intersect), i, visibleMask, results);
+    }
+
+    for (; i < count; ++i) {
+        const CullResult result = TestSphere(Vec3(centers.x[i], centers.y[i], centers.z[i]), radii[i]);
+        if (results) {
+            results[i] = result;
+        }
+        if (result != CullResult::Outside) {
+            ++visibleCount;
+            if (visibleMask) {
+                visibleMask[i >> 5] |= 1u << (i & 31);
+            }
+        }
+    }
+
+    return visibleCount;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file FrustumCulling.hpp
+ * @brief View-frustum plane extraction and box/sphere culling
+ * @author Lukas Ernst
+ *
+ * Extracts the six clip planes from a view-projection matrix (Gribb/Hartmann)
+ * and classifies bounding volumes against them without projecting anything.
+ * Box tests use the center/extent form of the p-vertex/n-vertex test, which is
+ * conservative: a box is only rejected when it lies entirely behind one plane.
+ * Batch versions classify SoA streams of boxes or spheres with SIMD and write a
+ * visibility bitmask and optionally a per-object inside/intersect/outside result.
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Result of a frustum test
+ */
+enum class CullResult : uint8_t {
+    Outside = 0,    // completely outside at least one plane
+    Intersect = 1,  // straddles at least one plane
+    Inside = 2      // completely inside all planes
+};
+
+/**
+ * @brief Plane n . p + d = 0, positive side is inside the frustum
+ */
+struct FrustumPlane {
+    Vec3 normal;
+    float d;
+
+    FrustumPlane() : d(0.0f) {}
+    FrustumPlane(const Vec3& n, float distance) : normal(n), d(distance) {}
+
+    float Distance(const Vec3& point) const { return normal.Dot(point) + d; }
+};
+
+/**
+ * @brief Six-plane view frustum
+ */
+class Frustum {
+public:
+    enum PlaneIndex {
+        Left = 0, Right, Bottom, Top, Near, Far,
+        PlaneCount
+    };
+
+    /**
+     * @brief Clip-space depth range of the projection the planes are extracted from
+     */
+    enum class ClipDepth {
+        NegativeOneToOne,  // OpenGL style, as produced by Matrix4x4::CreatePerspective
+        ZeroToOne,         // Direct3D/Vulkan style
+        ReversedZeroToOne  // reverse-Z, 1 at the near plane, as produced by CreatePerspectiveReverseZ
+    };
+
+    // Mask with one bit per plane, used to skip planes a parent volume is already inside of
+    static constexpr uint32_t kAllPlanes = (1u << PlaneCount) - 1u;
+
+    Frustum();
+
+    /**
+     * @brief Extracts normalized planes from a column-vector view-projection matrix
+     *
+     * A far plane that degenerates (infinite far projection) is disabled.
+     */
+    static Frustum FromMatrix(const Matrix4x4& viewProjMatrix, ClipDepth depth = ClipDepth::NegativeOneToOne);
+
+    /**
+     * @brief Frustum of the view matrix currently set on a transform
+     */
+    static Frustum FromTransform(const WorldToScreenTransform& transform,
+                                 ClipDepth depth = ClipDepth::NegativeOneToOne) {
+        return FromMatrix(transform.GetViewMatrix(), depth);
+    }
+
+    const FrustumPlane& GetPlane(int index) const { return m_planes[index]; }
+    void SetPlane(int index, const FrustumPlane& plane) { m_planes[index] = plane; }
+
+    bool IsPointInside(const Vec3& point) const;
+
+    /**
+     * @brief Classifies an axis-aligned box
+     */
+    CullResult TestAABB(const Vec3& minBounds, const Vec3& maxBounds) const;
+    CullResult TestAABB(const AABB& box) const { return TestAABB(box.minBounds, box.maxBounds); }
+
+    /**
+     * @brief Classifies a box against a subset of planes
+     * @param planeMask In: planes to test; out: planes the box straddles (children
+     *        of a box only need to test these)
+     */
+    CullResult TestAABB(const Vec3& minBounds, const Vec3& maxBounds, uint32_t& planeMask) const;
+
+    /**
+     * @brief Classifies a sphere
+     */
+    CullResult TestSphere(const Vec3& center, float radius) const;
+
+    bool IsAABBVisible(const Vec3& minBounds, const Vec3& maxBounds) const {
+        return TestAABB(minBounds, maxBounds) != CullResult::Outside;
+    }
+
+    bool IsSphereVisible(const Vec3& center, float radius) const {
+        return TestSphere(center, radius) != CullResult::Outside;
+    }
+
+    /**
+     * @brief SIMD classification of many boxes stored as SoA min/max streams
+     * @param visibleMask Output, (count + 31) / 32 words, bit i set if box i is not outside; may be null
+     * @param results Output per-box classification; may be null
+     * @return Number of boxes not outside
+     */
+    size_t CullAABBs(ConstVec3SoA boxMin, ConstVec3SoA boxMax, size_t count,
+                     uint32_t* visibleMask, CullResult* results = nullptr) const;
+
+    /**
+     * @brief AoS variant of CullAABBs
+     */
+    size_t CullAABBs(const AABB* boxes, size_t count, uint32_t* visibleMask, CullResult* results = nullptr) const;
+
+    /**
+     * @brief SIMD classification of many spheres
+     */
+    size_t CullSpheres(ConstVec3SoA centers, const float* radii, size_t count,
+                       uint32_t* visibleMask, CullResult* results = nullptr) const;
+
+private:
+    FrustumPlane m_planes[PlaneCount];
+};
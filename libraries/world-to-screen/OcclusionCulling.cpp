@@ -0,0 +1,430 @@
+/**
+ * @file OcclusionCulling.cpp
+ * @brief Implementation of the tiled software occlusion buffer
+ * @author Lukas Ernst
+ */
+
+#include "OcclusionCulling.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Pixel centers relative to the first pixel of a SIMD block
+alignas(64) const float kLaneOffsets[16] = {
+    0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f,
+    8.5f, 9.5f, 10.5f, 11.5f, 12.5f, 13.5f, 14.5f, 15.5f
+};
+
+// Pyramid levels that fit inside one tile and are reduced by the tile's job
+constexpr int kTileLevels = 5;  // log2(OcclusionBuffer::kTileSize)
+
+// Boxes per parallel chunk, a multiple of 32 so chunks own whole mask words
+constexpr size_t kTestGrain = 1024;
+
+// Vertices closer than this in clip w are treated as touching the camera plane
+constexpr float kMinClipW = 1e-6f;
+
+// Pixel column/row of a coordinate, clamped to [-1, size] (NaN to -1) before the integer conversion
+int ToPixel(float value, int size) {
+    return static_cast<int>(std::floor(std::min(static_cast<float>(size), std::max(-1.0f, value))));
+}
+
+int RoundUpToTile(int value) {
+    return (value + OcclusionBuffer::kTileSize - 1) / OcclusionBuffer::kTileSize * OcclusionBuffer::kTileSize;
+}
+
+} // namespace
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+    : m_width(0)
+    , m_height(0)
+    , m_stride(0)
+    , m_paddedHeight(0)
+    , m_tilesX(0)
+    , m_tilesY(0)
+    , m_rasterized(false) {
+    Resize(width, height);
+}
+
+void OcclusionBuffer::Resize(int width, int height) {
+    m_width = std::max(1, width);
+    m_height = std::max(1, height);
+    m_stride = RoundUpToTile(m_width);
+    m_paddedHeight = RoundUpToTile(m_height);
+    m_tilesX = m_stride / kTileSize;
+    m_tilesY = m_paddedHeight / kTileSize;
+
+    m_depth.assign(static_cast<size_t>(m_stride) * m_paddedHeight, FLT_MAX);
+    m_tileBins.assign(static_cast<size_t>(m_tilesX) * m_tilesY, std::vector<uint32_t>());
+    m_triangles.clear();
+    m_rasterized = false;
+
+    m_levelWidth.assign(1, m_stride);
+    m_levelHeight.assign(1, m_paddedHeight);
+    while (m_levelWidth.back() > 1 || m_levelHeight.back() > 1) {
+        m_levelWidth.push_back((m_levelWidth.back() + 1) / 2);
+        m_levelHeight.push_back((m_levelHeight.back() + 1) / 2);
+    }
+
+    m_minLevels.assign(m_levelWidth.size(), std::vector<float>());
+    m_maxLevels.assign(m_levelWidth.size(), std::vector<float>());
+    for (size_t level = 1; level < m_levelWidth.size(); ++level) {
+        const size_t size = static_cast<size_t>(m_levelWidth[level]) * m_levelHeight[level];
+        m_minLevels[level].assign(size, FLT_MAX);
+        m_maxLevels[level].assign(size, FLT_MAX);
+    }
+}
+
+void OcclusionBuffer::BeginFrame(const Matrix4x4& viewProjMatrix, bool reverseZ) {
+    m_viewProjMatrix = viewProjMatrix;
+    if (reverseZ) {
+        // -z turns 1..0 into -1..0: smaller is nearer again and the near plane
+        // is still z + w >= 0, so clipping, rasterization and tests stay as they are
+        for (int j = 0; j < 4; ++j) {
+            m_viewProjMatrix.m[2][j] = -m_viewProjMatrix.m[2][j];
+        }
+    }
+    m_triangles.clear();
+    m_rasterized = false;
+}
+
+void OcclusionBuffer::AddOccluder(const Vec3* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+    const float (&m)[4][4] = m_viewProjMatrix.m;
+    m_clipVertices.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const Vec3& p = vertices[i];
+        ClipVertex& v = m_clipVertices[i];
+        v.x = m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3];
+        v.y = m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3];
+        v.z = m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3];
+        v.w = m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3];
+    }
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        AddClippedTriangle(m_clipVertices[indices[i]], m_clipVertices[indices[i + 1]], m_clipVertices[indices[i + 2]]);
+    }
+}
+
+void OcclusionBuffer::AddOccluder(const AABB& box) {
+    static const uint32_t kBoxIndices[36] = {
+        0, 1, 3, 0, 3, 2,   // -x
+        4, 6, 7, 4, 7, 5,   // +x
+        0, 4, 5, 0, 5, 1,   // -y
+        2, 3, 7, 2, 7, 6,   // +y
+        0, 2, 6, 0, 6, 4,   // -z
+        1, 5, 7, 1, 7, 3    // +z
+    };
+
+    // Corner i has max x for bit 2, max y for bit 1, max z for bit 0
+    Vec3 corners[8];
+    for (int i = 0; i < 8; ++i) {
+        corners[i] = Vec3((i & 4) ? box.maxBounds.x : box.minBounds.x,
+                          (i & 2) ? box.maxBounds.y : box.minBounds.y,
+                          (i & 1) ? box.maxBounds.z : box.minBounds.z);
+    }
+    AddOccluder(corners, 8, kBoxIndices, 36);
+}
+
+void OcclusionBuffer::AddClippedTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2) {
+    // Near plane for -1..1 clip depth: z + w >= 0
+    const ClipVertex input[3] = { v0, v1, v2 };
+    const float distance[3] = { v0.z + v0.w, v1.z + v1.w, v2.z + v2.w };
+
+    if (distance[0] >= 0.0f && distance[1] >= 0.0f && distance[2] >= 0.0f) {
+        SetupTriangle(v0, v1, v2);
+        return;
+    }
+    if (distance[0] < 0.0f && distance[1] < 0.0f && distance[2] < 0.0f) {
+        return;
+    }
+
+    // Sutherland-Hodgman against one plane yields at most four vertices
+    ClipVertex polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        if (distance[i] >= 0.0f) {
+            polygon[count++] = input[i];
+        }
+        if ((distance[i] >= 0.0f) != (distance[j] >= 0.0f)) {
+            const float t = distance[i] / (distance[i] - distance[j]);
+            ClipVertex v;
+            v.x = input[i].x + (input[j].x - input[i].x) * t;
+            v.y = input[i].y + (input[j].y - input[i].y) * t;
+            v.z = input[i].z + (input[j].z - input[i].z) * t;
+            v.w = input[i].w + (input[j].w - input[i].w) * t;
+            polygon[count++] = v;
+        }
+    }
+
+    for (int i = 1; i + 1 < count; ++i) {
+        SetupTriangle(polygon[0], polygon[i], polygon[i + 1]);
+    }
+}
+
+void OcclusionBuffer::SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2) {
+    const ClipVertex* clip[3] = { &v0, &v1, &v2 };
+    float x[3], y[3], z[3];
+    for (int i = 0; i < 3; ++i) {
+        if (clip[i]->w < kMinClipW) {
+            return;
+        }
+        const float invW = 1.0f / clip[i]->w;
+        x[i] = (clip[i]->x * invW * 0.5f + 0.5f) * m_width;
+        y[i] = (0.5f - clip[i]->y * invW * 0.5f) * m_height;
+        z[i] = clip[i]->z * invW;
+    }
+
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (std::abs(area) < 1e-8f) {
+        return;
+    }
+
+    ScreenTriangle triangle;
+    triangle.minX = std::max(0, ToPixel(std::min({ x[0], x[1], x[2] }), m_width));
+    triangle.minY = std::max(0, ToPixel(std::min({ y[0], y[1], y[2] }), m_height));
+    triangle.maxX = std::min(m_width - 1, ToPixel(std::max({ x[0], x[1], x[2] }), m_width));
+    triangle.maxY = std::min(m_height - 1, ToPixel(std::max({ y[0], y[1], y[2] }), m_height));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return;
+    }
+
+    // Edge functions, oriented so the interior is positive
+    const float orientation = area > 0.0f ? 1.0f : -1.0f;
+    for (int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        triangle.edgeA[i] = (y[i] - y[j]) * orientation;
+        triangle.edgeB[i] = (x[j] - x[i]) * orientation;
+        triangle.edgeC[i] = (x[i] * y[j] - x[j] * y[i]) * orientation;
+    }
+
+    // Depth plane, pushed back by the largest change within half a pixel
+    const float invArea = 1.0f / area;
+    triangle.depthDx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+    triangle.depthDy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea;
+    triangle.depthC = z[0] - triangle.depthDx * x[0] - triangle.depthDy * y[0] +
+                      0.5f * (std::abs(triangle.depthDx) + std::abs(triangle.depthDy));
+    triangle.depthMax = std::max({ z[0], z[1], z[2] });
+
+    m_triangles.push_back(triangle);
+}
+
+void OcclusionBuffer::Rasterize(VectorMath::TaskScheduler& scheduler) {
+    for (std::vector<uint32_t>& bin : m_tileBins) {
+        bin.clear();
+    }
+    for (size_t t = 0; t < m_triangles.size(); ++t) {
+        const ScreenTriangle& triangle = m_triangles[t];
+        for (int ty = triangle.minY / kTileSize; ty <= triangle.maxY / kTileSize; ++ty) {
+            for (int tx = triangle.minX / kTileSize; tx <= triangle.maxX / kTileSize; ++tx) {
+                m_tileBins[static_cast<size_t>(ty) * m_tilesX + tx].push_back(static_cast<uint32_t>(t));
+            }
+        }
+    }
+
+    // Tiles are independent, including the pyramid levels that fit inside them
+    const int tileLevels = std::min(kTileLevels, GetLevelCount() - 1);
+    scheduler.ParallelFor(m_tileBins.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; ++tile) {
+            const int tileX = static_cast<int>(tile % m_tilesX);
+            const int tileY = static_cast<int>(tile / m_tilesX);
+            RasterizeTile(tileX, tileY);
+            for (int level = 1; level <= tileLevels; ++level) {
+                const int size = kTileSize >> level;
+                ReduceLevel(level, tileX * size, tileY * size, (tileX + 1) * size, (tileY + 1) * size);
+            }
+        }
+    });
+
+    for (int level = tileLevels + 1; level < GetLevelCount(); ++level) {
+        ReduceLevel(level, 0, 0, m_levelWidth[level], m_levelHeight[level]);
+    }
+
+    m_rasterized = true;
+}
+
+void OcclusionBuffer::RasterizeTile(int tileX, int tileY) {
+    using namespace VectorMath::SIMD;
+
+    const int x0 = tileX * kTileSize;
+    const int y0 = tileY * kTileSize;
+    for (int y = y0; y < y0 + kTileSize; ++y) {
+        std::fill_n(m_depth.data() + static_cast<size_t>(y) * m_stride + x0, kTileSize, FLT_MAX);
+    }
+
+    const FloatV laneOffsets = Load(kLaneOffsets);
+    const FloatV zero = Set1(0.0f);
+
+    for (uint32_t t : m_tileBins[static_cast<size_t>(tileY) * m_tilesX + tileX]) {
+        const ScreenTriangle& triangle = m_triangles[t];
+        const int startX = std::max(triangle.minX, x0) & ~(kWidth - 1);
+        const int endX = std::min(triangle.maxX, x0 + kTileSize - 1);
+        const int startY = std::max(triangle.minY, y0);
+        const int endY = std::min(triangle.maxY, y0 + kTileSize - 1);
+
+        const FloatV a0 = Set1(triangle.edgeA[0]), a1 = Set1(triangle.edgeA[1]), a2 = Set1(triangle.edgeA[2]);
+        const FloatV depthDx = Set1(triangle.depthDx);
+        const FloatV depthMax = Set1(triangle.depthMax);
+
+        for (int y = startY; y <= endY; ++y) {
+            const float centerY = static_cast<float>(y) + 0.5f;
+            const FloatV row0 = Set1(triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+            const FloatV row1 = Set1(triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+            const FloatV row2 = Set1(triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+            const FloatV rowDepth = Set1(triangle.depthDy * centerY + triangle.depthC);
+            float* depthRow = m_depth.data() + static_cast<size_t>(y) * m_stride;
+
+            for (int x = startX; x <= endX; x += kWidth) {
+                const FloatV centerX = Add(Set1(static_cast<float>(x)), laneOffsets);
+                const MaskV inside = MaskAnd(MaskAnd(CmpGe(MulAdd(a0, centerX, row0), zero),
+                                                     CmpGe(MulAdd(a1, centerX, row1), zero)),
+                                             CmpGe(MulAdd(a2, centerX, row2), zero));
+                if (MaskBits(inside) == 0) {
+                    continue;
+                }
+                const FloatV depth = Min(MulAdd(depthDx, centerX, rowDepth), depthMax);
+                const FloatV current = Load(depthRow + x);
+                Store(depthRow + x, Select(inside, Min(current, depth), current));
+            }
+        }
+    }
+}
+
+void OcclusionBuffer::ReduceLevel(int level, int x0, int y0, int x1, int y1) {
+    const int sourceWidth = m_levelWidth[level - 1];
+    const int sourceHeight = m_levelHeight[level - 1];
+    const float* sourceMin = LevelMin(level - 1);
+    const float* sourceMax = LevelMax(level - 1);
+    float* targetMin = m_minLevels[level].data();
+    float* targetMax = m_maxLevels[level].data();
+    const int targetWidth = m_levelWidth[level];
+
+    for (int y = y0; y < y1; ++y) {
+        const size_t row0 = static_cast<size_t>(2 * y) * sourceWidth;
+        const size_t row1 = static_cast<size_t>(std::min(2 * y + 1, sourceHeight - 1)) * sourceWidth;
+        for (int x = x0; x < x1; ++x) {
+            const int sx0 = 2 * x;
+            const int sx1 = std::min(2 * x + 1, sourceWidth - 1);
+            const size_t target = static_cast<size_t>(y) * targetWidth + x;
+            targetMin[target] = std::min(std::min(sourceMin[row0 + sx0], sourceMin[row0 + sx1]),
+                                         std::min(sourceMin[row1 + sx0], sourceMin[row1 + sx1]));
+            targetMax[target] = std::max(std::max(sourceMax[row0 + sx0], sourceMax[row0 + sx1]),
+                                         std::max(sourceMax[row1 + sx0], sourceMax[row1 + sx1]));
+        }
+    }
+}
+
+const float* OcclusionBuffer::LevelMin(int level) const {
+    return level == 0 ? m_depth.data() : m_minLevels[level].data();
+}
+
+const float* OcclusionBuffer::LevelMax(int level) const {
+    return level == 0 ? m_depth.data() : m_maxLevels[level].data();
+}
+
+float OcclusionBuffer::GetMaxDepth(int level, int x, int y) const {
+    return LevelMax(level)[static_cast<size_t>(y) * m_levelWidth[level] + x];
+}
+
+bool OcclusionBuffer::IsAABBVisible(const Vec3& minBounds, const Vec3& maxBounds) const {
+    if (!m_rasterized || m_triangles.empty()) {
+        return true;
+    }
+
+    const float (&m)[4][4] = m_viewProjMatrix.m;
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float nearestDepth = FLT_MAX;
+    for (int i = 0; i < 8; ++i) {
+        const float px = (i & 4) ? maxBounds.x : minBounds.x;
+        const float py = (i & 2) ? maxBounds.y : minBounds.y;
+        const float pz = (i & 1) ? maxBounds.z : minBounds.z;
+        const float w = m[3][0] * px + m[3][1] * py + m[3][2] * pz + m[3][3];
+        const float z = m[2][0] * px + m[2][1] * py + m[2][2] * pz + m[2][3];
+        if (w < kMinClipW || z + w < 0.0f) {
+            return true;
+        }
+        const float invW = 1.0f / w;
+        const float sx = ((m[0][0] * px + m[0][1] * py + m[0][2] * pz + m[0][3]) * invW * 0.5f + 0.5f) * m_width;
+        const float sy = (0.5f - (m[1][0] * px + m[1][1] * py + m[1][2] * pz + m[1][3]) * invW * 0.5f) * m_height;
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        nearestDepth = std::min(nearestDepth, z * invW);
+    }
+
+    const int x0 = std::max(0, ToPixel(minX, m_width));
+    const int y0 = std::max(0, ToPixel(minY, m_height));
+    const int x1 = std::min(m_width - 1, ToPixel(maxX, m_width));
+    const int y1 = std::min(m_height - 1, ToPixel(maxY, m_height));
+    if (x0 > x1 || y0 > y1) {
+        return true;
+    }
+
+    // Coarsest level on which the rectangle spans at most 4x4 texels
+    const int topLevel = GetLevelCount() - 1;
+    int level = 0;
+    while (level < topLevel && (std::max(x1 - x0, y1 - y0) >> level) > 3) {
+        ++level;
+    }
+
+    // Cheap accept: in front of everything drawn around the box, read from 2x2 texels higher up
+    const int acceptLevel = std::min(level + 2, topLevel);
+    const float* minLevel = LevelMin(acceptLevel);
+    float regionMin = FLT_MAX;
+    for (int y = y0 >> acceptLevel; y <= y1 >> acceptLevel; ++y) {
+        for (int x = x0 >> acceptLevel; x <= x1 >> acceptLevel; ++x) {
+            regionMin = std::min(regionMin, minLevel[static_cast<size_t>(y) * m_levelWidth[acceptLevel] + x]);
+        }
+    }
+    if (nearestDepth <= regionMin) {
+        return true;
+    }
+
+    const float* maxLevel = LevelMax(level);
+    for (int y = y0 >> level; y <= y1 >> level; ++y) {
+        for (int x = x0 >> level; x <= x1 >> level; ++x) {
+            if (nearestDepth <= maxLevel[static_cast<size_t>(y) * m_levelWidth[level] + x]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t OcclusionBuffer::CullAABBs(const AABB* boxes, size_t count, uint32_t* visibleMask,
+                                  VectorMath::TaskScheduler& scheduler) const {
+    std::atomic<size_t> visibleCount(0);
+    scheduler.ParallelFor(count, kTestGrain, [&](size_t begin, size_t end) {
+        size_t chunkVisible = 0;
+        for (size_t word = begin; word < end; word += 32) {
+            uint32_t bits = 0;
+            const size_t wordEnd = std::min(word + 32, end);
+            for (size_t i = word; i < wordEnd; ++i) {
+                if (IsAABBVisible(boxes[i].minBounds, boxes[i].maxBounds)) {
+                    bits |= 1u << (i - word);
+                    ++chunkVisible;
+                }
+            }
+            visibleMask[word >> 5] = bits;
+        }
+        visibleCount.fetch_add(chunkVisible, std::memory_order_relaxed);
+    });
+    return visibleCount.load();
+}
+
+size_t OcclusionBuffer::FilterVisible(const AABB* boxes, uint32_t* indices, size_t count) const {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const AABB& box = boxes[indices[i]];
+        if (IsAABBVisible(box.minBounds, box.maxBounds)) {
+            indices[kept++] = indices[i];
+        }
+    }
+    return kept;
+}
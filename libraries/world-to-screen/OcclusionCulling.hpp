@@ -0,0 +1,163 @@
+/**
+ * @file OcclusionCulling.hpp
+ * @brief Software depth buffer for occlusion culling on the CPU
+ * @author Lukas Ernst
+ *
+ * A small set of large occluder triangles is rasterized into a low-resolution
+ * depth buffer (256x128 by default). The buffer is split into 32x32 pixel tiles:
+ * triangles are binned per tile and every tile is rasterized independently with
+ * SIMD across pixels of a row, so tiles run in parallel on the TaskScheduler.
+ * A min/max depth pyramid is then built on top of the buffer.
+ *
+ * Candidates are tested by projecting their AABB to a screen rectangle and its
+ * nearest depth, and comparing against the coarsest pyramid level that covers
+ * the rectangle with a few texels. A box is only reported occluded when its
+ * nearest point is behind the farthest occluder depth over its whole screen
+ * rectangle; occluder coverage is sampled at pixel centers, so the test is
+ * conservative down to the buffer resolution.
+ *
+ * Depth is NDC z of the column-vector view-projection matrix used everywhere
+ * else (-1 near, 1 far for Matrix4x4::CreatePerspective). Reverse-Z matrices
+ * are stored negated (-1 near, 0 far), so smaller is nearer either way and
+ * the far range keeps the precision of floats close to 0. Occluder depth is
+ * rounded away from the camera by up to half a pixel of slope, so occluders
+ * never appear nearer than they are.
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Tiled software depth buffer with a hierarchical min/max pyramid
+ */
+class OcclusionBuffer {
+public:
+    static constexpr int kTileSize = 32;
+
+    /**
+     * @param width Buffer width in pixels (the viewport is scaled to it)
+     * @param height Buffer height in pixels
+     */
+    explicit OcclusionBuffer(int width = 256, int height = 128);
+
+    /**
+     * @brief Changes the resolution, occluders and depth are cleared
+     */
+    void Resize(int width, int height);
+
+    /**
+     * @brief Sets the view-projection matrix and drops all queued occluders
+     * @param reverseZ The matrix maps the near plane to depth 1 and far to 0,
+     *        e.g. Matrix4x4::CreatePerspectiveReverseZ
+     */
+    void BeginFrame(const Matrix4x4& viewProjMatrix, bool reverseZ = false);
+
+    /**
+     * @brief Queues an indexed triangle mesh as occluder
+     *
+     * Triangles are transformed, clipped against the near plane and set up for
+     * rasterization immediately. Winding does not matter.
+     */
+    void AddOccluder(const Vec3* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+
+    /**
+     * @brief Queues the twelve triangles of a solid box
+     */
+    void AddOccluder(const AABB& box);
+
+    /**
+     * @brief Rasterizes all queued occluders and builds the depth pyramid
+     */
+    void Rasterize(VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    /**
+     * @brief True unless the box is certainly hidden behind rasterized occluders
+     *
+     * Boxes touching the near plane or lying off-screen are reported visible;
+     * rejecting those is the frustum test's job.
+     */
+    bool IsAABBVisible(const Vec3& minBounds, const Vec3& maxBounds) const;
+    bool IsAABBVisible(const AABB& box) const { return IsAABBVisible(box.minBounds, box.maxBounds); }
+
+    /**
+     * @brief Tests many boxes in parallel
+     * @param visibleMask Output, (count + 31) / 32 words, bit i set if box i is not occluded
+     * @return Number of boxes not occluded
+     */
+    size_t CullAABBs(const AABB* boxes, size_t count, uint32_t* visibleMask,
+                     VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared()) const;
+
+    /**
+     * @brief Removes occluded objects from a list of object indices, e.g. CullingBVH output
+     * @param boxes Bounds of all objects, indexed by the entries of indices
+     * @return Number of indices kept at the front of the list, in their original order
+     */
+    size_t FilterVisible(const AABB* boxes, uint32_t* indices, size_t count) const;
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    size_t GetOccluderTriangleCount() const { return m_triangles.size(); }
+    int GetLevelCount() const { return static_cast<int>(m_levelWidth.size()); }
+
+    /**
+     * @brief Rasterized depth of a pixel, FLT_MAX where no occluder was drawn
+     *
+     * Negated NDC depth when the frame was begun with reverseZ.
+     */
+    float GetDepth(int x, int y) const { return m_depth[static_cast<size_t>(y) * m_stride + x]; }
+
+    /**
+     * @brief Farthest occluder depth of a pyramid texel (level 0 is the buffer itself)
+     */
+    float GetMaxDepth(int level, int x, int y) const;
+
+private:
+    /**
+     * @brief Triangle in buffer pixel space with edge and depth plane equations
+     */
+    struct ScreenTriangle {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        float depthDx;
+        float depthDy;
+        float depthC;
+        float depthMax;
+        int minX, minY, maxX, maxY;
+    };
+
+    struct ClipVertex {
+        float x, y, z, w;
+    };
+
+    void AddClippedTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+    void SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+    void RasterizeTile(int tileX, int tileY);
+    void ReduceLevel(int level, int x0, int y0, int x1, int y1);
+    const float* LevelMin(int level) const;
+    const float* LevelMax(int level) const;
+
+    int m_width;
+    int m_height;
+    int m_stride;           // padded to whole tiles
+    int m_paddedHeight;
+    int m_tilesX;
+    int m_tilesY;
+    Matrix4x4 m_viewProjMatrix;
+    bool m_rasterized;
+
+    std::vector<float> m_depth;
+    std::vector<ScreenTriangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_tileBins;
+    std::vector<ClipVertex> m_clipVertices;
+
+    // Pyramid levels 1..n; level 0 is m_depth for both min and max
+    std::vector<std::vector<float>> m_minLevels;
+    std::vector<std::vector<float>> m_maxLevels;
+    std::vector<int> m_levelWidth;
+    std::vector<int> m_levelHeight;
+};
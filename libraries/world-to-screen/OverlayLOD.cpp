@@ -0,0 +1,354 @@
+/**
+ * @file OverlayLOD.cpp
+ * @brief Implementation of batch LOD selection and label decluttering
+ * @author Lukas Ernst
+ */
+
+#include "OverlayLOD.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Entities per parallel chunk
+constexpr size_t kSelectGrain = 4096;
+
+constexpr float kMinProjectionW = 0.001f;
+
+/**
+ * @brief Per-call constants of the LOD kernel
+ */
+struct LODConstants {
+    const float (*screen)[4];   // rows of the screen matrix
+    float pixelScale;           // pixels per world unit at w = 1
+    float left, right, top, bottom;
+    float maxDistance;
+    const float* thresholds;
+    int thresholdCount;
+};
+
+struct LODOutput {
+    float* screenX;
+    float* screenY;
+    float* screenRadius;
+    float* depth;
+    uint8_t* levels;
+};
+
+void SelectLevels(const LODConstants& c, const float* xs, const float* ys, const float* zs, const float* radii,
+                  size_t begin, size_t end, const LODOutput& out) {
+    using namespace VectorMath::SIMD;
+
+    const float (&m)[4] = c.screen[0];
+    const FloatV m00 = Set1(m[0]), m01 = Set1(m[1]), m02 = Set1(m[2]), m03 = Set1(m[3]);
+    const FloatV m10 = Set1(c.screen[1][0]), m11 = Set1(c.screen[1][1]);
+    const FloatV m12 = Set1(c.screen[1][2]), m13 = Set1(c.screen[1][3]);
+    const FloatV m30 = Set1(c.screen[3][0]), m31 = Set1(c.screen[3][1]);
+    const FloatV m32 = Set1(c.screen[3][2]), m33 = Set1(c.screen[3][3]);
+    const FloatV minW = Set1(kMinProjectionW), maxW = Set1(c.maxDistance);
+    const FloatV zero = Set1(0.0f), one = Set1(1.0f), invalid = Set1(-1.0f);
+    const FloatV pixelScale = Set1(c.pixelScale);
+    const FloatV leftV = Set1(c.left), rightV = Set1(c.right), topV = Set1(c.top), bottomV = Set1(c.bottom);
+
+    FloatV thresholds[OverlayLOD::kMaxLevels];
+    for (int k = 0; k < c.thresholdCount; ++k) {
+        thresholds[k] = Set1(c.thresholds[k]);
+    }
+
+    alignas(64) float levels[kWidth];
+    size_t i = begin;
+    for (; i + kWidth <= end; i += kWidth) {
+        const FloatV x = Load(xs + i);
+        const FloatV y = Load(ys + i);
+        const FloatV z = Load(zs + i);
+
+        const FloatV clipX = MulAdd(m00, x, MulAdd(m01, y, MulAdd(m02, z, m03)));
+        const FloatV clipY = MulAdd(m10, x, MulAdd(m11, y, MulAdd(m12, z, m13)));
+        const FloatV w = MulAdd(m30, x, MulAdd(m31, y, MulAdd(m32, z, m33)));
+
+        const MaskV inFront = CmpGe(w, minW);
+        const FloatV invW = Rcp(Select(inFront, w, one));
+        const FloatV sx = Mul(clipX, invW);
+        const FloatV sy = Mul(clipY, invW);
+        const FloatV radius = Select(inFront, Mul(Mul(Load(radii + i), pixelScale), invW), zero);
+
+        // Sphere's screen square overlaps the viewport and is within range
+        const MaskV onScreen = MaskAnd(MaskAnd(CmpGe(Add(sx, radius), leftV), CmpLt(Sub(sx, radius), rightV)),
+                                       MaskAnd(CmpGe(Add(sy, radius), topV), CmpLt(Sub(sy, radius), bottomV)));
+        const MaskV candidate = MaskAnd(MaskAnd(inFront, CmpLe(w, maxW)), onScreen);
+
+        FloatV level = zero;
+        for (int k = 0; k < c.thresholdCount; ++k) {
+            level = Add(level, Select(CmpGe(radius, thresholds[k]), one, zero));
+        }
+
+        Store(out.screenX + i, Select(inFront, sx, invalid));
+        Store(out.screenY + i, Select(inFront, sy, invalid));
+        Store(out.screenRadius + i, radius);
+        Store(out.depth + i, Select(inFront, w, invalid));
+        Store(levels, Select(candidate, level, zero));
+        for (int lane = 0; lane < kWidth; ++lane) {
+            out.levels[i + lane] = static_cast<uint8_t>(levels[lane]);
+        }
+    }
+
+    for (; i < end; ++i) {
+        const float w = c.screen[3][0] * xs[i] + c.screen[3][1] * ys[i] + c.screen[3][2] * zs[i] + c.screen[3][3];
+        if (!(w >= kMinProjectionW)) {
+            out.screenX[i] = -1.0f;
+            out.screenY[i] = -1.0f;
+            out.screenRadius[i] = 0.0f;
+            out.depth[i] = -1.0f;
+            out.levels[i] = 0;
+            continue;
+        }
+        const float invW = 1.0f / w;
+        const float sx = (m[0] * xs[i] + m[1] * ys[i] + m[2] * zs[i] + m[3]) * invW;
+        const float sy = (c.screen[1][0] * xs[i] + c.screen[1][1] * ys[i] + c.screen[1][2] * zs[i] +
+                          c.screen[1][3]) * invW;
+        const float radius = radii[i] * c.pixelScale * invW;
+
+        uint8_t level = 0;
+        if (w <= c.maxDistance && sx + radius >= c.left && sx - radius < c.right &&
+            sy + radius >= c.top && sy - radius < c.bottom) {
+            while (level < c.thresholdCount && radius >= c.thresholds[level]) {
+                ++level;
+            }
+        }
+        out.screenX[i] = sx;
+        out.screenY[i] = sy;
+        out.screenRadius[i] = radius;
+        out.depth[i] = w;
+        out.levels[i] = level;
+    }
+}
+
+} // namespace
+
+OverlayLOD::OverlayLOD()
+    : m_thresholdCount(0)
+    , m_maxDistance(FLT_MAX)
+    , m_count(0) {
+    const float defaults[2] = { 0.5f, 4.0f };
+    SetLevels(defaults, 2);
+}
+
+void OverlayLOD::SetLevels(const float* minRadius, int thresholdCount) {
+    m_thresholdCount = std::min(kMaxLevels, std::max(1, thresholdCount));
+    for (int k = 0; k < m_thresholdCount; ++k) {
+        m_thresholds[k] = k < thresholdCount ? minRadius[k] : 0.0f;
+    }
+    std::sort(m_thresholds, m_thresholds + m_thresholdCount);
+}
+
+size_t OverlayLOD::Select(const WorldToScreenTransform& transform, ConstVec3SoA centers, const float* radii,
+                          size_t count, VectorMath::TaskScheduler& scheduler) {
+    m_count = count;
+    m_screenX.resize(count);
+    m_screenY.resize(count);
+    m_screenRadius.resize(count);
+    m_depth.resize(count);
+    m_levels.resize(count);
+    for (std::vector<uint32_t>& bucket : m_buckets) {
+        bucket.clear();
+    }
+
+    if (!transform.IsMatrixValid()) {
+        std::fill(m_screenX.begin(), m_screenX.end(), -1.0f);
+        std::fill(m_screenY.begin(), m_screenY.end(), -1.0f);
+        std::fill(m_screenRadius.begin(), m_screenRadius.end(), 0.0f);
+        std::fill(m_depth.begin(), m_depth.end(), -1.0f);
+        std::fill(m_levels.begin(), m_levels.end(), uint8_t(0));
+        m_buckets[0].resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_buckets[0][i] = static_cast<uint32_t>(i);
+        }
+        return 0;
+    }
+
+    // Pixels per world unit at w = 1 along screen x and y; the larger one keeps
+    // the radius conservative under non-square pixels
+    const Matrix4x4& viewProj = transform.GetViewMatrix();
+    const Viewport& viewport = transform.GetViewport();
+    auto rowLength = [&](int row) {
+        return std::sqrt(viewProj.m[row][0] * viewProj.m[row][0] + viewProj.m[row][1] * viewProj.m[row][1] +
+                         viewProj.m[row][2] * viewProj.m[row][2]);
+    };
+
+    LODConstants constants;
+    constants.screen = transform.GetScreenMatrix().m;
+    constants.pixelScale = std::max(0.5f * viewport.width * rowLength(0), 0.5f * viewport.height * rowLength(1));
+    constants.left = viewport.x_offset;
+    constants.right = viewport.x_offset + viewport.width;
+    constants.top = viewport.y_offset;
+    constants.bottom = viewport.y_offset + viewport.height;
+    constants.maxDistance = m_maxDistance;
+    constants.thresholds = m_thresholds;
+    constants.thresholdCount = m_thresholdCount;
+
+    const LODOutput out = { m_screenX.data(), m_screenY.data(), m_screenRadius.data(), m_depth.data(), m_levels.data() };
+    scheduler.ParallelFor(count, kSelectGrain, [&](size_t begin, size_t end) {
+        SelectLevels(constants, centers.x, centers.y, centers.z, radii, begin, end, out);
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        m_buckets[m_levels[i]].push_back(static_cast<uint32_t>(i));
+    }
+    return count - m_buckets[0].size();
+}
+
+LabelDeclutter::LabelDeclutter(float cellSize)
+    : m_cellSize(std::max(1.0f, cellSize))
+    , m_invCellSize(1.0f / m_cellSize)
+    , m_originX(0.0f)
+    , m_originY(0.0f)
+    , m_cellsX(1)
+    , m_cellsY(1) {
+}
+
+int LabelDeclutter::CellX(float x) const {
+    const float cell = (x - m_originX) * m_invCellSize;
+    if (!(cell >= 0.0f)) {
+        return 0;
+    }
+    return cell >= static_cast<float>(m_cellsX - 1) ? m_cellsX - 1 : static_cast<int>(cell);
+}
+
+int LabelDeclutter::CellY(float y) const {
+    const float cell = (y - m_originY) * m_invCellSize;
+    if (!(cell >= 0.0f)) {
+        return 0;
+    }
+    return cell >= static_cast<float>(m_cellsY - 1) ? m_cellsY - 1 : static_cast<int>(cell);
+}
+
+size_t LabelDeclutter::Resolve(const Viewport& viewport, const W2SUtils::ScreenRect* labels, const float* priority,
+                               size_t count) {
+    m_items.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const W2SUtils::ScreenRect& rect = labels[i];
+        if (!rect.valid) {
+            continue;
+        }
+        m_items.push_back({ std::min(rect.left, rect.right), std::min(rect.top, rect.bottom),
+                            std::max(rect.left, rect.right), std::max(rect.top, rect.bottom),
+                            priority ? priority[i] : 0.0f, static_cast<uint32_t>(i) });
+    }
+    return ResolveItems(viewport, priority != nullptr);
+}
+
+size_t LabelDeclutter::Resolve(const Viewport& viewport, const float* anchorX, const float* anchorY,
+                               const uint32_t* candidates, size_t candidateCount, const Vec2& labelSize,
+                               const Vec2& offset, const float* priority) {
+    m_items.clear();
+    for (size_t c = 0; c < candidateCount; ++c) {
+        const uint32_t i = candidates[c];
+        const float left = anchorX[i] + offset.x;
+        const float top = anchorY[i] + offset.y;
+        m_items.push_back({ left, top, left + labelSize.x, top + labelSize.y, priority ? priority[i] : 0.0f, i });
+    }
+    return ResolveItems(viewport, priority != nullptr);
+}
+
+void LabelDeclutter::SortByPriority() {
+    // Stable LSD radix sort on the priority bits, descending; ties keep input order
+    const size_t count = m_items.size();
+    if (count == 0) {
+        return;
+    }
+    m_keys.resize(count);
+    for (size_t slot = 0; slot < count; ++slot) {
+        uint32_t bits;
+        std::memcpy(&bits, &m_items[slot].priority, sizeof(bits));
+        bits ^= (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+        m_keys[slot] = ~bits;
+    }
+
+    m_orderScratch.resize(count);
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t offsets[257] = {};
+        for (uint32_t slot : m_order) {
+            ++offsets[((m_keys[slot] >> shift) & 0xFFu) + 1];
+        }
+        if (offsets[((m_keys[m_order[0]] >> shift) & 0xFFu) + 1] == count) {
+            continue;   // every key has the same byte here
+        }
+        for (int bucket = 0; bucket < 256; ++bucket) {
+            offsets[bucket + 1] += offsets[bucket];
+        }
+        for (uint32_t slot : m_order) {
+            m_orderScratch[offsets[(m_keys[slot] >> shift) & 0xFFu]++] = slot;
+        }
+        m_order.swap(m_orderScratch);
+    }
+}
+
+size_t LabelDeclutter::ResolveItems(const Viewport& viewport, bool sortByPriority) {
+    m_originX = viewport.x_offset;
+    m_originY = viewport.y_offset;
+    const float width = static_cast<float>(std::max(0, viewport.width));
+    const float height = static_cast<float>(std::max(0, viewport.height));
+    m_cellsX = std::max(1, static_cast<int>(std::ceil(width * m_invCellSize)));
+    m_cellsY = std::max(1, static_cast<int>(std::ceil(height * m_invCellSize)));
+    m_cellHead.assign(static_cast<size_t>(m_cellsX) * m_cellsY, -1);
+    m_nodes.clear();
+    m_accepted.clear();
+
+    uint32_t maxIndex = 0;
+    for (const Item& item : m_items) {
+        maxIndex = std::max(maxIndex, item.index);
+    }
+    m_acceptedMask.assign(m_items.empty() ? 0 : maxIndex / 32 + 1, 0u);
+
+    m_order.resize(m_items.size());
+    for (size_t slot = 0; slot < m_items.size(); ++slot) {
+        m_order[slot] = static_cast<uint32_t>(slot);
+    }
+    if (sortByPriority) {
+        SortByPriority();
+    }
+
+    const float right = m_originX + width;
+    const float bottom = m_originY + height;
+    for (uint32_t slot : m_order) {
+        const Item& item = m_items[slot];
+        if (!(item.right > m_originX && item.left < right && item.bottom > m_originY && item.top < bottom)) {
+            continue;
+        }
+
+        const int x0 = CellX(item.left), x1 = CellX(item.right);
+        const int y0 = CellY(item.top), y1 = CellY(item.bottom);
+        bool blocked = false;
+        for (int y = y0; y <= y1 && !blocked; ++y) {
+            for (int x = x0; x <= x1 && !blocked; ++x) {
+                for (int32_t n = m_cellHead[static_cast<size_t>(y) * m_cellsX + x]; n >= 0; n = m_nodes[n].next) {
+                    const Item& other = m_items[m_nodes[n].item];
+                    // Touching edges are not an overlap
+                    if (item.left < other.right && other.left < item.right &&
+                        item.top < other.bottom && other.top < item.bottom) {
+                        blocked = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (blocked) {
+            continue;
+        }
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                int32_t& head = m_cellHead[static_cast<size_t>(y) * m_cellsX + x];
+                m_nodes.push_back({ slot, head });
+                head = static_cast<int32_t>(m_nodes.size() - 1);
+            }
+        }
+        m_accepted.push_back(item.index);
+        m_acceptedMask[item.index >> 5] |= 1u << (item.index & 31);
+    }
+
+    return m_accepted.size();
+}
@@ -0,0 +1,171 @@
+/**
+ * @file OverlayLOD.hpp
+ * @brief Batch level-of-detail selection and label decluttering for overlays
+ * @author Lukas Ernst
+ *
+ * OverlayLOD projects bounding spheres with SIMD and turns the projected
+ * radius into a detail level per entity, e.g. nothing, a dot or a full box.
+ * The radius in pixels is the world radius times the pixels per world unit at
+ * w = 1, divided by w; the scale is taken from the view-projection rows once
+ * per call. Entities behind the camera, beyond the distance limit or entirely
+ * off screen get level 0. Every level also gets a compact index bucket in
+ * input order, so the drawing code can loop over one level at a time.
+ *
+ * LabelDeclutter resolves overlapping labels greedily: candidates are taken
+ * in priority order and a label is accepted if it does not overlap any label
+ * accepted before it. Accepted labels are entered into a uniform screen grid,
+ * so each test only looks at nearby labels and a frame with tens of thousands
+ * of candidates costs a sort plus roughly linear work instead of the quadratic
+ * all-pairs check.
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Projected-size based detail levels for many bounding spheres
+ */
+class OverlayLOD {
+public:
+    static constexpr int kMaxLevels = 8;
+
+    /**
+     * @brief Defaults to three levels: hidden, dot from 0.5 px radius, box from 4 px
+     */
+    OverlayLOD();
+
+    /**
+     * @brief Sets the level thresholds
+     * @param minRadius Projected radii in pixels, level k + 1 starts at minRadius[k];
+     *        sorted ascending here. Below minRadius[0] an entity is level 0
+     * @param thresholdCount 1 to kMaxLevels thresholds
+     */
+    void SetLevels(const float* minRadius, int thresholdCount);
+
+    /**
+     * @brief Entities farther than this (in w) are level 0
+     */
+    void SetMaxDistance(float maxDistance) { m_maxDistance = maxDistance; }
+
+    /**
+     * @brief Projects the spheres and assigns levels and buckets
+     * @param radii World-space sphere radii, one per entity
+     * @return Number of entities above level 0
+     */
+    size_t Select(const WorldToScreenTransform& transform, ConstVec3SoA centers, const float* radii, size_t count,
+                  VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    int GetLevelCount() const { return m_thresholdCount + 1; }
+    size_t GetCount() const { return m_count; }
+
+    uint8_t GetLevel(size_t index) const { return m_levels[index]; }
+    const uint8_t* GetLevels() const { return m_levels.data(); }
+
+    /**
+     * @brief Entities at a level, in input order
+     */
+    const std::vector<uint32_t>& GetBucket(int level) const { return m_buckets[level]; }
+
+    /**
+     * @brief Projected sphere centers, (-1, -1) behind the camera
+     */
+    const float* GetScreenX() const { return m_screenX.data(); }
+    const float* GetScreenY() const { return m_screenY.data(); }
+
+    /**
+     * @brief Projected radii in pixels, 0 behind the camera
+     */
+    const float* GetScreenRadius() const { return m_screenRadius.data(); }
+
+    /**
+     * @brief w of the sphere centers, -1 behind the camera
+     */
+    const float* GetDepth() const { return m_depth.data(); }
+
+private:
+    float m_thresholds[kMaxLevels];
+    int m_thresholdCount;
+    float m_maxDistance;
+    size_t m_count;
+
+    std::vector<float> m_screenX, m_screenY, m_screenRadius, m_depth;
+    std::vector<uint8_t> m_levels;
+    std::vector<uint32_t> m_buckets[kMaxLevels + 1];
+};
+
+/**
+ * @brief Greedy priority-ordered removal of overlapping labels
+ */
+class LabelDeclutter {
+public:
+    /**
+     * @param cellSize Grid cell edge in pixels; about the typical label size works well
+     */
+    explicit LabelDeclutter(float cellSize = 64.0f);
+
+    /**
+     * @brief Accepts labels in priority order, skipping those overlapping an accepted one
+     *
+     * Invalid rectangles and rectangles entirely outside the viewport are rejected.
+     * @param priority Higher is accepted first, ties keep input order; may be null (input order)
+     * @return Number of accepted labels
+     */
+    size_t Resolve(const Viewport& viewport, const W2SUtils::ScreenRect* labels, const float* priority, size_t count);
+
+    /**
+     * @brief Resolves equally sized labels anchored at projected points
+     *
+     * Candidate i is a labelSize rectangle with its top-left corner at
+     * (anchorX, anchorY)[candidates[i]] + offset, e.g. one LOD bucket.
+     * @param priority Indexed like the anchors, ties keep candidate order; may be null (candidate order)
+     */
+    size_t Resolve(const Viewport& viewport, const float* anchorX, const float* anchorY,
+                   const uint32_t* candidates, size_t candidateCount, const Vec2& labelSize, const Vec2& offset,
+                   const float* priority);
+
+    /**
+     * @brief Accepted label indices in acceptance order
+     */
+    const std::vector<uint32_t>& GetAccepted() const { return m_accepted; }
+
+    bool IsAccepted(size_t index) const {
+        return (index >> 5) < m_acceptedMask.size() && ((m_acceptedMask[index >> 5] >> (index & 31)) & 1u) != 0;
+    }
+
+private:
+    struct Item {
+        float left, top, right, bottom;
+        float priority;
+        uint32_t index;
+    };
+
+    struct Node {
+        uint32_t item;      // slot in m_items
+        int32_t next;       // next node in the same cell, -1 at the end
+    };
+
+    size_t ResolveItems(const Viewport& viewport, bool sortByPriority);
+    void SortByPriority();
+    int CellX(float x) const;
+    int CellY(float y) const;
+
+    float m_cellSize;
+    float m_invCellSize;
+    float m_originX;
+    float m_originY;
+    int m_cellsX;
+    int m_cellsY;
+
+    std::vector<Item> m_items;
+    std::vector<uint32_t> m_order;          // item slots in acceptance-test order
+    std::vector<uint32_t> m_orderScratch;
+    std::vector<uint32_t> m_keys;           // descending sort keys of the priorities
+    std::vector<int32_t> m_cellHead;        // first node per cell, -1 if empty
+    std::vector<Node> m_nodes;              // accepted labels, one node per overlapped cell
+    std::vector<uint32_t> m_accepted;
+    std::vector<uint32_t> m_acceptedMask;
+};
@@ -0,0 +1,400 @@
+/**
+ * @file OverlayRenderer.cpp
+ * @brief Implementation of the draw list and the tiled overlay rasterizer
+ * @author Lukas Ernst
+ */
+
+#include "OverlayRenderer.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+constexpr int kTilePixels = OverlayRasterizer::kTileSize * OverlayRasterizer::kTileSize;
+
+// Pixel columns relative to the first pixel of a SIMD block
+alignas(64) const float kLaneOffsets[16] = {
+    0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+    8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f
+};
+
+// Sample positions inside a pixel: the center, or a 4x rotated grid when antialiasing
+const float kCenterSample[1][2] = { { 0.5f, 0.5f } };
+const float kRotatedGridSamples[4][2] = {
+    { 0.375f, 0.125f }, { 0.875f, 0.375f }, { 0.125f, 0.625f }, { 0.625f, 0.875f }
+};
+
+// Pixel column/row of a coordinate, clamped to [-1, size] (NaN to -1) before the integer conversion
+int ToPixel(float value, int size) {
+    return static_cast<int>(std::floor(std::min(static_cast<float>(size), std::max(-1.0f, value))));
+}
+
+uint8_t ToChannel(float value) {
+    return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value)) + 0.5f);
+}
+
+} // namespace
+
+void DrawList::Clear() {
+    m_vertices.clear();
+    m_commands.clear();
+}
+
+void DrawList::Append(const Vec2* vertices, size_t count, uint32_t color) {
+    if (count == 0) {
+        return;
+    }
+    // Consecutive primitives of one color share a command
+    if (!m_commands.empty() && m_commands.back().color == color &&
+        m_commands.back().firstVertex + m_commands.back().vertexCount == m_vertices.size()) {
+        m_commands.back().vertexCount += static_cast<uint32_t>(count);
+    } else {
+        m_commands.push_back({ static_cast<uint32_t>(m_vertices.size()), static_cast<uint32_t>(count), color });
+    }
+    m_vertices.insert(m_vertices.end(), vertices, vertices + count);
+}
+
+void DrawList::AddQuad(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d, uint32_t color) {
+    const Vec2 vertices[6] = { a, b, c, a, c, d };
+    Append(vertices, 6, color);
+}
+
+void DrawList::AddLine(const Vec2& start, const Vec2& end, uint32_t color, float thickness) {
+    const float dx = end.x - start.x;
+    const float dy = end.y - start.y;
+    const float length = std::sqrt(dx * dx + dy * dy);
+    if (!(length > 0.0f) || !(thickness > 0.0f)) {
+        return;
+    }
+    const float scale = 0.5f * thickness / length;
+    const float nx = -dy * scale;
+    const float ny = dx * scale;
+    AddQuad(Vec2(start.x + nx, start.y + ny), Vec2(end.x + nx, end.y + ny),
+            Vec2(end.x - nx, end.y - ny), Vec2(start.x - nx, start.y - ny), color);
+}
+
+void DrawList::AddSegments(const ScreenSegment* segments, size_t count, uint32_t color, float thickness) {
+    for (size_t i = 0; i < count; ++i) {
+        AddLine(segments[i].start, segments[i].end, color, thickness);
+    }
+}
+
+void DrawList::AddRect(const W2SUtils::ScreenRect& rect, uint32_t color, float thickness) {
+    if (!rect.valid || !(thickness > 0.0f)) {
+        return;
+    }
+    const float l = rect.left, r = rect.right, t = rect.top, b = rect.bottom;
+    if (2.0f * thickness >= r - l || 2.0f * thickness >= b - t) {
+        AddRectFilled(rect, color);
+        return;
+    }
+    // Four bands that do not overlap, so translucent outlines stay even
+    AddQuad(Vec2(l, t), Vec2(r, t), Vec2(r, t + thickness), Vec2(l, t + thickness), color);
+    AddQuad(Vec2(l, b - thickness), Vec2(r, b - thickness), Vec2(r, b), Vec2(l, b), color);
+    AddQuad(Vec2(l, t + thickness), Vec2(l + thickness, t + thickness),
+            Vec2(l + thickness, b - thickness), Vec2(l, b - thickness), color);
+    AddQuad(Vec2(r - thickness, t + thickness), Vec2(r, t + thickness),
+            Vec2(r, b - thickness), Vec2(r - thickness, b - thickness), color);
+}
+
+void DrawList::AddRectFilled(const W2SUtils::ScreenRect& rect, uint32_t color) {
+    if (!rect.valid) {
+        return;
+    }
+    AddQuad(Vec2(rect.left, rect.top), Vec2(rect.right, rect.top),
+            Vec2(rect.right, rect.bottom), Vec2(rect.left, rect.bottom), color);
+}
+
+void DrawList::AddTriangleFilled(const Vec2& a, const Vec2& b, const Vec2& c, uint32_t color) {
+    const Vec2 vertices[3] = { a, b, c };
+    Append(vertices, 3, color);
+}
+
+void DrawList::AddCircleFilled(const Vec2& center, float radius, uint32_t color) {
+    if (!(radius > 0.0f)) {
+        return;
+    }
+    // About four pixels of arc per segment
+    const int segments = std::min(64, std::max(8, static_cast<int>(std::ceil(radius * 1.5f))));
+    const float step = 6.28318530718f / static_cast<float>(segments);
+
+    Vec2 previous(center.x + radius, center.y);
+    for (int i = 1; i <= segments; ++i) {
+        const float angle = step * static_cast<float>(i == segments ? 0 : i);
+        const Vec2 current(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle));
+        AddTriangleFilled(center, previous, current, color);
+        previous = current;
+    }
+}
+
+void DrawList::AddMarker(const Vec2& center, float size, uint32_t color, MarkerShape shape) {
+    if (!(size > 0.0f)) {
+        return;
+    }
+    const float half = size * 0.5f;
+    const float thickness = std::max(1.0f, size * 0.125f);
+    const float bar = thickness * 0.5f;
+
+    switch (shape) {
+        case MarkerShape::Cross:
+            // Horizontal bar plus the vertical bar above and below it, without overlap
+            AddQuad(Vec2(center.x - half, center.y - bar), Vec2(center.x + half, center.y - bar),
+                    Vec2(center.x + half, center.y + bar), Vec2(center.x - half, center.y + bar), color);
+            AddQuad(Vec2(center.x - bar, center.y - half), Vec2(center.x + bar, center.y - half),
+                    Vec2(center.x + bar, center.y - bar), Vec2(center.x - bar, center.y - bar), color);
+            AddQuad(Vec2(center.x - bar, center.y + bar), Vec2(center.x + bar, center.y + bar),
+                    Vec2(center.x + bar, center.y + half), Vec2(center.x - bar, center.y + half), color);
+            break;
+        case MarkerShape::Square:
+            AddRect(W2SUtils::ScreenRect(center.x - half, center.x + half, center.y - half, center.y + half),
+                    color, thickness);
+            break;
+        case MarkerShape::Diamond:
+            AddQuad(Vec2(center.x, center.y - half), Vec2(center.x + half, center.y),
+                    Vec2(center.x, center.y + half), Vec2(center.x - half, center.y), color);
+            break;
+        case MarkerShape::Circle:
+            AddCircleFilled(center, half, color);
+            break;
+    }
+}
+
+OverlayRasterizer::OverlayRasterizer(int width, int height)
+    : m_width(0)
+    , m_height(0)
+    , m_tilesX(0)
+    , m_tilesY(0) {
+    Resize(width, height);
+}
+
+void OverlayRasterizer::Resize(int width, int height) {
+    m_width = std::max(1, width);
+    m_height = std::max(1, height);
+    m_tilesX = (m_width + kTileSize - 1) / kTileSize;
+    m_tilesY = (m_height + kTileSize - 1) / kTileSize;
+    m_pixels.assign(static_cast<size_t>(m_width) * m_height, 0u);
+    m_tileBins.assign(static_cast<size_t>(m_tilesX) * m_tilesY, std::vector<uint32_t>());
+}
+
+void OverlayRasterizer::Clear(uint32_t color) {
+    std::fill(m_pixels.begin(), m_pixels.end(), color);
+}
+
+void OverlayRasterizer::SetupTriangles(const DrawList& drawList) {
+    m_triangles.clear();
+    const std::vector<Vec2>& vertices = drawList.GetVertices();
+
+    for (const DrawList::Command& command : drawList.GetCommands()) {
+        const float alpha = static_cast<float>(command.color >> 24) * (1.0f / 255.0f);
+        if (alpha <= 0.0f) {
+            continue;
+        }
+
+        const uint32_t endVertex = command.firstVertex + command.vertexCount;
+        for (uint32_t v = command.firstVertex; v + 3 <= endVertex; v += 3) {
+            const float x[3] = { vertices[v].x, vertices[v + 1].x, vertices[v + 2].x };
+            const float y[3] = { vertices[v].y, vertices[v + 1].y, vertices[v + 2].y };
+
+            Triangle triangle;
+            triangle.minX = std::max(0, ToPixel(std::min({ x[0], x[1], x[2] }), m_width));
+            triangle.maxX = std::min(m_width - 1, ToPixel(std::max({ x[0], x[1], x[2] }), m_width));
+            triangle.minY = std::max(0, ToPixel(std::min({ y[0], y[1], y[2] }), m_height));
+            triangle.maxY = std::min(m_height - 1, ToPixel(std::max({ y[0], y[1], y[2] }), m_height));
+            if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+                continue;
+            }
+
+            float area = 0.0f;
+            for (int e = 0; e < 3; ++e) {
+                const int n = (e + 1) % 3;
+                triangle.edgeA[e] = y[e] - y[n];
+                triangle.edgeB[e] = x[n] - x[e];
+                triangle.edgeC[e] = x[e] * y[n] - x[n] * y[e];
+                area += triangle.edgeC[e];
+            }
+            if (!(area != 0.0f) || !std::isfinite(area)) {
+                continue;
+            }
+            // Orient the edges so the interior is positive for either winding;
+            // negation is exact, so a shared edge keeps bit-identical opposite values
+            if (area < 0.0f) {
+                for (int e = 0; e < 3; ++e) {
+                    triangle.edgeA[e] = -triangle.edgeA[e];
+                    triangle.edgeB[e] = -triangle.edgeB[e];
+                    triangle.edgeC[e] = -triangle.edgeC[e];
+                }
+            }
+            // Tie-breaking: a sample exactly on an edge belongs to one of the two
+            // triangles sharing it, never both
+            for (int e = 0; e < 3; ++e) {
+                triangle.inclusive[e] = triangle.edgeA[e] > 0.0f ||
+                                        (triangle.edgeA[e] == 0.0f && triangle.edgeB[e] > 0.0f);
+            }
+
+            triangle.color[0] = static_cast<float>(command.color & 0xFFu);
+            triangle.color[1] = static_cast<float>((command.color >> 8) & 0xFFu);
+            triangle.color[2] = static_cast<float>((command.color >> 16) & 0xFFu);
+            triangle.color[3] = alpha;
+            m_triangles.push_back(triangle);
+        }
+    }
+}
+
+void OverlayRasterizer::Render(const DrawList& drawList, bool antialias, VectorMath::TaskScheduler& scheduler) {
+    SetupTriangles(drawList);
+    if (m_triangles.empty()) {
+        return;
+    }
+
+    // Bins keep submission order, which is the blend order inside every tile
+    for (std::vector<uint32_t>& bin : m_tileBins) {
+        bin.clear();
+    }
+    for (size_t t = 0; t < m_triangles.size(); ++t) {
+        const Triangle& triangle = m_triangles[t];
+        for (int ty = triangle.minY / kTileSize; ty <= triangle.maxY / kTileSize; ++ty) {
+            for (int tx = triangle.minX / kTileSize; tx <= triangle.maxX / kTileSize; ++tx) {
+                m_tileBins[static_cast<size_t>(ty) * m_tilesX + tx].push_back(static_cast<uint32_t>(t));
+            }
+        }
+    }
+
+    scheduler.ParallelFor(m_tileBins.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; ++tile) {
+            RasterizeTile(static_cast<int>(tile % m_tilesX), static_cast<int>(tile / m_tilesX), antialias);
+        }
+    });
+}
+
+void OverlayRasterizer::RasterizeTile(int tileX, int tileY, bool antialias) {
+    using namespace VectorMath::SIMD;
+
+    const std::vector<uint32_t>& bin = m_tileBins[static_cast<size_t>(tileY) * m_tilesX + tileX];
+    if (bin.empty()) {
+        return;
+    }
+
+    const int x0 = tileX * kTileSize;
+    const int y0 = tileY * kTileSize;
+    const int width = std::min(kTileSize, m_width - x0);
+    const int height = std::min(kTileSize, m_height - y0);
+
+    // Tile planes: color in 0..255, alpha in 0..1
+    alignas(64) float red[kTilePixels];
+    alignas(64) float green[kTilePixels];
+    alignas(64) float blue[kTilePixels];
+    alignas(64) float alpha[kTilePixels];
+    for (int y = 0; y < kTileSize; ++y) {
+        for (int x = 0; x < kTileSize; ++x) {
+            const int i = y * kTileSize + x;
+            const uint32_t pixel = (x < width && y < height)
+                ? m_pixels[static_cast<size_t>(y0 + y) * m_width + x0 + x] : 0u;
+            red[i] = static_cast<float>(pixel & 0xFFu);
+            green[i] = static_cast<float>((pixel >> 8) & 0xFFu);
+            blue[i] = static_cast<float>((pixel >> 16) & 0xFFu);
+            alpha[i] = static_cast<float>(pixel >> 24) * (1.0f / 255.0f);
+        }
+    }
+
+    const float (*samples)[2] = antialias ? kRotatedGridSamples : kCenterSample;
+    const int sampleCount = antialias ? 4 : 1;
+    const FloatV laneOffsets = Load(kLaneOffsets);
+    const FloatV zero = Set1(0.0f);
+    const FloatV one = Set1(1.0f);
+    const FloatV sampleWeight = Set1(1.0f / static_cast<float>(sampleCount));
+
+    for (uint32_t t : bin) {
+        const Triangle& triangle = m_triangles[t];
+        // Tile-local bounds; rows are 32 floats, so SIMD blocks never leave the tile
+        const int startX = (std::max(triangle.minX, x0) - x0) & ~(kWidth - 1);
+        const int endX = std::min(triangle.maxX, x0 + kTileSize - 1) - x0;
+        const int startY = std::max(triangle.minY, y0) - y0;
+        const int endY = std::min(triangle.maxY, y0 + kTileSize - 1) - y0;
+
+        const FloatV a0 = Set1(triangle.edgeA[0]), a1 = Set1(triangle.edgeA[1]), a2 = Set1(triangle.edgeA[2]);
+        const FloatV srcRed = Set1(triangle.color[0]);
+        const FloatV srcGreen = Set1(triangle.color[1]);
+        const FloatV srcBlue = Set1(triangle.color[2]);
+        const FloatV srcAlpha = Set1(triangle.color[3]);
+
+        auto edgeTest = [&](int e, FloatV value) {
+            return triangle.inclusive[e] ? CmpGe(value, zero) : CmpGt(value, zero);
+        };
+
+        for (int y = startY; y <= endY; ++y) {
+            const int row = y * kTileSize;
+            for (int x = startX; x <= endX; x += kWidth) {
+                const FloatV pixelX = Add(Set1(static_cast<float>(x0 + x)), laneOffsets);
+                FloatV coverage = zero;
+                for (int s = 0; s < sampleCount; ++s) {
+                    const FloatV sampleX = Add(pixelX, Set1(samples[s][0]));
+                    const float sampleY = static_cast<float>(y0 + y) + samples[s][1];
+                    const FloatV row0 = Set1(triangle.edgeB[0] * sampleY + triangle.edgeC[0]);
+                    const FloatV row1 = Set1(triangle.edgeB[1] * sampleY + triangle.edgeC[1]);
+                    const FloatV row2 = Set1(triangle.edgeB[2] * sampleY + triangle.edgeC[2]);
+                    const MaskV inside = MaskAnd(MaskAnd(edgeTest(0, MulAdd(a0, sampleX, row0)),
+                                                         edgeTest(1, MulAdd(a1, sampleX, row1))),
+                                                 edgeTest(2, MulAdd(a2, sampleX, row2)));
+                    coverage = Add(coverage, Select(inside, sampleWeight, zero));
+                }
+                if (MaskBits(CmpGt(coverage, zero)) == 0) {
+                    continue;
+                }
+
+                // Source over: dst += (src - dst) * srcAlpha * coverage
+                const FloatV weight = Mul(srcAlpha, coverage);
+                const int i = row + x;
+                const FloatV dstRed = Load(red + i);
+                const FloatV dstGreen = Load(green + i);
+                const FloatV dstBlue = Load(blue + i);
+                const FloatV dstAlpha = Load(alpha + i);
+                Store(red + i, MulAdd(Sub(srcRed, dstRed), weight, dstRed));
+                Store(green + i, MulAdd(Sub(srcGreen, dstGreen), weight, dstGreen));
+                Store(blue + i, MulAdd(Sub(srcBlue, dstBlue), weight, dstBlue));
+                Store(alpha + i, MulAdd(Sub(one, dstAlpha), weight, dstAlpha));
+            }
+        }
+    }
+
+    for (int y = 0; y < height; ++y) {
+        uint32_t* target = m_pixels.data() + static_cast<size_t>(y0 + y) * m_width + x0;
+        for (int x = 0; x < width; ++x) {
+            const int i = y * kTileSize + x;
+            target[x] = PackColor(ToChannel(red[i]), ToChannel(green[i]), ToChannel(blue[i]),
+                                  ToChannel(alpha[i] * 255.0f));
+        }
+    }
+}
+
+bool OverlayRasterizer::SaveRaw(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    // Byte order is fixed by the format, not by the host
+    std::vector<char> row(static_cast<size_t>(m_width) * 4);
+    for (int y = 0; y < m_height; ++y) {
+        const uint32_t* pixels = m_pixels.data() + static_cast<size_t>(y) * m_width;
+        for (int x = 0; x < m_width; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                row[static_cast<size_t>(x) * 4 + c] = static_cast<char>((pixels[x] >> (8 * c)) & 0xFFu);
+            }
+        }
+        file.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(file);
+}
+
+uint64_t OverlayRasterizer::Hash() const {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t pixel : m_pixels) {
+        for (int c = 0; c < 4; ++c) {
+            hash ^= (pixel >> (8 * c)) & 0xFFu;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file OverlayRenderer.hpp
+ * @brief Draw lists for 2D overlays and a headless tile-based software rasterizer
+ * @author Lukas Ernst
+ *
+ * A DrawList accumulates boxes, lines, filled shapes and markers built from
+ * projected results. Every primitive is lowered to triangles on insertion, so
+ * the list is just a vertex stream plus one small command (vertex range and
+ * color) per primitive.
+ *
+ * OverlayRasterizer renders a draw list into an RGBA8 image without a GPU.
+ * Triangles are binned into 32x32 pixel tiles and the tiles are rasterized in
+ * parallel on the TaskScheduler. Within a tile, edge functions are evaluated
+ * with SIMD across pixels of a row and colors are blended (source over) in
+ * float tile planes. Primitives are drawn in submission order in every tile,
+ * so the image is identical for any thread count. Shared triangle edges follow
+ * a tie-breaking rule, so translucent quads are not blended twice along their
+ * diagonal. Optional antialiasing takes four rotated-grid samples per pixel.
+ *
+ * The image is kept as packed RGBA8 and can be dumped as raw bytes for
+ * screenshot diffing; no image format library is involved.
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Marker glyphs for points of interest
+ */
+enum class MarkerShape : uint8_t {
+    Cross,
+    Square,
+    Diamond,
+    Circle
+};
+
+/**
+ * @brief Packs 8-bit channels into the RGBA8 layout used by the rasterizer
+ */
+inline uint32_t PackColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+    return static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) |
+           (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) << 24);
+}
+
+/**
+ * @brief Recorded 2D primitives, lowered to colored triangle lists
+ */
+class DrawList {
+public:
+    /**
+     * @brief A run of triangles sharing one color
+     */
+    struct Command {
+        uint32_t firstVertex;
+        uint32_t vertexCount;   // three per triangle
+        uint32_t color;         // PackColor layout
+    };
+
+    void Clear();
+
+    void AddLine(const Vec2& start, const Vec2& end, uint32_t color, float thickness = 1.0f);
+
+    /**
+     * @brief Adds projected segments, e.g. ProjectSegments or ProjectPolyline output
+     */
+    void AddSegments(const ScreenSegment* segments, size_t count, uint32_t color, float thickness = 1.0f);
+
+    /**
+     * @brief Rectangle outline drawn inside the rectangle; invalid rectangles are skipped
+     */
+    void AddRect(const W2SUtils::ScreenRect& rect, uint32_t color, float thickness = 1.0f);
+    void AddRectFilled(const W2SUtils::ScreenRect& rect, uint32_t color);
+
+    void AddTriangleFilled(const Vec2& a, const Vec2& b, const Vec2& c, uint32_t color);
+    void AddCircleFilled(const Vec2& center, float radius, uint32_t color);
+
+    /**
+     * @brief Point marker of the given size in pixels
+     */
+    void AddMarker(const Vec2& center, float size, uint32_t color, MarkerShape shape = MarkerShape::Cross);
+
+    const std::vector<Vec2>& GetVertices() const { return m_vertices; }
+    const std::vector<Command>& GetCommands() const { return m_commands; }
+    size_t GetTriangleCount() const { return m_vertices.size() / 3; }
+
+private:
+    void AddQuad(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d, uint32_t color);
+    void Append(const Vec2* vertices, size_t count, uint32_t color);
+
+    std::vector<Vec2> m_vertices;
+    std::vector<Command> m_commands;
+};
+
+/**
+ * @brief Tile-binned multithreaded software rasterizer into an RGBA8 image
+ */
+class OverlayRasterizer {
+public:
+    static constexpr int kTileSize = 32;
+
+    OverlayRasterizer(int width, int height);
+
+    void Resize(int width, int height);
+
+    /**
+     * @brief Fills the whole image with one color
+     */
+    void Clear(uint32_t color = PackColor(0, 0, 0, 0));
+
+    /**
+     * @brief Draws a list on top of the current image
+     * @param antialias Four samples per pixel instead of one at the center
+     */
+    void Render(const DrawList& drawList, bool antialias = false,
+                VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+
+    /**
+     * @brief Row-major RGBA8 pixels in PackColor layout
+     */
+    const uint32_t* GetPixels() const { return m_pixels.data(); }
+    uint32_t GetPixel(int x, int y) const { return m_pixels[static_cast<size_t>(y) * m_width + x]; }
+
+    /**
+     * @brief Writes width * height * 4 bytes in R, G, B, A order, row-major, no header
+     * @return false if the file could not be written
+     */
+    bool SaveRaw(const std::string& path) const;
+
+    /**
+     * @brief 64-bit FNV-1a hash of the image bytes, for comparing renders
+     */
+    uint64_t Hash() const;
+
+private:
+    /**
+     * @brief Triangle with edge functions A * x + B * y + C >= 0 inside
+     */
+    struct Triangle {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        bool inclusive[3];      // whether E == 0 counts as inside for this edge
+        float color[4];         // r, g, b in 0..255, alpha in 0..1
+        int minX, minY, maxX, maxY;
+    };
+
+    void SetupTriangles(const DrawList& drawList);
+    void RasterizeTile(int tileX, int tileY, bool antialias);
+
+    int m_width;
+    int m_height;
+    int m_tilesX;
+    int m_tilesY;
+
+    std::vector<uint32_t> m_pixels;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_tileBins;
+};
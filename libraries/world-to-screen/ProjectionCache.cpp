@@ -0,0 +1,255 @@
+/**
+ * @file ProjectionCache.cpp
+ * @brief Implementation of the incremental projection cache
+ * @author Lukas Ernst
+ */
+
+#include "ProjectionCache.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Sparse dirty entities are gathered into blocks of this size for the SIMD kernel
+constexpr size_t kGatherBlock = 256;
+
+/**
+ * @brief Bits of the last bitset word that belong to one of count entities
+ */
+inline uint32_t TailMask(size_t count) {
+    const size_t rest = count & 31;
+    return rest ? (1u << rest) - 1u : 0xFFFFFFFFu;
+}
+
+} // namespace
+
+ProjectionCache::ProjectionCache()
+    : m_count(0)
+    , m_visibleCount(0)
+    , m_lastUpdateCount(0)
+    , m_hasCamera(false) {
+}
+
+void ProjectionCache::Resize(size_t count) {
+    using VectorMath::SIMD::PopCount;
+
+    const size_t oldCount = m_count;
+    const size_t words = (count + 31) / 32;
+
+    // New mask bits start cleared, so only dropped entities change the visible count
+    if (count < oldCount) {
+        for (size_t w = words; w < m_visibleMask.size(); ++w) {
+            m_visibleCount -= PopCount(m_visibleMask[w]);
+        }
+        if (words > 0) {
+            m_visibleCount -= PopCount(m_visibleMask[words - 1] & ~TailMask(count));
+            m_visibleMask[words - 1] &= TailMask(count);
+            m_dirty[words - 1] &= TailMask(count);
+        }
+    }
+
+    m_x.resize(count, 0.0f);
+    m_y.resize(count, 0.0f);
+    m_z.resize(count, 0.0f);
+    m_screenX.resize(count, -1.0f);
+    m_screenY.resize(count, -1.0f);
+    m_visibleMask.resize(words, 0);
+    m_dirty.resize(words, 0);
+    m_count = count;
+
+    for (size_t i = oldCount; i < count; ++i) {
+        MarkMoved(i);
+    }
+}
+
+size_t ProjectionCache::Add(const Vec3& position) {
+    // push_back grows the streams geometrically, so filling a cache entity by entity stays linear
+    const size_t index = m_count;
+    m_x.push_back(position.x);
+    m_y.push_back(position.y);
+    m_z.push_back(position.z);
+    m_screenX.push_back(-1.0f);
+    m_screenY.push_back(-1.0f);
+    if ((index & 31) == 0) {
+        m_visibleMask.push_back(0);
+        m_dirty.push_back(0);
+    }
+    m_count = index + 1;
+    MarkMoved(index);
+    return index;
+}
+
+void ProjectionCache::SetPosition(size_t index, const Vec3& position) {
+    m_x[index] = position.x;
+    m_y[index] = position.y;
+    m_z[index] = position.z;
+    MarkMoved(index);
+}
+
+void ProjectionCache::MarkMoved(const uint32_t* movedBits) {
+    for (size_t w = 0; w < m_dirty.size(); ++w) {
+        m_dirty[w] |= movedBits[w];
+    }
+    if (!m_dirty.empty()) {
+        m_dirty.back() &= TailMask(m_count);
+    }
+}
+
+void ProjectionCache::MarkAllMoved() {
+    std::fill(m_dirty.begin(), m_dirty.end(), 0xFFFFFFFFu);
+    if (!m_dirty.empty()) {
+        m_dirty.back() &= TailMask(m_count);
+    }
+}
+
+size_t ProjectionCache::Update(const WorldToScreenTransform& transform, bool cameraChanged,
+                               VectorMath::TaskScheduler& scheduler) {
+    return UpdateMoved(transform, nullptr, cameraChanged, scheduler);
+}
+
+size_t ProjectionCache::UpdateMoved(const WorldToScreenTransform& transform, const uint32_t* movedBits,
+                                    bool cameraChanged, VectorMath::TaskScheduler& scheduler) {
+    if (movedBits) {
+        MarkMoved(movedBits);
+    }
+
+    if (!transform.IsMatrixValid()) {
+        // Nothing can be projected; the next valid camera reprojects everything
+        ClearProjection();
+        m_hasCamera = false;
+        m_lastUpdateCount = 0;
+        return 0;
+    }
+
+    if (cameraChanged || !m_hasCamera) {
+        m_lastUpdateCount = ReprojectAll(transform, scheduler);
+    } else {
+        m_lastUpdateCount = ReprojectDirty(transform);
+    }
+
+    m_lastScreenMatrix = transform.GetScreenMatrix();
+    m_hasCamera = true;
+    return m_lastUpdateCount;
+}
+
+size_t ProjectionCache::Update(const WorldToScreenTransform& transform, VectorMath::TaskScheduler& scheduler) {
+    const bool cameraChanged = !m_hasCamera ||
+        std::memcmp(m_lastScreenMatrix.m, transform.GetScreenMatrix().m, sizeof(m_lastScreenMatrix.m)) != 0;
+    return UpdateMoved(transform, nullptr, cameraChanged, scheduler);
+}
+
+size_t ProjectionCache::ReprojectAll(const WorldToScreenTransform& transform, VectorMath::TaskScheduler& scheduler) {
+    m_visibleCount = transform.WorldToScreenParallel(ConstVec3SoA(m_x.data(), m_y.data(), m_z.data()),
+                                                     m_screenX.data(), m_screenY.data(), m_visibleMask.data(),
+                                                     m_count, scheduler);
+    std::fill(m_dirty.begin(), m_dirty.end(), 0u);
+    return m_count;
+}
+
+size_t ProjectionCache::ReprojectDirty(const WorldToScreenTransform& transform) {
+    using VectorMath::SIMD::LowestBit;
+    using VectorMath::SIMD::PopCount;
+
+    const size_t fullWords = m_count / 32;
+    uint32_t gathered[kGatherBlock];
+    size_t gatheredCount = 0;
+    size_t runStart = 0;
+    size_t runLength = 0;
+    size_t projected = 0;
+
+    for (size_t w = 0; w < m_dirty.size(); ++w) {
+        uint32_t bits = m_dirty[w];
+        if (bits == 0xFFFFFFFFu && w < fullWords) {
+            // Whole word dirty: extend the run projected in place
+            if (runLength == 0) {
+                runStart = w;
+            }
+            ++runLength;
+            m_dirty[w] = 0;
+            projected += 32;
+            continue;
+        }
+
+        if (runLength > 0) {
+            ProjectWords(transform, runStart, runLength);
+            runLength = 0;
+        }
+        if (bits == 0) {
+            continue;
+        }
+
+        m_dirty[w] = 0;
+        projected += PopCount(bits);
+        while (bits) {
+            gathered[gatheredCount++] = static_cast<uint32_t>(w * 32 + LowestBit(bits));
+            bits &= bits - 1;
+            if (gatheredCount == kGatherBlock) {
+                ProjectGathered(transform, gathered, gatheredCount);
+                gatheredCount = 0;
+            }
+        }
+    }
+
+    if (runLength > 0) {
+        ProjectWords(transform, runStart, runLength);
+    }
+    if (gatheredCount > 0) {
+        ProjectGathered(transform, gathered, gatheredCount);
+    }
+    return projected;
+}
+
+void ProjectionCache::ProjectWords(const WorldToScreenTransform& transform, size_t firstWord, size_t wordCount) {
+    size_t oldVisible = 0;
+    for (size_t w = firstWord; w < firstWord + wordCount; ++w) {
+        oldVisible += VectorMath::SIMD::PopCount(m_visibleMask[w]);
+    }
+
+    const size_t begin = firstWord * 32;
+    const size_t count = wordCount * 32;
+    const int visible = transform.WorldToScreenBatch(
+        ConstVec3SoA(m_x.data() + begin, m_y.data() + begin, m_z.data() + begin),
+        m_screenX.data() + begin, m_screenY.data() + begin, m_visibleMask.data() + firstWord,
+        static_cast<int>(count));
+
+    m_visibleCount = m_visibleCount - oldVisible + static_cast<size_t>(visible);
+}
+
+void ProjectionCache::ProjectGathered(const WorldToScreenTransform& transform, const uint32_t* indices, size_t count) {
+    float xs[kGatherBlock], ys[kGatherBlock], zs[kGatherBlock];
+    float sx[kGatherBlock], sy[kGatherBlock];
+    uint32_t mask[kGatherBlock / 32];
+
+    for (size_t k = 0; k < count; ++k) {
+        xs[k] = m_x[indices[k]];
+        ys[k] = m_y[indices[k]];
+        zs[k] = m_z[indices[k]];
+    }
+
+    transform.WorldToScreenBatch(ConstVec3SoA(xs, ys, zs), sx, sy, mask, static_cast<int>(count));
+
+    for (size_t k = 0; k < count; ++k) {
+        const uint32_t i = indices[k];
+        const uint32_t bit = 1u << (i & 31);
+        const bool wasVisible = (m_visibleMask[i >> 5] & bit) != 0;
+        const bool visible = ((mask[k >> 5] >> (k & 31)) & 1u) != 0;
+
+        m_screenX[i] = sx[k];
+        m_screenY[i] = sy[k];
+        if (visible && !wasVisible) {
+            m_visibleMask[i >> 5] |= bit;
+            ++m_visibleCount;
+        } else if (!visible && wasVisible) {
+            m_visibleMask[i >> 5] &= ~bit;
+            --m_visibleCount;
+        }
+    }
+}
+
+void ProjectionCache::ClearProjection() {
+    std::fill(m_screenX.begin(), m_screenX.end(), -1.0f);
+    std::fill(m_screenY.begin(), m_screenY.end(), -1.0f);
+    std::fill(m_visibleMask.begin(), m_visibleMask.end(), 0u);
+    m_visibleCount = 0;
+}
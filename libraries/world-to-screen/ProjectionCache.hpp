@@ -0,0 +1,144 @@
+/**
+ * @file ProjectionCache.hpp
+ * @brief Incremental reprojection of entities that moved or saw the camera move
+ * @author Lukas Ernst
+ *
+ * Keeps world positions and the last screen results of a set of entities in
+ * SoA arrays. Every frame only entities flagged in a dirty bitset are sent
+ * through the SIMD projection kernel; when the camera changes everything is
+ * reprojected in parallel. With a static camera and a mostly static scene an
+ * update costs one scan over the dirty words.
+ *
+ * Fully dirty 32-entity words are projected in place, sparse dirty bits are
+ * gathered into small SoA blocks first so they still go through the SIMD path.
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Per-entity screen positions updated only where something changed
+ */
+class ProjectionCache {
+public:
+    ProjectionCache();
+
+    /**
+     * @brief Changes the number of entities, new entities start at the origin and dirty
+     */
+    void Resize(size_t count);
+
+    /**
+     * @brief Appends an entity
+     * @return Its index
+     */
+    size_t Add(const Vec3& position);
+
+    /**
+     * @brief Moves one entity and flags it for reprojection
+     */
+    void SetPosition(size_t index, const Vec3& position);
+
+    Vec3 GetPosition(size_t index) const { return Vec3(m_x[index], m_y[index], m_z[index]); }
+
+    /**
+     * @brief Writable position streams for bulk updates
+     *
+     * Entities written through these must be flagged with MarkMoved or passed
+     * in the movedBits of UpdateMoved.
+     */
+    VectorMath::Vec3SoA GetPositions() { return VectorMath::Vec3SoA(m_x.data(), m_y.data(), m_z.data()); }
+
+    /**
+     * @brief Flags one entity for reprojection
+     */
+    void MarkMoved(size_t index) { m_dirty[index >> 5] |= 1u << (index & 31); }
+
+    /**
+     * @brief Flags entities for reprojection, (GetCount() + 31) / 32 words
+     */
+    void MarkMoved(const uint32_t* movedBits);
+
+    /**
+     * @brief Flags every entity, e.g. after rewriting all positions
+     */
+    void MarkAllMoved();
+
+    /**
+     * @brief Reprojects flagged entities, or all of them if the camera changed
+     * @param cameraChanged The transform's matrix or viewport changed since the last update
+     * @return Number of entities reprojected
+     */
+    size_t Update(const WorldToScreenTransform& transform, bool cameraChanged,
+                  VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    /**
+     * @brief Update with an external bitset of moved entities in addition to the flagged ones
+     * @param movedBits (GetCount() + 31) / 32 words; may be null
+     */
+    size_t UpdateMoved(const WorldToScreenTransform& transform, const uint32_t* movedBits, bool cameraChanged = false,
+                       VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    // A bitset would convert to cameraChanged and reproject everything; use UpdateMoved
+    size_t Update(const WorldToScreenTransform& transform, const uint32_t* movedBits) = delete;
+
+    /**
+     * @brief Update that detects camera changes by comparing the transform's screen matrix
+     */
+    size_t Update(const WorldToScreenTransform& transform,
+                  VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    /**
+     * @brief Last projected position of an entity
+     * @return false if the entity is behind the camera
+     */
+    bool GetScreenPosition(size_t index, Vec2& screenPos) const {
+        screenPos = Vec2(m_screenX[index], m_screenY[index]);
+        return IsVisible(index);
+    }
+
+    bool IsVisible(size_t index) const { return ((m_visibleMask[index >> 5] >> (index & 31)) & 1u) != 0; }
+
+    /**
+     * @brief Screen coordinates of all entities, (-1, -1) where behind the camera
+     */
+    const float* GetScreenX() const { return m_screenX.data(); }
+    const float* GetScreenY() const { return m_screenY.data(); }
+
+    /**
+     * @brief Bit i set if entity i is in front of the camera
+     */
+    const uint32_t* GetVisibleMask() const { return m_visibleMask.data(); }
+
+    size_t GetCount() const { return m_count; }
+    size_t GetVisibleCount() const { return m_visibleCount; }
+
+    /**
+     * @brief Number of entities reprojected by the last Update
+     */
+    size_t GetLastUpdateCount() const { return m_lastUpdateCount; }
+
+private:
+    size_t ReprojectAll(const WorldToScreenTransform& transform, VectorMath::TaskScheduler& scheduler);
+    size_t ReprojectDirty(const WorldToScreenTransform& transform);
+    void ProjectWords(const WorldToScreenTransform& transform, size_t firstWord, size_t wordCount);
+    void ProjectGathered(const WorldToScreenTransform& transform, const uint32_t* indices, size_t count);
+    void ClearProjection();
+
+    size_t m_count;
+    size_t m_visibleCount;
+    size_t m_lastUpdateCount;
+
+    std::vector<float> m_x, m_y, m_z;
+    std::vector<float> m_screenX, m_screenY;
+    std::vector<uint32_t> m_visibleMask;
+    std::vector<uint32_t> m_dirty;
+
+    // Camera of the last update, for change detection
+    Matrix4x4 m_lastScreenMatrix;
+    bool m_hasCamera;
+};
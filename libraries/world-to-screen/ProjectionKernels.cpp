@@ -0,0 +1,63 @@
+/**
+ * @file ProjectionKernels.cpp
+ * @brief Projection kernels at the build's own SIMD level, and the dispatcher
+ * @author Lukas Ernst
+ */
+
+#include "ProjectionKernels.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "ProjectionKernels.inl"
+
+namespace {
+
+// Level this file was compiled for; its kernels replace the per-level build of the same level
+#if defined(VECTORMATH_SIMD_AVX512)
+constexpr VectorMath::SimdLevel kBuildLevel = VectorMath::SimdLevel::AVX512;
+#elif defined(VECTORMATH_SIMD_AVX2)
+constexpr VectorMath::SimdLevel kBuildLevel = VectorMath::SimdLevel::AVX2;
+#elif defined(VECTORMATH_SIMD_SSE2)
+constexpr VectorMath::SimdLevel kBuildLevel = VectorMath::SimdLevel::SSE2;
+#else
+constexpr VectorMath::SimdLevel kBuildLevel = VectorMath::SimdLevel::Scalar;
+#endif
+
+struct SelectedKernels {
+    ProjectionKernels::KernelSet kernels;
+    VectorMath::SimdLevel level;
+};
+
+const SelectedKernels& GetSelectedKernels() {
+    static const SelectedKernels selected = [] {
+        SelectedKernels set = { { nullptr, nullptr, nullptr }, VectorMath::SimdLevel::Scalar };
+        set.kernels = ProjectionKernels::GetKernels(VectorMath::GetSimdLevel(), &set.level);
+        return set;
+    }();
+    return selected;
+}
+
+} // namespace
+
+namespace ProjectionKernels {
+
+KernelSet GetKernels(VectorMath::SimdLevel level, VectorMath::SimdLevel* selected) {
+    KernelSet variants[VectorMath::kSimdLevelCount] = {
+        GetKernelsScalar(), { nullptr, nullptr, nullptr }, GetKernelsAVX2(), GetKernelsAVX512()
+    };
+    variants[static_cast<int>(kBuildLevel)] = { &ProjectPoints, &CullBoxes, &ScreenBoundsBoxes };
+    return VectorMath::SelectForLevel(variants, level, selected);
+}
+
+const KernelSet& GetKernels() {
+    return GetSelectedKernels().kernels;
+}
+
+VectorMath::SimdLevel GetProjectPointsLevel() {
+    return GetSelectedKernels().level;
+}
+
+} // namespace ProjectionKernels
@@ -0,0 +1,156 @@
+/**
+ * @file ProjectionKernels.hpp
+ * @brief Runtime-dispatched SIMD kernels behind the batch projection and box paths
+ * @author Lukas Ernst
+ *
+ * Three kernels are compiled once per SimdLevel: the SoA point projection used
+ * by WorldToScreenBatch, WorldToScreenParallel, WorldToScreenCompact and
+ * everything built on them; the box classification of Frustum::CullAABBs; and
+ * the clipped box rectangles of W2SUtils::GetScreenBoundsBatch. Each level is
+ * built from ProjectionKernels.inl: ProjectionKernels.cpp with the project's
+ * flags, plus scalar, AVX2 and AVX-512 files that enable their instruction set
+ * for that file only. GetKernels() picks the best set the CPU supports on first
+ * use, so a default x86-64 build still runs AVX2 or AVX-512 code where available.
+ *
+ * The remaining SIMD loops (CullSpheres, ProjectSegments, ScreenToWorldRays,
+ * occlusion and overlay rasterization, OverlayLOD, BulkTransform) are not
+ * dispatched; they run at the level the library was compiled for, SSE2 on a
+ * default x86-64 build.
+ *
+ * The kernels take plain floats so the per-level files include nothing but
+ * this header and VectorSIMD.hpp.
+ */
+
+#pragma once
+
+#include "../vector-math/CpuFeatures.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace ProjectionKernels {
+
+/**
+ * @brief Viewport rectangle for the clipToViewport test, in screen coordinates
+ */
+struct ScreenBounds {
+    float left;
+    float right;
+    float top;
+    float bottom;
+};
+
+// Camera-plane distance of every projection path: w below this is behind the camera
+constexpr float kMinProjectionW = 0.001f;
+
+// Box edges as corner pairs; corner bit 2 selects max x, bit 1 max y, bit 0 max z
+constexpr int kBoxEdges[12][2] = {
+    { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+    { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+    { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }
+};
+
+/**
+ * @brief SoA min and max corner streams of a batch of boxes
+ */
+struct BoxStreams {
+    const float* minX;
+    const float* minY;
+    const float* minZ;
+    const float* maxX;
+    const float* maxY;
+    const float* maxZ;
+};
+
+/**
+ * @brief Output streams of the box rectangle kernel
+ */
+struct RectStreams {
+    float* left;
+    float* right;
+    float* top;
+    float* bottom;
+};
+
+/**
+ * @brief Projects SoA points through a fused screen matrix
+ * @param screenMatrix Row-major 4x4 from W2SUtils::CreateScreenMatrix, 16 floats
+ * @param visibleMask Receives (count + 31) / 32 words, bit i set if point i is visible; may be null
+ * @param clipToViewport Count a point as visible only if it also lands inside bounds
+ * @param depth Receives NDC z, 0 behind the camera; may be null
+ * @return Number of visible points
+ */
+using ProjectPointsFunction = int (*)(const float* screenMatrix, const ScreenBounds& bounds,
+                                      const float* xs, const float* ys, const float* zs,
+                                      float* screenX, float* screenY, uint32_t* visibleMask, size_t count,
+                                      bool clipToViewport, float* depth);
+
+/**
+ * @brief Classifies SoA boxes against six normalized planes
+ * @param planes Six planes as nx, ny, nz, d, 24 floats; a point p is inside where n.p + d >= 0
+ * @param visibleMask Receives (count + 31) / 32 words, bit i set if box i is not outside; may be null
+ * @param results Receives the CullResult value per box: 0 outside, 1 intersecting, 2 inside; may be null
+ * @return Number of boxes not outside
+ */
+using CullBoxesFunction = size_t (*)(const float* planes, const BoxStreams& boxes, size_t count,
+                                     uint32_t* visibleMask, uint8_t* results);
+
+/**
+ * @brief Screen rectangles of SoA boxes, clipped at the camera plane
+ * @param matrix Row-major 4x4 view-projection matrix, 16 floats
+ * @param viewport Width, height, x offset and y offset
+ * @param rects Receives the rectangles, zero where a box is entirely behind the camera
+ * @param validMask Receives (count + 31) / 32 words, bit i set if box i is partly in front; may be null
+ * @return Number of valid rectangles
+ */
+using ScreenBoundsFunction = size_t (*)(const float* matrix, const float* viewport, const BoxStreams& boxes,
+                                        size_t count, const RectStreams& rects, uint32_t* validMask);
+
+/**
+ * @brief The kernels of one SimdLevel
+ */
+struct KernelSet {
+    ProjectPointsFunction projectPoints;
+    CullBoxesFunction cullBoxes;
+    ScreenBoundsFunction screenBounds;
+
+    // Null for a level that was not built
+    explicit operator bool() const { return projectPoints != nullptr; }
+};
+
+/**
+ * @brief Kernels for the highest level at or below level that was built
+ * @param selected Receives the level of the returned set; may be null
+ */
+KernelSet GetKernels(VectorMath::SimdLevel level, VectorMath::SimdLevel* selected = nullptr);
+
+/**
+ * @brief Kernels for VectorMath::GetSimdLevel(), resolved once
+ */
+const KernelSet& GetKernels();
+
+/**
+ * @brief Projection kernel for the highest level at or below level that was built
+ * @param selected Receives the level of the returned kernel; may be null
+ */
+inline ProjectPointsFunction GetProjectPoints(VectorMath::SimdLevel level, VectorMath::SimdLevel* selected = nullptr) {
+    return GetKernels(level, selected).projectPoints;
+}
+
+/**
+ * @brief Projection kernel of GetKernels()
+ */
+inline ProjectPointsFunction GetProjectPoints() {
+    return GetKernels().projectPoints;
+}
+
+/**
+ * @brief Level of the set returned by GetKernels(), shared by all its kernels
+ */
+VectorMath::SimdLevel GetProjectPointsLevel();
+
+// Per-level builds; all null where the level is not available for the target
+KernelSet GetKernelsScalar();
+KernelSet GetKernelsAVX2();
+KernelSet GetKernelsAVX512();
+
+} // namespace ProjectionKernels
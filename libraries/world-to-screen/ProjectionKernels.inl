@@ -0,0 +1,347 @@
+/**
+ * @file ProjectionKernels.inl
+ * @brief Kernel bodies compiled once per SIMD level
+ * @author Lukas Ernst
+ *
+ * Included by ProjectionKernels.cpp and the per-level files after
+ * VectorSIMD.hpp, which decides the instruction set. Everything stays in an
+ * anonymous namespace; each file exports its kernels through a getter.
+ * Remainders shorter than one vector go through plain scalar code with the
+ * same tests as Frustum::TestAABB and W2SUtils::GetScreenBounds.
+ */
+
+namespace {
+
+int ProjectPoints(const float* screenMatrix, const ProjectionKernels::ScreenBounds& bounds,
+                  const float* xs, const float* ys, const float* zs,
+                  float* screenX, float* screenY, uint32_t* visibleMask, size_t count,
+                  bool clipToViewport, float* depth) {
+    using namespace VectorMath::SIMD;
+
+    // Hoisted once per call: the matrix rows; the viewport mapping is already part of rows 0 and 1
+    const float (&m)[4][4] = *reinterpret_cast<const float (*)[4][4]>(screenMatrix);
+
+    if (visibleMask) {
+        std::memset(visibleMask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+    }
+
+    const FloatV m00 = Set1(m[0][0]), m01 = Set1(m[0][1]), m02 = Set1(m[0][2]), m03 = Set1(m[0][3]);
+    const FloatV m10 = Set1(m[1][0]), m11 = Set1(m[1][1]), m12 = Set1(m[1][2]), m13 = Set1(m[1][3]);
+    const FloatV m20 = Set1(m[2][0]), m21 = Set1(m[2][1]), m22 = Set1(m[2][2]), m23 = Set1(m[2][3]);
+    const FloatV m30 = Set1(m[3][0]), m31 = Set1(m[3][1]), m32 = Set1(m[3][2]), m33 = Set1(m[3][3]);
+    const FloatV minW = Set1(0.001f), one = Set1(1.0f), invalid = Set1(-1.0f), zero = Set1(0.0f);
+    const float left = bounds.left, right = bounds.right, top = bounds.top, bottom = bounds.bottom;
+    const FloatV leftV = Set1(left), rightV = Set1(right), topV = Set1(top), bottomV = Set1(bottom);
+
+    int visibleCount = 0;
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        const FloatV x = Load(xs + i);
+        const FloatV y = Load(ys + i);
+        const FloatV z = Load(zs + i);
+
+        const FloatV clipX = MulAdd(m00, x, MulAdd(m01, y, MulAdd(m02, z, m03)));
+        const FloatV clipY = MulAdd(m10, x, MulAdd(m11, y, MulAdd(m12, z, m13)));
+        const FloatV w = MulAdd(m30, x, MulAdd(m31, y, MulAdd(m32, z, m33)));
+
+        const MaskV inFront = CmpGe(w, minW);
+        const FloatV invW = Rcp(Select(inFront, w, one));
+        const FloatV sx = Mul(clipX, invW);
+        const FloatV sy = Mul(clipY, invW);
+
+        Store(screenX + i, Select(inFront, sx, invalid));
+        Store(screenY + i, Select(inFront, sy, invalid));
+        if (depth) {
+            // Same arithmetic for every depth convention; the matrix decides the mapping
+            const FloatV clipZ = MulAdd(m20, x, MulAdd(m21, y, MulAdd(m22, z, m23)));
+            Store(depth + i, Select(inFront, Mul(clipZ, invW), zero));
+        }
+
+        MaskV visible = inFront;
+        if (clipToViewport) {
+            visible = MaskAnd(visible, MaskAnd(MaskAnd(CmpGe(sx, leftV), CmpLt(sx, rightV)),
+                                               MaskAnd(CmpGe(sy, topV), CmpLt(sy, bottomV))));
+        }
+
+        const uint32_t bits = MaskBits(visible);
+        visibleCount += PopCount(bits);
+        if (visibleMask) {
+            visibleMask[i >> 5] |= bits << (i & 31);
+        }
+    }
+
+    for (; i < count; ++i) {
+        const float w = m[3][0] * xs[i] + m[3][1] * ys[i] + m[3][2] * zs[i] + m[3][3];
+        if (w >= 0.001f) {
+            const float invW = 1.0f / w;
+            screenX[i] = (m[0][0] * xs[i] + m[0][1] * ys[i] + m[0][2] * zs[i] + m[0][3]) * invW;
+            screenY[i] = (m[1][0] * xs[i] + m[1][1] * ys[i] + m[1][2] * zs[i] + m[1][3]) * invW;
+            if (depth) {
+                depth[i] = (m[2][0] * xs[i] + m[2][1] * ys[i] + m[2][2] * zs[i] + m[2][3]) * invW;
+            }
+            if (clipToViewport && !(screenX[i] >= left && screenX[i] < right && screenY[i] >= top && screenY[i] < bottom)) {
+                continue;
+            }
+            ++visibleCount;
+            if (visibleMask) {
+                visibleMask[i >> 5] |= 1u << (i & 31);
+            }
+        } else {
+            screenX[i] = -1.0f;
+            screenY[i] = -1.0f;
+            if (depth) {
+                depth[i] = 0.0f;
+            }
+        }
+    }
+
+    return visibleCount;
+}
+
+size_t CullBoxes(const float* planes, const ProjectionKernels::BoxStreams& boxes, size_t count,
+                 uint32_t* visibleMask, uint8_t* results) {
+    using namespace VectorMath::SIMD;
+
+    constexpr int kPlanes = 6;
+    constexpr uint8_t kOutside = 0, kIntersect = 1, kInside = 2;
+
+    if (visibleMask) {
+        std::memset(visibleMask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+    }
+
+    // Broadcast plane constants, with the absolute normal for the box extents
+    FloatV nx[kPlanes], ny[kPlanes], nz[kPlanes], ax[kPlanes], ay[kPlanes], az[kPlanes], d[kPlanes];
+    for (int p = 0; p < kPlanes; ++p) {
+        const float* plane = planes + p * 4;
+        nx[p] = Set1(plane[0]);
+        ny[p] = Set1(plane[1]);
+        nz[p] = Set1(plane[2]);
+        ax[p] = Set1(std::abs(plane[0]));
+        ay[p] = Set1(std::abs(plane[1]));
+        az[p] = Set1(std::abs(plane[2]));
+        d[p] = Set1(plane[3]);
+    }
+    const FloatV half = Set1(0.5f), zero = Set1(0.0f);
+    const uint32_t laneMask = (kWidth == 32) ? 0xFFFFFFFFu : ((1u << kWidth) - 1u);
+
+    size_t visibleCount = 0;
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        const FloatV minX = Load(boxes.minX + i), minY = Load(boxes.minY + i), minZ = Load(boxes.minZ + i);
+        const FloatV maxX = Load(boxes.maxX + i), maxY = Load(boxes.maxY + i), maxZ = Load(boxes.maxZ + i);
+        const FloatV cx = Mul(Add(minX, maxX), half), ex = Mul(Sub(maxX, minX), half);
+        const FloatV cy = Mul(Add(minY, maxY), half), ey = Mul(Sub(maxY, minY), half);
+        const FloatV cz = Mul(Add(minZ, maxZ), half), ez = Mul(Sub(maxZ, minZ), half);
+
+        const FloatV distance0 = MulAdd(nx[0], cx, MulAdd(ny[0], cy, MulAdd(nz[0], cz, d[0])));
+        const FloatV radius0 = MulAdd(ax[0], ex, MulAdd(ay[0], ey, Mul(az[0], ez)));
+        MaskV outside = CmpLt(Add(distance0, radius0), zero);
+        MaskV intersect = CmpLt(distance0, radius0);
+
+        for (int p = 1; p < kPlanes; ++p) {
+            const FloatV distance = MulAdd(nx[p], cx, MulAdd(ny[p], cy, MulAdd(nz[p], cz, d[p])));
+            const FloatV radius = MulAdd(ax[p], ex, MulAdd(ay[p], ey, Mul(az[p], ez)));
+            outside = MaskOr(outside, CmpLt(Add(distance, radius), zero));
+            intersect = MaskOr(intersect, CmpLt(distance, radius));
+        }
+
+        const uint32_t outsideBits = MaskBits(outside);
+        const uint32_t intersectBits = MaskBits(intersect);
+        const uint32_t visibleBits = ~outsideBits & laneMask;
+        visibleCount += PopCount(visibleBits);
+        if (visibleMask) {
+            visibleMask[i >> 5] |= visibleBits << (i & 31);
+        }
+        if (results) {
+            for (int lane = 0; lane < kWidth; ++lane) {
+                results[i + lane] = ((outsideBits >> lane) & 1u) ? kOutside
+                                  : ((intersectBits >> lane) & 1u) ? kIntersect : kInside;
+            }
+        }
+    }
+
+    for (; i < count; ++i) {
+        const float cx = (boxes.minX[i] + boxes.maxX[i]) * 0.5f, ex = (boxes.maxX[i] - boxes.minX[i]) * 0.5f;
+        const float cy = (boxes.minY[i] + boxes.maxY[i]) * 0.5f, ey = (boxes.maxY[i] - boxes.minY[i]) * 0.5f;
+        const float cz = (boxes.minZ[i] + boxes.maxZ[i]) * 0.5f, ez = (boxes.maxZ[i] - boxes.minZ[i]) * 0.5f;
+
+        uint8_t result = kInside;
+        for (int p = 0; p < kPlanes; ++p) {
+            const float* plane = planes + p * 4;
+            const float distance = plane[0] * cx + plane[1] * cy + plane[2] * cz + plane[3];
+            const float radius = std::abs(plane[0]) * ex + std::abs(plane[1]) * ey + std::abs(plane[2]) * ez;
+            if (distance < -radius) {
+                result = kOutside;
+                break;
+            }
+            if (distance < radius) {
+                result = kIntersect;
+            }
+        }
+
+        if (results) {
+            results[i] = result;
+        }
+        if (result != kOutside) {
+            ++visibleCount;
+            if (visibleMask) {
+                visibleMask[i >> 5] |= 1u << (i & 31);
+            }
+        }
+    }
+
+    return visibleCount;
+}
+
+size_t ScreenBoundsBoxes(const float* matrix, const float* viewport, const ProjectionKernels::BoxStreams& boxes,
+                         size_t count, const ProjectionKernels::RectStreams& rects, uint32_t* validMask) {
+    using namespace VectorMath::SIMD;
+    using ProjectionKernels::kBoxEdges;
+    using ProjectionKernels::kMinProjectionW;
+
+    if (validMask) {
+        std::memset(validMask, 0, ((count + 31) / 32) * sizeof(uint32_t));
+    }
+
+    const float (&m)[4][4] = *reinterpret_cast<const float (*)[4][4]>(matrix);
+    const float halfWidth = viewport[0] * 0.5f, halfHeight = viewport[1] * 0.5f;
+    const float centerXs = viewport[2] + halfWidth, centerYs = viewport[3] + halfHeight;
+    const int rows[3] = { 0, 1, 3 };
+    FloatV row[3][4];
+    for (int r = 0; r < 3; ++r) {
+        for (int col = 0; col < 4; ++col) {
+            row[r][col] = Set1(m[rows[r]][col]);
+        }
+    }
+
+    const FloatV centerX = Set1(centerXs), centerY = Set1(centerYs);
+    const FloatV scaleX = Set1(halfWidth), scaleY = Set1(-halfHeight);
+    const FloatV minW = Set1(kMinProjectionW), invMinW = Set1(1.0f / kMinProjectionW);
+    const FloatV one = Set1(1.0f), zero = Set1(0.0f);
+    const FloatV positiveMax = Set1(FLT_MAX), negativeMax = Set1(-FLT_MAX);
+
+    size_t validCount = 0;
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        const FloatV minX = Load(boxes.minX + i), minY = Load(boxes.minY + i), minZ = Load(boxes.minZ + i);
+        const FloatV extentX = Sub(Load(boxes.maxX + i), minX);
+        const FloatV extentY = Sub(Load(boxes.maxY + i), minY);
+        const FloatV extentZ = Sub(Load(boxes.maxZ + i), minZ);
+
+        // Corners are the min corner plus any combination of the three edge vectors
+        FloatV clip[3][8];
+        for (int r = 0; r < 3; ++r) {
+            const FloatV base = MulAdd(row[r][0], minX, MulAdd(row[r][1], minY, MulAdd(row[r][2], minZ, row[r][3])));
+            const FloatV stepX = Mul(row[r][0], extentX);
+            const FloatV stepY = Mul(row[r][1], extentY);
+            const FloatV stepZ = Mul(row[r][2], extentZ);
+            for (int c = 0; c < 8; ++c) {
+                FloatV value = base;
+                if (c & 4) value = Add(value, stepX);
+                if (c & 2) value = Add(value, stepY);
+                if (c & 1) value = Add(value, stepZ);
+                clip[r][c] = value;
+            }
+        }
+
+        FloatV left = positiveMax, right = negativeMax, top = positiveMax, bottom = negativeMax;
+        MaskV inFront[8];
+        MaskV anyInFront = CmpLt(one, zero);
+        for (int c = 0; c < 8; ++c) {
+            inFront[c] = CmpGe(clip[2][c], minW);
+            anyInFront = MaskOr(anyInFront, inFront[c]);
+            const FloatV invW = Div(one, Select(inFront[c], clip[2][c], one));
+            const FloatV sx = MulAdd(Mul(clip[0][c], invW), scaleX, centerX);
+            const FloatV sy = MulAdd(Mul(clip[1][c], invW), scaleY, centerY);
+            left = Min(left, Select(inFront[c], sx, positiveMax));
+            right = Max(right, Select(inFront[c], sx, negativeMax));
+            top = Min(top, Select(inFront[c], sy, positiveMax));
+            bottom = Max(bottom, Select(inFront[c], sy, negativeMax));
+        }
+
+        for (const auto& edge : kBoxEdges) {
+            const int a = edge[0], b = edge[1];
+            const MaskV crossing = MaskOr(MaskAndNot(inFront[a], inFront[b]), MaskAndNot(inFront[b], inFront[a]));
+            if (MaskBits(crossing) == 0) {
+                continue;
+            }
+            const FloatV deltaW = Sub(clip[2][b], clip[2][a]);
+            const FloatV t = Div(Sub(minW, clip[2][a]), Select(crossing, deltaW, one));
+            const FloatV x = MulAdd(t, Sub(clip[0][b], clip[0][a]), clip[0][a]);
+            const FloatV y = MulAdd(t, Sub(clip[1][b], clip[1][a]), clip[1][a]);
+            const FloatV sx = MulAdd(Mul(x, invMinW), scaleX, centerX);
+            const FloatV sy = MulAdd(Mul(y, invMinW), scaleY, centerY);
+            left = Min(left, Select(crossing, sx, positiveMax));
+            right = Max(right, Select(crossing, sx, negativeMax));
+            top = Min(top, Select(crossing, sy, positiveMax));
+            bottom = Max(bottom, Select(crossing, sy, negativeMax));
+        }
+
+        Store(rects.left + i, Select(anyInFront, left, zero));
+        Store(rects.right + i, Select(anyInFront, right, zero));
+        Store(rects.top + i, Select(anyInFront, top, zero));
+        Store(rects.bottom + i, Select(anyInFront, bottom, zero));
+
+        const uint32_t bits = MaskBits(anyInFront);
+        validCount += PopCount(bits);
+        if (validMask) {
+            validMask[i >> 5] |= bits << (i & 31);
+        }
+    }
+
+    for (; i < count; ++i) {
+        float clipX[8], clipY[8], clipW[8];
+        for (int c = 0; c < 8; ++c) {
+            const float x = (c & 4) ? boxes.maxX[i] : boxes.minX[i];
+            const float y = (c & 2) ? boxes.maxY[i] : boxes.minY[i];
+            const float z = (c & 1) ? boxes.maxZ[i] : boxes.minZ[i];
+            clipX[c] = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+            clipY[c] = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+            clipW[c] = m[3][0] * x + m[3][1] * y + m[3][2] * z + m[3][3];
+        }
+
+        float left = FLT_MAX, right = -FLT_MAX, top = FLT_MAX, bottom = -FLT_MAX;
+        bool anyInFront = false;
+        auto include = [&](float x, float y, float w) {
+            const float sx = centerXs + x / w * halfWidth;
+            const float sy = centerYs - y / w * halfHeight;
+            left = std::min(left, sx);
+            right = std::max(right, sx);
+            top = std::min(top, sy);
+            bottom = std::max(bottom, sy);
+        };
+
+        for (int c = 0; c < 8; ++c) {
+            if (clipW[c] >= kMinProjectionW) {
+                include(clipX[c], clipY[c], clipW[c]);
+                anyInFront = true;
+            }
+        }
+        if (anyInFront) {
+            for (const auto& edge : kBoxEdges) {
+                const int a = edge[0], b = edge[1];
+                if ((clipW[a] >= kMinProjectionW) != (clipW[b] >= kMinProjectionW)) {
+                    const float t = (kMinProjectionW - clipW[a]) / (clipW[b] - clipW[a]);
+                    include(clipX[a] + (clipX[b] - clipX[a]) * t, clipY[a] + (clipY[b] - clipY[a]) * t, kMinProjectionW);
+                }
+            }
+        } else {
+            left = right = top = bottom = 0.0f;
+        }
+
+        rects.left[i] = left;
+        rects.right[i] = right;
+        rects.top[i] = top;
+        rects.bottom[i] = bottom;
+        if (anyInFront) {
+            ++validCount;
+            if (validMask) {
+                validMask[i >> 5] |= 1u << (i & 31);
+            }
+        }
+    }
+
+    return validCount;
+}
+
+} // namespace
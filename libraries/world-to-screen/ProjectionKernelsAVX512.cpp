@@ -0,0 +1,51 @@
+/**
+ * @file ProjectionKernelsAVX512.cpp
+ * @brief AVX-512 (F and DQ) build of the projection kernels
+ * @author Lukas Ernst
+ *
+ * Enables the instruction set for this file only, so it builds with the
+ * project's baseline flags. The kernels are reached only through the
+ * dispatcher once the CPU has been found to support them; the standard
+ * headers are included before the target switch so none of their inline
+ * functions pick up the wider instructions.
+ */
+
+#include "ProjectionKernels.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !defined(VECTORMATH_NO_SIMD)
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx512dq,avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx2,fma")
+#endif
+
+#define VECTORMATH_SIMD_AVX512 1
+#include "../vector-math/VectorSIMD.hpp"
+
+#include "ProjectionKernels.inl"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+ProjectionKernels::KernelSet ProjectionKernels::GetKernelsAVX512() {
+    return { &ProjectPoints, &CullBoxes, &ScreenBoundsBoxes };
+}
+
+#else
+
+ProjectionKernels::KernelSet ProjectionKernels::GetKernelsAVX512() {
+    return { nullptr, nullptr, nullptr };
+}
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * @file ProjectionKernelsScalar.cpp
+ * @brief Scalar build of the projection kernels
+ * @author Lukas Ernst
+ *
+ * Reference path for VECTORMATH_SIMD_LEVEL=scalar and for comparing the SIMD
+ * builds against.
+ */
+
+#include "ProjectionKernels.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#ifndef VECTORMATH_NO_SIMD
+#define VECTORMATH_NO_SIMD 1
+#endif
+#include "../vector-math/VectorSIMD.hpp"
+
+#include "ProjectionKernels.inl"
+
+ProjectionKernels::KernelSet ProjectionKernels::GetKernelsScalar() {
+    return { &ProjectPoints, &CullBoxes, &ScreenBoundsBoxes };
+}
@@ -0,0 +1,305 @@
+/**
+ * @file ScreenPicking.cpp
+ * @brief Implementation of the screen-space picking grid
+ * @author Lukas Ernst
+ */
+
+#include "ScreenPicking.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Depth first, input index breaks ties so results are deterministic
+inline bool NearerToCamera(const PickHit& a, const PickHit& b) {
+    return a.depth < b.depth || (a.depth == b.depth && a.index < b.index);
+}
+
+// Screen distance first, then depth
+inline bool NearerToPoint(const PickHit& a, const PickHit& b) {
+    return a.distance < b.distance || (a.distance == b.distance && NearerToCamera(a, b));
+}
+
+} // namespace
+
+ScreenPickGrid::ScreenPickGrid(float cellSize)
+    : m_cellSize(std::max(1.0f, cellSize))
+    , m_invCellSize(1.0f / m_cellSize)
+    , m_originX(0.0f)
+    , m_originY(0.0f)
+    , m_width(0.0f)
+    , m_height(0.0f)
+    , m_cellsX(1)
+    , m_cellsY(1) {
+    m_cellStart.assign(2, 0);
+}
+
+void ScreenPickGrid::BeginBuild(const Viewport& viewport) {
+    m_originX = viewport.x_offset;
+    m_originY = viewport.y_offset;
+    m_width = static_cast<float>(std::max(0, viewport.width));
+    m_height = static_cast<float>(std::max(0, viewport.height));
+    m_cellsX = std::max(1, static_cast<int>(std::ceil(m_width * m_invCellSize)));
+    m_cellsY = std::max(1, static_cast<int>(std::ceil(m_height * m_invCellSize)));
+    m_items.clear();
+}
+
+void ScreenPickGrid::FinishBuild() {
+    const size_t cellCount = static_cast<size_t>(m_cellsX) * m_cellsY;
+    m_cellStart.assign(cellCount + 1, 0);
+
+    // Counting sort: count per cell, prefix sum, scatter
+    for (const Item& item : m_items) {
+        const int x0 = CellX(item.left), x1 = CellX(item.right);
+        const int y0 = CellY(item.top), y1 = CellY(item.bottom);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                ++m_cellStart[static_cast<size_t>(y) * m_cellsX + x + 1];
+            }
+        }
+    }
+    for (size_t c = 0; c < cellCount; ++c) {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+
+    m_cellItems.resize(m_cellStart[cellCount]);
+    m_cellCursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t slot = 0; slot < m_items.size(); ++slot) {
+        const Item& item = m_items[slot];
+        const int x0 = CellX(item.left), x1 = CellX(item.right);
+        const int y0 = CellY(item.top), y1 = CellY(item.bottom);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                m_cellItems[m_cellCursor[static_cast<size_t>(y) * m_cellsX + x]++] = static_cast<uint32_t>(slot);
+            }
+        }
+    }
+}
+
+void ScreenPickGrid::Build(const Viewport& viewport, const float* screenX, const float* screenY,
+                           const float* depth, const uint32_t* visibleMask, size_t count) {
+    BeginBuild(viewport);
+
+    const float right = m_originX + m_width;
+    const float bottom = m_originY + m_height;
+    for (size_t i = 0; i < count; ++i) {
+        if (visibleMask && ((visibleMask[i >> 5] >> (i & 31)) & 1u) == 0) {
+            continue;
+        }
+        const float x = screenX[i];
+        const float y = screenY[i];
+        if (!(x >= m_originX && x < right && y >= m_originY && y < bottom)) {
+            continue;
+        }
+        m_items.push_back({ x, y, x, y, depth ? depth[i] : 0.0f, static_cast<uint32_t>(i) });
+    }
+
+    FinishBuild();
+}
+
+void ScreenPickGrid::Build(const WorldToScreenTransform& transform, ConstVec3SoA worldPoints, size_t count) {
+    m_screenX.resize(count);
+    m_screenY.resize(count);
+    m_depth.resize(count);
+    m_visibleMask.resize((count + 31) / 32);
+
+    if (!transform.IsMatrixValid()) {
+        BeginBuild(transform.GetViewport());
+        FinishBuild();
+        return;
+    }
+
+    transform.WorldToScreenParallel(worldPoints, m_screenX.data(), m_screenY.data(), m_visibleMask.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        m_depth[i] = transform.GetDistanceToPoint(Vec3(worldPoints.x[i], worldPoints.y[i], worldPoints.z[i]));
+    }
+
+    Build(transform.GetViewport(), m_screenX.data(), m_screenY.data(), m_depth.data(), m_visibleMask.data(), count);
+}
+
+void ScreenPickGrid::Build(const Viewport& viewport, const W2SUtils::ScreenRect* rects, const float* depth, size_t count) {
+    BeginBuild(viewport);
+
+    const float right = m_originX + m_width;
+    const float bottom = m_originY + m_height;
+    for (size_t i = 0; i < count; ++i) {
+        const W2SUtils::ScreenRect& rect = rects[i];
+        if (!rect.valid || !(rect.right >= m_originX && rect.left < right && rect.bottom >= m_originY && rect.top < bottom)) {
+            continue;
+        }
+        m_items.push_back({ rect.left, rect.top, rect.right, rect.bottom, depth ? depth[i] : 0.0f,
+                            static_cast<uint32_t>(i) });
+    }
+
+    FinishBuild();
+}
+
+int ScreenPickGrid::CellX(float x) const {
+    const float cell = (x - m_originX) * m_invCellSize;
+    if (!(cell >= 0.0f)) {
+        return 0;
+    }
+    return cell >= static_cast<float>(m_cellsX - 1) ? m_cellsX - 1 : static_cast<int>(cell);
+}
+
+int ScreenPickGrid::CellY(float y) const {
+    const float cell = (y - m_originY) * m_invCellSize;
+    if (!(cell >= 0.0f)) {
+        return 0;
+    }
+    return cell >= static_cast<float>(m_cellsY - 1) ? m_cellsY - 1 : static_cast<int>(cell);
+}
+
+float ScreenPickGrid::Distance(const Item& item, const Vec2& point) const {
+    const float dx = std::max(0.0f, std::max(item.left - point.x, point.x - item.right));
+    const float dy = std::max(0.0f, std::max(item.top - point.y, point.y - item.bottom));
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+template <typename Visit>
+void ScreenPickGrid::ForEachInCells(int cellX0, int cellY0, int cellX1, int cellY1, const Visit& visit) const {
+    for (int y = cellY0; y <= cellY1; ++y) {
+        for (int x = cellX0; x <= cellX1; ++x) {
+            const size_t cell = static_cast<size_t>(y) * m_cellsX + x;
+            for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+                const Item& item = m_items[m_cellItems[i]];
+                // A rectangle spanning several cells is only reported from the
+                // first of them inside the range
+                if (std::max(CellX(item.left), cellX0) != x || std::max(CellY(item.top), cellY0) != y) {
+                    continue;
+                }
+                visit(item);
+            }
+        }
+    }
+}
+
+size_t ScreenPickGrid::PickPoint(const Vec2& point, float radius, std::vector<PickHit>& hits) const {
+    hits.clear();
+    if (m_items.empty()) {
+        return 0;
+    }
+
+    ForEachInCells(CellX(point.x - radius), CellY(point.y - radius), CellX(point.x + radius), CellY(point.y + radius),
+                   [&](const Item& item) {
+        const float distance = Distance(item, point);
+        if (distance <= radius) {
+            hits.emplace_back(item.index, item.depth, distance);
+        }
+    });
+
+    std::sort(hits.begin(), hits.end(), NearerToCamera);
+    return hits.size();
+}
+
+bool ScreenPickGrid::PickTopmost(const Vec2& point, float radius, PickHit& hit) const {
+    bool found = false;
+    if (m_items.empty()) {
+        return false;
+    }
+
+    ForEachInCells(CellX(point.x - radius), CellY(point.y - radius), CellX(point.x + radius), CellY(point.y + radius),
+                   [&](const Item& item) {
+        const float distance = Distance(item, point);
+        const PickHit candidate(item.index, item.depth, distance);
+        if (distance <= radius && (!found || NearerToCamera(candidate, hit))) {
+            hit = candidate;
+            found = true;
+        }
+    });
+    return found;
+}
+
+size_t ScreenPickGrid::PickRect(const W2SUtils::ScreenRect& rect, std::vector<PickHit>& hits) const {
+    hits.clear();
+    if (m_items.empty()) {
+        return 0;
+    }
+
+    const float left = std::min(rect.left, rect.right), right = std::max(rect.left, rect.right);
+    const float top = std::min(rect.top, rect.bottom), bottom = std::max(rect.top, rect.bottom);
+    ForEachInCells(CellX(left), CellY(top), CellX(right), CellY(bottom), [&](const Item& item) {
+        if (item.left <= right && item.right >= left && item.top <= bottom && item.bottom >= top) {
+            hits.emplace_back(item.index, item.depth, 0.0f);
+        }
+    });
+
+    std::sort(hits.begin(), hits.end(), NearerToCamera);
+    return hits.size();
+}
+
+size_t ScreenPickGrid::PickNearest(const Vec2& point, size_t k, float maxDistance, std::vector<PickHit>& hits) const {
+    hits.clear();
+    if (m_items.empty() || k == 0) {
+        return 0;
+    }
+
+    const int centerX = CellX(point.x);
+    const int centerY = CellY(point.y);
+
+    auto consider = [&](const Item& item) {
+        const PickHit candidate(item.index, item.depth, Distance(item, point));
+        if (candidate.distance > maxDistance) {
+            return;
+        }
+        if (hits.size() == k && !NearerToPoint(candidate, hits.back())) {
+            return;
+        }
+        // Rectangles show up in every cell they overlap
+        for (const PickHit& hit : hits) {
+            if (hit.index == candidate.index) {
+                return;
+            }
+        }
+        if (hits.size() == k) {
+            hits.pop_back();
+        }
+        hits.insert(std::upper_bound(hits.begin(), hits.end(), candidate, NearerToPoint), candidate);
+    };
+
+    auto visitCell = [&](int x, int y) {
+        const size_t cell = static_cast<size_t>(y) * m_cellsX + x;
+        for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+            consider(m_items[m_cellItems[i]]);
+        }
+    };
+
+    for (int ring = 0;; ++ring) {
+        const int x0 = centerX - ring, x1 = centerX + ring;
+        const int y0 = centerY - ring, y1 = centerY + ring;
+        for (int y = std::max(y0, 0); y <= std::min(y1, m_cellsY - 1); ++y) {
+            if (y == y0 || y == y1) {
+                for (int x = std::max(x0, 0); x <= std::min(x1, m_cellsX - 1); ++x) {
+                    visitCell(x, y);
+                }
+            } else {
+                if (x0 >= 0) {
+                    visitCell(x0, y);
+                }
+                if (x1 < m_cellsX && x1 != x0) {
+                    visitCell(x1, y);
+                }
+            }
+        }
+
+        // Closest any unvisited cell can be: the nearest edge of the visited block
+        // that still has cells beyond it
+        float bound = -1.0f;
+        auto limit = [&](bool cellsBeyond, float distance) {
+            if (cellsBeyond) {
+                distance = std::max(0.0f, distance);
+                bound = bound < 0.0f ? distance : std::min(bound, distance);
+            }
+        };
+        limit(x0 > 0, point.x - (m_originX + x0 * m_cellSize));
+        limit(x1 < m_cellsX - 1, m_originX + (x1 + 1) * m_cellSize - point.x);
+        limit(y0 > 0, point.y - (m_originY + y0 * m_cellSize));
+        limit(y1 < m_cellsY - 1, m_originY + (y1 + 1) * m_cellSize - point.y);
+
+        if (bound < 0.0f || bound > maxDistance || (hits.size() == k && hits.back().distance < bound)) {
+            break;
+        }
+    }
+
+    return hits.size();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file ScreenPicking.hpp
+ * @brief Screen-space uniform grid for cursor and selection-rectangle picking
+ * @author Lukas Ernst
+ *
+ * Projected points or screen rectangles are bucketed into a uniform grid over
+ * the viewport, rebuilt every frame in linear time with a counting sort: one
+ * pass counts items per cell, a prefix sum turns counts into offsets and a
+ * second pass scatters item indices into one flat array. Queries then only
+ * look at the cells they overlap.
+ *
+ * Point and rectangle picks return every hit sorted front to back by depth,
+ * the w of the projection as returned by GetDistanceToPoint. Nearest picks
+ * search rings of cells around the cursor and stop as soon as no unvisited
+ * cell can hold a closer item. Items outside the viewport are not pickable.
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief One picked item
+ */
+struct PickHit {
+    uint32_t index;     // input index of the item
+    float depth;        // w of the item, smaller is closer to the camera
+    float distance;     // screen distance from the query point, 0 inside the item
+
+    PickHit() : index(0), depth(0.0f), distance(0.0f) {}
+    PickHit(uint32_t i, float d, float dist) : index(i), depth(d), distance(dist) {}
+};
+
+/**
+ * @brief Uniform grid over the viewport holding projected points or rectangles
+ */
+class ScreenPickGrid {
+public:
+    /**
+     * @param cellSize Cell edge in pixels; about the typical pick radius works well
+     */
+    explicit ScreenPickGrid(float cellSize = 32.0f);
+
+    /**
+     * @brief Builds the grid from projected points, e.g. WorldToScreenBatch output
+     * @param depth Per-point depth, may be null (all 0)
+     * @param visibleMask Bit i set if point i was projected; may be null (all set)
+     */
+    void Build(const Viewport& viewport, const float* screenX, const float* screenY,
+               const float* depth, const uint32_t* visibleMask, size_t count);
+
+    /**
+     * @brief Projects world points and builds the grid, depth is taken from the transform
+     */
+    void Build(const WorldToScreenTransform& transform, ConstVec3SoA worldPoints, size_t count);
+
+    /**
+     * @brief Builds the grid from screen rectangles, e.g. GetScreenBoundsBatch output
+     *
+     * A rectangle is entered into every cell it overlaps; invalid ones are skipped.
+     * @param depth Per-rectangle depth, may be null (all 0)
+     */
+    void Build(const Viewport& viewport, const W2SUtils::ScreenRect* rects, const float* depth, size_t count);
+
+    /**
+     * @brief Items within radius of a screen position, nearest to the camera first
+     * @return Number of hits
+     */
+    size_t PickPoint(const Vec2& point, float radius, std::vector<PickHit>& hits) const;
+
+    /**
+     * @brief Front-most item within radius of a screen position
+     * @return false if nothing is there
+     */
+    bool PickTopmost(const Vec2& point, float radius, PickHit& hit) const;
+
+    /**
+     * @brief Items overlapping a selection rectangle, nearest to the camera first
+     * @return Number of hits
+     */
+    size_t PickRect(const W2SUtils::ScreenRect& rect, std::vector<PickHit>& hits) const;
+
+    /**
+     * @brief The k items closest to a screen position, by screen distance then depth
+     * @param maxDistance Items farther away on screen are ignored
+     * @return Number of hits, at most k
+     */
+    size_t PickNearest(const Vec2& point, size_t k, float maxDistance, std::vector<PickHit>& hits) const;
+
+    size_t GetItemCount() const { return m_items.size(); }
+    int GetCellsX() const { return m_cellsX; }
+    int GetCellsY() const { return m_cellsY; }
+    float GetCellSize() const { return m_cellSize; }
+
+private:
+    struct Item {
+        float left, top, right, bottom;
+        float depth;
+        uint32_t index;
+    };
+
+    void BeginBuild(const Viewport& viewport);
+    void FinishBuild();
+    int CellX(float x) const;
+    int CellY(float y) const;
+    float Distance(const Item& item, const Vec2& point) const;
+
+    /**
+     * @brief Calls visit once per item stored in the given cell range
+     */
+    template <typename Visit>
+    void ForEachInCells(int cellX0, int cellY0, int cellX1, int cellY1, const Visit& visit) const;
+
+    float m_cellSize;
+    float m_invCellSize;
+    float m_originX;
+    float m_originY;
+    float m_width;
+    float m_height;
+    int m_cellsX;
+    int m_cellsY;
+
+    std::vector<Item> m_items;
+    std::vector<uint32_t> m_cellStart;  // cellsX * cellsY + 1 offsets into m_cellItems
+    std::vector<uint32_t> m_cellItems;  // item slots grouped by cell
+    std::vector<uint32_t> m_cellCursor; // scatter positions during the build
+
+    // Projection scratch of the world-point Build
+    std::vector<float> m_screenX, m_screenY, m_depth;
+    std::vector<uint32_t> m_visibleMask;
+};
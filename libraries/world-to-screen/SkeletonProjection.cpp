@@ -0,0 +1,162 @@
+/**
+ * @file SkeletonProjection.cpp
+ * @brief Implementation of the batch skeleton projector
+ * @author Lukas Ernst
+ */
+
+#include "SkeletonProjection.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+
+namespace {
+
+// Characters per scheduler task; 64 bones each are a few KB of matrices
+constexpr size_t kCharactersPerTask = 16;
+
+} // namespace
+
+SkeletonProjector::SkeletonProjector()
+    : m_characterCount(0) {
+}
+
+bool SkeletonProjector::SetSkeleton(const int32_t* parents, size_t boneCount) {
+    m_parents.clear();
+    m_boneSegments.clear();
+    m_characterCount = 0;
+
+    for (size_t bone = 0; bone < boneCount; ++bone) {
+        if (parents[bone] != kNoParent && (parents[bone] < 0 || static_cast<size_t>(parents[bone]) >= bone)) {
+            m_boneSegments.clear();
+            return false;
+        }
+        if (parents[bone] != kNoParent) {
+            m_boneSegments.push_back(static_cast<uint32_t>(bone));
+        }
+    }
+    m_parents.assign(parents, parents + boneCount);
+    return true;
+}
+
+size_t SkeletonProjector::Update(const WorldToScreenTransform& transform, const float* boneLocals,
+                                 const float* rootTransforms, size_t characterCount, bool clipToViewport,
+                                 VectorMath::TaskScheduler& scheduler) {
+    const size_t jointCount = characterCount * m_parents.size();
+    m_characterCount = characterCount;
+    m_world.resize(jointCount * kMatrixFloats);
+    m_jointX.resize(jointCount);
+    m_jointY.resize(jointCount);
+    m_jointZ.resize(jointCount);
+    m_screenX.resize(jointCount);
+    m_screenY.resize(jointCount);
+    m_visibleMask.assign((jointCount + 31) / 32, 0);
+    m_segments.clear();
+    if (jointCount == 0) {
+        return 0;
+    }
+
+    scheduler.ParallelFor(characterCount, kCharactersPerTask, [&](size_t begin, size_t end) {
+        ComposeCharacters(boneLocals, rootTransforms, begin, end);
+    });
+
+    const size_t visible = transform.WorldToScreenParallel(GetJointPositions(), m_screenX.data(), m_screenY.data(),
+                                                           m_visibleMask.data(), jointCount, scheduler);
+    BuildSegments(transform, clipToViewport);
+    return visible;
+}
+
+void SkeletonProjector::ComposeCharacters(const float* boneLocals, const float* rootTransforms,
+                                          size_t begin, size_t end) {
+    const size_t boneCount = m_parents.size();
+    for (size_t character = begin; character < end; ++character) {
+        const size_t first = character * boneCount;
+        const float* locals = boneLocals + first * kMatrixFloats;
+        const float* root = rootTransforms ? rootTransforms + character * kMatrixFloats : nullptr;
+        float* world = m_world.data() + first * kMatrixFloats;
+
+        // Parents come first, so each parent's world matrix is ready when its children need it
+        for (size_t bone = 0; bone < boneCount; ++bone) {
+            const float* local = locals + bone * kMatrixFloats;
+            float* out = world + bone * kMatrixFloats;
+            if (m_parents[bone] != kNoParent) {
+                VectorMath::SIMD::MultiplyAffine(world + m_parents[bone] * kMatrixFloats, local, out);
+            } else if (root) {
+                VectorMath::SIMD::MultiplyAffine(root, local, out);
+            } else {
+                std::copy(local, local + kMatrixFloats, out);
+            }
+            m_jointX[first + bone] = out[3];
+            m_jointY[first + bone] = out[7];
+            m_jointZ[first + bone] = out[11];
+        }
+    }
+}
+
+void SkeletonProjector::BuildSegments(const WorldToScreenTransform& transform, bool clipToViewport) {
+    const size_t boneCount = m_parents.size();
+    const Viewport& viewport = transform.GetViewport();
+    m_segments.reserve(m_characterCount * m_boneSegments.size());
+    m_clipJoints.clear();
+
+    auto isVisible = [&](size_t joint) { return ((m_visibleMask[joint >> 5] >> (joint & 31)) & 1u) != 0; };
+
+    // Bones with both joints in front (and on screen when clipping) need no clipping
+    for (size_t character = 0; character < m_characterCount; ++character) {
+        const size_t first = character * boneCount;
+        for (uint32_t bone : m_boneSegments) {
+            const size_t joint = first + bone;
+            const size_t parent = first + m_parents[bone];
+            const bool jointVisible = isVisible(joint), parentVisible = isVisible(parent);
+            const Vec2 end(m_screenX[joint], m_screenY[joint]);
+            const Vec2 start(m_screenX[parent], m_screenY[parent]);
+
+            if (jointVisible && parentVisible &&
+                (!clipToViewport || (viewport.IsPointInside(start) && viewport.IsPointInside(end)))) {
+                m_segments.push_back(ScreenSegment(start, end, static_cast<uint32_t>(joint)));
+            } else if (jointVisible || parentVisible || clipToViewport) {
+                m_clipJoints.push_back(static_cast<uint32_t>(joint));
+            }
+        }
+    }
+    if (m_clipJoints.empty()) {
+        return;
+    }
+
+    // The rest are clipped in clip space, then merged back in joint order
+    const size_t clipCount = m_clipJoints.size();
+    for (int axis = 0; axis < 3; ++axis) {
+        m_clipStart[axis].resize(clipCount);
+        m_clipEnd[axis].resize(clipCount);
+    }
+    const std::vector<float>* joints[3] = { &m_jointX, &m_jointY, &m_jointZ };
+    for (size_t i = 0; i < clipCount; ++i) {
+        const size_t joint = m_clipJoints[i];
+        const size_t parent = joint - (joint % boneCount) + m_parents[joint % boneCount];
+        for (int axis = 0; axis < 3; ++axis) {
+            m_clipStart[axis][i] = (*joints[axis])[parent];
+            m_clipEnd[axis][i] = (*joints[axis])[joint];
+        }
+    }
+
+    m_clipped.resize(clipCount);
+    const size_t written = transform.ProjectSegments(
+        ConstVec3SoA(m_clipStart[0].data(), m_clipStart[1].data(), m_clipStart[2].data()),
+        ConstVec3SoA(m_clipEnd[0].data(), m_clipEnd[1].data(), m_clipEnd[2].data()),
+        clipCount, m_clipped.data(), clipToViewport);
+    for (size_t i = 0; i < written; ++i) {
+        m_clipped[i].sourceIndex = m_clipJoints[m_clipped[i].sourceIndex];
+    }
+
+    const size_t direct = m_segments.size();
+    m_segments.insert(m_segments.end(), m_clipped.begin(), m_clipped.begin() + written);
+    std::inplace_merge(m_segments.begin(), m_segments.begin() + direct, m_segments.end(),
+                       [](const ScreenSegment& a, const ScreenSegment& b) { return a.sourceIndex < b.sourceIndex; });
+}
+
+Matrix4x4 SkeletonProjector::GetBoneWorld(size_t character, size_t bone) const {
+    const float* world = m_world.data() + GetJointIndex(character, bone) * kMatrixFloats;
+    Matrix4x4 matrix;
+    for (int e = 0; e < kMatrixFloats; ++e) {
+        matrix.m[e / 4][e % 4] = world[e];
+    }
+    return matrix;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file SkeletonProjection.hpp
+ * @brief Batch world-space skinning and projection of skeleton joints
+ * @author Lukas Ernst
+ *
+ * SkeletonProjector takes bone-local 3x4 affine matrices of many characters
+ * that share one skeleton layout (a parent index per bone, parents before
+ * children), composes them into world space with one SIMD register per
+ * matrix row, and projects every joint of every character in a single SoA
+ * pass. Bone segments from each joint to its parent joint are then built
+ * from the projected joints directly; only bones crossing the camera plane
+ * (or the viewport edge when clipping) go through ProjectSegments to be
+ * clipped. Characters are spread over the TaskScheduler.
+ *
+ * A 3x4 matrix is the upper three rows of a row-major Matrix4x4, twelve
+ * floats per bone, the layout most engines keep bone transforms in.
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Skeleton overlays for many characters in one batch
+ */
+class SkeletonProjector {
+public:
+    static constexpr int32_t kNoParent = -1;
+
+    // Floats per bone matrix: rows 0 to 2, columns 0 to 3
+    static constexpr int kMatrixFloats = 12;
+
+    SkeletonProjector();
+
+    /**
+     * @brief Sets the bone layout shared by all characters
+     * @param parents Parent bone per bone, kNoParent for bones attached to the character root;
+     *        every parent must come before its children
+     * @return false (and an empty skeleton) if a parent index is out of order or out of range
+     */
+    bool SetSkeleton(const int32_t* parents, size_t boneCount);
+
+    size_t GetBoneCount() const { return m_parents.size(); }
+
+    /**
+     * @brief Composes, projects and connects the joints of all characters
+     * @param boneLocals characterCount * boneCount parent-relative 3x4 matrices, character-major
+     * @param rootTransforms One world 3x4 matrix per character, applied above kNoParent bones;
+     *        may be null when the bone matrices of the roots are already in world space
+     * @param clipToViewport Clip segments to the viewport instead of only to the camera plane
+     * @return Number of joints in front of the camera
+     */
+    size_t Update(const WorldToScreenTransform& transform, const float* boneLocals, const float* rootTransforms,
+                  size_t characterCount, bool clipToViewport = false,
+                  VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    size_t GetCharacterCount() const { return m_characterCount; }
+
+    /**
+     * @brief Joint index used by the per-joint arrays and ScreenSegment::sourceIndex
+     */
+    size_t GetJointIndex(size_t character, size_t bone) const { return character * m_parents.size() + bone; }
+
+    /**
+     * @brief Bone-to-world matrix of the last Update
+     */
+    Matrix4x4 GetBoneWorld(size_t character, size_t bone) const;
+
+    /**
+     * @brief World joint positions (bone origins), GetJointIndex order
+     */
+    ConstVec3SoA GetJointPositions() const { return ConstVec3SoA(m_jointX.data(), m_jointY.data(), m_jointZ.data()); }
+
+    /**
+     * @brief Projected joint of a character
+     * @return false if the joint is behind the camera
+     */
+    bool GetJointScreenPosition(size_t character, size_t bone, Vec2& screenPos) const {
+        const size_t joint = GetJointIndex(character, bone);
+        screenPos = Vec2(m_screenX[joint], m_screenY[joint]);
+        return ((m_visibleMask[joint >> 5] >> (joint & 31)) & 1u) != 0;
+    }
+
+    /**
+     * @brief Screen coordinates of all joints, (-1, -1) where behind the camera
+     */
+    const float* GetScreenX() const { return m_screenX.data(); }
+    const float* GetScreenY() const { return m_screenY.data(); }
+
+    /**
+     * @brief Bit j set if joint j is in front of the camera
+     */
+    const uint32_t* GetVisibleMask() const { return m_visibleMask.data(); }
+
+    /**
+     * @brief Visible bone segments from parent joint to joint, in joint order
+     *
+     * sourceIndex is the joint index of the child bone. Bones attached to the
+     * character root have no segment.
+     */
+    const std::vector<ScreenSegment>& GetSegments() const { return m_segments; }
+
+private:
+    void ComposeCharacters(const float* boneLocals, const float* rootTransforms, size_t begin, size_t end);
+    void BuildSegments(const WorldToScreenTransform& transform, bool clipToViewport);
+
+    std::vector<int32_t> m_parents;
+    std::vector<uint32_t> m_boneSegments;   // bones with a parent bone
+    size_t m_characterCount;
+
+    std::vector<float> m_world;             // kMatrixFloats per joint
+    std::vector<float> m_jointX, m_jointY, m_jointZ;
+    std::vector<float> m_screenX, m_screenY;
+    std::vector<uint32_t> m_visibleMask;
+
+    std::vector<ScreenSegment> m_segments;
+    std::vector<ScreenSegment> m_clipped;
+    std::vector<uint32_t> m_clipJoints;     // joints whose bone needs clipping
+    std::vector<float> m_clipStart[3];
+    std::vector<float> m_clipEnd[3];
+};
@@ -0,0 +1,292 @@
+/**
+ * @file TransformHierarchy.cpp
+ * @brief Implementation of the flat transform hierarchy
+ * @author Lukas Ernst
+ */
+
+#include "TransformHierarchy.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <algorithm>
+
+namespace {
+
+// Levels with at least this many nodes are split across the scheduler
+constexpr size_t kParallelNodes = 8192;
+constexpr size_t kNodesPerTask = 4096;
+
+} // namespace
+
+TransformHierarchy::TransformHierarchy()
+    : m_count(0)
+    , m_firstDirty(0)
+    , m_lastUpdateCount(0)
+    , m_structureChanged(false) {
+}
+
+void TransformHierarchy::Clear() {
+    m_count = 0;
+    m_firstDirty = 0;
+    m_lastUpdateCount = 0;
+    m_structureChanged = false;
+    m_parent.clear();
+    m_slot.clear();
+    m_depth.clear();
+    m_changed.clear();
+    m_local.clear();
+    m_world.clear();
+    m_node.clear();
+    m_parentSlot.clear();
+    m_dirty.clear();
+    m_levelStart.clear();
+}
+
+void TransformHierarchy::Reserve(size_t count) {
+    m_parent.reserve(count);
+    m_slot.reserve(count);
+    m_depth.reserve(count);
+    m_changed.reserve((count + 31) / 32);
+    m_local.reserve(count * kElements);
+    m_world.reserve(count * kElements);
+    m_node.reserve(count);
+    m_parentSlot.reserve(count);
+    m_dirty.reserve((count + 31) / 32);
+}
+
+uint32_t TransformHierarchy::AddNode(uint32_t parent, const Matrix4x4& local) {
+    if (parent != kNoParent && parent >= m_count) {
+        return kNoParent;
+    }
+
+    const uint32_t node = static_cast<uint32_t>(m_count);
+    const int depth = parent == kNoParent ? 0 : m_depth[parent] + 1;
+    const size_t slot = m_count;
+
+    m_parent.push_back(parent);
+    m_slot.push_back(static_cast<uint32_t>(slot));
+    m_depth.push_back(depth);
+    m_node.push_back(node);
+    m_parentSlot.push_back(parent == kNoParent ? kNoParent : m_slot[parent]);
+    m_local.resize(m_local.size() + kElements);
+    m_world.resize(m_world.size() + kElements, 0.0f);
+    WriteMatrix(m_local, slot, local);
+    ++m_count;
+    m_dirty.resize((m_count + 31) / 32, 0);
+    m_changed.resize((m_count + 31) / 32, 0);
+    SetDirty(slot);
+
+    // Appending keeps the level order as long as the node is not shallower than the last slot
+    const int levels = static_cast<int>(GetLevelCount());
+    if (m_structureChanged || depth < levels - 1) {
+        m_structureChanged = true;
+    } else if (depth == levels - 1) {
+        ++m_levelStart.back();
+    } else {
+        if (m_levelStart.empty()) {
+            m_levelStart.push_back(0);
+        }
+        m_levelStart.push_back(m_count);
+    }
+    return node;
+}
+
+bool TransformHierarchy::SetParent(uint32_t node, uint32_t parent) {
+    if (node >= m_count || (parent != kNoParent && parent >= m_count)) {
+        return false;
+    }
+    for (uint32_t ancestor = parent; ancestor != kNoParent; ancestor = m_parent[ancestor]) {
+        if (ancestor == node) {
+            return false;
+        }
+    }
+    if (m_parent[node] == parent) {
+        return true;
+    }
+
+    m_parent[node] = parent;
+    m_parentSlot[m_slot[node]] = parent == kNoParent ? kNoParent : m_slot[parent];
+    m_structureChanged = true;
+    SetDirty(m_slot[node]);
+    return true;
+}
+
+void TransformHierarchy::SetLocal(uint32_t node, const Matrix4x4& local) {
+    WriteMatrix(m_local, m_slot[node], local);
+    SetDirty(m_slot[node]);
+}
+
+void TransformHierarchy::MarkDirty(uint32_t node) {
+    SetDirty(m_slot[node]);
+}
+
+void TransformHierarchy::SetDirty(size_t slot) {
+    m_dirty[slot >> 5] |= 1u << (slot & 31);
+    m_firstDirty = std::min(m_firstDirty, slot);
+}
+
+size_t TransformHierarchy::Update(VectorMath::TaskScheduler& scheduler) {
+    std::fill(m_changed.begin(), m_changed.end(), 0u);
+    m_lastUpdateCount = 0;
+
+    if (m_structureChanged) {
+        Reorder();
+    }
+    if (m_firstDirty >= m_count) {
+        return 0;
+    }
+
+    Propagate();
+
+    for (size_t level = 0; level + 1 < m_levelStart.size(); ++level) {
+        const size_t begin = std::max(m_levelStart[level], m_firstDirty);
+        const size_t end = m_levelStart[level + 1];
+        if (end <= begin) {
+            continue;
+        }
+
+        if (end - begin >= kParallelNodes && scheduler.GetThreadCount() > 1) {
+            scheduler.ParallelFor(end - begin, kNodesPerTask, [&](size_t rangeBegin, size_t rangeEnd) {
+                ComputeRange(begin + rangeBegin, begin + rangeEnd);
+            });
+        } else {
+            ComputeRange(begin, end);
+        }
+    }
+
+    // Report recomputed nodes by id and clear the flags
+    for (size_t w = m_firstDirty >> 5; w < m_dirty.size(); ++w) {
+        uint32_t bits = m_dirty[w];
+        m_lastUpdateCount += VectorMath::SIMD::PopCount(bits);
+        while (bits) {
+            const uint32_t node = m_node[(w << 5) + VectorMath::SIMD::LowestBit(bits)];
+            m_changed[node >> 5] |= 1u << (node & 31);
+            bits &= bits - 1;
+        }
+        m_dirty[w] = 0;
+    }
+    m_firstDirty = m_count;
+    return m_lastUpdateCount;
+}
+
+void TransformHierarchy::Reorder() {
+    // Depth of every node; walks each chain of unknown depths once
+    std::fill(m_depth.begin(), m_depth.end(), -1);
+    std::vector<uint32_t> chain;
+    for (size_t i = 0; i < m_count; ++i) {
+        uint32_t node = static_cast<uint32_t>(i);
+        while (node != kNoParent && m_depth[node] < 0) {
+            chain.push_back(node);
+            node = m_parent[node];
+        }
+        int depth = node == kNoParent ? -1 : m_depth[node];
+        while (!chain.empty()) {
+            m_depth[chain.back()] = ++depth;
+            chain.pop_back();
+        }
+    }
+
+    // Counting sort by depth, node ids ascending within a level
+    const int maxDepth = m_count ? *std::max_element(m_depth.begin(), m_depth.end()) : -1;
+    m_levelStart.assign(static_cast<size_t>(maxDepth) + 2, 0);
+    for (size_t i = 0; i < m_count; ++i) {
+        ++m_levelStart[m_depth[i] + 1];
+    }
+    for (size_t level = 1; level < m_levelStart.size(); ++level) {
+        m_levelStart[level] += m_levelStart[level - 1];
+    }
+
+    std::vector<uint32_t> newSlot(m_count);
+    std::vector<size_t> next(m_levelStart.begin(), m_levelStart.end() - 1);
+    for (size_t i = 0; i < m_count; ++i) {
+        newSlot[i] = static_cast<uint32_t>(next[m_depth[i]]++);
+    }
+
+    std::vector<float> scratch(m_count * kElements);
+    auto permute = [&](std::vector<float>& matrices) {
+        for (size_t slot = 0; slot < m_count; ++slot) {
+            std::copy(&matrices[slot * kElements], &matrices[slot * kElements] + kElements,
+                      &scratch[static_cast<size_t>(newSlot[m_node[slot]]) * kElements]);
+        }
+        matrices.swap(scratch);
+    };
+    permute(m_local);
+    permute(m_world);
+
+    std::vector<uint32_t> dirty(m_dirty.size(), 0);
+    m_firstDirty = m_count;
+    for (size_t slot = 0; slot < m_count; ++slot) {
+        if (IsDirty(slot)) {
+            const size_t moved = newSlot[m_node[slot]];
+            dirty[moved >> 5] |= 1u << (moved & 31);
+            m_firstDirty = std::min(m_firstDirty, moved);
+        }
+    }
+    m_dirty.swap(dirty);
+
+    for (size_t i = 0; i < m_count; ++i) {
+        m_slot[i] = newSlot[i];
+        m_node[newSlot[i]] = static_cast<uint32_t>(i);
+    }
+    for (size_t i = 0; i < m_count; ++i) {
+        m_parentSlot[m_slot[i]] = m_parent[i] == kNoParent ? kNoParent : m_slot[m_parent[i]];
+    }
+    m_structureChanged = false;
+}
+
+void TransformHierarchy::Propagate() {
+    // Parents precede their children, so one forward pass reaches every descendant
+    for (size_t slot = m_firstDirty + 1; slot < m_count; ++slot) {
+        const uint32_t parent = m_parentSlot[slot];
+        if (parent != kNoParent && !IsDirty(slot) && IsDirty(parent)) {
+            m_dirty[slot >> 5] |= 1u << (slot & 31);
+        }
+    }
+}
+
+void TransformHierarchy::ComputeRange(size_t begin, size_t end) {
+    // Walks the flagged slots word by word, so clean stretches cost one test per 32 nodes
+    for (size_t w = begin >> 5; (w << 5) < end; ++w) {
+        uint32_t bits = m_dirty[w];
+        if ((w << 5) < begin) {
+            bits &= ~0u << (begin & 31);
+        }
+        if ((w << 5) + 32 > end) {
+            bits &= (1u << (end & 31)) - 1u;
+        }
+        while (bits) {
+            const size_t slot = (w << 5) + VectorMath::SIMD::LowestBit(bits);
+            const uint32_t parent = m_parentSlot[slot];
+            const float* local = &m_local[slot * kElements];
+            float* world = &m_world[slot * kElements];
+            if (parent == kNoParent) {
+                std::copy(local, local + kElements, world);
+            } else {
+                VectorMath::SIMD::MultiplyAffine(&m_world[static_cast<size_t>(parent) * kElements], local, world);
+            }
+            bits &= bits - 1;
+        }
+    }
+}
+
+void TransformHierarchy::GetWorldPositions(VectorMath::Vec3SoA positions) const {
+    for (size_t slot = 0; slot < m_count; ++slot) {
+        const uint32_t node = m_node[slot];
+        const float* world = &m_world[slot * kElements];
+        positions.x[node] = world[3];
+        positions.y[node] = world[7];
+        positions.z[node] = world[11];
+    }
+}
+
+Matrix4x4 TransformHierarchy::ReadMatrix(const std::vector<float>& matrices, size_t slot) {
+    Matrix4x4 matrix;
+    for (int e = 0; e < kElements; ++e) {
+        matrix.m[e / 4][e % 4] = matrices[slot * kElements + e];
+    }
+    return matrix;
+}
+
+void TransformHierarchy::WriteMatrix(std::vector<float>& matrices, size_t slot, const Matrix4x4& matrix) {
+    for (int e = 0; e < kElements; ++e) {
+        matrices[slot * kElements + e] = matrix.m[e / 4][e % 4];
+    }
+}
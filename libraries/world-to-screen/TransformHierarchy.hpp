@@ -0,0 +1,155 @@
+/**
+ * @file TransformHierarchy.hpp
+ * @brief Flat parent-child transform hierarchy with dirty propagation
+ * @author Lukas Ernst
+ *
+ * Stores local and world transforms of many nodes (bones, attachments, scene
+ * objects) in two contiguous arrays of 3x4 affine matrices, the upper three
+ * rows of a Matrix4x4. Nodes are kept sorted by depth in the tree, so every
+ * parent is computed before its children and all nodes of one level are
+ * independent of each other.
+ *
+ * Changing a local transform only flags the node. Update pushes the flags down
+ * to the descendants in one pass over the level order, then recomputes the
+ * flagged nodes level by level: world = parent world * local, one SIMD register
+ * per matrix row, with large levels spread over the TaskScheduler. Untouched
+ * subtrees are never multiplied, and an update with nothing flagged is free.
+ *
+ * Transforms are affine; the bottom row is always taken as (0, 0, 0, 1).
+ */
+
+#pragma once
+
+#include "WorldToScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Level-ordered SoA transform tree with cached world matrices
+ */
+class TransformHierarchy {
+public:
+    static constexpr uint32_t kNoParent = 0xFFFFFFFFu;
+
+    // Floats stored per matrix: rows 0 to 2, columns 0 to 3
+    static constexpr int kElements = 12;
+
+    TransformHierarchy();
+
+    /**
+     * @brief Removes all nodes
+     */
+    void Clear();
+
+    /**
+     * @brief Preallocates storage for count nodes
+     */
+    void Reserve(size_t count);
+
+    /**
+     * @brief Appends a node
+     * @param parent An existing node or kNoParent for a root
+     * @return Id of the new node, ids count up from 0; kNoParent if parent does not exist
+     */
+    uint32_t AddNode(uint32_t parent, const Matrix4x4& local = Matrix4x4::Identity());
+
+    /**
+     * @brief Moves a node and its subtree under another parent
+     * @return false if parent does not exist or is the node itself or one of its descendants
+     */
+    bool SetParent(uint32_t node, uint32_t parent);
+
+    uint32_t GetParent(uint32_t node) const { return m_parent[node]; }
+
+    /**
+     * @brief Replaces a local transform and flags the node for recomputation
+     */
+    void SetLocal(uint32_t node, const Matrix4x4& local);
+
+    Matrix4x4 GetLocal(uint32_t node) const { return ReadMatrix(m_local, m_slot[node]); }
+
+    /**
+     * @brief Flags a node for recomputation without changing its local transform
+     */
+    void MarkDirty(uint32_t node);
+
+    /**
+     * @brief Recomputes world transforms of flagged nodes and their descendants
+     * @return Number of nodes recomputed
+     */
+    size_t Update(VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared());
+
+    /**
+     * @brief Cached world transform as of the last Update
+     */
+    Matrix4x4 GetWorld(uint32_t node) const { return ReadMatrix(m_world, m_slot[node]); }
+
+    /**
+     * @brief World-space origin of a node, the translation column of its world transform
+     */
+    Vec3 GetWorldPosition(uint32_t node) const {
+        const float* world = &m_world[static_cast<size_t>(m_slot[node]) * kElements];
+        return Vec3(world[3], world[7], world[11]);
+    }
+
+    /**
+     * @brief Writes the world origins of all nodes, indexed by node id
+     */
+    void GetWorldPositions(VectorMath::Vec3SoA positions) const;
+
+    /**
+     * @brief Bit i set if node i was recomputed by the last Update, (GetCount() + 31) / 32 words
+     *
+     * Can be passed straight to ProjectionCache::MarkMoved when the cache
+     * holds the node origins.
+     */
+    const uint32_t* GetChangedBits() const { return m_changed.data(); }
+
+    size_t GetCount() const { return m_count; }
+
+    /**
+     * @brief Distance from the root, 0 for roots; valid after Update
+     */
+    int GetDepth(uint32_t node) const { return m_depth[node]; }
+
+    /**
+     * @brief Number of distinct depths, valid after Update
+     */
+    size_t GetLevelCount() const { return m_levelStart.empty() ? 0 : m_levelStart.size() - 1; }
+
+    /**
+     * @brief Number of nodes recomputed by the last Update
+     */
+    size_t GetLastUpdateCount() const { return m_lastUpdateCount; }
+
+private:
+    static Matrix4x4 ReadMatrix(const std::vector<float>& matrices, size_t slot);
+    static void WriteMatrix(std::vector<float>& matrices, size_t slot, const Matrix4x4& matrix);
+
+    bool IsDirty(size_t slot) const { return ((m_dirty[slot >> 5] >> (slot & 31)) & 1u) != 0; }
+    void SetDirty(size_t slot);
+
+    void Reorder();
+    void Propagate();
+    void ComputeRange(size_t begin, size_t end);
+
+    size_t m_count;
+    size_t m_firstDirty;            // lowest flagged slot, m_count if none
+    size_t m_lastUpdateCount;
+    bool m_structureChanged;        // slots are no longer sorted by depth
+
+    // Indexed by node id
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_slot;
+    std::vector<int> m_depth;
+    std::vector<uint32_t> m_changed;
+
+    // Indexed by slot, in level order after Update
+    std::vector<float> m_local;             // kElements floats per slot
+    std::vector<float> m_world;
+    std::vector<uint32_t> m_node;           // node id of a slot
+    std::vector<uint32_t> m_parentSlot;     // kNoParent for roots
+    std::vector<uint32_t> m_dirty;          // one bit per slot
+    std::vector<size_t> m_levelStart;       // first slot of each depth, plus the end
+};
@@ -9,8 +9,15 @@
  */
 
 #include "WorldToScreen.hpp"
+#include "FrustumCulling.hpp"
+#include "ProjectionKernels.hpp"
+#include "../vector-math/VectorSIMD.hpp"
+#include <atomic>
 #include <cfloat>
+#include <cstring>
 #include <algorithm>
+#include <memory>
+#include <thread>
 
 #ifndef DEG2RAD
 #define DEG2RAD(degrees) ((degrees) * M_PI / 180.0f)
@@ -22,6 +29,691 @@
 
 // WorldToScreen.cpp - Additional implementations and utilities
 
+namespace {
+
+// Points are deinterleaved into stack blocks of this size for the AoS batch path
+constexpr int kProjectionBlock = 256;
+
+// Points per parallel tile, a multiple of 32 so visibility mask words never straddle tiles
+constexpr size_t kParallelTile = 2048;
+
+// Tile status for the compaction prefix sum: flag in the top two bits, visible count below
+constexpr uint64_t kTileAggregate = 1ull << 62;
+constexpr uint64_t kTileInclusive = 1ull << 63;
+constexpr uint64_t kTileValueMask = kTileAggregate - 1;
+
+/**
+ * @brief SIMD projection kernel shared by all batch entry points
+ * @param screenMatrix Fused matrix from W2SUtils::CreateScreenMatrix
+ * @param viewport Only used for the bounds test of clipToViewport
+ * @param visibleMask Receives (count + 31) / 32 words, bit i set if point i is visible; may be null
+ * @param clipToViewport Count a point as visible only if it also lands inside the viewport
+ * @param depth Receives NDC z (row 2 over w) in whatever convention the matrix uses,
+ *        0 behind the camera; may be null
+ * @return Number of visible points
+ *
+ * Runs the ProjectionKernels build for the CPU's SIMD level.
+ */
+int ProjectPointsSoA(const Matrix4x4& screenMatrix, const Viewport& viewport,
+                     const float* xs, const float* ys, const float* zs,
+                     float* screenX, float* screenY, uint32_t* visibleMask, size_t count,
+                     bool clipToViewport = false, float* depth = nullptr) {
+    const ProjectionKernels::ScreenBounds bounds = {
+        viewport.x_offset, viewport.width + viewport.x_offset,
+        viewport.y_offset, viewport.height + viewport.y_offset
+    };
+    return ProjectionKernels::GetProjectPoints()(&screenMatrix.m[0][0], bounds, xs, ys, zs, screenX, screenY,
+                                                 visibleMask, count, clipToViewport, depth);
+}
+
+/**
+ * @brief Parallel projection with single-pass compaction
+ * 
+ * project(begin, n, sx, sy, mask) fills tile scratch and returns the visible
+ * count; emit(begin, n, offset, sx, sy, mask) writes the visible points at
+ * their final offset. Tiles are claimed in increasing order, so a tile only
+ * ever waits on predecessors that are already being processed.
+ */
+template <typename ProjectTile, typename EmitTile>
+size_t ProjectCompacted(size_t count, VectorMath::TaskScheduler& scheduler,
+                        const ProjectTile& project, const EmitTile& emit) {
+    const size_t tileCount = (count + kParallelTile - 1) / kParallelTile;
+    if (tileCount == 0) {
+        return 0;
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> status(new std::atomic<uint64_t>[tileCount]);
+    for (size_t i = 0; i < tileCount; ++i) {
+        status[i].store(0, std::memory_order_relaxed);
+    }
+
+    scheduler.ParallelFor(count, kParallelTile, [&](size_t begin, size_t end) {
+        float sx[kParallelTile], sy[kParallelTile];
+        uint32_t mask[kParallelTile / 32];
+        const size_t tile = begin / kParallelTile;
+        const uint64_t visible = project(begin, end - begin, sx, sy, mask);
+
+        // Publish the local count first so successors can look past this tile
+        uint64_t exclusive = 0;
+        if (tile == 0) {
+            status[0].store(kTileInclusive | visible, std::memory_order_release);
+        } else {
+            status[tile].store(kTileAggregate | visible, std::memory_order_release);
+            for (size_t j = tile; j-- > 0;) {
+                uint64_t state;
+                while (((state = status[j].load(std::memory_order_acquire)) & ~kTileValueMask) == 0) {
+                    std::this_thread::yield();
+                }
+                exclusive += state & kTileValueMask;
+                if (state & kTileInclusive) {
+                    break;
+                }
+            }
+            status[tile].store(kTileInclusive | (exclusive + visible), std::memory_order_release);
+        }
+
+        emit(begin, end - begin, static_cast<size_t>(exclusive), sx, sy, mask);
+    });
+
+    return static_cast<size_t>(status[tileCount - 1].load(std::memory_order_acquire) & kTileValueMask);
+}
+
+/**
+ * @brief Calls visit(index) for every set bit of a tile mask in increasing order
+ */
+template <typename Visit>
+void ForEachVisible(const uint32_t* mask, size_t count, const Visit& visit) {
+    for (size_t word = 0; word < (count + 31) / 32; ++word) {
+        uint32_t bits = mask[word];
+        while (bits) {
+            const int lane = VectorMath::SIMD::LowestBit(bits);
+            bits &= bits - 1;
+            visit(word * 32 + lane);
+        }
+    }
+}
+
+// Shared with the box kernels: camera-plane distance and box edges as corner pairs
+using ProjectionKernels::kMinProjectionW;
+using ProjectionKernels::kBoxEdges;
+
+/**
+ * @brief Screen rectangle of the part of a box in front of the camera plane
+ *
+ * The clipped box is the convex hull of its corners in front of the plane and
+ * the points where its edges cross the plane, so the rectangle is the bound of
+ * both sets projected.
+ */
+W2SUtils::ScreenRect ClippedScreenBounds(const Matrix4x4& matrix, const Viewport& viewport,
+                                         const Vec3& minBounds, const Vec3& maxBounds) {
+    const float (&m)[4][4] = matrix.m;
+    const Vec2 center = viewport.GetCenter();
+    const float halfWidth = viewport.width * 0.5f;
+    const float halfHeight = viewport.height * 0.5f;
+
+    float clipX[8], clipY[8], clipW[8];
+    for (int c = 0; c < 8; ++c) {
+        const float x = (c & 4) ? maxBounds.x : minBounds.x;
+        const float y = (c & 2) ? maxBounds.y : minBounds.y;
+        const float z = (c & 1) ? maxBounds.z : minBounds.z;
+        clipX[c] = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+        clipY[c] = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+        clipW[c] = m[3][0] * x + m[3][1] * y + m[3][2] * z + m[3][3];
+    }
+
+    float left = FLT_MAX, right = -FLT_MAX, top = FLT_MAX, bottom = -FLT_MAX;
+    bool anyInFront = false;
+    auto include = [&](float x, float y, float w) {
+        const float sx = center.x + x / w * halfWidth;
+        const float sy = center.y - y / w * halfHeight;
+        left = std::min(left, sx);
+        right = std::max(right, sx);
+        top = std::min(top, sy);
+        bottom = std::max(bottom, sy);
+    };
+
+    for (int c = 0; c < 8; ++c) {
+        if (clipW[c] >= kMinProjectionW) {
+            include(clipX[c], clipY[c], clipW[c]);
+            anyInFront = true;
+        }
+    }
+    if (!anyInFront) {
+        return W2SUtils::ScreenRect();
+    }
+
+    for (const auto& edge : kBoxEdges) {
+        const int a = edge[0], b = edge[1];
+        if ((clipW[a] >= kMinProjectionW) != (clipW[b] >= kMinProjectionW)) {
+            const float t = (kMinProjectionW - clipW[a]) / (clipW[b] - clipW[a]);
+            include(clipX[a] + (clipX[b] - clipX[a]) * t, clipY[a] + (clipY[b] - clipY[a]) * t, kMinProjectionW);
+        }
+    }
+
+    return W2SUtils::ScreenRect(left, right, top, bottom);
+}
+
+/**
+ * @brief SIMD version of ClippedScreenBounds over SoA boxes
+ * @return Number of valid rectangles
+ *
+ * Runs the ProjectionKernels build for the CPU's SIMD level.
+ */
+size_t ClippedScreenBoundsSoA(const Matrix4x4& matrix, const Viewport& viewport,
+                              ConstVec3SoA boxMin, ConstVec3SoA boxMax, size_t count,
+                              W2SUtils::ScreenRectSoA rects, uint32_t* validMask) {
+    const float viewportValues[4] = {
+        static_cast<float>(viewport.width), static_cast<float>(viewport.height), viewport.x_offset, viewport.y_offset
+    };
+    const ProjectionKernels::BoxStreams boxes = { boxMin.x, boxMin.y, boxMin.z, boxMax.x, boxMax.y, boxMax.z };
+    const ProjectionKernels::RectStreams rectStreams = { rects.left, rects.right, rects.top, rects.bottom };
+    return ProjectionKernels::GetKernels().screenBounds(&matrix.m[0][0], viewportValues, boxes, count,
+                                                        rectStreams, validMask);
+}
+
+/**
+ * @brief Clips segment a-b in clip space and projects the surviving part
+ * @return false if nothing of the segment is left
+ */
+bool ClipProjectSegment(const Matrix4x4& matrix, const Viewport& viewport, const Vec3& a, const Vec3& b,
+                        bool clipToViewport, Vec2& start, Vec2& end) {
+    const float (&m)[4][4] = matrix.m;
+    const float ax = m[0][0] * a.x + m[0][1] * a.y + m[0][2] * a.z + m[0][3];
+    const float ay = m[1][0] * a.x + m[1][1] * a.y + m[1][2] * a.z + m[1][3];
+    const float aw = m[3][0] * a.x + m[3][1] * a.y + m[3][2] * a.z + m[3][3];
+    const float bx = m[0][0] * b.x + m[0][1] * b.y + m[0][2] * b.z + m[0][3];
+    const float by = m[1][0] * b.x + m[1][1] * b.y + m[1][2] * b.z + m[1][3];
+    const float bw = m[3][0] * b.x + m[3][1] * b.y + m[3][2] * b.z + m[3][3];
+
+    // Liang-Barsky: each plane d >= 0 shrinks the parameter range [t0, t1]
+    float t0 = 0.0f, t1 = 1.0f;
+    auto clip = [&](float da, float db) {
+        if (da < 0.0f && db < 0.0f) {
+            return false;
+        }
+        if (da < 0.0f) {
+            t0 = std::max(t0, da / (da - db));
+        } else if (db < 0.0f) {
+            t1 = std::min(t1, da / (da - db));
+        }
+        return true;
+    };
+
+    if (!clip(aw - kMinProjectionW, bw - kMinProjectionW)) {
+        return false;
+    }
+    if (clipToViewport) {
+        if (!clip(aw + ax, bw + bx) || !clip(aw - ax, bw - bx) ||
+            !clip(aw + ay, bw + by) || !clip(aw - ay, bw - by)) {
+            return false;
+        }
+    }
+    if (t0 > t1) {
+        return false;
+    }
+
+    const Vec2 center = viewport.GetCenter();
+    const float halfWidth = viewport.width * 0.5f;
+    const float halfHeight = viewport.height * 0.5f;
+    auto project = [&](float t, Vec2& out) {
+        const float w = std::max(aw + (bw - aw) * t, kMinProjectionW);
+        out.x = center.x + (ax + (bx - ax) * t) / w * halfWidth;
+        out.y = center.y - (ay + (by - ay) * t) / w * halfHeight;
+    };
+    project(t0, start);
+    project(t1, end);
+    return true;
+}
+
+/**
+ * @brief SIMD segment clipping and projection with compacted output
+ * @param firstIndex sourceIndex of segment 0
+ * @return Number of segments written
+ */
+size_t ProjectSegmentsSoA(const Matrix4x4& matrix, const Viewport& viewport,
+                          ConstVec3SoA starts, ConstVec3SoA ends, size_t count, uint32_t firstIndex,
+                          bool clipToViewport, ScreenSegment* out) {
+    using namespace VectorMath::SIMD;
+
+    const float (&m)[4][4] = matrix.m;
+    const Vec2 center = viewport.GetCenter();
+    const int rows[3] = { 0, 1, 3 };
+    FloatV row[3][4];
+    for (int r = 0; r < 3; ++r) {
+        for (int col = 0; col < 4; ++col) {
+            row[r][col] = Set1(m[rows[r]][col]);
+        }
+    }
+
+    const FloatV centerX = Set1(center.x), centerY = Set1(center.y);
+    const FloatV scaleX = Set1(viewport.width * 0.5f), scaleY = Set1(-viewport.height * 0.5f);
+    const FloatV minW = Set1(kMinProjectionW), zero = Set1(0.0f), one = Set1(1.0f);
+
+    alignas(64) float startX[kWidth], startY[kWidth], endX[kWidth], endY[kWidth];
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        FloatV clipA[3], clipB[3];
+        const FloatV ax = Load(starts.x + i), ay = Load(starts.y + i), az = Load(starts.z + i);
+        const FloatV bx = Load(ends.x + i), by = Load(ends.y + i), bz = Load(ends.z + i);
+        for (int r = 0; r < 3; ++r) {
+            clipA[r] = MulAdd(row[r][0], ax, MulAdd(row[r][1], ay, MulAdd(row[r][2], az, row[r][3])));
+            clipB[r] = MulAdd(row[r][0], bx, MulAdd(row[r][1], by, MulAdd(row[r][2], bz, row[r][3])));
+        }
+
+        FloatV t0 = zero, t1 = one;
+        MaskV rejected = CmpLt(one, zero);
+        auto clip = [&](FloatV da, FloatV db) {
+            const MaskV aOut = CmpLt(da, zero);
+            const MaskV bOut = CmpLt(db, zero);
+            rejected = MaskOr(rejected, MaskAnd(aOut, bOut));
+            const MaskV entering = MaskAndNot(bOut, aOut);
+            const MaskV leaving = MaskAndNot(aOut, bOut);
+            const FloatV t = Div(da, Select(MaskOr(entering, leaving), Sub(da, db), one));
+            t0 = Select(entering, Max(t0, t), t0);
+            t1 = Select(leaving, Min(t1, t), t1);
+        };
+
+        clip(Sub(clipA[2], minW), Sub(clipB[2], minW));
+        if (clipToViewport) {
+            clip(Add(clipA[2], clipA[0]), Add(clipB[2], clipB[0]));
+            clip(Sub(clipA[2], clipA[0]), Sub(clipB[2], clipB[0]));
+            clip(Add(clipA[2], clipA[1]), Add(clipB[2], clipB[1]));
+            clip(Sub(clipA[2], clipA[1]), Sub(clipB[2], clipB[1]));
+        }
+        rejected = MaskOr(rejected, CmpGt(t0, t1));
+
+        const uint32_t accepted = ~MaskBits(rejected) & ((kWidth == 32) ? 0xFFFFFFFFu : ((1u << kWidth) - 1u));
+        if (accepted == 0) {
+            continue;
+        }
+
+        const FloatV dx = Sub(clipB[0], clipA[0]), dy = Sub(clipB[1], clipA[1]), dw = Sub(clipB[2], clipA[2]);
+        const FloatV w0 = Max(MulAdd(t0, dw, clipA[2]), minW);
+        const FloatV w1 = Max(MulAdd(t1, dw, clipA[2]), minW);
+        Store(startX, MulAdd(Div(MulAdd(t0, dx, clipA[0]), w0), scaleX, centerX));
+        Store(startY, MulAdd(Div(MulAdd(t0, dy, clipA[1]), w0), scaleY, centerY));
+        Store(endX, MulAdd(Div(MulAdd(t1, dx, clipA[0]), w1), scaleX, centerX));
+        Store(endY, MulAdd(Div(MulAdd(t1, dy, clipA[1]), w1), scaleY, centerY));
+
+        uint32_t bits = accepted;
+        while (bits) {
+            const int lane = LowestBit(bits);
+            bits &= bits - 1;
+            out[written++] = ScreenSegment(Vec2(startX[lane], startY[lane]), Vec2(endX[lane], endY[lane]),
+                                           firstIndex + static_cast<uint32_t>(i + lane));
+        }
+    }
+
+    for (; i < count; ++i) {
+        Vec2 start, end;
+        if (ClipProjectSegment(matrix, viewport, Vec3(starts.x[i], starts.y[i], starts.z[i]),
+                               Vec3(ends.x[i], ends.y[i], ends.z[i]), clipToViewport, start, end)) {
+            out[written++] = ScreenSegment(start, end, firstIndex + static_cast<uint32_t>(i));
+        }
+    }
+
+    return written;
+}
+
+/**
+ * @brief Gathers AoS segments into SoA blocks for ProjectSegmentsSoA
+ * 
+ * fetch(i, start, end) returns the endpoints of segment i.
+ */
+template <typename Fetch>
+size_t ProjectSegmentBlocks(const Matrix4x4& matrix, const Viewport& viewport, size_t count,
+                            bool clipToViewport, ScreenSegment* out, const Fetch& fetch) {
+    float ax[kProjectionBlock], ay[kProjectionBlock], az[kProjectionBlock];
+    float bx[kProjectionBlock], by[kProjectionBlock], bz[kProjectionBlock];
+
+    size_t written = 0;
+    for (size_t base = 0; base < count; base += kProjectionBlock) {
+        const size_t n = std::min(static_cast<size_t>(kProjectionBlock), count - base);
+        for (size_t i = 0; i < n; ++i) {
+            Vec3 start, end;
+            fetch(base + i, start, end);
+            ax[i] = start.x; ay[i] = start.y; az[i] = start.z;
+            bx[i] = end.x; by[i] = end.y; bz[i] = end.z;
+        }
+        written += ProjectSegmentsSoA(matrix, viewport, ConstVec3SoA(ax, ay, az), ConstVec3SoA(bx, by, bz), n,
+                                      static_cast<uint32_t>(base), clipToViewport, out + written);
+    }
+    return written;
+}
+
+/**
+ * @brief Inverse view-projection with the pixel-to-NDC mapping folded in
+ * 
+ * near = rows . (x, y, 1) + nearOffset and mid = rows . (x, y, 1), both
+ * homogeneous, for pixel coordinates x and y.
+ */
+struct UnprojectConstants {
+    float m[4][3];          // per output row: x, y and constant coefficients of the depth-0 point
+    float nearOffset[4];    // added for the near-plane point (NDC z = -1)
+};
+
+UnprojectConstants MakeUnprojectConstants(const Matrix4x4& invViewProj, const Viewport& viewport) {
+    // ndcX = x * ax + bx, ndcY = y * ay + by
+    const float ax = 2.0f / viewport.width, bx = -1.0f - viewport.x_offset * ax;
+    const float ay = -2.0f / viewport.height, by = 1.0f - viewport.y_offset * ay;
+
+    UnprojectConstants c;
+    for (int r = 0; r < 4; ++r) {
+        const float (&row)[4] = invViewProj.m[r];
+        c.m[r][0] = row[0] * ax;
+        c.m[r][1] = row[1] * ay;
+        c.m[r][2] = row[0] * bx + row[1] * by + row[3];
+        c.nearOffset[r] = -row[2];
+    }
+    return c;
+}
+
+inline void UnprojectScalar(const UnprojectConstants& c, float x, float y, Vec3& origin, Vec3& direction) {
+    float mid[4], nearPoint[4];
+    for (int r = 0; r < 4; ++r) {
+        mid[r] = c.m[r][0] * x + c.m[r][1] * y + c.m[r][2];
+        nearPoint[r] = mid[r] + c.nearOffset[r];
+    }
+    const float invNearW = 1.0f / nearPoint[3];
+    const float invMidW = 1.0f / mid[3];
+    origin = Vec3(nearPoint[0] * invNearW, nearPoint[1] * invNearW, nearPoint[2] * invNearW);
+    direction = Vec3(mid[0] * invMidW - origin.x, mid[1] * invMidW - origin.y, mid[2] * invMidW - origin.z);
+    const float length = direction.Length();
+    if (length > 0.0f) {
+        direction = direction * (1.0f / length);
+    }
+}
+
+/**
+ * @brief Unprojects kWidth pixels and stores the rays at offset i
+ */
+template <typename FloatV>
+inline void UnprojectLanes(const FloatV (&coeff)[4][3], const FloatV (&nearOffset)[4], FloatV x, FloatV y,
+                           VectorMath::Vec3SoA origins, VectorMath::Vec3SoA directions, size_t i) {
+    using namespace VectorMath::SIMD;
+
+    FloatV mid[4], nearPoint[4];
+    for (int r = 0; r < 4; ++r) {
+        mid[r] = MulAdd(coeff[r][0], x, MulAdd(coeff[r][1], y, coeff[r][2]));
+        nearPoint[r] = Add(mid[r], nearOffset[r]);
+    }
+
+    const FloatV one = Set1(1.0f);
+    const FloatV invNearW = Div(one, nearPoint[3]);
+    const FloatV invMidW = Div(one, mid[3]);
+    const FloatV ox = Mul(nearPoint[0], invNearW), oy = Mul(nearPoint[1], invNearW), oz = Mul(nearPoint[2], invNearW);
+    const FloatV dx = Sub(Mul(mid[0], invMidW), ox);
+    const FloatV dy = Sub(Mul(mid[1], invMidW), oy);
+    const FloatV dz = Sub(Mul(mid[2], invMidW), oz);
+    const FloatV length = Sqrt(MulAdd(dx, dx, MulAdd(dy, dy, Mul(dz, dz))));
+    const FloatV zero = Set1(0.0f);
+    const FloatV invLength = Select(CmpGt(length, zero), Div(one, length), one);
+
+    Store(origins.x + i, ox);
+    Store(origins.y + i, oy);
+    Store(origins.z + i, oz);
+    Store(directions.x + i, Mul(dx, invLength));
+    Store(directions.y + i, Mul(dy, invLength));
+    Store(directions.z + i, Mul(dz, invLength));
+}
+
+inline void StoreRay(VectorMath::Vec3SoA origins, VectorMath::Vec3SoA directions, size_t i,
+                     const Vec3& origin, const Vec3& direction) {
+    origins.x[i] = origin.x;
+    origins.y[i] = origin.y;
+    origins.z[i] = origin.z;
+    directions.x[i] = direction.x;
+    directions.y[i] = direction.y;
+    directions.z[i] = direction.z;
+}
+
+} // namespace
+
+/**
+ * @brief Recomputes the fused screen matrix after the matrix or viewport changed
+ */
+void WorldToScreenTransform::UpdateScreenMatrix() {
+    m_screenMatrix = W2SUtils::CreateScreenMatrix(m_viewMatrix, m_viewport);
+}
+
+/**
+ * @brief AoS batch transform through the SoA kernel
+ */
+int WorldToScreenTransform::WorldToScreenBatch(const Vec3* worldPoints, Vec2* screenPoints, int count) const {
+    if (!m_matrixValid) {
+        return 0;
+    }
+
+    float xs[kProjectionBlock], ys[kProjectionBlock], zs[kProjectionBlock];
+    float sx[kProjectionBlock], sy[kProjectionBlock];
+
+    int successCount = 0;
+    for (int base = 0; base < count; base += kProjectionBlock) {
+        const int blockCount = std::min(kProjectionBlock, count - base);
+        for (int i = 0; i < blockCount; ++i) {
+            xs[i] = worldPoints[base + i].x;
+            ys[i] = worldPoints[base + i].y;
+            zs[i] = worldPoints[base + i].z;
+        }
+
+        successCount += ProjectPointsSoA(m_screenMatrix, m_viewport, xs, ys, zs, sx, sy, nullptr, blockCount);
+
+        for (int i = 0; i < blockCount; ++i) {
+            screenPoints[base + i] = Vec2(sx[i], sy[i]);
+        }
+    }
+
+    return successCount;
+}
+
+/**
+ * @brief SoA batch transform with visibility bitmask
+ */
+int WorldToScreenTransform::WorldToScreenBatch(ConstVec3SoA worldPoints, float* screenX, float* screenY,
+                                               uint32_t* visibleMask, int count) const {
+    if (!m_matrixValid || count <= 0) {
+        return 0;
+    }
+    return ProjectPointsSoA(m_screenMatrix, m_viewport, worldPoints.x, worldPoints.y, worldPoints.z,
+                            screenX, screenY, visibleMask, static_cast<size_t>(count));
+}
+
+/**
+ * @brief SoA batch transform that also writes NDC depth
+ */
+int WorldToScreenTransform::WorldToScreenBatch(ConstVec3SoA worldPoints, float* screenX, float* screenY, float* depth,
+                                               uint32_t* visibleMask, int count) const {
+    if (!m_matrixValid || count <= 0) {
+        return 0;
+    }
+    return ProjectPointsSoA(m_screenMatrix, m_viewport, worldPoints.x, worldPoints.y, worldPoints.z,
+                            screenX, screenY, visibleMask, static_cast<size_t>(count), false, depth);
+}
+
+/**
+ * @brief Multi-threaded SoA batch transform
+ */
+size_t WorldToScreenTransform::WorldToScreenParallel(ConstVec3SoA worldPoints, float* screenX, float* screenY,
+                                                     uint32_t* visibleMask, size_t count,
+                                                     VectorMath::TaskScheduler& scheduler) const {
+    if (!m_matrixValid || count == 0) {
+        return 0;
+    }
+
+    std::atomic<size_t> visibleCount(0);
+    scheduler.ParallelFor(count, kParallelTile, [&](size_t begin, size_t end) {
+        const int visible = ProjectPointsSoA(m_screenMatrix, m_viewport,
+                                             worldPoints.x + begin, worldPoints.y + begin, worldPoints.z + begin,
+                                             screenX + begin, screenY + begin,
+                                             visibleMask ? visibleMask + begin / 32 : nullptr, end - begin);
+        visibleCount.fetch_add(static_cast<size_t>(visible), std::memory_order_relaxed);
+    });
+    return visibleCount.load();
+}
+
+/**
+ * @brief Parallel projection with compacted on-screen output (SoA)
+ */
+size_t WorldToScreenTransform::WorldToScreenCompact(ConstVec3SoA worldPoints, size_t count, float* screenX, float* screenY,
+                                                    uint32_t* sourceIndices, VectorMath::TaskScheduler& scheduler) const {
+    if (!m_matrixValid) {
+        return 0;
+    }
+
+    auto project = [&](size_t begin, size_t n, float* sx, float* sy, uint32_t* mask) {
+        return static_cast<uint64_t>(ProjectPointsSoA(m_screenMatrix, m_viewport,
+                                                      worldPoints.x + begin, worldPoints.y + begin, worldPoints.z + begin,
+                                                      sx, sy, mask, n, true));
+    };
+    auto emit = [&](size_t begin, size_t n, size_t offset, const float* sx, const float* sy, const uint32_t* mask) {
+        ForEachVisible(mask, n, [&](size_t i) {
+            screenX[offset] = sx[i];
+            screenY[offset] = sy[i];
+            if (sourceIndices) {
+                sourceIndices[offset] = static_cast<uint32_t>(begin + i);
+            }
+            ++offset;
+        });
+    };
+    return ProjectCompacted(count, scheduler, project, emit);
+}
+
+/**
+ * @brief Parallel projection with compacted on-screen output (AoS)
+ */
+size_t WorldToScreenTransform::WorldToScreenCompact(const Vec3* worldPoints, size_t count, Vec2* screenPoints,
+                                                    uint32_t* sourceIndices, VectorMath::TaskScheduler& scheduler) const {
+    if (!m_matrixValid) {
+        return 0;
+    }
+
+    auto project = [&](size_t begin, size_t n, float* sx, float* sy, uint32_t* mask) {
+        float xs[kParallelTile], ys[kParallelTile], zs[kParallelTile];
+        for (size_t i = 0; i < n; ++i) {
+            xs[i] = worldPoints[begin + i].x;
+            ys[i] = worldPoints[begin + i].y;
+            zs[i] = worldPoints[begin + i].z;
+        }
+        return static_cast<uint64_t>(ProjectPointsSoA(m_screenMatrix, m_viewport, xs, ys, zs, sx, sy, mask, n, true));
+    };
+    auto emit = [&](size_t begin, size_t n, size_t offset, const float* sx, const float* sy, const uint32_t* mask) {
+        ForEachVisible(mask, n, [&](size_t i) {
+            screenPoints[offset] = Vec2(sx[i], sy[i]);
+            if (sourceIndices) {
+                sourceIndices[offset] = static_cast<uint32_t>(begin + i);
+            }
+            ++offset;
+        });
+    };
+    return ProjectCompacted(count, scheduler, project, emit);
+}
+
+/**
+ * @brief SIMD segment projection with clip-space clipping
+ */
+size_t WorldToScreenTransform::ProjectSegments(ConstVec3SoA starts, ConstVec3SoA ends, size_t count,
+                                               ScreenSegment* out, bool clipToViewport) const {
+    if (!m_matrixValid) {
+        return 0;
+    }
+    return ProjectSegmentsSoA(m_viewMatrix, m_viewport, starts, ends, count, 0, clipToViewport, out);
+}
+
+/**
+ * @brief AoS segment projection through SoA blocks
+ */
+size_t WorldToScreenTransform::ProjectSegments(const Vec3* starts, const Vec3* ends, size_t count,
+                                               ScreenSegment* out, bool clipToViewport) const {
+    if (!m_matrixValid) {
+        return 0;
+    }
+    return ProjectSegmentBlocks(m_viewMatrix, m_viewport, count, clipToViewport, out,
+                                [&](size_t i, Vec3& start, Vec3& end) {
+        start = starts[i];
+        end = ends[i];
+    });
+}
+
+/**
+ * @brief Indexed segment projection
+ */
+size_t WorldToScreenTransform::ProjectLines(const Vec3* vertices, const uint32_t* indices, size_t segmentCount,
+                                            ScreenSegment* out, bool clipToViewport) const {
+    if (!m_matrixValid) {
+        return 0;
+    }
+    return ProjectSegmentBlocks(m_viewMatrix, m_viewport, segmentCount, clipToViewport, out,
+                                [&](size_t i, Vec3& start, Vec3& end) {
+        start = vertices[indices[2 * i]];
+        end = vertices[indices[2 * i + 1]];
+    });
+}
+
+/**
+ * @brief Polyline projection, the end stream is the vertex stream shifted by one
+ */
+size_t WorldToScreenTransform::ProjectPolyline(ConstVec3SoA vertices, size_t vertexCount,
+                                               ScreenSegment* out, bool clipToViewport) const {
+    if (!m_matrixValid || vertexCount < 2) {
+        return 0;
+    }
+    const ConstVec3SoA next(vertices.x + 1, vertices.y + 1, vertices.z + 1);
+    return ProjectSegmentsSoA(m_viewMatrix, m_viewport, vertices, next, vertexCount - 1, 0, clipToViewport, out);
+}
+
+/**
+ * @brief AoS polyline projection
+ */
+size_t WorldToScreenTransform::ProjectPolyline(const Vec3* vertices, size_t vertexCount,
+                                               ScreenSegment* out, bool clipToViewport) const {
+    if (!m_matrixValid || vertexCount < 2) {
+        return 0;
+    }
+    return ProjectSegmentBlocks(m_viewMatrix, m_viewport, vertexCount - 1, clipToViewport, out,
+                                [&](size_t i, Vec3& start, Vec3& end) {
+        start = vertices[i];
+        end = vertices[i + 1];
+    });
+}
+
+/**
+ * @brief Rebases an absolute view-projection matrix on origin
+ */
+void CameraRelativeTransform::SetViewMatrix(const Matrix4x4d& viewProjMatrix, const Vec3d& origin) {
+    // viewProj * T(origin) cancels the large translation in double before narrowing
+    m_origin = origin;
+    m_relative.SetViewMatrix((viewProjMatrix * Matrix4x4d::CreateTranslation(origin)).ToFloat());
+}
+
+/**
+ * @brief Sets a camera whose view-projection has no translation part
+ */
+void CameraRelativeTransform::SetCamera(const Vec3d& cameraPos, const Matrix4x4& rotationProjMatrix) {
+    m_origin = cameraPos;
+    m_relative.SetViewMatrix(rotationProjMatrix);
+}
+
+/**
+ * @brief Batch transform of absolute positions through the float batch path
+ */
+int CameraRelativeTransform::WorldToScreenBatch(const Vec3d* worldPoints, Vec2* screenPoints, int count) const {
+    // Rebase in cache-sized tiles so the float pass runs on contiguous data
+    constexpr int kTileSize = 256;
+    Vec3 relative[kTileSize];
+
+    int successCount = 0;
+    for (int base = 0; base < count; base += kTileSize) {
+        const int tileCount = std::min(kTileSize, count - base);
+        for (int i = 0; i < tileCount; ++i) {
+            relative[i] = worldPoints[base + i].RelativeTo(m_origin);
+        }
+        successCount += m_relative.WorldToScreenBatch(relative, screenPoints + base, tileCount);
+    }
+    return successCount;
+}
+
 namespace W2SUtils {
 
 /**
@@ -101,6 +793,22 @@ bool QuickWorldToScreen(const Vec3& worldPos, const Matrix4x4& viewMatrix,
     return true;
 }
 
+/**
+ * @brief Fold the viewport mapping into rows 0 and 1 of a view-projection matrix
+ */
+Matrix4x4 CreateScreenMatrix(const Matrix4x4& viewProjMatrix, const Viewport& viewport) {
+    const Vec2 center = viewport.GetCenter();
+    const float halfWidth = viewport.width * 0.5f;
+    const float halfHeight = viewport.height * 0.5f;
+
+    Matrix4x4 result = viewProjMatrix;
+    for (int col = 0; col < 4; ++col) {
+        result.m[0][col] = center.x * viewProjMatrix.m[3][col] + halfWidth * viewProjMatrix.m[0][col];
+        result.m[1][col] = center.y * viewProjMatrix.m[3][col] - halfHeight * viewProjMatrix.m[1][col];
+    }
+    return result;
+}
+
 /**
  * @brief Create a view matrix from position and Euler angles
  */
@@ -244,6 +952,85 @@ Ray ScreenToWorldRay(const Vec2& screenPos, const Matrix4x4& viewMatrix, const M
     return Ray(rayOrigin, rayDirection);
 }
 
+/**
+ * @brief Unproject one pixel with a precomputed inverse
+ */
+Ray ScreenToWorldRay(const Vec2& screenPos, const Matrix4x4& invViewProj, const Viewport& viewport) {
+    Vec3 origin, direction;
+    UnprojectScalar(MakeUnprojectConstants(invViewProj, viewport), screenPos.x, screenPos.y, origin, direction);
+    return Ray(origin, direction);
+}
+
+/**
+ * @brief SIMD unprojection of a pixel list
+ */
+void ScreenToWorldRays(const float* screenX, const float* screenY, size_t count,
+                       const Matrix4x4& invViewProj, const Viewport& viewport,
+                       VectorMath::Vec3SoA origins, VectorMath::Vec3SoA directions) {
+    using namespace VectorMath::SIMD;
+
+    const UnprojectConstants c = MakeUnprojectConstants(invViewProj, viewport);
+    FloatV coeff[4][3], nearOffset[4];
+    for (int r = 0; r < 4; ++r) {
+        for (int k = 0; k < 3; ++k) {
+            coeff[r][k] = Set1(c.m[r][k]);
+        }
+        nearOffset[r] = Set1(c.nearOffset[r]);
+    }
+
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        UnprojectLanes(coeff, nearOffset, Load(screenX + i), Load(screenY + i), origins, directions, i);
+    }
+    for (; i < count; ++i) {
+        Vec3 origin, direction;
+        UnprojectScalar(c, screenX[i], screenY[i], origin, direction);
+        StoreRay(origins, directions, i, origin, direction);
+    }
+}
+
+/**
+ * @brief SIMD unprojection of a pixel grid
+ */
+void ScreenToWorldRayGrid(const Vec2& firstPixel, const Vec2& step, int columns, int rows,
+                          const Matrix4x4& invViewProj, const Viewport& viewport,
+                          VectorMath::Vec3SoA origins, VectorMath::Vec3SoA directions) {
+    using namespace VectorMath::SIMD;
+
+    const UnprojectConstants c = MakeUnprojectConstants(invViewProj, viewport);
+    FloatV coeff[4][3], nearOffset[4];
+    for (int r = 0; r < 4; ++r) {
+        for (int k = 0; k < 3; ++k) {
+            coeff[r][k] = Set1(c.m[r][k]);
+        }
+        nearOffset[r] = Set1(c.nearOffset[r]);
+    }
+
+    // Lane offsets along a row
+    alignas(64) float laneX[kWidth];
+    for (size_t lane = 0; lane < kWidth; ++lane) {
+        laneX[lane] = lane * step.x;
+    }
+    const FloatV laneOffset = Load(laneX);
+
+    for (int row = 0; row < rows; ++row) {
+        const float y = firstPixel.y + row * step.y;
+        const FloatV yV = Set1(y);
+        const size_t rowStart = static_cast<size_t>(row) * columns;
+
+        size_t col = 0;
+        for (; col + kWidth <= static_cast<size_t>(columns); col += kWidth) {
+            const FloatV x = Add(Set1(firstPixel.x + col * step.x), laneOffset);
+            UnprojectLanes(coeff, nearOffset, x, yV, origins, directions, rowStart + col);
+        }
+        for (; col < static_cast<size_t>(columns); ++col) {
+            Vec3 origin, direction;
+            UnprojectScalar(c, firstPixel.x + col * step.x, y, origin, direction);
+            StoreRay(origins, directions, rowStart + col, origin, direction);
+        }
+    }
+}
+
 /**
  * @brief Calculate matrix inverse (simplified for 4x4 matrices)
  */
@@ -300,34 +1087,129 @@ Matrix4x4 InverseMatrix(const Matrix4x4& matrix) {
 }
 
 /**
- * @brief Check if a 3D bounding box is visible in the view frustum
+ * @brief General 4x4 inverse by cofactor expansion
  */
-bool IsBoundingBoxVisible(const Vec3& minBounds, const Vec3& maxBounds, const Matrix4x4& viewProjMatrix, const Viewport& viewport) {
-    // Test all 8 corners of the bounding box
-    Vec3 corners[8] = {
-        Vec3(minBounds.x, minBounds.y, minBounds.z),
-        Vec3(maxBounds.x, minBounds.y, minBounds.z),
-        Vec3(minBounds.x, maxBounds.y, minBounds.z),
-        Vec3(maxBounds.x, maxBounds.y, minBounds.z),
-        Vec3(minBounds.x, minBounds.y, maxBounds.z),
-        Vec3(maxBounds.x, minBounds.y, maxBounds.z),
-        Vec3(minBounds.x, maxBounds.y, maxBounds.z),
-        Vec3(maxBounds.x, maxBounds.y, maxBounds.z)
+bool InvertMatrix(const Matrix4x4& matrix, Matrix4x4& inverse) {
+    double a[16];
+    for (int i = 0; i < 16; ++i) {
+        a[i] = matrix.m[i / 4][i % 4];
+    }
+
+    // 2x2 minors of the top two and bottom two rows
+    const double s0 = a[0] * a[5] - a[4] * a[1];
+    const double s1 = a[0] * a[6] - a[4] * a[2];
+    const double s2 = a[0] * a[7] - a[4] * a[3];
+    const double s3 = a[1] * a[6] - a[5] * a[2];
+    const double s4 = a[1] * a[7] - a[5] * a[3];
+    const double s5 = a[2] * a[7] - a[6] * a[3];
+    const double c5 = a[10] * a[15] - a[14] * a[11];
+    const double c4 = a[9] * a[15] - a[13] * a[11];
+    const double c3 = a[9] * a[14] - a[13] * a[10];
+    const double c2 = a[8] * a[15] - a[12] * a[11];
+    const double c1 = a[8] * a[14] - a[12] * a[10];
+    const double c0 = a[8] * a[13] - a[12] * a[9];
+
+    const double det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det == 0.0 || !std::isfinite(det)) {
+        return false;
+    }
+    const double invDet = 1.0 / det;
+
+    const double r[16] = {
+        ( a[5] * c5 - a[6] * c4 + a[7] * c3) * invDet,
+        (-a[1] * c5 + a[2] * c4 - a[3] * c3) * invDet,
+        ( a[13] * s5 - a[14] * s4 + a[15] * s3) * invDet,
+        (-a[9] * s5 + a[10] * s4 - a[11] * s3) * invDet,
+        (-a[4] * c5 + a[6] * c2 - a[7] * c1) * invDet,
+        ( a[0] * c5 - a[2] * c2 + a[3] * c1) * invDet,
+        (-a[12] * s5 + a[14] * s2 - a[15] * s1) * invDet,
+        ( a[8] * s5 - a[10] * s2 + a[11] * s1) * invDet,
+        ( a[4] * c4 - a[5] * c2 + a[7] * c0) * invDet,
+        (-a[0] * c4 + a[1] * c2 - a[3] * c0) * invDet,
+        ( a[12] * s4 - a[13] * s2 + a[15] * s0) * invDet,
+        (-a[8] * s4 + a[9] * s2 - a[11] * s0) * invDet,
+        (-a[4] * c3 + a[5] * c1 - a[6] * c0) * invDet,
+        ( a[0] * c3 - a[1] * c1 + a[2] * c0) * invDet,
+        (-a[12] * s3 + a[13] * s1 - a[14] * s0) * invDet,
+        ( a[8] * s3 - a[9] * s1 + a[10] * s0) * invDet
     };
-    
-    int visibleCorners = 0;
-    for (int i = 0; i < 8; ++i) {
-        Vec2 screenPos;
-        WorldToScreenTransform transform(viewport);
-        transform.SetViewMatrix(viewProjMatrix);
-        
-        if (transform.WorldToScreen(corners[i], screenPos) && viewport.IsPointInside(screenPos)) {
-            visibleCorners++;
+
+    for (int i = 0; i < 16; ++i) {
+        inverse.m[i / 4][i % 4] = static_cast<float>(r[i]);
+    }
+    return true;
+}
+
+/**
+ * @brief LinearizeDepth for many values with SIMD
+ */
+void LinearizeDepthBatch(const float* ndcDepth, float* viewDepth, size_t count, const Matrix4x4& projMatrix) {
+    using namespace VectorMath::SIMD;
+
+    const FloatV scale = Set1(projMatrix.m[2][3]);
+    const FloatV offset = Set1(projMatrix.m[2][2]);
+    size_t i = 0;
+    for (; i + kWidth <= count; i += kWidth) {
+        Store(viewDepth + i, Div(scale, Add(Load(ndcDepth + i), offset)));
+    }
+    for (; i < count; ++i) {
+        viewDepth[i] = LinearizeDepth(ndcDepth[i], projMatrix);
+    }
+}
+
+/**
+ * @brief Measures how well float NDC depth preserves distance and order
+ */
+DepthErrorStats MeasureDepthError(const Matrix4x4& projMatrix, float nearDistance, float farDistance,
+                                  size_t sampleCount, float separation) {
+    DepthErrorStats stats = { 0.0, 0.0, 0, sampleCount };
+    if (sampleCount == 0 || !(nearDistance > 0.0f) || !(farDistance >= nearDistance)) {
+        stats.sampleCount = 0;
+        return stats;
+    }
+
+    const float (&m)[4][4] = projMatrix.m;
+    // Float pipeline of the batch kernels for a point on the view axis (z = -distance)
+    auto project = [&](float distance) {
+        const float clipZ = m[2][2] * -distance + m[2][3];
+        const float w = m[3][2] * -distance + m[3][3];
+        return clipZ / w;
+    };
+    // Depth grows with distance when m[2][3] < 0 (standard), shrinks for reverse-Z
+    const double direction = m[2][3] < 0.0f ? 1.0 : -1.0;
+
+    const double logNear = std::log(static_cast<double>(nearDistance));
+    const double logFar = std::log(static_cast<double>(farDistance));
+    double errorSum = 0.0;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        const double t = sampleCount > 1 ? static_cast<double>(i) / static_cast<double>(sampleCount - 1) : 0.0;
+        const float distance = static_cast<float>(std::exp(logNear + (logFar - logNear) * t));
+
+        const float depth = project(distance);
+        const double reconstructed = static_cast<double>(m[2][3]) / (static_cast<double>(depth) + m[2][2]);
+        const double error = std::abs(reconstructed - distance) / distance;
+        // Depth that saturated to a constant reconstructs to infinity
+        const double bounded = std::isfinite(error) ? error : 1.0;
+        stats.maxRelativeError = std::max(stats.maxRelativeError, bounded);
+        errorSum += bounded;
+
+        const float fartherDepth = project(distance * (1.0f + separation));
+        if (!(direction * (static_cast<double>(fartherDepth) - depth) > 0.0)) {
+            ++stats.orderingErrors;
         }
     }
-    
-    // If any corner is visible, the bounding box might be visible
-    return visibleCorners > 0;
+    stats.meanRelativeError = errorSum / static_cast<double>(sampleCount);
+    return stats;
+}
+
+/**
+ * @brief Check if a 3D bounding box is visible in the view frustum
+ */
+bool IsBoundingBoxVisible(const Vec3& minBounds, const Vec3& maxBounds, const Matrix4x4& viewProjMatrix, const Viewport& viewport) {
+    // Plane tests instead of corner projection: a box can cover the screen with
+    // every corner off-screen or behind the camera
+    (void)viewport;
+    return Frustum::FromMatrix(viewProjMatrix).IsAABBVisible(minBounds, maxBounds);
 }
 
 /**
@@ -336,40 +1218,53 @@ bool IsBoundingBoxVisible(const Vec3& minBounds, const Vec3& maxBounds, const Ma
 
 
 ScreenRect GetScreenBounds(const Vec3& minBounds, const Vec3& maxBounds, const Matrix4x4& viewMatrix, const Viewport& viewport) {
-    Vec3 corners[8] = {
-        Vec3(minBounds.x, minBounds.y, minBounds.z),
-        Vec3(maxBounds.x, minBounds.y, minBounds.z),
-        Vec3(minBounds.x, maxBounds.y, minBounds.z),
-        Vec3(maxBounds.x, maxBounds.y, minBounds.z),
-        Vec3(minBounds.x, minBounds.y, maxBounds.z),
-        Vec3(maxBounds.x, minBounds.y, maxBounds.z),
-        Vec3(minBounds.x, maxBounds.y, maxBounds.z),
-        Vec3(maxBounds.x, maxBounds.y, maxBounds.z)
-    };
-    
-    float minX = FLT_MAX, maxX = -FLT_MAX;
-    float minY = FLT_MAX, maxY = -FLT_MAX;
-    int validPoints = 0;
-    
-    WorldToScreenTransform transform(viewport);
-    transform.SetViewMatrix(viewMatrix);
-    
-    for (int i = 0; i < 8; ++i) {
-        Vec2 screenPos;
-        if (transform.WorldToScreen(corners[i], screenPos)) {
-            minX = std::min(minX, screenPos.x);
-            maxX = std::max(maxX, screenPos.x);
-            minY = std::min(minY, screenPos.y);
-            maxY = std::max(maxY, screenPos.y);
-            validPoints++;
+    return ClippedScreenBounds(viewMatrix, viewport, minBounds, maxBounds);
+}
+
+/**
+ * @brief Screen rectangles of many SoA boxes with SIMD
+ */
+size_t GetScreenBoundsBatch(ConstVec3SoA boxMin, ConstVec3SoA boxMax, size_t count,
+                            const Matrix4x4& viewMatrix, const Viewport& viewport,
+                            ScreenRectSoA rects, uint32_t* validMask) {
+    return ClippedScreenBoundsSoA(viewMatrix, viewport, boxMin, boxMax, count, rects, validMask);
+}
+
+/**
+ * @brief Screen rectangles of many AoS boxes
+ */
+size_t GetScreenBoundsBatch(const AABB* boxes, size_t count, const Matrix4x4& viewMatrix,
+                            const Viewport& viewport, ScreenRect* rects) {
+    float minX[kProjectionBlock], minY[kProjectionBlock], minZ[kProjectionBlock];
+    float maxX[kProjectionBlock], maxY[kProjectionBlock], maxZ[kProjectionBlock];
+    float left[kProjectionBlock], right[kProjectionBlock], top[kProjectionBlock], bottom[kProjectionBlock];
+    uint32_t valid[kProjectionBlock / 32];
+
+    size_t validCount = 0;
+    for (size_t base = 0; base < count; base += kProjectionBlock) {
+        const size_t n = std::min(static_cast<size_t>(kProjectionBlock), count - base);
+        for (size_t i = 0; i < n; ++i) {
+            minX[i] = boxes[base + i].minBounds.x;
+            minY[i] = boxes[base + i].minBounds.y;
+            minZ[i] = boxes[base + i].minBounds.z;
+            maxX[i] = boxes[base + i].maxBounds.x;
+            maxY[i] = boxes[base + i].maxBounds.y;
+            maxZ[i] = boxes[base + i].maxBounds.z;
+        }
+
+        validCount += ClippedScreenBoundsSoA(viewMatrix, viewport, ConstVec3SoA(minX, minY, minZ),
+                                             ConstVec3SoA(maxX, maxY, maxZ), n,
+                                             ScreenRectSoA(left, right, top, bottom), valid);
+
+        for (size_t i = 0; i < n; ++i) {
+            if ((valid[i >> 5] >> (i & 31)) & 1u) {
+                rects[base + i] = ScreenRect(left[i], right[i], top[i], bottom[i]);
+            } else {
+                rects[base + i] = ScreenRect();
+            }
         }
     }
-    
-    if (validPoints > 0) {
-        return ScreenRect(minX, maxX, minY, maxY);
-    }
-    
-    return ScreenRect(); // Invalid
+    return validCount;
 }
 
 } // namespace W2SUtils
\ No newline at end of file
@@ -18,7 +18,9 @@
 #pragma once
 
 #include "../vector-math/Vector.hpp"
+#include "../vector-math/TaskScheduler.hpp"
 #include <array>
+#include <cstdint>
 #include <iostream>
 #include <iomanip>
 #include <cmath>
@@ -138,6 +140,41 @@ struct Matrix4x4 {
         return result;
     }
 
+    /**
+     * @brief Reverse-Z perspective: NDC depth 1 at the near plane, 0 at the far plane
+     *
+     * Float has most of its precision near 0, which reverse-Z spends on the far
+     * range where the hyperbolic depth of CreatePerspective runs out of bits.
+     * Depth is 0..1 (Direct3D/Vulkan clip space); screen x/y and w are the same
+     * as for CreatePerspective.
+     */
+    static Matrix4x4 CreatePerspectiveReverseZ(float fov, float aspect, float nearPlane, float farPlane) {
+        Matrix4x4 result = CreatePerspective(fov, aspect, nearPlane, farPlane);
+        result.m[2][2] = nearPlane / (farPlane - nearPlane);
+        result.m[2][3] = farPlane * nearPlane / (farPlane - nearPlane);
+        return result;
+    }
+
+    /**
+     * @brief CreatePerspective with the far plane at infinity, NDC depth -1 (near) to 1
+     */
+    static Matrix4x4 CreatePerspectiveInfinite(float fov, float aspect, float nearPlane) {
+        Matrix4x4 result = CreatePerspective(fov, aspect, nearPlane, 2.0f * nearPlane);
+        result.m[2][2] = -1.0f;
+        result.m[2][3] = -2.0f * nearPlane;
+        return result;
+    }
+
+    /**
+     * @brief Reverse-Z with the far plane at infinity: NDC depth is nearPlane / distance
+     */
+    static Matrix4x4 CreatePerspectiveInfiniteReverseZ(float fov, float aspect, float nearPlane) {
+        Matrix4x4 result = CreatePerspective(fov, aspect, nearPlane, 2.0f * nearPlane);
+        result.m[2][2] = 0.0f;
+        result.m[2][3] = nearPlane;
+        return result;
+    }
+
     static Matrix4x4 CreateLookAt(const Vec3& eye, const Vec3& center, const Vec3& up) {
         Vec3 forward = (center - eye).Normalized();
         Vec3 right = forward.Cross(up).Normalized();
@@ -223,6 +260,76 @@ struct Matrix4x4 {
     }
 };
 
+/**
+ * @brief Double-precision 4x4 matrix for large world coordinates
+ * 
+ * Same layout and conventions as Matrix4x4. Used to compose view-projection
+ * matrices whose translation is too large for float before rebasing them
+ * around a local origin (see CameraRelativeTransform).
+ */
+struct Matrix4x4d {
+    double m[4][4];
+
+    Matrix4x4d() {
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                m[i][j] = (i == j) ? 1.0 : 0.0;
+            }
+        }
+    }
+
+    explicit Matrix4x4d(const Matrix4x4& matrix) {
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                m[i][j] = matrix.m[i][j];
+            }
+        }
+    }
+
+    Matrix4x4d operator*(const Matrix4x4d& other) const {
+        Matrix4x4d result;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                result.m[i][j] = 0.0;
+                for (int k = 0; k < 4; ++k) {
+                    result.m[i][j] += m[i][k] * other.m[k][j];
+                }
+            }
+        }
+        return result;
+    }
+
+    Vec3d TransformVector(const Vec3d& vector) const {
+        return Vec3d(
+            m[0][0] * vector.x + m[0][1] * vector.y + m[0][2] * vector.z + m[0][3],
+            m[1][0] * vector.x + m[1][1] * vector.y + m[1][2] * vector.z + m[1][3],
+            m[2][0] * vector.x + m[2][1] * vector.y + m[2][2] * vector.z + m[2][3]
+        );
+    }
+
+    double GetTransformW(const Vec3d& vector) const {
+        return m[3][0] * vector.x + m[3][1] * vector.y + m[3][2] * vector.z + m[3][3];
+    }
+
+    Matrix4x4 ToFloat() const {
+        Matrix4x4 result;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                result.m[i][j] = static_cast<float>(m[i][j]);
+            }
+        }
+        return result;
+    }
+
+    static Matrix4x4d CreateTranslation(const Vec3d& translation) {
+        Matrix4x4d result;
+        result.m[0][3] = translation.x;
+        result.m[1][3] = translation.y;
+        result.m[2][3] = translation.z;
+        return result;
+    }
+};
+
 /**
  * @brief Screen dimensions and viewport information
  */
@@ -254,18 +361,35 @@ struct Viewport {
     }
 };
 
+/**
+ * @brief Projected line segment, ready for drawing
+ */
+struct ScreenSegment {
+    Vec2 start;
+    Vec2 end;
+    uint32_t sourceIndex;  // index of the input segment
+
+    ScreenSegment() : sourceIndex(0) {}
+    ScreenSegment(const Vec2& s, const Vec2& e, uint32_t index) : start(s), end(e), sourceIndex(index) {}
+};
+
 /**
  * @brief Main class for world-to-screen transformations
  */
 class WorldToScreenTransform {
 private:
     Matrix4x4 m_viewMatrix;
+    Matrix4x4 m_screenMatrix;   // m_viewMatrix with the viewport mapping folded in
     Viewport m_viewport;
     bool m_matrixValid;
 
+    void UpdateScreenMatrix();
+
 public:
     WorldToScreenTransform(const Viewport& viewport) 
-        : m_viewport(viewport), m_matrixValid(false) {}
+        : m_viewport(viewport), m_matrixValid(false) {
+        UpdateScreenMatrix();
+    }
 
     /**
      * @brief Sets the view matrix for transformations
@@ -274,6 +398,7 @@ public:
     void SetViewMatrix(const Matrix4x4& matrix) {
         m_viewMatrix = matrix;
         m_matrixValid = true;
+        UpdateScreenMatrix();
     }
 
     /**
@@ -282,6 +407,7 @@ public:
      */
     void SetViewport(const Viewport& viewport) {
         m_viewport = viewport;
+        UpdateScreenMatrix();
     }
 
     /**
@@ -295,9 +421,9 @@ public:
             return false;
         }
 
-        // Transform the point through the view matrix
-        Vec3 transformed = m_viewMatrix.TransformVector(worldPos);
-        float w = m_viewMatrix.GetTransformW(worldPos);
+        // The screen matrix yields pixel coordinates scaled by w
+        const float (&m)[4][4] = m_screenMatrix.m;
+        float w = m[3][0] * worldPos.x + m[3][1] * worldPos.y + m[3][2] * worldPos.z + m[3][3];
 
         // Check if point is behind the camera
         if (w < 0.001f) {
@@ -306,13 +432,8 @@ public:
 
         // Perspective divide
         float invW = 1.0f / w;
-        transformed.x *= invW;
-        transformed.y *= invW;
-
-        // Convert to screen coordinates
-        Vec2 center = m_viewport.GetCenter();
-        screenPos.x = center.x + (transformed.x * m_viewport.width * 0.5f);
-        screenPos.y = center.y - (transformed.y * m_viewport.height * 0.5f);
+        screenPos.x = (m[0][0] * worldPos.x + m[0][1] * worldPos.y + m[0][2] * worldPos.z + m[0][3]) * invW;
+        screenPos.y = (m[1][0] * worldPos.x + m[1][1] * worldPos.y + m[1][2] * worldPos.z + m[1][3]) * invW;
 
         return true;
     }
@@ -323,36 +444,106 @@ public:
      * @param screenPoints Output array of 2D screen positions
      * @param count Number of points to transform
      * @return Number of successfully transformed points
+     * 
+     * Points are deinterleaved into SoA blocks and run through the SIMD kernel of
+     * the SoA overload. Points behind the camera are written as (-1, -1).
      */
-    int WorldToScreenBatch(const Vec3* worldPoints, Vec2* screenPoints, int count) const {
-        if (!m_matrixValid) {
-            return 0;
-        }
+    int WorldToScreenBatch(const Vec3* worldPoints, Vec2* screenPoints, int count) const;
 
-        int successCount = 0;
-        Vec2 center = m_viewport.GetCenter();
-        
-        for (int i = 0; i < count; ++i) {
-            Vec3 transformed = m_viewMatrix.TransformVector(worldPoints[i]);
-            float w = m_viewMatrix.GetTransformW(worldPoints[i]);
-
-            if (w >= 0.001f) {
-                float invW = 1.0f / w;
-                transformed.x *= invW;
-                transformed.y *= invW;
-
-                screenPoints[i].x = center.x + (transformed.x * m_viewport.width * 0.5f);
-                screenPoints[i].y = center.y - (transformed.y * m_viewport.height * 0.5f);
-                
-                successCount++;
-            } else {
-                // Mark invalid points
-                screenPoints[i] = Vec2(-1.0f, -1.0f);
-            }
-        }
+    /**
+     * @brief SIMD transform of points stored as separate x/y/z streams
+     * @param worldPoints SoA input positions
+     * @param screenX Output screen x coordinates (-1 for points behind the camera)
+     * @param screenY Output screen y coordinates (-1 for points behind the camera)
+     * @param visibleMask Output bitmask, bit i of word i / 32 set if point i is in
+     *        front of the camera; (count + 31) / 32 words are written, may be null
+     * @param count Number of points to transform
+     * @return Number of points in front of the camera
+     */
+    int WorldToScreenBatch(ConstVec3SoA worldPoints, float* screenX, float* screenY,
+                           uint32_t* visibleMask, int count) const;
 
-        return successCount;
-    }
+    /**
+     * @brief SoA transform that also writes the NDC depth of every point
+     * 
+     * Depth is row 2 of the matrix over w, so standard, reverse-Z and infinite
+     * projections all go through the same kernel; W2SUtils::LinearizeDepth turns
+     * it back into a distance.
+     * @param depth Output NDC depth, 0 for points behind the camera
+     */
+    int WorldToScreenBatch(ConstVec3SoA worldPoints, float* screenX, float* screenY, float* depth,
+                           uint32_t* visibleMask, int count) const;
+
+    /**
+     * @brief Multi-threaded SoA transform, same outputs as the SoA WorldToScreenBatch
+     * @param scheduler Worker pool the input is partitioned across
+     * @return Number of points in front of the camera
+     */
+    size_t WorldToScreenParallel(ConstVec3SoA worldPoints, float* screenX, float* screenY,
+                                 uint32_t* visibleMask, size_t count,
+                                 VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared()) const;
+
+    /**
+     * @brief Multi-threaded projection that keeps only points landing inside the viewport
+     * 
+     * Each tile is projected into thread-local scratch, then finds its output
+     * offset through a single-pass prefix sum over per-tile visible counts
+     * (decoupled look-back), so the compacted output is written directly,
+     * in input order, without locks or a separate compaction pass.
+     * 
+     * @param screenX Compacted screen x coordinates, room for count entries
+     * @param screenY Compacted screen y coordinates, room for count entries
+     * @param sourceIndices Input index of each written point, may be null
+     * @return Number of points written
+     */
+    size_t WorldToScreenCompact(ConstVec3SoA worldPoints, size_t count, float* screenX, float* screenY,
+                                uint32_t* sourceIndices,
+                                VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared()) const;
+
+    /**
+     * @brief AoS variant of WorldToScreenCompact
+     */
+    size_t WorldToScreenCompact(const Vec3* worldPoints, size_t count, Vec2* screenPoints,
+                                uint32_t* sourceIndices,
+                                VectorMath::TaskScheduler& scheduler = VectorMath::TaskScheduler::Shared()) const;
+
+    /**
+     * @brief SIMD projection of line segments with clipping before the perspective divide
+     * 
+     * Each segment is clipped in clip space against the camera plane and, when
+     * clipToViewport is set, against the four viewport edges (Liang-Barsky), so
+     * segments reaching behind the camera keep their visible part instead of
+     * being dropped.
+     * 
+     * @param out Receives the visible segments in input order, room for count entries
+     * @return Number of segments written
+     */
+    size_t ProjectSegments(ConstVec3SoA starts, ConstVec3SoA ends, size_t count,
+                           ScreenSegment* out, bool clipToViewport = false) const;
+
+    /**
+     * @brief AoS variant of ProjectSegments
+     */
+    size_t ProjectSegments(const Vec3* starts, const Vec3* ends, size_t count,
+                           ScreenSegment* out, bool clipToViewport = false) const;
+
+    /**
+     * @brief Projects indexed segments, e.g. skeleton bones or wireframe edges
+     * @param indices Two vertex indices per segment
+     * @param segmentCount Number of index pairs
+     */
+    size_t ProjectLines(const Vec3* vertices, const uint32_t* indices, size_t segmentCount,
+                        ScreenSegment* out, bool clipToViewport = false) const;
+
+    /**
+     * @brief Projects the vertexCount - 1 segments of a polyline in one pass
+     * 
+     * Segment i joins vertex i and i + 1 and is reported with sourceIndex i.
+     */
+    size_t ProjectPolyline(ConstVec3SoA vertices, size_t vertexCount,
+                           ScreenSegment* out, bool clipToViewport = false) const;
+    size_t ProjectPolyline(const Vec3* vertices, size_t vertexCount,
+                           ScreenSegment* out, bool clipToViewport = false) const;
 
     /**
      * @brief Checks if a 3D point would be visible on screen
@@ -387,6 +578,18 @@ public:
      */
     const Viewport& GetViewport() const { return m_viewport; }
 
+    /**
+     * @brief Gets the current view(-projection) matrix
+     * @return Matrix set by SetViewMatrix
+     */
+    const Matrix4x4& GetViewMatrix() const { return m_viewMatrix; }
+
+    /**
+     * @brief Gets the view matrix with the viewport folded in
+     * @return Matrix whose rows 0 and 1 give screen x and y times w, see W2SUtils::CreateScreenMatrix
+     */
+    const Matrix4x4& GetScreenMatrix() const { return m_screenMatrix; }
+
     /**
      * @brief Checks if the view matrix is valid
      * @return true if matrix is set and valid
@@ -394,6 +597,76 @@ public:
     bool IsMatrixValid() const { return m_matrixValid; }
 };
 
+/**
+ * @brief World-to-screen transformation for worlds larger than float precision
+ * 
+ * Keeps a double-precision origin (normally the camera position) and a float
+ * view-projection matrix rebased onto that origin. Points are subtracted from the
+ * origin in double, narrowed to float, and projected with the regular float
+ * batch path, so precision depends on distance from the camera rather than
+ * distance from the world origin.
+ */
+class CameraRelativeTransform {
+private:
+    Vec3d m_origin;
+    WorldToScreenTransform m_relative;
+
+public:
+    CameraRelativeTransform(const Viewport& viewport)
+        : m_relative(viewport) {}
+
+    /**
+     * @brief Sets an absolute-space view-projection matrix and rebases it on origin
+     * @param viewProjMatrix View-projection matrix in absolute world coordinates
+     * @param origin Rebasing origin, usually the camera position
+     */
+    void SetViewMatrix(const Matrix4x4d& viewProjMatrix, const Vec3d& origin);
+
+    /**
+     * @brief Sets a camera from its position and a translation-free view-projection
+     * @param cameraPos Absolute camera position
+     * @param rotationProjMatrix Projection * rotation, i.e. the view-projection of a camera at the origin
+     */
+    void SetCamera(const Vec3d& cameraPos, const Matrix4x4& rotationProjMatrix);
+
+    /**
+     * @brief Updates the viewport dimensions
+     */
+    void SetViewport(const Viewport& viewport) { m_relative.SetViewport(viewport); }
+
+    /**
+     * @brief Transforms an absolute world position to 2D screen coordinates
+     */
+    bool WorldToScreen(const Vec3d& worldPos, Vec2& screenPos) const {
+        return m_relative.WorldToScreen(worldPos.RelativeTo(m_origin), screenPos);
+    }
+
+    /**
+     * @brief Transforms multiple absolute world positions
+     * @return Number of successfully transformed points, invalid points are set to (-1, -1)
+     */
+    int WorldToScreenBatch(const Vec3d* worldPoints, Vec2* screenPoints, int count) const;
+
+    /**
+     * @brief Calculates the distance from camera to an absolute world position
+     */
+    float GetDistanceToPoint(const Vec3d& worldPos) const {
+        return m_relative.GetDistanceToPoint(worldPos.RelativeTo(m_origin));
+    }
+
+    /**
+     * @brief Converts an absolute position into the float space of the rebased matrix
+     */
+    Vec3 ToRelative(const Vec3d& worldPos) const { return worldPos.RelativeTo(m_origin); }
+
+    const Vec3d& GetOrigin() const { return m_origin; }
+
+    /**
+     * @brief Float transform operating on origin-relative positions
+     */
+    const WorldToScreenTransform& GetRelativeTransform() const { return m_relative; }
+};
+
 /**
  * @brief Utility functions for common transformations
  */
@@ -424,10 +697,38 @@ namespace W2SUtils {
      * @param viewport Screen viewport
      * @param screenPos Output 2D screen position
      * @return true if transformation successful
+     * @note Maps to pixels per call; when many points share one camera, build the
+     *       matrix once with CreateScreenMatrix and use QuickWorldToScreenFused
      */
     bool QuickWorldToScreen(const Vec3& worldPos, const Matrix4x4& viewMatrix, 
                            const Viewport& viewport, Vec2& screenPos);
 
+    /**
+     * @brief Folds the viewport mapping into a view-projection matrix
+     * 
+     * Rows 0 and 1 become center.x * w + halfWidth * x and center.y * w - halfHeight * y,
+     * so dividing them by w (row 3, unchanged) gives pixel coordinates directly.
+     */
+    Matrix4x4 CreateScreenMatrix(const Matrix4x4& viewProjMatrix, const Viewport& viewport);
+
+    /**
+     * @brief Fast path for a matrix built by CreateScreenMatrix: one transform and a reciprocal
+     * @param screenMatrix Fused view-projection-viewport matrix, not a plain view-projection
+     *        matrix (those go to QuickWorldToScreen with a Viewport)
+     * @return true if the point is in front of the camera
+     */
+    inline bool QuickWorldToScreenFused(const Vec3& worldPos, const Matrix4x4& screenMatrix, Vec2& screenPos) {
+        const float (&m)[4][4] = screenMatrix.m;
+        const float w = m[3][0] * worldPos.x + m[3][1] * worldPos.y + m[3][2] * worldPos.z + m[3][3];
+        if (w < 0.001f) {
+            return false;
+        }
+        const float invW = 1.0f / w;
+        screenPos.x = (m[0][0] * worldPos.x + m[0][1] * worldPos.y + m[0][2] * worldPos.z + m[0][3]) * invW;
+        screenPos.y = (m[1][0] * worldPos.x + m[1][1] * worldPos.y + m[1][2] * worldPos.z + m[1][3]) * invW;
+        return true;
+    }
+
     /**
      * @brief Create a view matrix from position and Euler angles
      */
@@ -464,11 +765,91 @@ namespace W2SUtils {
      */
     Ray ScreenToWorldRay(const Vec2& screenPos, const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix, const Viewport& viewport);
 
+    /**
+     * @brief Unproject one pixel with a precomputed inverse view-projection
+     * @param invViewProj Result of InvertMatrix on the view-projection matrix
+     * @return Ray starting on the near plane with a normalized direction
+     */
+    Ray ScreenToWorldRay(const Vec2& screenPos, const Matrix4x4& invViewProj, const Viewport& viewport);
+
+    /**
+     * @brief SIMD unprojection of a list of pixels into SoA rays
+     * 
+     * The pixel-to-NDC mapping is folded into the inverse once per call, so
+     * each ray costs two homogeneous transforms, two divides and a normalize.
+     * Directions point from the near plane through the NDC depth-0 plane, so
+     * infinite-far projections work too.
+     * 
+     * @param invViewProj Result of InvertMatrix on a GL-style (-1..1 depth) view-projection
+     * @param origins Output ray origins on the near plane, count entries per stream
+     * @param directions Output normalized ray directions, count entries per stream
+     */
+    void ScreenToWorldRays(const float* screenX, const float* screenY, size_t count,
+                           const Matrix4x4& invViewProj, const Viewport& viewport,
+                           VectorMath::Vec3SoA origins, VectorMath::Vec3SoA directions);
+
+    /**
+     * @brief SIMD unprojection of a regular pixel grid, e.g. a visibility probe
+     * 
+     * Ray (column, row) goes through firstPixel + (column * step.x, row * step.y)
+     * and is stored at row * columns + column.
+     */
+    void ScreenToWorldRayGrid(const Vec2& firstPixel, const Vec2& step, int columns, int rows,
+                              const Matrix4x4& invViewProj, const Viewport& viewport,
+                              VectorMath::Vec3SoA origins, VectorMath::Vec3SoA directions);
+
     /**
      * @brief Calculate matrix inverse
      */
     Matrix4x4 InverseMatrix(const Matrix4x4& matrix);
 
+    /**
+     * @brief General 4x4 inverse (cofactor expansion in double precision)
+     * 
+     * Unlike InverseMatrix this handles projective matrices.
+     * @return false if the matrix is singular; inverse is left untouched
+     */
+    bool InvertMatrix(const Matrix4x4& matrix, Matrix4x4& inverse);
+
+    /**
+     * @brief View distance (w) of an NDC depth value
+     * 
+     * Works for every perspective matrix of the CreatePerspective family, standard,
+     * reverse-Z or infinite, by inverting depth = m[2][3] / w - m[2][2].
+     * @param projMatrix Projection matrix without the view transform
+     */
+    inline float LinearizeDepth(float ndcDepth, const Matrix4x4& projMatrix) {
+        return projMatrix.m[2][3] / (ndcDepth + projMatrix.m[2][2]);
+    }
+
+    /**
+     * @brief LinearizeDepth for many values with SIMD
+     */
+    void LinearizeDepthBatch(const float* ndcDepth, float* viewDepth, size_t count, const Matrix4x4& projMatrix);
+
+    /**
+     * @brief Depth precision of a projection over a distance range
+     */
+    struct DepthErrorStats {
+        double maxRelativeError;    // |reconstructed - true| / true distance
+        double meanRelativeError;
+        size_t orderingErrors;      // sample pairs whose float depths tie or invert
+        size_t sampleCount;
+    };
+
+    /**
+     * @brief Measures how well float NDC depth preserves distance and order
+     * 
+     * Points on the view axis at log-spaced distances between nearDistance and
+     * farDistance are projected in float the way the batch kernels do it and
+     * linearized again in double. Each point is also paired with one
+     * separation * distance farther away; a pair whose depths tie or invert
+     * counts as an ordering error.
+     * @param projMatrix Projection matrix of the CreatePerspective family
+     */
+    DepthErrorStats MeasureDepthError(const Matrix4x4& projMatrix, float nearDistance, float farDistance,
+                                      size_t sampleCount, float separation = 1e-4f);
+
     /**
      * @brief Check if a 3D bounding box is visible in the view frustum
      */
@@ -491,6 +872,38 @@ namespace W2SUtils {
 
     /**
      * @brief Calculate the screen-space bounding rectangle of a 3D bounding box
+     *
+     * The part of the box behind the camera is clipped away, so boxes that
+     * straddle the camera plane get the rectangle of their visible part. The
+     * rectangle is not clamped to the viewport.
      */
     ScreenRect GetScreenBounds(const Vec3& minBounds, const Vec3& maxBounds, const Matrix4x4& viewMatrix, const Viewport& viewport);
+
+    /**
+     * @brief Output streams for batched screen rectangles
+     */
+    struct ScreenRectSoA {
+        float* left;
+        float* right;
+        float* top;
+        float* bottom;
+
+        ScreenRectSoA(float* l, float* r, float* t, float* b) : left(l), right(r), top(t), bottom(b) {}
+    };
+
+    /**
+     * @brief GetScreenBounds for many SoA boxes with SIMD
+     * @param validMask Output, (count + 31) / 32 words, bit i set if box i is partly in front
+     *        of the camera; rectangles of invalid boxes are zero. May be null
+     * @return Number of valid rectangles
+     */
+    size_t GetScreenBoundsBatch(ConstVec3SoA boxMin, ConstVec3SoA boxMax, size_t count,
+                                const Matrix4x4& viewMatrix, const Viewport& viewport,
+                                ScreenRectSoA rects, uint32_t* validMask);
+
+    /**
+     * @brief GetScreenBounds for many AoS boxes, validity in ScreenRect::valid
+     */
+    size_t GetScreenBoundsBatch(const AABB* boxes, size_t count, const Matrix4x4& viewMatrix,
+                                const Viewport& viewport, ScreenRect* rects);
 }
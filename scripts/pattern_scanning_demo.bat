@@ -13,6 +13,7 @@ echo Compiling pattern scanning demo executable...
 cl /EHsc /std:c++17 /O2 ^
    examples/pattern_scanning_demo.cpp ^
    libraries/pattern-scanning/PatternScanning.cpp ^
+   libraries/vector-math/CpuFeatures.cpp ^
    /Fe:compiled/pattern_scanning_demo.exe ^
    kernel32.lib user32.lib advapi32.lib
 
@@ -13,6 +13,7 @@ set DEMO_NAME=vector_math_demo
 set SOURCE_FILE=examples\%DEMO_NAME%.cpp
 set HEADER_FILE=libraries\vector-math\Vector.hpp
 set IMPL_FILE=libraries\vector-math\Vector.cpp
+set IMPL_SOURCES=libraries\vector-math\*.cpp
 
 echo Checking required files...
 if not exist "%SOURCE_FILE%" (
@@ -52,10 +53,10 @@ echo [OK] Build environment configured.
 echo.
 
 echo Compiling VectorMath Demo...
-echo Command: cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %IMPL_FILE%
+echo Command: cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %IMPL_SOURCES%
 echo.
 
-cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %IMPL_FILE%
+cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %IMPL_SOURCES%
 
 if errorlevel 1 (
     echo.
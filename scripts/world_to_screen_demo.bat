@@ -14,6 +14,8 @@ set SOURCE_FILE=examples\%DEMO_NAME%.cpp
 set HEADER_FILE=libraries\world-to-screen\WorldToScreen.hpp
 set IMPL_FILE=libraries\world-to-screen\WorldToScreen.cpp
 set VECTOR_IMPL_FILE=libraries\vector-math\Vector.cpp
+set VECTOR_IMPL_SOURCES=libraries\vector-math\*.cpp
+set W2S_IMPL_SOURCES=libraries\world-to-screen\*.cpp
 
 echo Checking required files...
 if not exist "%SOURCE_FILE%" (
@@ -59,10 +61,10 @@ echo [OK] Build environment configured.
 echo.
 
 echo Compiling WorldToScreen Demo...
-echo Command: cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %IMPL_FILE% %VECTOR_IMPL_FILE%
+echo Command: cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %W2S_IMPL_SOURCES% %VECTOR_IMPL_SOURCES%
 echo.
 
-cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %IMPL_FILE% %VECTOR_IMPL_FILE%
+cl /EHsc /std:c++17 /O2 /Fe:compiled\%DEMO_NAME%.exe %SOURCE_FILE% %W2S_IMPL_SOURCES% %VECTOR_IMPL_SOURCES%
 
 if errorlevel 1 (
     echo.